@@ -46,6 +46,7 @@ if not exist build mkdir build
 :: build
 pushd build
 %compile% ..\src\main.c %compile_link% %out%gdb.exe|| exit /b 1
+%compile% ..\src\bench\bench_main.c %compile_link% %out%gdb_bench.exe|| exit /b 1
 popd
 
 :: unset
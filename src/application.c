@@ -1,20 +1,36 @@
 
 internal void
-app_execute_query(String8 sql_query)
+app_init(void)
+{
+  Arena* arena = arena_alloc();
+  g_app_scan_scheduler = push_array(arena, APP_ScanScheduler, 1);
+  g_app_scan_scheduler->arena = arena;
+  g_app_scan_scheduler->mutex = os_mutex_alloc();
+  g_app_scan_scheduler->cv = os_condition_variable_alloc();
+  
+  g_app_statement_cache = push_array(arena, APP_StatementCache, 1);
+  g_app_statement_cache->mutex = os_mutex_alloc();
+}
+
+internal void
+app_execute_query(String8 sql_query, APP_QueryContext* context)
 {
   ProfBeginFunction();
   
+  APP_QueryContext local_context = { 0 };
+  if (context == NULL)
+  {
+    context = &local_context;
+  }
+  
   Arena* arena = arena_alloc(.reserve_size=GB(1), .commit_size=MB(32));
   
-  SQL_TokenizeResult tokenize_result = sql_tokenize_from_text(arena, sql_query);
-  SQL_Node* sql_root = sql_parse(arena, tokenize_result.tokens, tokenize_result.count);
-  IR_Query* ir_query = ir_generate_from_ast(arena, sql_root);
-  //sql_tokens_print(tokenize_result);
-  //sql_print_ast(sql_root);
+  // tec: repeated queries skip tokenizing, parsing and ir generation
+  IR_Query* ir_query = app_query_from_text(arena, sql_query);
   //ir_print_query(ir_query);
   
   
-  GDB_Database* database = NULL;
+  GDB_Database* database = context->database;
   
   for (IR_Node* ir_execution_node = ir_query->execution_nodes; ir_execution_node != NULL;
        ir_execution_node = ir_execution_node->next)
@@ -29,9 +45,9 @@ app_execute_query(String8 sql_query)
         
         if (use_ir_node->type == IR_NodeType_Database)
         {
+          // tec: a database stays loaded once used, the server keeps it warm between queries
           String8 database_path = push_str8f(arena, "gdb_data/%.*s", str8_varg(use_ir_node->value));
-          database = gdb_database_load(database_path);
-          gdb_add_database(database);
+          database = gdb_find_or_load_database(use_ir_node->value, database_path);
         }
       } break;
       
@@ -42,8 +58,18 @@ app_execute_query(String8 sql_query)
         if (create_ir_node->type == IR_NodeType_Database)
         {
           database = gdb_database_alloc(create_ir_node->value);
+          String8 database_path = push_str8f(arena, "gdb_data/%.*s", str8_varg(database->name));
+          database->wal = gdb_wal_open(database, database_path);
           gdb_add_database(database);
         }
+        else if (database == NULL)
+        {
+          log_error("no database selected, 'use' or 'create' one first");
+          context->failed = 1;
+          arena_release(arena);
+          ProfEnd();
+          return;
+        }
         else if (create_ir_node->type == IR_NodeType_Table)
         {
           GDB_Table* table = gdb_table_alloc(create_ir_node->value);
@@ -57,13 +83,52 @@ app_execute_query(String8 sql_query)
           
           gdb_database_add_table(database, table);
         }
+        else if (create_ir_node->type == IR_NodeType_Index)
+        {
+          IR_Node* table_node = ir_node_find_child(create_ir_node, IR_NodeType_Table);
+          IR_Node* column_node = ir_node_find_child(create_ir_node, IR_NodeType_Column);
+          IR_Node* kind_node = ir_node_find_child(create_ir_node, IR_NodeType_Type);
+          
+          GDB_Table* table = gdb_database_find_table(database, table_node->value);
+          GDB_Column* column = table ? gdb_table_find_column(table, column_node->value) : 0;
+          if (column)
+          {
+            // tec: strings can only be hashed, numbers default to the sorted index which also serves ranges
+            GDB_IndexKind kind = (column->type == GDB_ColumnType_String8) ? GDB_IndexKind_Hash : GDB_IndexKind_Sorted;
+            if (kind_node)
+            {
+              kind = gdb_index_kind_from_string(kind_node->value);
+            }
+            gdb_index_create(table, create_ir_node->value, column->name, kind);
+          }
+          else
+          {
+            context->failed = 1;
+          }
+        }
         
       } break;
       case IR_NodeType_Insert:
       {
         // tec: table
         IR_Node* table_object = ir_node_find_child(ir_execution_node, IR_NodeType_Table);
+        if (database == NULL)
+        {
+          log_error("no database selected, 'use' or 'create' one first");
+          context->failed = 1;
+          arena_release(arena);
+          ProfEnd();
+          return;
+        }
+        // tec: the lookup logs the missing table itself
         GDB_Table* table = gdb_database_find_table(database, table_object->value);
+        if (table == NULL)
+        {
+          context->failed = 1;
+          arena_release(arena);
+          ProfEnd();
+          return;
+        }
         
         // tec: skip column defs
         IR_Node* columns_object = table_object->next;
@@ -74,10 +139,17 @@ app_execute_query(String8 sql_query)
         //- tec: value group
         Temp scratch = scratch_begin(0, 0);
         
-        void** row_data = push_array(scratch.arena, void*, table->column_count);
+        U64 row_count = 0;
+        for (IR_Node* value_group_node = values_object->first; value_group_node != 0; value_group_node = value_group_node->next)
+        {
+          row_count++;
+        }
+        void*** rows = push_array(scratch.arena, void**, row_count);
         
+        U64 row_index = 0;
         for (IR_Node* value_group_node = values_object->first; value_group_node != 0; value_group_node = value_group_node->next)
         {
+          void** row_data = push_array(scratch.arena, void*, table->column_count);
           U64 column_index = 0;
           
           for (IR_Node* data_node = value_group_node->first; data_node != 0; data_node = data_node->next)
@@ -85,6 +157,10 @@ app_execute_query(String8 sql_query)
             if (column_index >= table->column_count)
             {
               log_error("too many values in 'insert' statement");
+              scratch_end(scratch);
+              context->failed = 1;
+              arena_release(arena);
+              ProfEnd();
               return;
             }
             
@@ -93,36 +169,51 @@ app_execute_query(String8 sql_query)
             
             void* value_ptr = 0;
             
+            if (data_node->type == IR_NodeType_Null)
+            {
+              row_data[column_index] = 0;
+              column_index++;
+              continue;
+            }
+            
             switch (column->type)
             {
               case GDB_ColumnType_U32:
               {
-                U32 value = (U32)u64_from_str8(value_str, 10);
-                value_ptr = &value;
+                U32* value = push_array(scratch.arena, U32, 1);
+                *value = (U32)u64_from_str8(value_str, 10);
+                value_ptr = value;
               } break;
               case GDB_ColumnType_U64:
               {
-                U64 value = u64_from_str8(value_str, 10);
-                value_ptr = &value;
+                U64* value = push_array(scratch.arena, U64, 1);
+                *value = u64_from_str8(value_str, 10);
+                value_ptr = value;
               } break;
               case GDB_ColumnType_F32:
               {
-                F32 value = (F32)f64_from_str8(value_str);
-                value_ptr = &value;
+                F32* value = push_array(scratch.arena, F32, 1);
+                *value = (F32)f64_from_str8(value_str);
+                value_ptr = value;
               } break;
               case GDB_ColumnType_F64:
               {
-                F64 value = f64_from_str8(value_str);
-                value_ptr = &value;
+                F64* value = push_array(scratch.arena, F64, 1);
+                *value = f64_from_str8(value_str);
+                value_ptr = value;
               } break;
               case GDB_ColumnType_String8:
               {
-                String8* value = push_array(arena, String8, 1);
+                String8* value = push_array(scratch.arena, String8, 1);
                 *value = value_str;
                 value_ptr = value;
               } break;
               default:
               log_error("unknown column type");
+              scratch_end(scratch);
+              context->failed = 1;
+              arena_release(arena);
+              ProfEnd();
               return;
             }
             
@@ -133,12 +224,19 @@ app_execute_query(String8 sql_query)
           if (column_index != table->column_count)
           {
             log_error("mismatch in column count and value count in 'insert' statement");
+            scratch_end(scratch);
+            context->failed = 1;
+            arena_release(arena);
+            ProfEnd();
             return;
           }
           
-          gdb_table_add_row(table, row_data);
+          rows[row_index++] = row_data;
         }
         
+        // tec: the whole statement is one write-ahead log record
+        gdb_table_insert_rows(table, rows, row_count);
+        
         scratch_end(scratch);
         
       } break;
@@ -174,91 +272,206 @@ app_execute_query(String8 sql_query)
         
         IR_Node* table_node = ir_node_find_child(ir_execution_node, IR_NodeType_Table);
         IR_Node* import_file_node = ir_node_find_child(ir_execution_node, IR_NodeType_Literal);
+        IR_Node* column_list_node = ir_node_find_child(ir_execution_node, IR_NodeType_ColumnList);
+        IR_Node* where_node = ir_node_find_child(ir_execution_node, IR_NodeType_Where);
         
-        //if (gdb_database_contains_table(database, table_node->value))
+        // tec: an existing table is appended to, its columns keep their types and the input is converted to them.
+        // a new one is built under a reserved name, so a second import of the same name can not build it too
+        B32 reserved = 0;
+        GDB_Table* existing_table = database ? gdb_database_find_or_reserve_table(database, table_node->value, &reserved) : 0;
+        if (database == NULL)
         {
-          
+          log_error("no database selected, 'use' or 'create' one first");
+          context->failed = 1;
+        }
+        else if (existing_table == 0 && !reserved)
+        {
+          log_error("table '%.*s' is being created by another statement", str8_varg(table_node->value));
+          context->failed = 1;
+        }
+        else if (existing_table)
+        {
+          Temp scratch = scratch_begin(0, 0);
+          String8 filepath = push_str8f(scratch.arena, "%.*s", 
+                                        str8_varg(import_file_node->value));
+          if (column_list_node || where_node || gdb_parquet_path_is_parquet(filepath) || gdb_arrow_path_is_arrow(filepath))
+          {
+            log_error("appending to an existing table is only supported for CSV input, table '%.*s' already exists",
+                      str8_varg(table_node->value));
+            context->failed = 1;
+          }
+          else if (!gdb_table_import_csv_append(existing_table, filepath))
+          {
+            context->failed = 1;
+          }
+          scratch_end(scratch);
         }
-        //else
+        else
         {
           Temp scratch = scratch_begin(0, 0);
           String8 filepath = push_str8f(scratch.arena, "%.*s", 
                                         str8_varg(import_file_node->value));
           //GDB_Table* table = gdb_table_import_csv(database, filepath);
-          GDB_Table* table = gdb_table_import_csv_streaming(database, table_node->value, filepath);
+          GDB_Table* table = 0;
+          if (gdb_parquet_path_is_parquet(filepath))
+          {
+            // tec: named columns are the only ones read, the where clause skips row groups and rows while reading
+            String8List columns = {0};
+            for (IR_Node* column = column_list_node ? column_list_node->first : 0; column != 0; column = column->next)
+            {
+              str8_list_push(scratch.arena, &columns, column->value);
+            }
+            GDB_ParquetFilter* filters = 0;
+            if (!where_node || app_import_filters_from_condition(scratch.arena, where_node->first, &filters))
+            {
+              table = gdb_table_import_parquet(database, table_node->value, filepath, columns, filters);
+            }
+          }
+          else if (column_list_node || where_node)
+          {
+            log_error("column lists and 'where' on 'import' are only supported for Parquet files");
+          }
+          else if (gdb_arrow_path_is_arrow(filepath))
+          {
+            table = gdb_table_import_arrow(database, table_node->value, filepath);
+          }
+          else
+          {
+            table = gdb_table_import_csv_streaming(database, table_node->value, filepath);
+          }
           //table->name = push_str8_copy(table->arena, table_node->value);
           //table->name = push_str8_copy(table->arena, table_node->value);
           scratch_end(scratch);
-          gdb_database_add_table(database, table);
+          if (table)
+          {
+            gdb_database_add_reserved_table(database, table_node->value, table);
+          }
+          else
+          {
+            gdb_database_drop_reserved_table(database, table_node->value);
+            context->failed = 1;
+          }
         }
         
         ProfEnd();
       } break;
       
-      //~ tec: gpu
-      case IR_NodeType_Select:
+      case IR_NodeType_Export:
       {
-        ProfBegin("SQL: Select");
-        U64 start_time = os_now_microseconds();
-        
-        ir_expand_star_to_columns(arena, database, ir_execution_node);
-        
-        String8 kernel_name = str8_lit("select_query");
-        APP_KernelResult result = app_perform_kernel(arena, kernel_name, database, ir_execution_node);
-        
-        IR_Node* select_output_columns = ir_node_find_child(ir_execution_node, IR_NodeType_ColumnList);
-        GDB_Table* table = gdb_database_find_table(database, ir_node_find_child(ir_execution_node, IR_NodeType_Table)->value);
+        ProfBegin("SQL: Export");
         
-        log_info("result count %llu", result.count);
-#if PRINT_SELECT_OUTPUT
-        Temp scratch = scratch_begin(0, 0);
-        for (U64 i = 0; i < result.count; i++)
+        IR_Node* table_node = ir_node_find_child(ir_execution_node, IR_NodeType_Table);
+        IR_Node* export_file_node = ir_node_find_child(ir_execution_node, IR_NodeType_Literal);
+        GDB_Table* table = gdb_database_find_table(database, table_node->value);
+        if (table == NULL)
+        {
+          log_error("table '%.*s' does not exist", str8_varg(table_node->value));
+          context->failed = 1;
+        }
+        else
         {
-          U64 row_index = result.indices[i];
-          for (IR_Node* column_node = select_output_columns->first; column_node != NULL; column_node = column_node->next)
+          Temp scratch = scratch_begin(0, 0);
+          String8 filepath = push_str8_copy(scratch.arena, export_file_node->value);
+          B32 exported = gdb_arrow_path_is_arrow(filepath) ? gdb_table_export_arrow(table, filepath) : gdb_table_export_csv(table, filepath);
+          if (!exported)
           {
-            GDB_Column* column = gdb_table_find_column(table, column_node->value);
-            void* data = gdb_column_get_data(column, row_index);
-            
-            switch (column->type)
-            {
-              case GDB_ColumnType_U32:
-              printf("%u ", *(U32*)data);
-              break;
-              case GDB_ColumnType_U64:
-              printf("%llu ", *(U64*)data);
-              break;
-              case GDB_ColumnType_F32:
-              printf("%f ", *(F32*)data);
-              break;
-              case GDB_ColumnType_F64:
-              printf("%lf ", *(F64*)data);
-              break;
-              case GDB_ColumnType_String8: 
-              {
-                String8 str = gdb_column_get_string(scratch.arena, column, row_index);
-                printf("%.*s ", str8_varg(str));
-              } break;
-              default:
-              printf("UNKNOWN ");
-              break;
-            }
+            context->failed = 1;
           }
-          printf("\n");
           scratch_end(scratch);
         }
-#endif
         
-        log_info("total 'SELECT' query time: %.4f ms", (os_now_microseconds() - start_time) / 1000.0f);
+        ProfEnd();
+      } break;
+      
+      //~ tec: gpu
+      case IR_NodeType_Select:
+      {
+        app_execute_select(arena, context, database, ir_execution_node, 0);
+      } break;
+      
+      case IR_NodeType_Explain:
+      {
+        ProfBegin("SQL: Explain");
+        
+        IR_Node* statement_node = ir_execution_node->first;
+        if (statement_node == NULL)
+        {
+          log_error("'explain' expects a statement");
+          context->failed = 1;
+        }
+        else if (str8_match(ir_execution_node->value, str8_lit("analyze"), StringMatchFlag_CaseInsensitive))
+        {
+          // tec: analyze runs the statement, its rows are gathered and dropped
+          if (statement_node->type != IR_NodeType_Select)
+          {
+            log_error("'explain analyze' only supports 'select'");
+            context->failed = 1;
+          }
+          else
+          {
+            APP_ExplainAnalyze analyze = { 0 };
+            app_execute_select(arena, context, database, statement_node, &analyze);
+            app_report_explain_analyze(arena, context, &analyze);
+          }
+        }
+        else
+        {
+          String8List plan = { 0 };
+          app_explain_plan(arena, database, statement_node, &plan);
+          for (String8Node* line = plan.first; line != NULL; line = line->next)
+          {
+            log_info("%.*s", str8_varg(line->string));
+          }
+          if (context->sink)
+          {
+            app_stream_text_result(context->sink, str8_lit("plan"), &plan);
+          }
+          else if (context->output_arena)
+          {
+            app_encode_text_result(context->output_arena, &context->output, str8_lit("plan"), &plan);
+          }
+        }
         
         ProfEnd();
       } break;
       
+      case IR_NodeType_Prepare:
+      {
+        if (!app_statement_prepare(ir_execution_node))
+        {
+          context->failed = 1;
+        }
+      } break;
+      
+      case IR_NodeType_Execute:
+      {
+        // tec: the bound statement is spliced in after this node, the loop runs it next
+        IR_Node* bound_nodes = app_statement_execute(arena, ir_execution_node);
+        if (bound_nodes)
+        {
+          IR_Node* last_bound_node = bound_nodes;
+          for (; last_bound_node->next != NULL; last_bound_node = last_bound_node->next);
+          last_bound_node->next = ir_execution_node->next;
+          ir_execution_node->next = bound_nodes;
+        }
+        else
+        {
+          context->failed = 1;
+        }
+      } break;
+      
     }
   }
   
-  String8 database_filepath = push_str8f(arena, "gdb_data/%.*s", (U32)database->name.size, database->name.str);
-  gdb_database_save(database, database_filepath);
+  context->database = database;
+  
+  // tec: only flushes what the query changed
+  if (database)
+  {
+    String8 database_filepath = push_str8f(arena, "gdb_data/%.*s", (U32)database->name.size, database->name.str);
+    gdb_database_save(database, database_filepath);
+    gdb_wal_checkpoint_if_needed(database, database_filepath);
+  }
   
   //String8 table_filepath = push_str8f(arena, "gdb_data/benchmark/%.*s/", str8_varg(database->tables[0]->name));
   //gdb_table_save(database->tables[0], table_filepath);
@@ -271,255 +484,2340 @@ app_execute_query(String8 sql_query)
   ProfEnd();
 }
 
-internal APP_KernelResult
-app_perform_kernel(Arena* arena, String8 kernel_name, GDB_Database* database, IR_Node* root_node)
+//~ tec: statement cache
+internal IR_Query*
+app_query_from_text(Arena* arena, String8 sql_query)
 {
   ProfBeginFunction();
   
-  APP_KernelResult result = { 0 };
-  
-  IR_Node* where_clause = ir_node_find_child(root_node, IR_NodeType_Where);
-  String8List active_columns = { 0 };
-  ir_create_active_column_list(arena, where_clause, &active_columns);
-  String8 kernel_code = gpu_generate_kernel_from_ir(arena, kernel_name, database, root_node, &active_columns);
-  //log_debug("kernel output:\n%.*s", str8_varg(kernel_code));
-  
-  GPU_Kernel* kernel = gpu_kernel_alloc(kernel_name, kernel_code);
-  if (!kernel)
-  {
-    log_error("failed to alloc kernel");
-    return result;
-  }
-  
-  GDB_Table* table = gdb_database_find_table(database, ir_node_find_child(root_node, IR_NodeType_Table)->value);
-  U64 largest_column_size = 0;
-  U64 gpu_buffer_count = 0;
-  for (String8Node* node = active_columns.first; node != NULL; node = node->next)
-  {
-    GDB_Column* column = gdb_table_find_column(table, node->string);
-    gpu_buffer_count += column->type == GDB_ColumnType_String8 ? 2 : 1;
-    largest_column_size = Max(gdb_column_get_total_size(column), largest_column_size);
-  }
-  
-  U64 gpu_kernel_execution_time = 0;
-  U64 load_data_from_disk_time = 0;
+  IR_Query* ir_query = push_array(arena, IR_Query, 1);
+  B32 done = 0;
   
-  if (largest_column_size > GPU_MAX_BUFFER_SIZE)
+  //- tec: read only queries bind their literals to the ir of an earlier query with the same normalized text
+  SQL_Token* literals = push_array(arena, SQL_Token, APP_STATEMENT_MAX_PARAMS);
+  U64 literal_count = 0;
+  String8 normalized_text = sql_normalize_text(arena, sql_query, literals, APP_STATEMENT_MAX_PARAMS, &literal_count);
+  if (normalized_text.size != 0 && app_statement_text_is_cacheable(normalized_text))
   {
-    U64 row_size = 0;
-    for (String8Node* node = active_columns.first; node != NULL; node = node->next)
+    IR_Node** params = push_array(arena, IR_Node*, literal_count);
+    for (U64 i = 0; i < literal_count; i++)
     {
-      GDB_Column* column = gdb_table_find_column(table, node->string);
-      //row_size += column->size;
-      row_size += gdb_column_get_total_size(column) / table->row_count;
+      IR_NodeType type = (literals[i].type == SQL_TokenType_Number) ? IR_NodeType_Numeric : IR_NodeType_Literal;
+      params[i] = ir_node_make(arena, type, literals[i].value);
     }
-    if (row_size == 0) row_size = 1;
     
-    U64 rows_per_chunk = GPU_MAX_BUFFER_SIZE / row_size;
-    if (rows_per_chunk == 0) rows_per_chunk = 1;
-    
-    U64 chunk_count = (table->row_count + rows_per_chunk - 1) / rows_per_chunk;
-    U64 chunk_size = GPU_MAX_BUFFER_SIZE;
+    OS_MutexScope(g_app_statement_cache->mutex)
+    {
+      APP_Statement* statement = app_statement_cache_find(normalized_text, 0);
+      if (statement)
+      {
+        ir_query->execution_nodes = app_statement_bind(arena, statement, params, literal_count);
+        g_app_statement_cache->hits++;
+        done = 1;
+      }
+    }
     
-    for (U64 chunk_index = 0; chunk_index < chunk_count; chunk_index++)
+    if (!done)
     {
-      Temp chunk_arena = temp_begin(arena);
-      
-      U64 chunk_offset = chunk_index * chunk_size;
-      U64 chunk_rows = Min(rows_per_chunk, table->row_count - (chunk_index * rows_per_chunk));
-      
-      GPU_Buffer** column_gpu_buffers = push_array(arena, GPU_Buffer*, gpu_buffer_count);
-      U32 column_index = 0;
-      
-      log_info("filtering rows %llu-%llu", chunk_index * rows_per_chunk, Min((chunk_index + 1) * rows_per_chunk, table->row_count));
-      
-      for (String8Node* node = active_columns.first; node != NULL; node = node->next)
+      APP_Statement* statement = app_statement_alloc(normalized_text, 0);
       {
-        GDB_Column* column = gdb_table_find_column(table, node->string);
-        
-        if (column->type == GDB_ColumnType_String8)
-        {
-          U64 start_read_time = os_now_microseconds();
-          GDB_StringDataChunk chunk = gdb_column_get_string_chunk(
-                                                                  chunk_arena.arena,
-                                                                  column,
-                                                                  r1u64(chunk_index * rows_per_chunk, Min((chunk_index + 1) * rows_per_chunk, table->row_count))
-                                                                  );
-          load_data_from_disk_time += os_now_microseconds() - start_read_time;
-          
-          if (chunk.data && chunk.offsets)
-          {
-            //column_gpu_buffers[column_index] = gpu_buffer_alloc(chunk.size, GPU_BufferFlag_Write | GPU_BufferFlag_CopyHostPointer, chunk.data);
-            column_gpu_buffers[column_index] = gpu_buffer_alloc(chunk.size, GPU_BufferFlag_Write | GPU_BufferFlag_HostVisible, NULL);
-            gpu_buffer_write(column_gpu_buffers[column_index], chunk.data, chunk.size);
-            column_index++;
-            
-            column_gpu_buffers[column_index] = gpu_buffer_alloc((chunk.row_count + 1) * sizeof(U64), GPU_BufferFlag_Write | GPU_BufferFlag_CopyHostPointer, chunk.offsets);
-            column_index++;
-          }
-          
-          gdb_column_close_string_chunk(column);
-        }
-        else
-        {
-          U64 size = 0;
-          U64 start_read_time = os_now_microseconds();
-          void* data_ptr = gdb_column_get_data_range(
-                                                     chunk_arena.arena,
-                                                     column,
-                                                     r1u64(chunk_index * rows_per_chunk, Min((chunk_index + 1) * rows_per_chunk, table->row_count)),
-                                                     &size
-                                                     );
-          load_data_from_disk_time += os_now_microseconds() - start_read_time;
-          
-          if (data_ptr)
-          {
-            column_gpu_buffers[column_index] = gpu_buffer_alloc(size, GPU_BufferFlag_Write | GPU_BufferFlag_CopyHostPointer, data_ptr);
-            column_index++;
-          }
-        }
+        Temp scratch = scratch_begin(&arena, 1);
+        SQL_TokenizeResult tokenize_result = sql_tokenize_from_text(scratch.arena, statement->key);
+        SQL_Node* sql_root = sql_parse(scratch.arena, tokenize_result.tokens, tokenize_result.count);
+        statement->execution_nodes = ir_generate_from_ast(statement->arena, sql_root)->execution_nodes;
+        scratch_end(scratch);
       }
-      
-      GPU_Buffer* output_buffer = gpu_buffer_alloc(chunk_rows * sizeof(U64), GPU_BufferFlag_Read, 0);
-      U64 zero = 0;
-      GPU_Buffer* result_counter_buffer = gpu_buffer_alloc(sizeof(U64), GPU_BufferFlag_ReadWrite | GPU_BufferFlag_HostCached, &zero);
-      
-      for (U64 i = 0; i < gpu_buffer_count; i++)
+      for (IR_Node* node = statement->execution_nodes; node != NULL; node = node->next)
       {
-        gpu_kernel_set_arg_buffer(kernel, i, column_gpu_buffers[i]);
+        U64 node_param_count = ir_node_param_count(node);
+        statement->param_count = Max(statement->param_count, node_param_count);
       }
-      gpu_kernel_set_arg_buffer(kernel, gpu_buffer_count + 0, output_buffer);
-      gpu_kernel_set_arg_buffer(kernel, gpu_buffer_count + 1, result_counter_buffer);
-      gpu_kernel_set_arg_u64(kernel,    gpu_buffer_count + 2, chunk_rows);
-      
-      // tec: TODO fix local size
-      U64 local_size = 1;
-      U64 group_size = (chunk_rows + (local_size - 1)) / local_size * local_size;
-      gpu_kernel_execute(kernel, chunk_rows, local_size);
-      gpu_kernel_execution_time += gpu_get_executed_kernel_time_microseconds();
-      
-      gpu_wait();
       
-      U64 result_count = 0;
-      gpu_buffer_read(result_counter_buffer, &result_count, sizeof(U64));
-      //U64* chunk_results = push_array(chunk_arena.arena, U64, result_count);
-      //gpu_buffer_read(output_buffer, chunk_results, result_count * sizeof(U64));
-      
-      gpu_wait();
-      
-      for (U64 i = 0; i < gpu_buffer_count; i++) gpu_buffer_release(column_gpu_buffers[i]);
-      temp_end(chunk_arena);
-      
-      if (result_count != 0)
+      // tec: a text that does not parse falls through to the plain path, which reports the error
+      if (statement->execution_nodes != NULL && statement->param_count == literal_count)
       {
-        if (result.indices == 0)
+        APP_Statement* cached = 0;
+        OS_MutexScope(g_app_statement_cache->mutex)
         {
-          result.cap = result_count;
-          result.indices = push_array(arena, U64, result.cap);
+          g_app_statement_cache->misses++;
+          cached = app_statement_cache_insert(statement);
+          ir_query->execution_nodes = app_statement_bind(arena, cached ? cached : statement, params, literal_count);
         }
-        else if (result.count + result_count > result.cap)
+        if (cached != statement)
         {
-          result.cap = Max(result.cap * 2, result.count + result_count);
-          U64* new_ptr = push_array(arena, U64, result.cap);
-          MemoryCopy(new_ptr, result.indices, result.count * sizeof(U64));
-          result.indices = new_ptr;
+          arena_release(statement->arena);
         }
-        
-        
-        //MemoryCopy(result.indices + result.count, chunk_results, result_count * sizeof(U64));
-        gpu_buffer_read(output_buffer, result.indices + result.count, result_count * sizeof(U64));
-        result.count += result_count;
+        done = 1;
+      }
+      else
+      {
+        arena_release(statement->arena);
       }
-      
-      gpu_buffer_release(output_buffer);
-      gpu_buffer_release(result_counter_buffer);
     }
   }
-  else
+  
+  //- tec: everything else is parsed as is
+  if (!done)
   {
-    log_info("filtering rows %llu-%llu", 0, table->row_count);
-    
-    GPU_Buffer** column_gpu_buffers = push_array(arena, GPU_Buffer*, gpu_buffer_count);
-    U32 column_index = 0;
+    Temp scratch = scratch_begin(&arena, 1);
+    SQL_TokenizeResult tokenize_result = sql_tokenize_from_text(scratch.arena, sql_query);
+    SQL_Node* sql_root = sql_parse(arena, tokenize_result.tokens, tokenize_result.count);
+    ir_query = ir_generate_from_ast(arena, sql_root);
+    //sql_tokens_print(tokenize_result);
+    //sql_print_ast(sql_root);
+    scratch_end(scratch);
     
-    for (String8Node* node = active_columns.first; node != NULL; node = node->next)
+    for (IR_Node* node = ir_query->execution_nodes; node != NULL; node = node->next)
     {
-      GDB_Column* column = gdb_table_find_column(table, node->string);
-      
-      if (column->type == GDB_ColumnType_String8)
-      {
-        GDB_StringDataChunk chunk = gdb_column_get_string_chunk(arena,
-                                                                column,
-                                                                r1u64(0, table->row_count));
-        
-        if (chunk.data && chunk.offsets)
-        {
-          column_gpu_buffers[column_index] = gpu_buffer_alloc(chunk.size, GPU_BufferFlag_Write | GPU_BufferFlag_CopyHostPointer, chunk.data);
-          column_index++;
-          
-          // tec: NOTE add 1 to the row count. so the last offset used for string size calculation
-          column_gpu_buffers[column_index] = gpu_buffer_alloc((chunk.row_count + 1) * sizeof(U64), GPU_BufferFlag_Write | GPU_BufferFlag_CopyHostPointer, chunk.offsets);
-          column_index++;
-        }
-        else
-        {
-          log_error("failed to load string data or offsets for column: %.*s", str8_varg(column->name));
-        }
-        gdb_column_close_string_chunk(column);
-      }
-      else
+      if (node->type != IR_NodeType_Prepare && ir_node_param_count(node) != 0)
       {
-        U64 size = 0;
-        void* data_ptr = gdb_column_get_data_range(arena, column, r1u64(0, table->row_count), &size);
-        column_gpu_buffers[column_index] = gpu_buffer_alloc(size, GPU_BufferFlag_Write | GPU_BufferFlag_CopyHostPointer, data_ptr);
-        column_index++;
+        log_error("parameters like $1 are only allowed in 'prepare'");
+        ir_query->execution_nodes = 0;
+        break;
       }
     }
-    
-    GPU_Buffer* output_buffer = gpu_buffer_alloc(table->row_count * sizeof(U64), GPU_BufferFlag_Read, 0);
-    U64 zero = 0;
-    GPU_Buffer* result_counter_buffer = gpu_buffer_alloc(sizeof(U64), GPU_BufferFlag_ReadWrite | GPU_BufferFlag_HostCached, &zero);
-    
-    
-    for (U64 i = 0; i < gpu_buffer_count; i++)
+  }
+  
+  ir_query->count = 0;
+  for (IR_Node* node = ir_query->execution_nodes; node != NULL; node = node->next)
+  {
+    ir_query->count++;
+  }
+  
+  ProfEnd();
+  return ir_query;
+}
+
+// tec: statements that write or define things usually run once, caching them would only fill the cache
+internal B32
+app_statement_text_is_cacheable(String8 normalized_text)
+{
+  local_persist String8 uncached_keywords[] =
+  {
+    str8_lit_comp("insert"),
+    str8_lit_comp("import"),
+    str8_lit_comp("export"),
+    str8_lit_comp("create"),
+    str8_lit_comp("alter"),
+    str8_lit_comp("delete"),
+    str8_lit_comp("drop"),
+    str8_lit_comp("prepare"),
+    str8_lit_comp("execute"),
+  };
+  
+  U64 pos = 0;
+  while (pos < normalized_text.size)
+  {
+    if (!char_is_alpha(normalized_text.str[pos]))
     {
-      gpu_kernel_set_arg_buffer(kernel, i, column_gpu_buffers[i]);
+      pos++;
+      continue;
     }
-    gpu_kernel_set_arg_buffer(kernel, gpu_buffer_count + 0, output_buffer);
-    gpu_kernel_set_arg_buffer(kernel, gpu_buffer_count + 1, result_counter_buffer);
-    gpu_kernel_set_arg_u64(kernel,    gpu_buffer_count + 2, table->row_count);
     
-    U64 group_size = 32;
-    U64 row_count = table->row_count;
-    U64 global_size = (row_count + (group_size - 1)) & ~(group_size - 1);
-    //gpu_kernel_execute(kernel, Min(global_size, row_count), Min(group_size, row_count));
-    gpu_kernel_execute(kernel, Min(global_size, row_count), 1);
-    gpu_kernel_execution_time += gpu_get_executed_kernel_time_microseconds();
-    
-    gpu_wait();
-    
-    U64 result_count = 0;
-    gpu_buffer_read(result_counter_buffer, &result_count, sizeof(U64));
-    if (result_count != 0)
+    U64 start = pos;
+    while (pos < normalized_text.size && (char_is_alpha(normalized_text.str[pos]) || char_is_digit(normalized_text.str[pos], 10) || normalized_text.str[pos] == '_'))
     {
-      U64* indices = push_array(arena, U64, result_count);
-      gpu_buffer_read(output_buffer, indices, result_count * sizeof(U64));
-      result.indices = indices;
-      result.count = result_count;
+      pos++;
     }
-    gpu_wait();
-    
-    gpu_buffer_release(output_buffer);
-    gpu_buffer_release(result_counter_buffer);
-    for (U64 i = 0; i < gpu_buffer_count; i++)
+    String8 word = str8_substr(normalized_text, r1u64(start, pos));
+    for (U64 i = 0; i < ArrayCount(uncached_keywords); i++)
     {
-      gpu_buffer_release(column_gpu_buffers[i]);
+      if (str8_match(word, uncached_keywords[i], StringMatchFlag_CaseInsensitive))
+      {
+        return 0;
+      }
     }
   }
-  
-  log_info("gpu kernel total execution time: %llu microseconds", gpu_kernel_execution_time);
-  log_info("load from disk total time: %llu microseconds", load_data_from_disk_time);
-  
-  ProfEnd();
-  return result;
-}
\ No newline at end of file
+  return 1;
+}
+
+internal APP_Statement*
+app_statement_alloc(String8 key, B32 is_prepared)
+{
+  Arena* arena = arena_alloc(.reserve_size=APP_STATEMENT_ARENA_RESERVE_SIZE, .commit_size=KB(16));
+  APP_Statement* statement = push_array(arena, APP_Statement, 1);
+  statement->arena = arena;
+  statement->key = push_str8_copy(arena, key);
+  statement->hash = u64_hash_from_str8(key);
+  statement->is_prepared = is_prepared;
+  return statement;
+}
+
+// tec: the caller holds the cache mutex
+internal APP_Statement*
+app_statement_cache_find(String8 key, B32 is_prepared)
+{
+  U64 hash = u64_hash_from_str8(key);
+  APP_Statement* result = 0;
+  for (APP_Statement* statement = g_app_statement_cache->buckets[hash % APP_STATEMENT_CACHE_BUCKET_COUNT];
+       statement != NULL; statement = statement->hash_next)
+  {
+    if (statement->hash == hash && statement->is_prepared == is_prepared && str8_match(statement->key, key, 0))
+    {
+      result = statement;
+      break;
+    }
+  }
+  return result;
+}
+
+// tec: the caller holds the cache mutex. a prepared statement replaces one of the same name, a cached
+// text returns the entry already there, or 0 when the cache is full
+internal APP_Statement*
+app_statement_cache_insert(APP_Statement* statement)
+{
+  APP_StatementCache* cache = g_app_statement_cache;
+  APP_Statement** bucket = &cache->buckets[statement->hash % APP_STATEMENT_CACHE_BUCKET_COUNT];
+  
+  for (APP_Statement** existing = bucket; *existing != NULL; existing = &(*existing)->hash_next)
+  {
+    APP_Statement* other = *existing;
+    if (other->hash == statement->hash && other->is_prepared == statement->is_prepared && str8_match(other->key, statement->key, 0))
+    {
+      if (!statement->is_prepared)
+      {
+        return other;
+      }
+      
+      // tec: bound copies never point into a statement, so the old one can go right away
+      *existing = other->hash_next;
+      arena_release(other->arena);
+      break;
+    }
+  }
+  
+  if (!statement->is_prepared)
+  {
+    if (cache->cached_count >= APP_STATEMENT_CACHE_MAX_COUNT)
+    {
+      return 0;
+    }
+    cache->cached_count++;
+  }
+  
+  statement->hash_next = *bucket;
+  *bucket = statement;
+  return statement;
+}
+
+// tec: the caller holds the cache mutex
+internal IR_Node*
+app_statement_bind(Arena* arena, APP_Statement* statement, IR_Node** params, U64 param_count)
+{
+  IR_Node* first = 0;
+  IR_Node** next = &first;
+  for (IR_Node* node = statement->execution_nodes; node != NULL; node = node->next)
+  {
+    *next = ir_node_copy(arena, node, params, param_count);
+    next = &(*next)->next;
+  }
+  return first;
+}
+
+internal B32
+app_statement_prepare(IR_Node* prepare_node)
+{
+  IR_Node* statement_node = prepare_node->first;
+  if (statement_node == NULL)
+  {
+    log_error("'prepare' expects a statement");
+    return 0;
+  }
+  
+  APP_Statement* statement = app_statement_alloc(prepare_node->value, 1);
+  statement->execution_nodes = ir_node_copy(statement->arena, statement_node, 0, 0);
+  statement->param_count = ir_node_param_count(statement_node);
+  OS_MutexScope(g_app_statement_cache->mutex)
+  {
+    app_statement_cache_insert(statement);
+  }
+  
+  log_info("prepared '%.*s' with %llu parameters", str8_varg(prepare_node->value), statement->param_count);
+  return 1;
+}
+
+// tec: the prepared statement with the values of execute_node bound, 0 when it does not exist or
+// the value count does not match
+internal IR_Node*
+app_statement_execute(Arena* arena, IR_Node* execute_node)
+{
+  U64 arg_count = 0;
+  for (IR_Node* arg = execute_node->first; arg != NULL; arg = arg->next)
+  {
+    arg_count++;
+  }
+  IR_Node** args = push_array(arena, IR_Node*, arg_count);
+  {
+    U64 arg_index = 0;
+    for (IR_Node* arg = execute_node->first; arg != NULL; arg = arg->next)
+    {
+      args[arg_index++] = arg;
+    }
+  }
+  
+  IR_Node* result = 0;
+  B32 found = 0;
+  U64 param_count = 0;
+  OS_MutexScope(g_app_statement_cache->mutex)
+  {
+    APP_Statement* statement = app_statement_cache_find(execute_node->value, 1);
+    if (statement)
+    {
+      found = 1;
+      param_count = statement->param_count;
+      if (param_count == arg_count)
+      {
+        result = app_statement_bind(arena, statement, args, arg_count);
+      }
+    }
+  }
+  
+  if (!found)
+  {
+    log_error("no prepared statement named '%.*s'", str8_varg(execute_node->value));
+  }
+  else if (param_count != arg_count)
+  {
+    log_error("'%.*s' expects %llu values, %llu were given", str8_varg(execute_node->value), param_count, arg_count);
+  }
+  return result;
+}
+
+//~ tec: select
+// tec: the table and every column the select projects or filters on have to exist, the planner, the kernel
+// generator and the encoders look them up without checking
+internal B32
+app_select_validate(Arena* arena, GDB_Database* database, IR_Node* select_node)
+{
+  IR_Node* table_node = ir_node_find_child(select_node, IR_NodeType_Table);
+  if (database == NULL || table_node == NULL)
+  {
+    log_error("'select' expects a table");
+    return 0;
+  }
+  GDB_Table* table = gdb_database_find_table(database, table_node->value);
+  if (table == NULL)
+  {
+    return 0;
+  }
+  
+  String8List columns = { 0 };
+  IR_Node* output_columns = ir_node_find_child(select_node, IR_NodeType_ColumnList);
+  for (IR_Node* column_node = output_columns ? output_columns->first : 0; column_node != NULL; column_node = column_node->next)
+  {
+    if (!str8_match(column_node->value, str8_lit("*"), 0))
+    {
+      str8_list_push(arena, &columns, column_node->value);
+    }
+  }
+  ir_create_active_column_list(arena, ir_node_find_child(select_node, IR_NodeType_Where), &columns);
+  
+  // tec: the lookups log what they do not find
+  B32 result = 1;
+  for (String8Node* node = columns.first; node != NULL; node = node->next)
+  {
+    result &= (gdb_table_find_column(table, node->string) != NULL);
+  }
+  return result;
+}
+
+internal void
+app_execute_select(Arena* arena, APP_QueryContext* context, GDB_Database* database, IR_Node* select_node, APP_ExplainAnalyze* analyze)
+{
+  ProfBegin("SQL: Select");
+  U64 start_time = os_now_microseconds();
+  
+  if (!app_select_validate(arena, database, select_node))
+  {
+    context->failed = 1;
+    ProfEnd();
+    return;
+  }
+  
+  ir_expand_star_to_columns(arena, database, select_node);
+  
+  IR_Node* select_output_columns = ir_node_find_child(select_node, IR_NodeType_ColumnList);
+  GDB_Table* table = gdb_database_find_table(database, ir_node_find_child(select_node, IR_NodeType_Table)->value);
+  U64 table_row_count = gdb_table_row_count(table);
+  
+  //- tec: selective predicates go through an index, everything else scans on the gpu
+  APP_OperatorStats* filter_op = app_operator_begin(arena, analyze, str8_lit("gpu scan"));
+  APP_KernelResult result = { 0 };
+  B32 used_index = app_perform_index_lookup(arena, database, select_node, &result);
+  if (!used_index && analyze)
+  {
+    // tec: analyzed queries scan alone, a shared scan would count other queries' work on this thread
+    APP_ScanRequest request = { 0 };
+    request.arena = arena;
+    request.root_node = select_node;
+    APP_ScanRequest* requests[1] = { &request };
+    app_perform_kernel(arena, str8_lit("select_query"), database, requests, 1);
+    result = request.result;
+  }
+  else if (!used_index)
+  {
+    result = app_perform_scan(arena, database, select_node);
+  }
+  if (result.failed)
+  {
+    log_error("'SELECT' on table '%.*s' failed, part of the table could not be scanned", str8_varg(table->name));
+    context->failed = 1;
+    result.count = 0;
+  }
+  if (filter_op)
+  {
+    filter_op->name = used_index ? str8_lit("index lookup") : filter_op->name;
+    filter_op->detail = table->name;
+    filter_op->rows_in = table_row_count;
+    filter_op->rows_out = result.count;
+    app_operator_end(filter_op);
+  }
+  
+  //- tec: materialize
+  log_info("result count %llu", result.count);
+  APP_OperatorStats* materialize_op = app_operator_begin(arena, analyze, str8_lit("materialize"));
+  if (materialize_op)
+  {
+    Temp scratch = scratch_begin(&arena, 1);
+    String8List discarded = { 0 };
+    app_encode_select_result(scratch.arena, &discarded, table, select_output_columns, &result);
+    materialize_op->detail = push_str8f(arena, "%llu bytes", discarded.total_size);
+    scratch_end(scratch);
+    
+    materialize_op->rows_in = result.count;
+    materialize_op->rows_out = result.count;
+    app_operator_end(materialize_op);
+  }
+  else if (context->sink)
+  {
+    app_stream_select_result(context->sink, table, select_output_columns, &result);
+  }
+  else if (context->output_arena)
+  {
+    app_encode_select_result(context->output_arena, &context->output, table, select_output_columns, &result);
+  }
+#if PRINT_SELECT_OUTPUT
+  Temp scratch = scratch_begin(0, 0);
+  for (U64 i = 0; i < result.count; i++)
+  {
+    U64 row_index = result.indices[i];
+    for (IR_Node* column_node = select_output_columns->first; column_node != NULL; column_node = column_node->next)
+    {
+      GDB_Column* column = gdb_table_find_column(table, column_node->value);
+      if (gdb_column_is_null(column, row_index))
+      {
+        printf("NULL ");
+        continue;
+      }
+      void* data = gdb_column_get_data(scratch.arena, column, row_index);
+      
+      switch (column->type)
+      {
+        case GDB_ColumnType_U32:
+        printf("%u ", *(U32*)data);
+        break;
+        case GDB_ColumnType_U64:
+        printf("%llu ", *(U64*)data);
+        break;
+        case GDB_ColumnType_F32:
+        printf("%f ", *(F32*)data);
+        break;
+        case GDB_ColumnType_F64:
+        printf("%lf ", *(F64*)data);
+        break;
+        case GDB_ColumnType_String8: 
+        {
+          String8 str = gdb_column_get_string(scratch.arena, column, row_index);
+          printf("%.*s ", str8_varg(str));
+        } break;
+        default:
+        printf("UNKNOWN ");
+        break;
+      }
+    }
+    printf("\n");
+    scratch_end(scratch);
+  }
+#endif
+  
+  log_info("total 'SELECT' query time: %.4f ms", (os_now_microseconds() - start_time) / 1000.0f);
+  
+  ProfEnd();
+}
+
+//~ tec: shared scans
+internal APP_KernelResult
+app_perform_scan(Arena* arena, GDB_Database* database, IR_Node* root_node)
+{
+  ProfBeginFunction();
+  
+  APP_ScanScheduler* scheduler = g_app_scan_scheduler;
+  GDB_Table* table = gdb_database_find_table(database, ir_node_find_child(root_node, IR_NodeType_Table)->value);
+  
+  // tec: both live on the stack, the leader only touches them while their owners are blocked
+  APP_ScanRequest request = { 0 };
+  request.arena = arena;
+  request.root_node = root_node;
+  request.shape_hash = app_hash_ir_shape(ir_node_find_child(root_node, IR_NodeType_Where), 5381);
+  APP_ScanBatch batch = { 0 };
+  
+  B32 is_leader = 0;
+  os_mutex_take(scheduler->mutex);
+  {
+    APP_ScanBatch* open_batch = 0;
+    for (APP_ScanBatch* b = scheduler->open_batches; b != NULL; b = b->next)
+    {
+      if (b->table == table && b->count < APP_SCAN_BATCH_MAX_QUERIES)
+      {
+        open_batch = b;
+        break;
+      }
+    }
+    
+    if (open_batch)
+    {
+      //- tec: follower, the leader runs our query and wakes us when it is done
+      SLLQueuePush(open_batch->first, open_batch->last, &request);
+      open_batch->count++;
+      if (open_batch->count == APP_SCAN_BATCH_MAX_QUERIES)
+      {
+        os_condition_variable_broadcast(scheduler->cv);
+      }
+      while (!request.done)
+      {
+        os_condition_variable_wait(scheduler->cv, scheduler->mutex, max_U64);
+      }
+    }
+    else
+    {
+      //- tec: leader, an idle gpu is used right away, otherwise gather queries until the window closes
+      is_leader = 1;
+      batch.table = table;
+      SLLQueuePush(batch.first, batch.last, &request);
+      batch.count = 1;
+      SLLStackPush(scheduler->open_batches, &batch);
+      
+      U64 endt_us = os_now_microseconds() + APP_SCAN_BATCH_WINDOW_US;
+      while (scheduler->running_scan_count > 0 && batch.count < APP_SCAN_BATCH_MAX_QUERIES)
+      {
+        if (!os_condition_variable_wait(scheduler->cv, scheduler->mutex, endt_us))
+        {
+          break;
+        }
+      }
+      
+      for (APP_ScanBatch** b = &scheduler->open_batches; *b != NULL; b = &(*b)->next)
+      {
+        if (*b == &batch)
+        {
+          *b = batch.next;
+          break;
+        }
+      }
+      scheduler->running_scan_count++;
+      if (batch.count > 1)
+      {
+        scheduler->fused_scan_count++;
+        scheduler->fused_query_count += batch.count;
+      }
+    }
+  }
+  os_mutex_drop(scheduler->mutex);
+  
+  if (is_leader)
+  {
+    // tec: queries of the same shape sit next to each other, so a recurring mix of queries
+    // generates the same fused source and hits the kernel cache
+    APP_ScanRequest** requests = push_array(arena, APP_ScanRequest*, batch.count);
+    U64 request_count = 0;
+    for (APP_ScanRequest* r = batch.first; r != NULL; r = r->next)
+    {
+      U64 insert_index = request_count++;
+      for (; insert_index > 0 && requests[insert_index - 1]->shape_hash > r->shape_hash; insert_index--)
+      {
+        requests[insert_index] = requests[insert_index - 1];
+      }
+      requests[insert_index] = r;
+    }
+    
+    if (request_count > 1)
+    {
+      log_info("shared scan of %.*s for %llu queries", str8_varg(table->name), request_count);
+    }
+    
+    String8 kernel_name = str8_lit("select_query");
+    app_perform_kernel(arena, kernel_name, database, requests, request_count);
+    
+    OS_MutexScope(scheduler->mutex)
+    {
+      for (U64 i = 0; i < request_count; i++)
+      {
+        requests[i]->done = 1;
+      }
+      scheduler->running_scan_count--;
+      os_condition_variable_broadcast(scheduler->cv);
+    }
+  }
+  
+  ProfEnd();
+  return request.result;
+}
+
+// tec: hashes the structure of a where clause, literal values are kernel arguments and do not change the source
+internal U64
+app_hash_ir_shape(IR_Node* node, U64 hash)
+{
+  if (node == NULL)
+  {
+    return hash;
+  }
+  
+  hash = ((hash << 5) + hash) + node->type;
+  if (node->type != IR_NodeType_Literal && node->type != IR_NodeType_Numeric)
+  {
+    for (U64 i = 0; i < node->value.size; i++)
+    {
+      hash = ((hash << 5) + hash) + node->value.str[i];
+    }
+  }
+  for (IR_Node* child = node->first; child != NULL; child = child->next)
+  {
+    hash = app_hash_ir_shape(child, hash);
+  }
+  return hash;
+}
+
+internal void
+app_perform_kernel(Arena* arena, String8 kernel_name, GDB_Database* database, APP_ScanRequest** requests, U64 request_count)
+{
+  ProfBeginFunction();
+  
+  // tec: the columns every query touches are uploaded once
+  IR_Node** root_nodes = push_array(arena, IR_Node*, request_count);
+  String8List active_columns = { 0 };
+  for (U64 i = 0; i < request_count; i++)
+  {
+    root_nodes[i] = requests[i]->root_node;
+    ir_create_active_column_list(arena, ir_node_find_child(root_nodes[i], IR_NodeType_Where), &active_columns);
+  }
+  
+  GDB_Table* table = gdb_database_find_table(database, ir_node_find_child(root_nodes[0], IR_NodeType_Table)->value);
+  
+  // tec: the query sees the rows published when it starts, inserts running alongside land past this
+  U64 row_count = gdb_table_row_count(table);
+  U64 largest_column_size = 0;
+  U64 gpu_buffer_count = 0;
+  U64 row_size = 0;
+  
+  // tec: a gpu scan always reads the whole table, large columns go past the page cache.
+  // whether a column holds nulls is read once here, an insert adding the first null mid scan must not
+  // change the kernel's arguments or the buffers each chunk uploads
+  B8* direct_io = push_array(arena, B8, active_columns.node_count);
+  B8* has_nulls = push_array(arena, B8, active_columns.node_count);
+  String8List nullable_columns = { 0 };
+  U64 column_position = 0;
+  for (String8Node* node = active_columns.first; node != NULL; node = node->next, column_position++)
+  {
+    GDB_Column* column = gdb_table_find_column(table, node->string);
+    direct_io[column_position] = (B8)gdb_column_prefers_direct_io(column);
+    has_nulls[column_position] = (B8)gdb_column_has_nulls(column);
+    if (has_nulls[column_position])
+    {
+      str8_list_push(arena, &nullable_columns, node->string);
+    }
+    gpu_buffer_count += column->type == GDB_ColumnType_String8 ? 2 : 1;
+    gpu_buffer_count += has_nulls[column_position] ? 1 : 0;
+    largest_column_size = Max(gdb_column_get_total_size(column), largest_column_size);
+    row_size += row_count ? gdb_column_get_total_size(column) / row_count : 0;
+  }
+  if (row_size == 0) row_size = 1;
+  
+  GPU_KernelParamList kernel_params = { 0 };
+  String8 kernel_code = gpu_generate_kernel_from_ir(arena, kernel_name, database, root_nodes, request_count, &active_columns, &nullable_columns, &kernel_params);
+  //log_debug("kernel output:\n%.*s", str8_varg(kernel_code));
+  
+  //- tec: chunks are bounded by the largest buffer a device takes, and cut finer when several devices share the scan
+  U32 device_count = gpu_device_count();
+  if (row_count < APP_SCAN_MULTI_DEVICE_MIN_ROWS)
+  {
+    device_count = 1;
+  }
+  
+  U64 rows_per_chunk = Max(row_count, 1);
+  if (largest_column_size > GPU_MAX_BUFFER_SIZE)
+  {
+    rows_per_chunk = Max(GPU_MAX_BUFFER_SIZE / row_size, 1);
+  }
+  if (device_count > 1)
+  {
+    U64 target_chunk_count = device_count * APP_SCAN_CHUNKS_PER_DEVICE;
+    rows_per_chunk = Min(rows_per_chunk, (row_count + target_chunk_count - 1) / target_chunk_count);
+  }
+  
+  // tec: chunks start on a 64 row boundary so null bitmaps can be passed without shifting
+  if (rows_per_chunk > 64) rows_per_chunk = AlignDownPow2(rows_per_chunk, 64);
+  
+  APP_ScanJob job = { 0 };
+  job.kernel_name = kernel_name;
+  job.kernel_code = kernel_code;
+  job.kernel_params = &kernel_params;
+  job.table = table;
+  job.active_columns = &active_columns;
+  job.direct_io = direct_io;
+  job.has_nulls = has_nulls;
+  job.gpu_buffer_count = gpu_buffer_count;
+  job.request_count = request_count;
+  job.row_count = row_count;
+  job.rows_per_chunk = rows_per_chunk;
+  job.chunk_count = (row_count + rows_per_chunk - 1) / rows_per_chunk;
+  job.chunk_results = push_array(arena, APP_KernelResult, job.chunk_count * request_count);
+  job.device_count = (U32)Max(Min(device_count, job.chunk_count), 1);
+  
+  //- tec: initial shares follow measured throughput, devices that have not run a chunk yet count as average
+  F64 weights[GPU_MAX_DEVICE_COUNT] = { 0 };
+  F64 measured_total = 0;
+  U32 measured_count = 0;
+  for (U32 d = 0; d < job.device_count; d++)
+  {
+    weights[d] = gpu_device_throughput(d);
+    measured_total += weights[d];
+    measured_count += weights[d] > 0 ? 1 : 0;
+  }
+  F64 weight_total = 0;
+  for (U32 d = 0; d < job.device_count; d++)
+  {
+    if (weights[d] <= 0) weights[d] = measured_count ? measured_total / measured_count : 1.0;
+    weight_total += weights[d];
+  }
+  U64 assigned_chunks = 0;
+  for (U32 d = 0; d < job.device_count; d++)
+  {
+    U64 share = (d + 1 == job.device_count) ? job.chunk_count - assigned_chunks : (U64)(job.chunk_count * weights[d] / weight_total + 0.5);
+    share = Min(share, job.chunk_count - assigned_chunks);
+    job.device_chunks[d] = r1u64(assigned_chunks, assigned_chunks + share);
+    assigned_chunks += share;
+  }
+  
+  //- tec: the calling thread drives the first device, every other device gets a thread of its own
+  APP_ScanWorker workers[GPU_MAX_DEVICE_COUNT] = { 0 };
+  OS_Handle threads[GPU_MAX_DEVICE_COUNT] = { 0 };
+  if (job.device_count > 1)
+  {
+    job.mutex = os_mutex_alloc();
+    log_info("scan of %llu rows in %llu chunks over %u gpus", row_count, job.chunk_count, job.device_count);
+  }
+  for (U32 d = 0; d < job.device_count; d++)
+  {
+    workers[d].job = &job;
+    workers[d].device_index = d;
+    workers[d].arena = arena_alloc();
+  }
+  for (U32 d = 1; d < job.device_count; d++)
+  {
+    threads[d] = os_thread_launch(app_scan_device_thread, &workers[d], 0);
+  }
+  app_scan_worker_run(&workers[0]);
+  for (U32 d = 1; d < job.device_count; d++)
+  {
+    os_thread_join(threads[d], max_U64);
+    
+    GPU_Stats* gpu_stats = &workers[d].gpu_stats;
+    g_gpu_stats.bytes_uploaded         += gpu_stats->bytes_uploaded;
+    g_gpu_stats.bytes_downloaded       += gpu_stats->bytes_downloaded;
+    g_gpu_stats.upload_time_us         += gpu_stats->upload_time_us;
+    g_gpu_stats.download_time_us       += gpu_stats->download_time_us;
+    g_gpu_stats.kernel_time_us         += gpu_stats->kernel_time_us;
+    g_gpu_stats.kernel_compile_time_us += gpu_stats->kernel_compile_time_us;
+    g_gpu_stats.kernel_cache_hits      += gpu_stats->kernel_cache_hits;
+    g_gpu_stats.kernel_cache_misses    += gpu_stats->kernel_cache_misses;
+    g_gdb_io_stats.bytes_read   += workers[d].io_stats.bytes_read;
+    g_gdb_io_stats.read_time_us += workers[d].io_stats.read_time_us;
+  }
+  if (job.device_count > 1)
+  {
+    for (U32 d = 0; d < job.device_count; d++)
+    {
+      log_info("gpu %u: %llu chunks (%llu taken from other gpus), %llu rows, %.1f rows/us",
+               d, workers[d].chunks_run, workers[d].chunks_stolen, workers[d].rows_run, gpu_device_throughput(d));
+    }
+    os_mutex_release(job.mutex);
+  }
+  
+  //- tec: partial results are merged in chunk order, so row indices stay ascending whichever device ran a chunk
+  for (U64 q = 0; q < request_count; q++)
+  {
+    requests[q]->result.failed |= job.failed;
+    U64 total = 0;
+    for (U64 c = 0; c < job.chunk_count; c++)
+    {
+      total += job.chunk_results[c * request_count + q].count;
+    }
+    if (total == 0)
+    {
+      continue;
+    }
+    
+    // tec: each query's result lives in its own arena, it outlives the query that ran the scan
+    APP_ScanRequest* request = requests[q];
+    APP_KernelResult* result = &request->result;
+    if (result->count + total > result->cap)
+    {
+      result->cap = result->count + total;
+      U64* new_ptr = push_array(request->arena, U64, result->cap);
+      if (result->count) MemoryCopy(new_ptr, result->indices, result->count * sizeof(U64));
+      result->indices = new_ptr;
+    }
+    for (U64 c = 0; c < job.chunk_count; c++)
+    {
+      APP_KernelResult* partial = &job.chunk_results[c * request_count + q];
+      if (partial->count) MemoryCopy(result->indices + result->count, partial->indices, partial->count * sizeof(U64));
+      result->count += partial->count;
+    }
+  }
+  
+  for (U32 d = 0; d < job.device_count; d++)
+  {
+    arena_release(workers[d].arena);
+  }
+  
+  ProfEnd();
+}
+
+internal void
+app_scan_device_thread(void* ptr)
+{
+  APP_ScanWorker* worker = (APP_ScanWorker*)ptr;
+  app_scan_worker_run(worker);
+  
+  // tec: a fresh thread starts from zero, so its counters are exactly what the scan added
+  worker->gpu_stats = g_gpu_stats;
+  worker->io_stats = g_gdb_io_stats;
+}
+
+internal void
+app_scan_worker_run(APP_ScanWorker* worker)
+{
+  ProfBeginFunction();
+  
+  APP_ScanJob* job = worker->job;
+  U32 previous_device = gpu_selected_device();
+  gpu_select_device(worker->device_index);
+  
+  // tec: kernels and their literal buffers belong to one device, every worker binds its own
+  GPU_Kernel* kernel = gpu_kernel_alloc(job->kernel_name, job->kernel_code);
+  if (!kernel)
+  {
+    log_error("failed to alloc kernel");
+    gpu_select_device(previous_device);
+    ProfEnd();
+    return;
+  }
+  
+  //- tec: literals are bound once, their arguments follow output_stride
+  GPU_Buffer** param_buffers = push_array(worker->arena, GPU_Buffer*, job->kernel_params->count);
+  U32 param_arg_index = (U32)job->gpu_buffer_count + 4;
+  U64 param_index = 0;
+  for (GPU_KernelParam* param = job->kernel_params->first; param != NULL; param = param->next, param_index++)
+  {
+    switch (param->kind)
+    {
+      case GPU_KernelParamKind_U64: { gpu_kernel_set_arg_u64(kernel, param_arg_index++, param->u64); } break;
+      case GPU_KernelParamKind_S64: { gpu_kernel_set_arg_bytes(kernel, param_arg_index++, &param->s64, sizeof(S64)); } break;
+      case GPU_KernelParamKind_F32: { F32 value = (F32)param->f64; gpu_kernel_set_arg_bytes(kernel, param_arg_index++, &value, sizeof(F32)); } break;
+      case GPU_KernelParamKind_F64: { gpu_kernel_set_arg_bytes(kernel, param_arg_index++, &param->f64, sizeof(F64)); } break;
+      case GPU_KernelParamKind_String:
+      {
+        // tec: zero sized buffers are invalid, an empty string still uploads one byte
+        U8 empty = 0;
+        void* data = param->string.size ? (void*)param->string.str : (void*)&empty;
+        param_buffers[param_index] = gpu_buffer_alloc(Max(param->string.size, 1), GPU_BufferFlag_Read | GPU_BufferFlag_CopyHostPointer, data);
+        gpu_kernel_set_arg_buffer(kernel, param_arg_index++, param_buffers[param_index]);
+        gpu_kernel_set_arg_u64(kernel, param_arg_index++, param->string.size);
+      } break;
+    }
+  }
+  
+  U64 gpu_kernel_execution_time = g_gpu_stats.kernel_time_us;
+  U64 load_data_from_disk_time = g_gdb_io_stats.read_time_us;
+  
+  //- tec: the slots form a ring, the chunk in slot 'at' runs while the ones after it are read.
+  // a slot that finished is refilled with the next claimed chunk, which goes to the back of the ring
+  // tec: the memory is taken on the worker's node, chunk reads land in it and it is only read from this thread
+  ArenaFlags read_flags = 0;
+  if (os_get_system_info()->numa_node_count > 1)
+  {
+    read_flags |= ArenaFlagsFromNumaNode(os_thread_numa_node());
+  }
+  for (U32 slot = 0; slot < APP_SCAN_READ_SLOT_COUNT; slot++)
+  {
+    worker->read_arenas[slot] = arena_alloc(.reserve_size=APP_SCAN_READ_ARENA_RESERVE_SIZE, .commit_size=APP_SCAN_READ_ARENA_COMMIT_SIZE, .flags=read_flags);
+    worker->reads[slot].queue = os_io_queue_alloc();
+  }
+  
+  U64 slot_chunks[APP_SCAN_READ_SLOT_COUNT] = { 0 };
+  U32 queued = 0;
+  while (queued < APP_SCAN_READ_SLOT_COUNT && app_scan_claim_chunk(worker, &slot_chunks[queued]))
+  {
+    app_scan_submit_chunk_reads(worker, queued, slot_chunks[queued]);
+    queued++;
+  }
+  for (U32 at = 0; queued > 0; at = (at + 1) % APP_SCAN_READ_SLOT_COUNT)
+  {
+    U64 chunk_index = slot_chunks[at];
+    U64 chunk_start_time = os_now_microseconds();
+    app_scan_run_chunk(worker, kernel, chunk_index, at);
+    
+    U64 chunk_rows = dim_1u64(app_scan_chunk_rows(job, chunk_index));
+    gpu_device_record_throughput(worker->device_index, chunk_rows, os_now_microseconds() - chunk_start_time);
+    worker->chunks_run++;
+    worker->rows_run += chunk_rows;
+    
+    queued--;
+    if (app_scan_claim_chunk(worker, &slot_chunks[at]))
+    {
+      app_scan_submit_chunk_reads(worker, at, slot_chunks[at]);
+      queued++;
+    }
+  }
+  
+  for (U32 slot = 0; slot < APP_SCAN_READ_SLOT_COUNT; slot++)
+  {
+    os_io_queue_release(worker->reads[slot].queue);
+    arena_release(worker->read_arenas[slot]);
+    MemoryZeroStruct(&worker->reads[slot]);
+    worker->read_arenas[slot] = 0;
+  }
+  
+  for (U64 i = 0; i < job->kernel_params->count; i++)
+  {
+    if (param_buffers[i]) gpu_buffer_release(param_buffers[i]);
+  }
+  gpu_kernel_release(kernel);
+  gpu_select_device(previous_device);
+  
+  log_info("gpu kernel total execution time: %llu microseconds", g_gpu_stats.kernel_time_us - gpu_kernel_execution_time);
+  log_info("load from disk total time: %llu microseconds", g_gdb_io_stats.read_time_us - load_data_from_disk_time);
+  
+  ProfEnd();
+}
+
+// tec: the next chunk of the worker's own share, or one from the back of the device with the most left
+internal B32
+app_scan_claim_chunk(APP_ScanWorker* worker, U64* out_chunk_index)
+{
+  APP_ScanJob* job = worker->job;
+  B32 claimed = 0;
+  
+  if (job->device_count == 1)
+  {
+    Rng1U64* own = &job->device_chunks[0];
+    if (own->min < own->max)
+    {
+      *out_chunk_index = own->min++;
+      claimed = 1;
+    }
+    return claimed;
+  }
+  
+  OS_MutexScope(job->mutex)
+  {
+    Rng1U64* own = &job->device_chunks[worker->device_index];
+    if (own->min < own->max)
+    {
+      *out_chunk_index = own->min++;
+      claimed = 1;
+    }
+    else
+    {
+      Rng1U64* victim = 0;
+      for (U32 d = 0; d < job->device_count; d++)
+      {
+        Rng1U64* range = &job->device_chunks[d];
+        if (range->max > range->min && (victim == 0 || range->max - range->min > victim->max - victim->min))
+        {
+          victim = range;
+        }
+      }
+      if (victim)
+      {
+        *out_chunk_index = --victim->max;
+        worker->chunks_stolen++;
+        claimed = 1;
+      }
+    }
+  }
+  return claimed;
+}
+
+internal Rng1U64
+app_scan_chunk_rows(APP_ScanJob* job, U64 chunk_index)
+{
+  Rng1U64 rows = r1u64(chunk_index * job->rows_per_chunk, Min((chunk_index + 1) * job->rows_per_chunk, job->row_count));
+  return rows;
+}
+
+// tec: queues the disk reads of a chunk's fixed width columns into one of the worker's two slots,
+// the slot's previous chunk has been run and waited on by now so its memory can be reused.
+// the reads land in pinned staging buffers so the upload is a single dma. string chunks are not read,
+// gdb_column_get_string_chunk maps the column file and they upload from the mapping, staging them would
+// add a host copy of every string byte for what the driver already does with the mapped pages
+internal void
+app_scan_submit_chunk_reads(APP_ScanWorker* worker, U32 slot, U64 chunk_index)
+{
+  ProfBeginFunction();
+  
+  APP_ScanJob* job = worker->job;
+  Rng1U64 rows = app_scan_chunk_rows(job, chunk_index);
+  
+  GDB_ChunkReadBatch* reads = &worker->reads[slot];
+  arena_clear(worker->read_arenas[slot]);
+  reads->first = reads->last = NULL;
+  reads->pieces_pending = 0;
+  worker->staging[slot] = push_array(worker->read_arenas[slot], GPU_Buffer*, job->active_columns->node_count);
+  
+  U64 column_position = 0;
+  for (String8Node* node = job->active_columns->first; node != NULL; node = node->next, column_position++)
+  {
+    GDB_Column* column = gdb_table_find_column(job->table, node->string);
+    
+    // tec: only a hint, a column flushed after this check is read into the arena instead
+    B32 direct = job->direct_io[column_position];
+    GPU_Buffer* staging = 0;
+    if (column->type != GDB_ColumnType_String8 && column->is_disk_backed)
+    {
+      staging = gpu_staging_alloc(gdb_chunk_read_capacity(column, rows, direct));
+    }
+    
+    // tec: direct reads need an aligned buffer, a staging buffer that is not goes back for an arena one
+    if (staging && direct && IntFromPtr(gpu_staging_ptr(staging)) % GDB_DIRECT_IO_ALIGNMENT != 0)
+    {
+      gpu_staging_release(staging);
+      staging = 0;
+    }
+    
+    B32 queued = gdb_chunk_read_submit(worker->read_arenas[slot], reads, column, rows, direct, staging ? gpu_staging_ptr(staging) : NULL);
+    if (staging && !queued)
+    {
+      gpu_staging_release(staging);
+      staging = 0;
+    }
+    worker->staging[slot][column_position] = staging;
+  }
+  
+  ProfEnd();
+}
+
+internal void
+app_scan_run_chunk(APP_ScanWorker* worker, GPU_Kernel* kernel, U64 chunk_index, U32 slot)
+{
+  ProfBeginFunction();
+  
+  APP_ScanJob* job = worker->job;
+  GDB_Table* table = job->table;
+  U64 request_count = job->request_count;
+  U64 gpu_buffer_count = job->gpu_buffer_count;
+  Rng1U64 rows = app_scan_chunk_rows(job, chunk_index);
+  U64 chunk_rows = dim_1u64(rows);
+  
+  // tec: usually done already, the reads were queued while the previous chunk ran
+  GDB_ChunkReadBatch* reads = &worker->reads[slot];
+  gdb_chunk_read_wait(reads);
+  
+  Temp chunk_arena = temp_begin(worker->arena);
+  GPU_Buffer** column_gpu_buffers = push_array(chunk_arena.arena, GPU_Buffer*, gpu_buffer_count);
+  U32 column_index = 0;
+  
+  log_info("filtering rows %llu-%llu", rows.min, rows.max);
+  
+  U64 column_position = 0;
+  for (String8Node* node = job->active_columns->first; node != NULL; node = node->next, column_position++)
+  {
+    GDB_Column* column = gdb_table_find_column(table, node->string);
+    
+    if (column->type == GDB_ColumnType_String8)
+    {
+      GDB_StringDataChunk chunk = gdb_column_get_string_chunk(chunk_arena.arena, column, rows);
+      
+      if (chunk.data && chunk.offsets)
+      {
+        column_gpu_buffers[column_index] = gpu_buffer_alloc(chunk.size, GPU_BufferFlag_Write | GPU_BufferFlag_HostVisible, NULL);
+        if (column_gpu_buffers[column_index])
+        {
+          gpu_buffer_write(column_gpu_buffers[column_index], chunk.data, chunk.size);
+        }
+        column_index++;
+        
+        // tec: NOTE add 1 to the row count. so the last offset used for string size calculation
+        column_gpu_buffers[column_index] = gpu_buffer_alloc((chunk.row_count + 1) * sizeof(U64), GPU_BufferFlag_Write | GPU_BufferFlag_CopyHostPointer, chunk.offsets);
+        column_index++;
+      }
+      else
+      {
+        log_error("failed to load string data or offsets for column: %.*s", str8_varg(column->name));
+      }
+      
+      gdb_column_close_string_chunk(&chunk);
+    }
+    else
+    {
+      U64 size = 0;
+      GPU_Buffer* staging = worker->staging[slot][column_position];
+      void* data_ptr = gdb_chunk_read_find(reads, column, &size);
+      if (data_ptr && staging)
+      {
+        U64 staging_offset = (U64)((U8*)data_ptr - (U8*)gpu_staging_ptr(staging));
+        column_gpu_buffers[column_index] = gpu_buffer_alloc(size, GPU_BufferFlag_Write, NULL);
+        if (column_gpu_buffers[column_index])
+        {
+          gpu_buffer_write_from_staging(column_gpu_buffers[column_index], staging, staging_offset, size);
+        }
+        column_index++;
+      }
+      else
+      {
+        if (!data_ptr)
+        {
+          data_ptr = gdb_column_get_data_range(chunk_arena.arena, column, rows, &size);
+        }
+        if (data_ptr)
+        {
+          column_gpu_buffers[column_index] = gpu_buffer_alloc(size, GPU_BufferFlag_Write | GPU_BufferFlag_CopyHostPointer, data_ptr);
+          column_index++;
+        }
+      }
+      
+      // tec: the upload is done once gpu_buffer_write_from_staging returns, the buffer can go back to the pool
+      if (staging)
+      {
+        gpu_staging_release(staging);
+        worker->staging[slot][column_position] = 0;
+      }
+    }
+    
+    if (job->has_nulls[column_position])
+    {
+      U64 validity_size = 0;
+      U64* validity = gdb_column_get_validity_range(chunk_arena.arena, column, rows, &validity_size);
+      column_gpu_buffers[column_index] = gpu_buffer_alloc(validity_size, GPU_BufferFlag_Write | GPU_BufferFlag_CopyHostPointer, validity);
+      column_index++;
+    }
+  }
+  
+  GPU_Buffer* output_buffer = gpu_buffer_alloc(request_count * chunk_rows * sizeof(U64), GPU_BufferFlag_Read, 0);
+  U64* zero_counts = push_array(chunk_arena.arena, U64, request_count);
+  GPU_Buffer* result_counter_buffer = gpu_buffer_alloc(request_count * sizeof(U64), GPU_BufferFlag_ReadWrite | GPU_BufferFlag_CopyHostPointer, zero_counts);
+  
+  // tec: a column that did not load or a buffer the device refused fails the chunk, and with it the scan.
+  // running the kernel anyway would hand it a null argument or drop the chunk's matches without a word
+  B32 chunk_failed = (output_buffer == 0 || result_counter_buffer == 0);
+  for (U64 i = 0; i < gpu_buffer_count; i++)
+  {
+    chunk_failed |= (column_gpu_buffers[i] == 0);
+  }
+  
+  if (chunk_failed)
+  {
+    log_error("rows %llu-%llu of %.*s could not be put on the gpu, the scan fails", rows.min, rows.max, str8_varg(table->name));
+    job->failed = 1;
+  }
+  else
+  {
+    for (U64 i = 0; i < gpu_buffer_count; i++)
+    {
+      gpu_kernel_set_arg_buffer(kernel, i, column_gpu_buffers[i]);
+    }
+    gpu_kernel_set_arg_buffer(kernel, gpu_buffer_count + 0, output_buffer);
+    gpu_kernel_set_arg_buffer(kernel, gpu_buffer_count + 1, result_counter_buffer);
+    gpu_kernel_set_arg_u64(kernel,    gpu_buffer_count + 2, chunk_rows);
+    gpu_kernel_set_arg_u64(kernel,    gpu_buffer_count + 3, chunk_rows);
+    
+    // tec: TODO fix local size
+    gpu_kernel_execute(kernel, chunk_rows, 1);
+    gpu_wait();
+  }
+  
+  for (U64 i = 0; i < gpu_buffer_count; i++)
+  {
+    if (column_gpu_buffers[i]) gpu_buffer_release(column_gpu_buffers[i]);
+  }
+  temp_end(chunk_arena);
+  
+  // tec: partials outlive the chunk, they are merged once every device is done
+  if (!chunk_failed)
+  {
+    app_collect_kernel_results(worker->arena, job->chunk_results + chunk_index * request_count, request_count,
+                               output_buffer, result_counter_buffer, chunk_rows, rows.min);
+  }
+  
+  if (output_buffer) gpu_buffer_release(output_buffer);
+  if (result_counter_buffer) gpu_buffer_release(result_counter_buffer);
+  
+  ProfEnd();
+}
+
+// tec: query q's matches sit at [q * output_stride, q * output_stride + count) of the output buffer,
+// row indices there are relative to the chunk that starts at row_base
+internal void
+app_collect_kernel_results(Arena* arena, APP_KernelResult* results, U64 request_count, GPU_Buffer* output_buffer, GPU_Buffer* counts_buffer, U64 output_stride, U64 row_base)
+{
+  ProfBeginFunction();
+  
+  Temp scratch = scratch_begin(&arena, 1);
+  U64* counts = push_array(scratch.arena, U64, request_count);
+  gpu_buffer_read(counts_buffer, counts, request_count * sizeof(U64));
+  
+  for (U64 q = 0; q < request_count; q++)
+  {
+    U64 result_count = counts[q];
+    if (result_count == 0)
+    {
+      continue;
+    }
+    
+    APP_KernelResult* result = &results[q];
+    result->cap = result_count;
+    result->count = result_count;
+    result->indices = push_array_no_zero(arena, U64, result_count);
+    gpu_buffer_read_range(output_buffer, q * output_stride * sizeof(U64), result->indices, result_count * sizeof(U64));
+    for (U64 i = 0; i < result_count && row_base > 0; i++)
+    {
+      result->indices[i] += row_base;
+    }
+  }
+  
+  scratch_end(scratch);
+  ProfEnd();
+}
+
+//~ tec: index lookups
+internal U64
+app_count_conjuncts(IR_Node* condition)
+{
+  if (condition->type == IR_NodeType_Operator && str8_match(condition->value, str8_lit("and"), StringMatchFlag_CaseInsensitive))
+  {
+    return app_count_conjuncts(condition->first) + app_count_conjuncts(condition->first->next);
+  }
+  return 1;
+}
+
+internal void
+app_gather_conjuncts(IR_Node* condition, IR_Node** conjuncts, U64* count)
+{
+  if (condition->type == IR_NodeType_Operator && str8_match(condition->value, str8_lit("and"), StringMatchFlag_CaseInsensitive))
+  {
+    app_gather_conjuncts(condition->first, conjuncts, count);
+    app_gather_conjuncts(condition->first->next, conjuncts, count);
+  }
+  else
+  {
+    conjuncts[(*count)++] = condition;
+  }
+}
+
+internal B32
+app_is_equal_operator(String8 op)
+{
+  B32 result = (str8_match(op, str8_lit("="), 0) || str8_match(op, str8_lit("=="), 0));
+  return result;
+}
+
+internal B32
+app_plan_index_for_conjunct(GDB_Table* table, IR_Node* conjunct, APP_IndexPlan* out_plan)
+{
+  if (conjunct->type != IR_NodeType_Operator) return 0;
+  
+  IR_Node* left = conjunct->first;
+  IR_Node* right = left ? left->next : 0;
+  if (!left || !right) return 0;
+  
+  // tec: '5 < a' is planned as 'a > 5'
+  IR_Node* column_node = left;
+  IR_Node* value_node = right;
+  B32 flipped = 0;
+  if (left->type != IR_NodeType_Column)
+  {
+    column_node = right;
+    value_node = left;
+    flipped = 1;
+  }
+  if (column_node->type != IR_NodeType_Column ||
+      (value_node->type != IR_NodeType_Numeric && value_node->type != IR_NodeType_Literal))
+  {
+    return 0;
+  }
+  
+  GDB_Column* column = gdb_table_find_column(table, column_node->value);
+  if (!column) return 0;
+  if ((column->type == GDB_ColumnType_String8) != (value_node->type == IR_NodeType_Literal)) return 0;
+  
+  U64 key = 0;
+  if (!gdb_index_key_from_string(column->type, value_node->value, &key)) return 0;
+  
+  String8 op = conjunct->value;
+  APP_IndexPlan plan = { 0 };
+  plan.conjunct = conjunct;
+  
+  if (app_is_equal_operator(op))
+  {
+    plan.is_equal = 1;
+    plan.key = key;
+    plan.string_key = value_node->value;
+    plan.min_key = key;
+    plan.min_inclusive = 1;
+    plan.max_key = key;
+    plan.max_inclusive = 1;
+    
+    plan.index = gdb_table_find_index(table, column->name, GDB_IndexKind_Hash);
+    if (plan.index)
+    {
+      // tec: a point lookup, the cheapest plan there is
+      gdb_index_refresh(plan.index);
+      plan.estimated_rows = 1;
+    }
+    else
+    {
+      plan.index = gdb_table_find_index(table, column->name, GDB_IndexKind_Sorted);
+      if (!plan.index) return 0;
+      gdb_index_refresh(plan.index);
+      plan.estimated_rows = gdb_index_count_range(plan.index, key, 1, key, 1);
+    }
+  }
+  else
+  {
+    B32 is_less = 0;
+    B32 inclusive = 0;
+    if      (str8_match(op, str8_lit("<"), 0))  { is_less = 1; inclusive = 0; }
+    else if (str8_match(op, str8_lit("<="), 0)) { is_less = 1; inclusive = 1; }
+    else if (str8_match(op, str8_lit(">"), 0))  { is_less = 0; inclusive = 0; }
+    else if (str8_match(op, str8_lit(">="), 0)) { is_less = 0; inclusive = 1; }
+    else return 0;
+    
+    if (flipped) is_less = !is_less;
+    
+    plan.index = gdb_table_find_index(table, column->name, GDB_IndexKind_Sorted);
+    if (!plan.index) return 0;
+    gdb_index_refresh(plan.index);
+    
+    if (is_less)
+    {
+      plan.min_key = 0;
+      plan.min_inclusive = 1;
+      plan.max_key = key;
+      plan.max_inclusive = inclusive;
+    }
+    else
+    {
+      plan.min_key = key;
+      plan.min_inclusive = inclusive;
+      plan.max_key = max_U64;
+      plan.max_inclusive = 1;
+    }
+    plan.estimated_rows = gdb_index_count_range(plan.index, plan.min_key, plan.min_inclusive, plan.max_key, plan.max_inclusive);
+  }
+  
+  *out_plan = plan;
+  return 1;
+}
+
+internal B32
+app_operand_supported_on_cpu(GDB_Table* table, IR_Node* operand, B32* out_is_string)
+{
+  B32 result = 0;
+  if (operand->type == IR_NodeType_Column)
+  {
+    GDB_Column* column = gdb_table_find_column(table, operand->value);
+    result = (column != 0);
+    *out_is_string = column && column->type == GDB_ColumnType_String8;
+  }
+  else if (operand->type == IR_NodeType_Numeric)
+  {
+    result = 1;
+    *out_is_string = 0;
+  }
+  else if (operand->type == IR_NodeType_Literal)
+  {
+    result = 1;
+    *out_is_string = 1;
+  }
+  return result;
+}
+
+internal B32
+app_predicate_supported_on_cpu(GDB_Table* table, IR_Node* condition)
+{
+  if (!condition || condition->type != IR_NodeType_Operator) return 0;
+  
+  String8 op = condition->value;
+  IR_Node* left = condition->first;
+  IR_Node* right = left ? left->next : 0;
+  if (!left) return 0;
+  
+  if (str8_match(op, str8_lit("and"), StringMatchFlag_CaseInsensitive) ||
+      str8_match(op, str8_lit("or"), StringMatchFlag_CaseInsensitive))
+  {
+    return right && app_predicate_supported_on_cpu(table, left) && app_predicate_supported_on_cpu(table, right);
+  }
+  
+  if (str8_match(op, str8_lit("is null"), StringMatchFlag_CaseInsensitive) ||
+      str8_match(op, str8_lit("is not null"), StringMatchFlag_CaseInsensitive))
+  {
+    B32 is_string = 0;
+    return left->type == IR_NodeType_Column && app_operand_supported_on_cpu(table, left, &is_string);
+  }
+  
+  B32 left_is_string = 0;
+  B32 right_is_string = 0;
+  if (!right ||
+      !app_operand_supported_on_cpu(table, left, &left_is_string) ||
+      !app_operand_supported_on_cpu(table, right, &right_is_string))
+  {
+    return 0;
+  }
+  
+  // tec: strings only support the operators the kernel has helpers for
+  if (left_is_string || right_is_string)
+  {
+    return left_is_string && right_is_string &&
+    (app_is_equal_operator(op) || str8_match(op, str8_lit("contains"), StringMatchFlag_CaseInsensitive));
+  }
+  
+  return (app_is_equal_operator(op) ||
+          str8_match(op, str8_lit("!="), 0) ||
+          str8_match(op, str8_lit("<"), 0) ||
+          str8_match(op, str8_lit("<="), 0) ||
+          str8_match(op, str8_lit(">"), 0) ||
+          str8_match(op, str8_lit(">="), 0));
+}
+
+internal APP_Value
+app_value_from_operand(Arena* arena, GDB_Table* table, IR_Node* operand, U64 row)
+{
+  APP_Value result = { 0 };
+  
+  if (operand->type == IR_NodeType_Column)
+  {
+    GDB_Column* column = gdb_table_find_column(table, operand->value);
+    if (gdb_column_is_null(column, row))
+    {
+      result.is_null = 1;
+      return result;
+    }
+    
+    switch (column->type)
+    {
+      case GDB_ColumnType_U32: { result.is_integer = 1; result.u64 = *(U32*)gdb_column_get_data(arena, column, row); result.f64 = (F64)result.u64; } break;
+      case GDB_ColumnType_U64: { result.is_integer = 1; result.u64 = *(U64*)gdb_column_get_data(arena, column, row); result.f64 = (F64)result.u64; } break;
+      case GDB_ColumnType_F32: { result.f64 = *(F32*)gdb_column_get_data(arena, column, row); } break;
+      case GDB_ColumnType_F64: { result.f64 = *(F64*)gdb_column_get_data(arena, column, row); } break;
+      case GDB_ColumnType_String8: { result.is_string = 1; result.string = gdb_column_get_string(arena, column, row); } break;
+    }
+  }
+  else if (operand->type == IR_NodeType_Numeric)
+  {
+    result.is_integer = !str8_contains(operand->value, '.');
+    result.u64 = result.is_integer ? u64_from_str8(operand->value, 10) : 0;
+    result.f64 = f64_from_str8(operand->value);
+  }
+  else if (operand->type == IR_NodeType_Literal)
+  {
+    result.is_string = 1;
+    result.string = operand->value;
+  }
+  
+  return result;
+}
+
+internal B32
+app_evaluate_predicate(Arena* arena, GDB_Table* table, IR_Node* condition, U64 row)
+{
+  String8 op = condition->value;
+  IR_Node* left = condition->first;
+  IR_Node* right = left->next;
+  
+  if (str8_match(op, str8_lit("and"), StringMatchFlag_CaseInsensitive))
+  {
+    return app_evaluate_predicate(arena, table, left, row) && app_evaluate_predicate(arena, table, right, row);
+  }
+  if (str8_match(op, str8_lit("or"), StringMatchFlag_CaseInsensitive))
+  {
+    return app_evaluate_predicate(arena, table, left, row) || app_evaluate_predicate(arena, table, right, row);
+  }
+  if (str8_match(op, str8_lit("is null"), StringMatchFlag_CaseInsensitive))
+  {
+    return gdb_column_is_null(gdb_table_find_column(table, left->value), row);
+  }
+  if (str8_match(op, str8_lit("is not null"), StringMatchFlag_CaseInsensitive))
+  {
+    return !gdb_column_is_null(gdb_table_find_column(table, left->value), row);
+  }
+  
+  APP_Value a = app_value_from_operand(arena, table, left, row);
+  APP_Value b = app_value_from_operand(arena, table, right, row);
+  
+  // tec: a comparison against a null row is never true, same as the kernel
+  if (a.is_null || b.is_null) return 0;
+  
+  if (a.is_string)
+  {
+    if (str8_match(op, str8_lit("contains"), StringMatchFlag_CaseInsensitive))
+    {
+      return str8_find_needle(a.string, 0, b.string, 0) < a.string.size;
+    }
+    return str8_match(a.string, b.string, 0);
+  }
+  
+  int cmp = 0;
+  if (a.is_integer && b.is_integer)
+  {
+    cmp = (a.u64 < b.u64) ? -1 : (a.u64 > b.u64) ? 1 : 0;
+  }
+  else
+  {
+    cmp = (a.f64 < b.f64) ? -1 : (a.f64 > b.f64) ? 1 : 0;
+  }
+  
+  if (app_is_equal_operator(op))            return cmp == 0;
+  if (str8_match(op, str8_lit("!="), 0))    return cmp != 0;
+  if (str8_match(op, str8_lit("<"), 0))     return cmp < 0;
+  if (str8_match(op, str8_lit("<="), 0))    return cmp <= 0;
+  if (str8_match(op, str8_lit(">"), 0))     return cmp > 0;
+  if (str8_match(op, str8_lit(">="), 0))    return cmp >= 0;
+  return 0;
+}
+
+// tec: 'column op number' comparisons joined by 'and', in either order. anything else can not be checked while reading
+internal B32
+app_import_filters_from_condition(Arena* arena, IR_Node* condition, GDB_ParquetFilter** filters)
+{
+  if (!condition || condition->type != IR_NodeType_Operator || !condition->first || !condition->first->next)
+  {
+    log_error("'import' filters must be comparisons of a column with a number joined by 'and'");
+    return 0;
+  }
+  
+  String8 op = condition->value;
+  IR_Node* left = condition->first;
+  IR_Node* right = left->next;
+  if (str8_match(op, str8_lit("and"), StringMatchFlag_CaseInsensitive))
+  {
+    return app_import_filters_from_condition(arena, left, filters) && app_import_filters_from_condition(arena, right, filters);
+  }
+  
+  B32 flipped = (left->type == IR_NodeType_Numeric && right->type == IR_NodeType_Column);
+  IR_Node* column = flipped ? right : left;
+  IR_Node* value = flipped ? left : right;
+  if (column->type != IR_NodeType_Column || value->type != IR_NodeType_Numeric)
+  {
+    log_error("'import' filters must be comparisons of a column with a number joined by 'and'");
+    return 0;
+  }
+  
+  GDB_ParquetCompare compare = GDB_ParquetCompare_Equal;
+  if      (app_is_equal_operator(op))                                                  compare = GDB_ParquetCompare_Equal;
+  else if (str8_match(op, str8_lit("!="), 0) || str8_match(op, str8_lit("<>"), 0))     compare = GDB_ParquetCompare_NotEqual;
+  else if (str8_match(op, str8_lit("<"), 0))  compare = flipped ? GDB_ParquetCompare_Greater : GDB_ParquetCompare_Less;
+  else if (str8_match(op, str8_lit("<="), 0)) compare = flipped ? GDB_ParquetCompare_GreaterEqual : GDB_ParquetCompare_LessEqual;
+  else if (str8_match(op, str8_lit(">"), 0))  compare = flipped ? GDB_ParquetCompare_Less : GDB_ParquetCompare_Greater;
+  else if (str8_match(op, str8_lit(">="), 0)) compare = flipped ? GDB_ParquetCompare_LessEqual : GDB_ParquetCompare_GreaterEqual;
+  else
+  {
+    log_error("operator '%.*s' is not supported in 'import' filters", str8_varg(op));
+    return 0;
+  }
+  
+  GDB_ParquetFilter* filter = push_array(arena, GDB_ParquetFilter, 1);
+  filter->column = column->value;
+  filter->compare = compare;
+  filter->is_integer = !str8_contains(value->value, '.');
+  filter->u64 = filter->is_integer ? u64_from_str8(value->value, 10) : 0;
+  filter->f64 = f64_from_str8(value->value);
+  filter->next = *filters;
+  *filters = filter;
+  return 1;
+}
+
+// tec: the conjunct whose index yields the fewest candidate rows, 0 when a gpu scan is the cheaper plan
+internal B32
+app_choose_index_plan(Arena* arena, GDB_Table* table, IR_Node* where_clause, U64 row_count, APP_IndexPlan* out_plan)
+{
+  if (!where_clause || !where_clause->first || !table || table->index_count == 0 ||
+      !app_predicate_supported_on_cpu(table, where_clause->first))
+  {
+    return 0;
+  }
+  
+  //- tec: split the where clause on 'and' and pick the conjunct with the fewest candidate rows
+  U64 conjunct_count = app_count_conjuncts(where_clause->first);
+  IR_Node** conjuncts = push_array(arena, IR_Node*, conjunct_count);
+  U64 gathered = 0;
+  app_gather_conjuncts(where_clause->first, conjuncts, &gathered);
+  
+  APP_IndexPlan best = { 0 };
+  for (U64 i = 0; i < conjunct_count; i++)
+  {
+    APP_IndexPlan plan = { 0 };
+    if (app_plan_index_for_conjunct(table, conjuncts[i], &plan) &&
+        (best.index == 0 || plan.estimated_rows < best.estimated_rows))
+    {
+      best = plan;
+    }
+  }
+  
+  // tec: wide ranges are cheaper to scan on the gpu than to fetch row by row
+  if (best.index == 0 || best.estimated_rows * 100 > row_count * APP_INDEX_MAX_SELECTIVITY_PERCENT)
+  {
+    return 0;
+  }
+  
+  *out_plan = best;
+  return 1;
+}
+
+internal B32
+app_perform_index_lookup(Arena* arena, GDB_Database* database, IR_Node* root_node, APP_KernelResult* out_result)
+{
+  ProfBeginFunction();
+  
+  IR_Node* where_clause = ir_node_find_child(root_node, IR_NodeType_Where);
+  IR_Node* table_node = ir_node_find_child(root_node, IR_NodeType_Table);
+  GDB_Table* table = table_node ? gdb_database_find_table(database, table_node->value) : 0;
+  
+  Temp scratch = scratch_begin(&arena, 1);
+  
+  // tec: an index may already cover rows inserted after this query started, those are skipped
+  U64 row_count = table ? gdb_table_row_count(table) : 0;
+  
+  APP_IndexPlan best = { 0 };
+  if (!app_choose_index_plan(scratch.arena, table, where_clause, row_count, &best))
+  {
+    scratch_end(scratch);
+    ProfEnd();
+    return 0;
+  }
+  
+  U64 conjunct_count = app_count_conjuncts(where_clause->first);
+  IR_Node** conjuncts = push_array(scratch.arena, IR_Node*, conjunct_count);
+  U64 gathered = 0;
+  app_gather_conjuncts(where_clause->first, conjuncts, &gathered);
+  
+  GDB_IndexLookup lookup = { 0 };
+  if (best.is_equal)
+  {
+    lookup = gdb_index_lookup_equal(scratch.arena, best.index, best.key, best.string_key);
+  }
+  else
+  {
+    lookup = gdb_index_lookup_range(scratch.arena, best.index, best.min_key, best.min_inclusive, best.max_key, best.max_inclusive);
+  }
+  
+  //- tec: the remaining conjuncts are checked on the cpu against the candidate rows
+  APP_KernelResult result = { 0 };
+  result.cap = Max(1, lookup.count);
+  result.indices = push_array_no_zero(arena, U64, result.cap);
+  for (U64 i = 0; i < lookup.count; i++)
+  {
+    U64 row = lookup.rows[i];
+    B32 keep = (row < row_count);
+    
+    Temp row_temp = temp_begin(scratch.arena);
+    for (U64 c = 0; c < conjunct_count && keep; c++)
+    {
+      if (conjuncts[c] != best.conjunct)
+      {
+        keep = app_evaluate_predicate(row_temp.arena, table, conjuncts[c], row);
+      }
+    }
+    temp_end(row_temp);
+    
+    if (keep)
+    {
+      result.indices[result.count++] = row;
+    }
+  }
+  
+  log_info("%.*s index '%.*s' found %llu candidate rows, %llu matched",
+           str8_varg(string_from_gdb_index_kind(best.index->kind)), str8_varg(best.index->name), lookup.count, result.count);
+  
+  *out_result = result;
+  
+  scratch_end(scratch);
+  ProfEnd();
+  return 1;
+}
+
+//~ tec: explain
+internal APP_OperatorStats*
+app_operator_begin(Arena* arena, APP_ExplainAnalyze* analyze, String8 name)
+{
+  if (analyze == NULL)
+  {
+    return NULL;
+  }
+  
+  APP_OperatorStats* op = push_array(arena, APP_OperatorStats, 1);
+  op->name = name;
+  op->io_start = g_gdb_io_stats;
+  op->gpu_start = g_gpu_stats;
+  op->start_us = os_now_microseconds();
+  SLLQueuePush(analyze->first, analyze->last, op);
+  analyze->count++;
+  return op;
+}
+
+internal void
+app_operator_end(APP_OperatorStats* op)
+{
+  op->time_us = os_now_microseconds() - op->start_us;
+  op->bytes_read = g_gdb_io_stats.bytes_read - op->io_start.bytes_read;
+  op->bytes_uploaded = g_gpu_stats.bytes_uploaded - op->gpu_start.bytes_uploaded;
+  op->bytes_downloaded = g_gpu_stats.bytes_downloaded - op->gpu_start.bytes_downloaded;
+  op->kernel_compile_us = g_gpu_stats.kernel_compile_time_us - op->gpu_start.kernel_compile_time_us;
+  op->kernel_cache_hits = g_gpu_stats.kernel_cache_hits - op->gpu_start.kernel_cache_hits;
+  op->kernel_cache_misses = g_gpu_stats.kernel_cache_misses - op->gpu_start.kernel_cache_misses;
+  op->kernel_us = g_gpu_stats.kernel_time_us - op->gpu_start.kernel_time_us;
+}
+
+// tec: the ir of the statement followed by the access path a select would take, nothing is executed
+internal void
+app_explain_plan(Arena* arena, GDB_Database* database, IR_Node* statement_node, String8List* out)
+{
+  ir_node_to_string_list(arena, statement_node, 0, out);
+  
+  IR_Node* table_node = ir_node_find_child(statement_node, IR_NodeType_Table);
+  if (statement_node->type != IR_NodeType_Select || database == NULL || table_node == NULL)
+  {
+    return;
+  }
+  
+  GDB_Table* table = gdb_database_find_table(database, table_node->value);
+  if (table == NULL)
+  {
+    str8_list_pushf(arena, out, "access: unknown table '%.*s'", str8_varg(table_node->value));
+    return;
+  }
+  
+  U64 row_count = gdb_table_row_count(table);
+  IR_Node* where_clause = ir_node_find_child(statement_node, IR_NodeType_Where);
+  APP_IndexPlan index_plan = { 0 };
+  if (app_choose_index_plan(arena, table, where_clause, row_count, &index_plan))
+  {
+    str8_list_pushf(arena, out, "access: %.*s index '%.*s' on %.*s, ~%llu of %llu rows",
+                    str8_varg(string_from_gdb_index_kind(index_plan.index->kind)), str8_varg(index_plan.index->name),
+                    str8_varg(index_plan.index->column->name), index_plan.estimated_rows, row_count);
+  }
+  else
+  {
+    String8List active_columns = { 0 };
+    ir_create_active_column_list(arena, where_clause, &active_columns);
+    String8List direct_columns = { 0 };
+    for (String8Node* node = active_columns.first; node != NULL; node = node->next)
+    {
+      GDB_Column* column = gdb_table_find_column(table, node->string);
+      if (column && gdb_column_prefers_direct_io(column))
+      {
+        str8_list_push(arena, &direct_columns, node->string);
+      }
+    }
+    String8 columns = str8_list_join(arena, &active_columns, &(StringJoin){ .sep = str8_lit_comp(", ") });
+    String8 direct = str8_list_join(arena, &direct_columns, &(StringJoin){ .sep = str8_lit_comp(", ") });
+    str8_list_pushf(arena, out, "access: gpu scan of %.*s, %llu rows, columns uploaded: %.*s, direct io: %.*s",
+                    str8_varg(table->name), row_count, str8_varg(columns.size ? columns : str8_lit("none")),
+                    str8_varg(direct.size ? direct : str8_lit("none")));
+  }
+}
+
+internal void
+app_report_explain_analyze(Arena* arena, APP_QueryContext* context, APP_ExplainAnalyze* analyze)
+{
+  log_info("%-14s %-20s %12s %12s %10s %14s %14s %14s %10s %6s %10s",
+           "operator", "detail", "rows in", "rows out", "time us", "disk read", "uploaded", "downloaded", "compile us", "cached", "kernel us");
+  for (APP_OperatorStats* op = analyze->first; op != NULL; op = op->next)
+  {
+    log_info("%-14.*s %-20.*s %12llu %12llu %10llu %14llu %14llu %14llu %10llu %6s %10llu",
+             str8_varg(op->name), str8_varg(op->detail), op->rows_in, op->rows_out, op->time_us,
+             op->bytes_read, op->bytes_uploaded, op->bytes_downloaded, op->kernel_compile_us,
+             op->kernel_cache_misses ? "no" : op->kernel_cache_hits ? "yes" : "-", op->kernel_us);
+  }
+  
+  if (context->output_arena == NULL && context->sink == NULL)
+  {
+    return;
+  }
+  
+  //- tec: one row per operator, the same columns as the log
+  Temp scratch = scratch_begin(&arena, 1);
+  Arena* out_arena = context->output_arena ? context->output_arena : scratch.arena;
+  U64 count = analyze->count;
+  String8* names = push_array(out_arena, String8, count);
+  String8* details = push_array(out_arena, String8, count);
+  U64* counters[APP_ExplainCounter_COUNT] = { 0 };
+  for (U64 c = 0; c < APP_ExplainCounter_COUNT; c++)
+  {
+    counters[c] = push_array(out_arena, U64, Max(count, 1));
+  }
+  
+  U64 row = 0;
+  for (APP_OperatorStats* op = analyze->first; op != NULL; op = op->next, row++)
+  {
+    names[row] = op->name;
+    details[row] = op->detail;
+    counters[APP_ExplainCounter_RowsIn][row]          = op->rows_in;
+    counters[APP_ExplainCounter_RowsOut][row]         = op->rows_out;
+    counters[APP_ExplainCounter_TimeUs][row]          = op->time_us;
+    counters[APP_ExplainCounter_BytesRead][row]       = op->bytes_read;
+    counters[APP_ExplainCounter_BytesUploaded][row]   = op->bytes_uploaded;
+    counters[APP_ExplainCounter_BytesDownloaded][row] = op->bytes_downloaded;
+    counters[APP_ExplainCounter_KernelCompileUs][row] = op->kernel_compile_us;
+    counters[APP_ExplainCounter_KernelCacheHits][row] = op->kernel_cache_hits;
+    counters[APP_ExplainCounter_KernelUs][row]        = op->kernel_us;
+  }
+  
+  U32 column_count = 2 + APP_ExplainCounter_COUNT;
+  String8List schema = { 0 };
+  app_encode_result_column_header(out_arena, &schema, GDB_ColumnType_String8, str8_lit("operator"));
+  app_encode_result_column_header(out_arena, &schema, GDB_ColumnType_String8, str8_lit("detail"));
+  for (U64 c = 0; c < APP_ExplainCounter_COUNT; c++)
+  {
+    app_encode_result_column_header(out_arena, &schema, GDB_ColumnType_U64, g_app_explain_counter_names[c]);
+  }
+  String8List data = { 0 };
+  app_encode_string_values(out_arena, &data, names, count);
+  app_encode_string_values(out_arena, &data, details, count);
+  for (U64 c = 0; c < APP_ExplainCounter_COUNT; c++)
+  {
+    str8_list_push(out_arena, &data, str8((U8*)counters[c], count * sizeof(U64)));
+  }
+  
+  if (context->sink)
+  {
+    app_result_sink_write_frame(context->sink, APP_ResultFrameKind_Schema, column_count, count, &schema);
+    app_result_sink_write_frame(context->sink, APP_ResultFrameKind_Batch, column_count, count, &data);
+  }
+  else
+  {
+    app_encode_result_set_header(out_arena, &context->output, column_count, count);
+    str8_list_concat_in_place(&context->output, &schema);
+    str8_list_concat_in_place(&context->output, &data);
+  }
+  scratch_end(scratch);
+}
+
+//~ tec: server
+internal void
+app_encode_result_set_header(Arena* arena, String8List* out, U32 column_count, U64 row_count)
+{
+  APP_ResultSetHeader* header = push_array(arena, APP_ResultSetHeader, 1);
+  header->column_count = column_count;
+  header->row_count = row_count;
+  str8_list_push(arena, out, str8_struct(header));
+}
+
+internal void
+app_encode_result_column_header(Arena* arena, String8List* out, GDB_ColumnType type, String8 name)
+{
+  APP_ResultColumnHeader* column_header = push_array(arena, APP_ResultColumnHeader, 1);
+  column_header->type = type;
+  column_header->name_size = (U32)name.size;
+  str8_list_push(arena, out, str8_struct(column_header));
+  str8_list_push(arena, out, push_str8_copy(arena, name));
+}
+
+internal void
+app_encode_string_values(Arena* arena, String8List* out, String8* values, U64 count)
+{
+  U64* offsets = push_array_no_zero(arena, U64, count + 1);
+  String8List strings = { 0 };
+  offsets[0] = 0;
+  for (U64 i = 0; i < count; i++)
+  {
+    str8_list_push(arena, &strings, push_str8_copy(arena, values[i]));
+    offsets[i + 1] = offsets[i] + values[i].size;
+  }
+  str8_list_push(arena, out, str8((U8*)offsets, (count + 1) * sizeof(U64)));
+  str8_list_concat_in_place(out, &strings);
+}
+
+// tec: a result set with a single string column, one row per line
+internal void
+app_encode_text_result(Arena* arena, String8List* out, String8 column_name, String8List* lines)
+{
+  String8Array values = str8_array_from_list(arena, lines);
+  app_encode_result_set_header(arena, out, 1, values.count);
+  app_encode_result_column_header(arena, out, GDB_ColumnType_String8, column_name);
+  app_encode_string_values(arena, out, values.v, values.count);
+}
+
+internal void
+app_encode_select_result(Arena* arena, String8List* out, GDB_Table* table, IR_Node* column_list, APP_KernelResult* result)
+{
+  ProfBeginFunction();
+  
+  U32 column_count = 0;
+  for (IR_Node* column_node = column_list->first; column_node != NULL; column_node = column_node->next)
+  {
+    column_count++;
+  }
+  
+  APP_ResultSetHeader* header = push_array(arena, APP_ResultSetHeader, 1);
+  header->column_count = column_count;
+  header->row_count = result->count;
+  str8_list_push(arena, out, str8_struct(header));
+  
+  // tec: has_nulls is decided once, the header and the values it describes have to agree
+  GDB_Column** columns = push_array(arena, GDB_Column*, column_count);
+  B32* has_nulls = push_array(arena, B32, column_count);
+  U32 column_index = 0;
+  for (IR_Node* column_node = column_list->first; column_node != NULL; column_node = column_node->next, column_index++)
+  {
+    GDB_Column* column = gdb_table_find_column(table, column_node->value);
+    columns[column_index] = column;
+    has_nulls[column_index] = gdb_column_has_nulls(column);
+    
+    APP_ResultColumnHeader* column_header = push_array(arena, APP_ResultColumnHeader, 1);
+    column_header->type = column->type;
+    column_header->has_nulls = has_nulls[column_index];
+    column_header->name_size = (U32)column->name.size;
+    str8_list_push(arena, out, str8_struct(column_header));
+    str8_list_push(arena, out, push_str8_copy(arena, column->name));
+  }
+  
+  //- tec: column major, gathered from the matching rows
+  for (column_index = 0; column_index < column_count; column_index++)
+  {
+    app_encode_column_values(arena, out, columns[column_index], has_nulls[column_index], result->indices, result->count);
+  }
+  
+  ProfEnd();
+}
+
+// tec: [validity bitmap, when has_nulls][count x value] or [validity][(count + 1) x U64 offsets][bytes].
+// rows that form one contiguous run are not gathered, in memory columns are referenced in place and
+// disk backed ones are read with a single call. in memory buffers live as long as the column
+internal void
+app_encode_column_values(Arena* arena, String8List* out, GDB_Column* column, B32 has_nulls, U64* indices, U64 count)
+{
+  B32 is_contiguous = (count > 0);
+  for (U64 i = 1; is_contiguous && i < count; i++)
+  {
+    is_contiguous = (indices[i] == indices[0] + i);
+  }
+  
+  if (has_nulls)
+  {
+    U64 word_count = (count + 63) / 64;
+    U64* validity = push_array(arena, U64, Max(word_count, 1));
+    for (U64 i = 0; i < count; i++)
+    {
+      if (!gdb_column_is_null(column, indices[i]))
+      {
+        validity[i >> 6] |= (1ull << (i & 63));
+      }
+    }
+    str8_list_push(arena, out, str8((U8*)validity, word_count * sizeof(U64)));
+  }
+  
+  if (column->type == GDB_ColumnType_String8)
+  {
+    if (is_contiguous && !column->is_disk_backed)
+    {
+      // tec: nulls are stored as empty strings, the chunk already has the layout we send
+      GDB_StringDataChunk chunk = gdb_column_get_string_chunk(arena, column, r1u64(indices[0], indices[0] + count));
+      str8_list_push(arena, out, str8((U8*)chunk.offsets, (count + 1) * sizeof(U64)));
+      str8_list_push(arena, out, str8((U8*)chunk.data, chunk.size));
+    }
+    else
+    {
+      U64* offsets = push_array_no_zero(arena, U64, count + 1);
+      String8List strings = { 0 };
+      offsets[0] = 0;
+      for (U64 i = 0; i < count; i++)
+      {
+        String8 value = gdb_column_is_null(column, indices[i]) ? str8_zero() : gdb_column_get_string(arena, column, indices[i]);
+        str8_list_push(arena, &strings, value);
+        offsets[i + 1] = offsets[i] + value.size;
+      }
+      str8_list_push(arena, out, str8((U8*)offsets, (count + 1) * sizeof(U64)));
+      str8_list_concat_in_place(out, &strings);
+    }
+  }
+  else
+  {
+    U64 value_size = column->size;
+    if (is_contiguous)
+    {
+      U64 size = 0;
+      void* values = gdb_column_get_data_range(arena, column, r1u64(indices[0], indices[0] + count), &size);
+      str8_list_push(arena, out, str8((U8*)values, size));
+    }
+    else
+    {
+      U8* values = push_array_no_zero(arena, U8, Max(count * value_size, 1));
+      for (U64 i = 0; i < count; i++)
+      {
+        MemoryCopy(values + i * value_size, gdb_column_get_data(arena, column, indices[i]), value_size);
+      }
+      str8_list_push(arena, out, str8(values, count * value_size));
+    }
+  }
+}
+
+internal B32
+app_socket_recv_exact(OS_Handle socket, void* data, U64 size)
+{
+  U64 received = 0;
+  while (received < size)
+  {
+    U64 read = os_socket_recv(socket, (U8*)data + received, size - received);
+    if (read == 0)
+    {
+      return 0;
+    }
+    received += read;
+  }
+  return 1;
+}
+
+internal void
+app_server_connection_thread(void* ptr)
+{
+  APP_ServerConnection* connection = (APP_ServerConnection*)ptr;
+  APP_Server* server = connection->server;
+  Arena* arena = connection->arena;
+  OS_Handle client = connection->client;
+  log_info("client connected");
+  
+  APP_QueryContext context = { 0 };
+  for (;;)
+  {
+    Temp request_temp = temp_begin(arena);
+    
+    APP_ServerFrameHeader request = { 0 };
+    if (!app_socket_recv_exact(client, &request, sizeof(request)))
+    {
+      temp_end(request_temp);
+      break;
+    }
+    
+    APP_ServerFrameHeader response = { 0 };
+    response.magic = APP_SERVER_RESPONSE_MAGIC;
+    
+    context.output_arena = request_temp.arena;
+    context.output = (String8List){ 0 };
+    context.sink = 0;
+    context.failed = 0;
+    
+    if (request.magic != APP_SERVER_REQUEST_MAGIC || request.size > APP_SERVER_MAX_QUERY_SIZE)
+    {
+      // tec: the stream can't be trusted past a bad header, answer and drop the connection
+      log_error("bad request header (magic %08x, size %llu)", request.magic, request.size);
+      response.flags_or_status = APP_ServerStatus_BadRequest;
+      os_socket_send(client, &response, sizeof(response));
+      temp_end(request_temp);
+      break;
+    }
+    
+    String8 query = { 0 };
+    query.size = request.size;
+    query.str = push_array_no_zero(request_temp.arena, U8, request.size + 1);
+    if (!app_socket_recv_exact(client, query.str, query.size))
+    {
+      temp_end(request_temp);
+      break;
+    }
+    query.str[query.size] = 0;
+    
+    // tec: a streamed response is written while the query runs, it carries its own status at the end
+    B32 stream_results = (request.flags_or_status & APP_ServerFlag_StreamResults) != 0;
+    APP_ResultSink sink = { 0 };
+    if (stream_results)
+    {
+      sink = app_result_sink_from_socket(client);
+      context.sink = &sink;
+    }
+    
+    if (query.size > 0)
+    {
+      ins_atomic_u64_inc_eval(&server->active_query_count);
+      U64 start_time = os_now_microseconds();
+      app_execute_query(query, &context);
+      log_info("server query time: %.4f ms", (os_now_microseconds() - start_time) / 1000.0f);
+      ins_atomic_u64_dec_eval(&server->active_query_count);
+    }
+    
+    response.flags_or_status = context.failed ? APP_ServerStatus_Error : APP_ServerStatus_Ok;
+    response.size = context.output.total_size;
+    
+    B32 sent = 0;
+    if (stream_results)
+    {
+      app_result_sink_close(&sink, response.flags_or_status);
+      sent = !sink.failed;
+    }
+    else
+    {
+      sent = (os_socket_send(client, &response, sizeof(response)) == sizeof(response));
+      for (String8Node* node = context.output.first; sent && node != NULL; node = node->next)
+      {
+        sent = (os_socket_send(client, node->string.str, node->string.size) == node->string.size);
+      }
+    }
+    temp_end(request_temp);
+    
+    if (request.flags_or_status & APP_ServerFlag_Shutdown)
+    {
+      // tec: closing the listener wakes the accept loop, it sees running cleared and stops
+      ins_atomic_u64_eval_assign(&server->running, 0);
+      os_socket_close(server->listener);
+      break;
+    }
+    if (!sent)
+    {
+      break;
+    }
+  }
+  
+  os_socket_close(client);
+  log_info("client disconnected");
+  arena_release(arena);
+}
+
+internal void
+app_server_run(String8 host, U16 port)
+{
+  ProfBeginFunction();
+  
+  APP_Server server = { 0 };
+  server.listener = os_socket_listen(host, port);
+  if (os_handle_match(server.listener, os_handle_zero()))
+  {
+    log_error("failed to listen on %.*s:%u", str8_varg(host), port);
+    ProfEnd();
+    return;
+  }
+  server.running = 1;
+  log_info("server listening on %.*s:%u", str8_varg(host), port);
+  
+  // tec: every connection gets a thread, queries run concurrently. reads share a snapshot of each
+  // table, writes serialize per table. databases, the gpu context and compiled kernels stay warm
+  for (;;)
+  {
+    OS_Handle client = os_socket_accept(server.listener);
+    if (!ins_atomic_u64_eval(&server.running))
+    {
+      if (!os_handle_match(client, os_handle_zero())) os_socket_close(client);
+      break;
+    }
+    if (os_handle_match(client, os_handle_zero()))
+    {
+      log_error("failed to accept connection");
+      continue;
+    }
+    
+    Arena* arena = arena_alloc(.reserve_size=APP_SERVER_ARENA_RESERVE_SIZE, .commit_size=APP_SERVER_ARENA_COMMIT_SIZE);
+    APP_ServerConnection* connection = push_array(arena, APP_ServerConnection, 1);
+    connection->server = &server;
+    connection->arena = arena;
+    connection->client = client;
+    os_thread_detach(os_thread_launch(app_server_connection_thread, connection, 0));
+  }
+  
+  // tec: idle connections are dropped with the process, queries already running finish first
+  while (ins_atomic_u64_eval(&server.active_query_count) > 0)
+  {
+    os_sleep_milliseconds(1);
+  }
+  
+  log_info("server stopped");
+  ProfEnd();
+}
+
+//~ tec: result streams
+internal APP_ResultSink
+app_result_sink_open(String8 path)
+{
+  APP_ResultSink sink = { 0 };
+  sink.kind = APP_ResultSinkKind_File;
+  
+  // tec: '-' is stdout, so results can be piped into another process. the log goes to stderr
+  if (str8_match(path, str8_lit("-"), 0))
+  {
+    sink.handle = os_stdout();
+  }
+  else
+  {
+    sink.handle = os_file_open(OS_AccessFlag_Write, path);
+    sink.owns_handle = 1;
+  }
+  
+  if (os_handle_match(sink.handle, os_handle_zero()))
+  {
+    log_error("failed to open result output '%.*s'", str8_varg(path));
+    sink.failed = 1;
+    return sink;
+  }
+  
+  Temp scratch = scratch_begin(0, 0);
+  String8List magic = { 0 };
+  U64 magic_value = APP_RESULT_STREAM_MAGIC;
+  str8_list_push(scratch.arena, &magic, str8_struct(&magic_value));
+  app_result_sink_write(&sink, &magic);
+  scratch_end(scratch);
+  return sink;
+}
+
+internal APP_ResultSink
+app_result_sink_from_socket(OS_Handle socket)
+{
+  APP_ResultSink sink = { 0 };
+  sink.kind = APP_ResultSinkKind_Socket;
+  sink.handle = socket;
+  
+  Temp scratch = scratch_begin(0, 0);
+  String8List magic = { 0 };
+  U64 magic_value = APP_RESULT_STREAM_MAGIC;
+  str8_list_push(scratch.arena, &magic, str8_struct(&magic_value));
+  app_result_sink_write(&sink, &magic);
+  scratch_end(scratch);
+  return sink;
+}
+
+internal void
+app_result_sink_close(APP_ResultSink* sink, APP_ServerStatus status)
+{
+  app_result_sink_write_frame(sink, APP_ResultFrameKind_End, status, 0, 0);
+  if (sink->owns_handle)
+  {
+    os_file_close(sink->handle);
+  }
+  sink->handle = os_handle_zero();
+  log_info("streamed %llu bytes in %llu batches", sink->bytes_written, sink->batch_count);
+}
+
+// tec: every node goes out as is, the buffers are never copied into a staging area first
+internal void
+app_result_sink_write(APP_ResultSink* sink, String8List* data)
+{
+  for (String8Node* node = data->first; node != NULL && !sink->failed; node = node->next)
+  {
+    if (node->string.size == 0)
+    {
+      continue;
+    }
+    
+    U64 written = 0;
+    if (sink->kind == APP_ResultSinkKind_Socket)
+    {
+      written = os_socket_send(sink->handle, node->string.str, node->string.size);
+    }
+    else
+    {
+      written = os_file_write(sink->handle, r1u64(sink->offset, sink->offset + node->string.size), node->string.str);
+    }
+    sink->offset += written;
+    sink->bytes_written += written;
+    
+    if (written != node->string.size)
+    {
+      log_error("result output failed after %llu bytes", sink->bytes_written);
+      sink->failed = 1;
+    }
+  }
+}
+
+internal void
+app_result_sink_write_frame(APP_ResultSink* sink, APP_ResultFrameKind kind, U32 column_count_or_status, U64 row_count, String8List* payload)
+{
+  Temp scratch = scratch_begin(0, 0);
+  
+  APP_ResultFrameHeader* header = push_array(scratch.arena, APP_ResultFrameHeader, 1);
+  header->kind = kind;
+  header->column_count_or_status = column_count_or_status;
+  header->row_count = row_count;
+  header->size = payload ? payload->total_size : 0;
+  
+  String8List frame = { 0 };
+  str8_list_push(scratch.arena, &frame, str8_struct(header));
+  app_result_sink_write(sink, &frame);
+  if (payload)
+  {
+    app_result_sink_write(sink, payload);
+  }
+  if (kind == APP_ResultFrameKind_Batch)
+  {
+    sink->batch_count++;
+  }
+  
+  scratch_end(scratch);
+}
+
+internal void
+app_stream_select_result(APP_ResultSink* sink, GDB_Table* table, IR_Node* column_list, APP_KernelResult* result)
+{
+  ProfBeginFunction();
+  Temp scratch = scratch_begin(0, 0);
+  
+  U32 column_count = 0;
+  for (IR_Node* column_node = column_list->first; column_node != NULL; column_node = column_node->next)
+  {
+    column_count++;
+  }
+  
+  //- tec: schema, has_nulls is decided once so every batch of the set has the same layout
+  GDB_Column** columns = push_array(scratch.arena, GDB_Column*, column_count);
+  B32* has_nulls = push_array(scratch.arena, B32, column_count);
+  String8List schema = { 0 };
+  {
+    U32 column_index = 0;
+    for (IR_Node* column_node = column_list->first; column_node != NULL; column_node = column_node->next, column_index++)
+    {
+      GDB_Column* column = gdb_table_find_column(table, column_node->value);
+      columns[column_index] = column;
+      has_nulls[column_index] = gdb_column_has_nulls(column);
+      
+      APP_ResultColumnHeader* column_header = push_array(scratch.arena, APP_ResultColumnHeader, 1);
+      column_header->type = column->type;
+      column_header->has_nulls = has_nulls[column_index];
+      column_header->name_size = (U32)column->name.size;
+      str8_list_push(scratch.arena, &schema, str8_struct(column_header));
+      str8_list_push(scratch.arena, &schema, column->name);
+    }
+  }
+  app_result_sink_write_frame(sink, APP_ResultFrameKind_Schema, column_count, result->count, &schema);
+  
+  //- tec: each batch is gathered, written and dropped before the next one
+  for (U64 batch_start = 0; batch_start < result->count && !sink->failed; batch_start += APP_RESULT_BATCH_ROWS)
+  {
+    U64 batch_count = Min(APP_RESULT_BATCH_ROWS, result->count - batch_start);
+    Temp batch_temp = temp_begin(scratch.arena);
+    
+    String8List batch = { 0 };
+    for (U32 column_index = 0; column_index < column_count; column_index++)
+    {
+      app_encode_column_values(batch_temp.arena, &batch, columns[column_index], has_nulls[column_index],
+                               result->indices + batch_start, batch_count);
+    }
+    app_result_sink_write_frame(sink, APP_ResultFrameKind_Batch, column_count, batch_count, &batch);
+    
+    temp_end(batch_temp);
+  }
+  
+  scratch_end(scratch);
+  ProfEnd();
+}
+
+internal void
+app_stream_text_result(APP_ResultSink* sink, String8 column_name, String8List* lines)
+{
+  Temp scratch = scratch_begin(0, 0);
+  
+  String8Array values = str8_array_from_list(scratch.arena, lines);
+  String8List schema = { 0 };
+  app_encode_result_column_header(scratch.arena, &schema, GDB_ColumnType_String8, column_name);
+  String8List data = { 0 };
+  app_encode_string_values(scratch.arena, &data, values.v, values.count);
+  
+  app_result_sink_write_frame(sink, APP_ResultFrameKind_Schema, 1, values.count, &schema);
+  app_result_sink_write_frame(sink, APP_ResultFrameKind_Batch, 1, values.count, &data);
+  
+  scratch_end(scratch);
+}
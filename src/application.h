@@ -3,15 +3,495 @@
 #ifndef APPLICATION_H
 #define APPLICATION_H
 
+// tec: an index is only used when it narrows the table down to at most this share of rows (percent)
+#ifndef APP_INDEX_MAX_SELECTIVITY_PERCENT
+#define APP_INDEX_MAX_SELECTIVITY_PERCENT 10
+#endif
+
+//~ tec: shared scans
+// tec: a scan waits this long for other SELECTs on its table when another scan is already running
+#ifndef APP_SCAN_BATCH_WINDOW_US
+#define APP_SCAN_BATCH_WINDOW_US 2000
+#endif
+#ifndef APP_SCAN_BATCH_MAX_QUERIES
+#define APP_SCAN_BATCH_MAX_QUERIES 16
+#endif
+
+// tec: with several gpus a scan is cut into about this many chunks per device, so a device that
+// runs ahead has chunks left to take from slower ones. smaller tables stay on one device
+#ifndef APP_SCAN_CHUNKS_PER_DEVICE
+#define APP_SCAN_CHUNKS_PER_DEVICE 8
+#endif
+#ifndef APP_SCAN_MULTI_DEVICE_MIN_ROWS
+#define APP_SCAN_MULTI_DEVICE_MIN_ROWS (1 << 20)
+#endif
+
+// tec: chunks a scan worker has claimed and is reading from disk ahead of the one it runs
+#ifndef APP_SCAN_PREFETCH_DEPTH
+#define APP_SCAN_PREFETCH_DEPTH 1
+#endif
+#define APP_SCAN_READ_SLOT_COUNT (APP_SCAN_PREFETCH_DEPTH + 1)
+
+// tec: chunks are read into these when they do not go to a staging buffer, which makes them the fallback
+// path. regular pages committed as the reads need them, a scan that stages every column commits little
+#ifndef APP_SCAN_READ_ARENA_RESERVE_SIZE
+#define APP_SCAN_READ_ARENA_RESERVE_SIZE MB(128)
+#endif
+#ifndef APP_SCAN_READ_ARENA_COMMIT_SIZE
+#define APP_SCAN_READ_ARENA_COMMIT_SIZE MB(2)
+#endif
+
+//~ tec: statement cache
+// tec: read only queries are cached by their normalized text with literals as parameters,
+// queries with more literals than this are parsed every time
+#ifndef APP_STATEMENT_MAX_PARAMS
+#define APP_STATEMENT_MAX_PARAMS 64
+#endif
+#ifndef APP_STATEMENT_CACHE_BUCKET_COUNT
+#define APP_STATEMENT_CACHE_BUCKET_COUNT 256
+#endif
+// tec: once this many texts are cached new ones are parsed every time, prepared statements always fit
+#ifndef APP_STATEMENT_CACHE_MAX_COUNT
+#define APP_STATEMENT_CACHE_MAX_COUNT 1024
+#endif
+#ifndef APP_STATEMENT_ARENA_RESERVE_SIZE
+#define APP_STATEMENT_ARENA_RESERVE_SIZE KB(256)
+#endif
+
+//~ tec: server
+#define APP_SERVER_REQUEST_MAGIC  0x51424447 // tec: 'GDBQ'
+#define APP_SERVER_RESPONSE_MAGIC 0x52424447 // tec: 'GDBR'
+
+#ifndef APP_SERVER_DEFAULT_PORT
+#define APP_SERVER_DEFAULT_PORT 7450
+#endif
+#ifndef APP_SERVER_MAX_QUERY_SIZE
+#define APP_SERVER_MAX_QUERY_SIZE MB(16)
+#endif
+#ifndef APP_SERVER_ARENA_RESERVE_SIZE
+#define APP_SERVER_ARENA_RESERVE_SIZE GB(16)
+#endif
+#ifndef APP_SERVER_ARENA_COMMIT_SIZE
+#define APP_SERVER_ARENA_COMMIT_SIZE MB(1)
+#endif
+
+typedef U32 APP_ServerFlags;
+enum
+{
+  APP_ServerFlag_Shutdown      = (1 << 0),
+  APP_ServerFlag_StreamResults = (1 << 1),
+};
+
+typedef U32 APP_ServerStatus;
+enum
+{
+  APP_ServerStatus_Ok,
+  APP_ServerStatus_Error,
+  APP_ServerStatus_BadRequest,
+};
+
+// tec: a request is [header: magic 'GDBQ', flags, size][size bytes of sql]
+// a response is [header: magic 'GDBR', status, size][size bytes of result sets], one result set per SELECT,
+// or a result stream (see below) when the request has APP_ServerFlag_StreamResults:
+// [APP_ResultSetHeader][column_count x (APP_ResultColumnHeader, name)][column_count x column data]
+// column data is [validity bitmap, when has_nulls][row_count x value] for fixed size types and
+// [validity bitmap, when has_nulls][(row_count + 1) x U64 offsets][bytes] for strings
+typedef struct APP_ServerFrameHeader APP_ServerFrameHeader;
+struct APP_ServerFrameHeader
+{
+  U32 magic;
+  U32 flags_or_status;
+  U64 size;
+};
+
+typedef struct APP_ResultSetHeader APP_ResultSetHeader;
+struct APP_ResultSetHeader
+{
+  U32 column_count;
+  U32 reserved;
+  U64 row_count;
+};
+
+typedef struct APP_ResultColumnHeader APP_ResultColumnHeader;
+struct APP_ResultColumnHeader
+{
+  GDB_ColumnType type;
+  U32 has_nulls;
+  U32 name_size;
+  U32 reserved;
+};
+
+//~ tec: result streams
+// tec: a stream is [U64 magic 'GDBRES01'] followed by frames, each [APP_ResultFrameHeader][size bytes].
+// every result set starts with a schema frame, column_count x (APP_ResultColumnHeader, name), with
+// row_count the total rows of the set. batch frames follow with row_count rows each, the column data
+// laid out like a server response. an end frame with the APP_ServerStatus closes the stream.
+// unlike a server response nothing is buffered, a result of any size streams in bounded memory
+#define APP_RESULT_STREAM_MAGIC 0x3130534552424447ull // tec: 'GDBRES01'
+
+#ifndef APP_RESULT_BATCH_ROWS
+#define APP_RESULT_BATCH_ROWS (1 << 16)
+#endif
+
+typedef U32 APP_ResultFrameKind;
+enum
+{
+  APP_ResultFrameKind_Schema,
+  APP_ResultFrameKind_Batch,
+  APP_ResultFrameKind_End,
+};
+
+typedef struct APP_ResultFrameHeader APP_ResultFrameHeader;
+struct APP_ResultFrameHeader
+{
+  APP_ResultFrameKind kind;
+  U32 column_count_or_status;
+  U64 row_count;
+  U64 size;
+};
+
+typedef U32 APP_ResultSinkKind;
+enum
+{
+  APP_ResultSinkKind_File,
+  APP_ResultSinkKind_Socket,
+};
+
+// tec: where a stream goes. files and pipes, stdout included, are written with os_file_write,
+// sockets with os_socket_send. a failed write stops the stream, the rest is dropped
+typedef struct APP_ResultSink APP_ResultSink;
+struct APP_ResultSink
+{
+  APP_ResultSinkKind kind;
+  OS_Handle handle;
+  B32 owns_handle;
+  B32 failed;
+  
+  // tec: write position in a file, pipes and sockets ignore it
+  U64 offset;
+  U64 bytes_written;
+  U64 batch_count;
+};
+
+// tec: state kept between queries, the server keeps one per connection so USE sticks
+typedef struct APP_QueryContext APP_QueryContext;
+struct APP_QueryContext
+{
+  GDB_Database* database;
+  
+  // tec: when set, the rows of every SELECT are encoded into output
+  Arena* output_arena;
+  String8List output;
+  
+  // tec: when set, results stream here in batches instead, output stays empty
+  APP_ResultSink* sink;
+  B32 failed;
+};
+
+// tec: shared by the accept loop and every connection thread
+typedef struct APP_Server APP_Server;
+struct APP_Server
+{
+  OS_Handle listener;
+  U64 running;
+  U64 active_query_count;
+};
+
+// tec: one per client, each runs on its own thread with its own arena and USE state
+typedef struct APP_ServerConnection APP_ServerConnection;
+struct APP_ServerConnection
+{
+  APP_Server* server;
+  Arena* arena;
+  OS_Handle client;
+};
+
 typedef struct APP_KernelResult APP_KernelResult;
 struct APP_KernelResult
 {
   U64* indices;
   U64 count;
   U64 cap;
+  
+  // tec: the scan could not run every chunk, the indices are incomplete
+  B32 failed;
 };
 
-internal void app_execute_query(String8 sql_query);
-internal APP_KernelResult app_perform_kernel(Arena* arena, String8 kernel_name, GDB_Database* database, IR_Node* root_node);
+// tec: one SELECT waiting on a shared scan. the result is pushed onto the requester's arena
+typedef struct APP_ScanRequest APP_ScanRequest;
+struct APP_ScanRequest
+{
+  APP_ScanRequest* next;
+  Arena* arena;
+  IR_Node* root_node;
+  U64 shape_hash;
+  APP_KernelResult result;
+  B32 done;
+};
+
+// tec: SELECTs on one table that run as a single fused kernel. the first query to arrive leads,
+// it runs the kernel for everyone that joined before it closed the batch
+typedef struct APP_ScanBatch APP_ScanBatch;
+struct APP_ScanBatch
+{
+  APP_ScanBatch* next;
+  GDB_Table* table;
+  APP_ScanRequest* first;
+  APP_ScanRequest* last;
+  U64 count;
+};
+
+typedef struct APP_ScanScheduler APP_ScanScheduler;
+struct APP_ScanScheduler
+{
+  Arena* arena;
+  OS_Handle mutex;
+  OS_Handle cv;
+  APP_ScanBatch* open_batches;
+  U64 running_scan_count;
+  
+  U64 fused_scan_count;
+  U64 fused_query_count;
+};
+
+global APP_ScanScheduler* g_app_scan_scheduler = 0;
+
+// tec: a parsed statement whose values are $1, $2, ... parameters. its ir is never executed directly,
+// every execution gets a copy with the parameters bound, so concurrent queries share it safely
+typedef struct APP_Statement APP_Statement;
+struct APP_Statement
+{
+  APP_Statement* hash_next;
+  Arena* arena;
+  U64 hash;
+  
+  // tec: the normalized text of a cached statement, the name of a prepared one
+  String8 key;
+  B32 is_prepared;
+  
+  IR_Node* execution_nodes;
+  U64 param_count;
+};
+
+// tec: shared by every connection, PREPARE in one is visible to EXECUTE in all of them
+typedef struct APP_StatementCache APP_StatementCache;
+struct APP_StatementCache
+{
+  OS_Handle mutex;
+  APP_Statement* buckets[APP_STATEMENT_CACHE_BUCKET_COUNT];
+  U64 cached_count;
+  U64 hits;
+  U64 misses;
+};
+
+global APP_StatementCache* g_app_statement_cache = 0;
+
+// tec: one kernel run over a table, cut into chunks that are spread over the devices. each device
+// starts on a contiguous share sized by its measured throughput, when it runs out it takes chunks
+// from the end of the device with the most left
+typedef struct APP_ScanJob APP_ScanJob;
+struct APP_ScanJob
+{
+  String8 kernel_name;
+  String8 kernel_code;
+  GPU_KernelParamList* kernel_params;
+  GDB_Table* table;
+  String8List* active_columns;
+  U64 gpu_buffer_count;
+  U64 request_count;
+  
+  // tec: per active column, whether its chunks are read past the page cache
+  B8* direct_io;
+  
+  // tec: per active column, whether it held nulls when the scan started. the kernel takes a bitmap for these
+  B8* has_nulls;
+  
+  U64 row_count;
+  U64 rows_per_chunk;
+  U64 chunk_count;
+  
+  // tec: the matches of chunk c for query q sit at chunk_results[c * request_count + q]
+  APP_KernelResult* chunk_results;
+  
+  // tec: set by any worker whose chunk could not run
+  B32 failed;
+  
+  OS_Handle mutex;
+  U32 device_count;
+  Rng1U64 device_chunks[GPU_MAX_DEVICE_COUNT];
+};
+
+typedef struct APP_ScanWorker APP_ScanWorker;
+struct APP_ScanWorker
+{
+  APP_ScanJob* job;
+  U32 device_index;
+  Arena* arena;
+  
+  // tec: the disk reads of the chunk being run and of the ones claimed after it, their columns
+  // load while the current chunk is on the gpu. direct reads land in the slot arenas, aligned
+  Arena* read_arenas[APP_SCAN_READ_SLOT_COUNT];
+  GDB_ChunkReadBatch reads[APP_SCAN_READ_SLOT_COUNT];
+  
+  // tec: per slot, the pinned staging buffer each active column was read into, NULL for columns that were not
+  GPU_Buffer** staging[APP_SCAN_READ_SLOT_COUNT];
+  
+  // tec: what the worker's thread added, folded into the calling thread's counters afterwards
+  GPU_Stats gpu_stats;
+  GDB_IOStats io_stats;
+  U64 chunks_run;
+  U64 chunks_stolen;
+  U64 rows_run;
+};
+
+//~ tec: explain
+// tec: one row of EXPLAIN ANALYZE, the counters are what the operator added on this thread
+typedef struct APP_OperatorStats APP_OperatorStats;
+struct APP_OperatorStats
+{
+  APP_OperatorStats* next;
+  String8 name;
+  String8 detail;
+  U64 rows_in;
+  U64 rows_out;
+  U64 time_us;
+  U64 bytes_read;
+  U64 bytes_uploaded;
+  U64 bytes_downloaded;
+  U64 kernel_compile_us;
+  U64 kernel_cache_hits;
+  U64 kernel_cache_misses;
+  U64 kernel_us;
+  
+  U64 start_us;
+  GDB_IOStats io_start;
+  GPU_Stats gpu_start;
+};
+
+typedef struct APP_ExplainAnalyze APP_ExplainAnalyze;
+struct APP_ExplainAnalyze
+{
+  APP_OperatorStats* first;
+  APP_OperatorStats* last;
+  U64 count;
+};
+
+// tec: the U64 columns of an EXPLAIN ANALYZE result set, after operator and detail
+typedef U32 APP_ExplainCounter;
+enum
+{
+  APP_ExplainCounter_RowsIn,
+  APP_ExplainCounter_RowsOut,
+  APP_ExplainCounter_TimeUs,
+  APP_ExplainCounter_BytesRead,
+  APP_ExplainCounter_BytesUploaded,
+  APP_ExplainCounter_BytesDownloaded,
+  APP_ExplainCounter_KernelCompileUs,
+  APP_ExplainCounter_KernelCacheHits,
+  APP_ExplainCounter_KernelUs,
+  APP_ExplainCounter_COUNT
+};
+
+global String8 g_app_explain_counter_names[APP_ExplainCounter_COUNT] =
+{
+  str8_lit_comp("rows_in"),
+  str8_lit_comp("rows_out"),
+  str8_lit_comp("time_us"),
+  str8_lit_comp("bytes_read"),
+  str8_lit_comp("bytes_uploaded"),
+  str8_lit_comp("bytes_downloaded"),
+  str8_lit_comp("kernel_compile_us"),
+  str8_lit_comp("kernel_cache_hits"),
+  str8_lit_comp("kernel_us"),
+};
+
+// tec: a where clause conjunct that an index can answer
+typedef struct APP_IndexPlan APP_IndexPlan;
+struct APP_IndexPlan
+{
+  GDB_Index* index;
+  IR_Node* conjunct;
+  B32 is_equal;
+  U64 key;
+  String8 string_key;
+  U64 min_key;
+  B32 min_inclusive;
+  U64 max_key;
+  B32 max_inclusive;
+  U64 estimated_rows;
+};
+
+// tec: one operand of a predicate evaluated on the cpu
+typedef struct APP_Value APP_Value;
+struct APP_Value
+{
+  B32 is_null;
+  B32 is_string;
+  B32 is_integer;
+  U64 u64;
+  F64 f64;
+  String8 string;
+};
+
+internal void app_init(void);
+internal void app_execute_query(String8 sql_query, APP_QueryContext* context);
+internal void app_execute_select(Arena* arena, APP_QueryContext* context, GDB_Database* database, IR_Node* select_node, APP_ExplainAnalyze* analyze);
+internal B32 app_select_validate(Arena* arena, GDB_Database* database, IR_Node* select_node);
+
+//- tec: statement cache
+internal IR_Query*      app_query_from_text(Arena* arena, String8 sql_query);
+internal B32            app_statement_text_is_cacheable(String8 normalized_text);
+internal APP_Statement* app_statement_alloc(String8 key, B32 is_prepared);
+internal APP_Statement* app_statement_cache_find(String8 key, B32 is_prepared);
+internal APP_Statement* app_statement_cache_insert(APP_Statement* statement);
+internal IR_Node*       app_statement_bind(Arena* arena, APP_Statement* statement, IR_Node** params, U64 param_count);
+internal B32            app_statement_prepare(IR_Node* prepare_node);
+internal IR_Node*       app_statement_execute(Arena* arena, IR_Node* execute_node);
+
+//~ tec: shared scans
+internal APP_KernelResult app_perform_scan(Arena* arena, GDB_Database* database, IR_Node* root_node);
+internal U64  app_hash_ir_shape(IR_Node* node, U64 hash);
+internal void app_perform_kernel(Arena* arena, String8 kernel_name, GDB_Database* database, APP_ScanRequest** requests, U64 request_count);
+internal void app_scan_device_thread(void* ptr);
+internal void app_scan_worker_run(APP_ScanWorker* worker);
+internal B32  app_scan_claim_chunk(APP_ScanWorker* worker, U64* out_chunk_index);
+internal Rng1U64 app_scan_chunk_rows(APP_ScanJob* job, U64 chunk_index);
+internal void app_scan_submit_chunk_reads(APP_ScanWorker* worker, U32 slot, U64 chunk_index);
+internal void app_scan_run_chunk(APP_ScanWorker* worker, GPU_Kernel* kernel, U64 chunk_index, U32 slot);
+internal void app_collect_kernel_results(Arena* arena, APP_KernelResult* results, U64 request_count, GPU_Buffer* output_buffer, GPU_Buffer* counts_buffer, U64 output_stride, U64 row_base);
+
+//~ tec: index lookups
+internal B32 app_choose_index_plan(Arena* arena, GDB_Table* table, IR_Node* where_clause, U64 row_count, APP_IndexPlan* out_plan);
+internal B32 app_perform_index_lookup(Arena* arena, GDB_Database* database, IR_Node* root_node, APP_KernelResult* out_result);
+internal B32 app_plan_index_for_conjunct(GDB_Table* table, IR_Node* conjunct, APP_IndexPlan* out_plan);
+internal B32 app_predicate_supported_on_cpu(GDB_Table* table, IR_Node* condition);
+internal B32 app_evaluate_predicate(Arena* arena, GDB_Table* table, IR_Node* condition, U64 row);
+internal B32 app_import_filters_from_condition(Arena* arena, IR_Node* condition, GDB_ParquetFilter** filters);
+
+//~ tec: explain
+internal APP_OperatorStats* app_operator_begin(Arena* arena, APP_ExplainAnalyze* analyze, String8 name);
+internal void               app_operator_end(APP_OperatorStats* op);
+internal void               app_explain_plan(Arena* arena, GDB_Database* database, IR_Node* statement_node, String8List* out);
+internal void               app_report_explain_analyze(Arena* arena, APP_QueryContext* context, APP_ExplainAnalyze* analyze);
+
+//~ tec: server
+internal void app_encode_result_set_header(Arena* arena, String8List* out, U32 column_count, U64 row_count);
+internal void app_encode_result_column_header(Arena* arena, String8List* out, GDB_ColumnType type, String8 name);
+internal void app_encode_string_values(Arena* arena, String8List* out, String8* values, U64 count);
+internal void app_encode_text_result(Arena* arena, String8List* out, String8 column_name, String8List* lines);
+internal void app_encode_select_result(Arena* arena, String8List* out, GDB_Table* table, IR_Node* column_list, APP_KernelResult* result);
+internal void app_encode_column_values(Arena* arena, String8List* out, GDB_Column* column, B32 has_nulls, U64* indices, U64 count);
+internal B32  app_socket_recv_exact(OS_Handle socket, void* data, U64 size);
+internal void app_server_connection_thread(void* ptr);
+internal void app_server_run(String8 host, U16 port);
+
+//- tec: result streams
+internal APP_ResultSink app_result_sink_open(String8 path);
+internal APP_ResultSink app_result_sink_from_socket(OS_Handle socket);
+internal void           app_result_sink_close(APP_ResultSink* sink, APP_ServerStatus status);
+internal void           app_result_sink_write(APP_ResultSink* sink, String8List* data);
+internal void           app_result_sink_write_frame(APP_ResultSink* sink, APP_ResultFrameKind kind, U32 column_count_or_status, U64 row_count, String8List* payload);
+internal void           app_stream_select_result(APP_ResultSink* sink, GDB_Table* table, IR_Node* column_list, APP_KernelResult* result);
+internal void           app_stream_text_result(APP_ResultSink* sink, String8 column_name, String8List* lines);
 
 #endif //APPLICATION_H
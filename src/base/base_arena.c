@@ -6,13 +6,25 @@
 internal Arena *
 arena_alloc_(ArenaParams *params)
 {
+  // tec: large pages are a request, without the privilege for them the arena takes regular pages
+  ArenaFlags flags = params->flags;
+  if((flags & ArenaFlag_LargePages) && !os_get_system_info()->large_pages_enabled)
+  {
+    flags &= ~ArenaFlag_LargePages;
+  }
+  
+  // tec: a node preference only matters with more than one node
+  B32 on_node = ((flags & ArenaFlag_NumaNode) && os_get_system_info()->numa_node_count > 1);
+  U32 node = NumaNodeFromArenaFlags(flags);
+  
   // tec: round up reserve/commit sizes
   U64 reserve_size = params->reserve_size;
   U64 commit_size = params->commit_size;
-  if(params->flags & ArenaFlag_LargePages)
+  if(flags & ArenaFlag_LargePages)
   {
+    // tec: large pages are committed on reserve, the whole block is usable from the start
     reserve_size = AlignPow2(reserve_size, os_get_system_info()->large_page_size);
-    commit_size  = AlignPow2(commit_size,  os_get_system_info()->large_page_size);
+    commit_size  = reserve_size;
   }
   else
   {
@@ -22,19 +34,26 @@ arena_alloc_(ArenaParams *params)
   
   // tec: reserve/commit initial block
   void *base = params->optional_backing_buffer;
-  if(base == 0)
+  if(base == 0 && (flags & ArenaFlag_LargePages))
   {
-    if(params->flags & ArenaFlag_LargePages)
+    base = on_node ? os_reserve_large_numa(reserve_size, node) : os_reserve_large(reserve_size);
+    if(base != 0)
     {
-      base = os_reserve_large(reserve_size);
       os_commit_large(base, commit_size);
     }
     else
     {
-      base = os_reserve(reserve_size);
-      os_commit(base, commit_size);
+      // tec: physical memory too fragmented for large pages, take regular ones
+      flags &= ~ArenaFlag_LargePages;
+      reserve_size = AlignPow2(params->reserve_size, os_get_system_info()->page_size);
+      commit_size  = AlignPow2(params->commit_size,  os_get_system_info()->page_size);
     }
   }
+  if(base == 0 && !(flags & ArenaFlag_LargePages))
+  {
+    base = on_node ? os_reserve_numa(reserve_size, node) : os_reserve(reserve_size);
+    os_commit(base, commit_size);
+  }
   
   // tec: panic on arena creation failure
 #if OS_FEATURE_GRAPHICAL
@@ -52,7 +71,7 @@ arena_alloc_(ArenaParams *params)
   // tec: extract arena header & fill
   Arena *arena = (Arena *)base;
   arena->current = arena;
-  arena->flags = params->flags;
+  arena->flags = flags;
   arena->cmt_size = (U32)params->commit_size;
   arena->res_size = params->reserve_size;
   arena->base_pos = 0;
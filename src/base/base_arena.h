@@ -20,8 +20,14 @@ enum
 {
   ArenaFlag_NoChain    = (1<<0),
   ArenaFlag_LargePages = (1<<1),
+  ArenaFlag_NumaNode   = (1<<2),
 };
 
+// tec: the node an ArenaFlag_NumaNode arena prefers sits in the top byte of its flags, so chained blocks keep it
+#define ARENA_NUMA_NODE_SHIFT 24
+#define ArenaFlagsFromNumaNode(node) (ArenaFlag_NumaNode | ((ArenaFlags)(node) << ARENA_NUMA_NODE_SHIFT))
+#define NumaNodeFromArenaFlags(flags) ((U32)((flags) >> ARENA_NUMA_NODE_SHIFT))
+
 typedef struct ArenaParams ArenaParams;
 struct ArenaParams
 {
@@ -7,6 +7,7 @@
 //~ tec: Foreign Includes
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <stdarg.h>
 #include <math.h>
 #include <string.h>
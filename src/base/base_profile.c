@@ -1,143 +1,300 @@
 #if PROFILE_CUSTOM
+// tec: a finished scope or a message. fixed size, the strings are never copied
 struct ProfEvent
 {
+  const char* name;
+  const char* file;
+  U64 start;
+  U64 end;
+  U32 line;
   ProfEventType type;
-  U64 timestamp;
-  String8 name;
-  String8 file;
+};
+
+typedef struct ProfOpenScope ProfOpenScope;
+struct ProfOpenScope
+{
+  const char* name;
+  const char* file;
+  U64 start;
   U32 line;
+  B32 dynamic;
+  char dynamic_name[PROF_DYNAMIC_NAME_SIZE];
+};
+
+// tec: only the owning thread writes its ring. write_count is published after each event,
+// a dump copies the ring and drops whatever the writer lapped while it was copying
+struct ProfThread
+{
+  ProfThread* next;
+  ProfThread* next_free;
   U32 thread_id;
+  U64 write_count;
+  ProfEvent* events;
+  
+  ProfOpenScope scopes[PROF_MAX_DEPTH];
+  U64 depth;
+  
+  // tec: ProfBeginDynamic names, one slot per ring event. an event's name is overwritten together with the event
+  char* names;
 };
 
 struct ProfState
 {
   Arena *arena;
+  
+  // tec: taken when a thread gets or returns its ring, never while recording
   OS_Handle mutex;
-  ProfEvent *events;
-  U64 event_count;
-  U64 event_capacity;
+  ProfThread* first_thread;
+  ProfThread* free_threads;
+  U64 capturing;
   
-  U64 *begin_stack;
-  U64 begin_stack_count;
-  U64 begin_stack_capacity;
+  // tec: timestamps are converted to microseconds against the os clock sampled at alloc and dump
+  U64 start_ticks;
+  U64 start_us;
 };
 
 internal void
 prof_alloc(void)
 {
   Arena* arena = arena_alloc();
-  g_prof = push_array(arena, ProfState, 1);
-  g_prof->arena = arena;
-  g_prof->mutex = os_mutex_alloc();
-  
-  g_prof->event_capacity = 8192*2;
-  g_prof->events = push_array(arena, ProfEvent, g_prof->event_capacity);
-  g_prof->event_count = 0;
+  ProfState* prof = push_array(arena, ProfState, 1);
+  prof->arena = arena;
+  prof->mutex = os_mutex_alloc();
+  prof->start_us = os_now_microseconds();
+  prof->start_ticks = prof_timestamp();
+  prof->capturing = 1;
+  g_prof = prof;
 }
 
 
 internal void
 prof_release(void)
 {
-  os_mutex_release(g_prof->mutex);
+  // tec: rings stay mapped, detached threads may record until the process exits
+  ins_atomic_u64_eval_assign(&g_prof->capturing, 0);
   prof_json_dump();
-  arena_release(g_prof->arena);
 }
 
 internal void 
 prof_json_dump()
 {
+  Temp scratch = scratch_begin(0, 0);
   String8List list = { 0 };
   
-  str8_list_push(g_prof->arena, &list, str8_lit("{ \"traceEvents\": [\n"));
+  U64 end_us = os_now_microseconds();
+  U64 end_ticks = prof_timestamp();
+  F64 us_per_tick = (end_ticks > g_prof->start_ticks) ? (F64)(end_us - g_prof->start_us) / (F64)(end_ticks - g_prof->start_ticks) : 1.0;
   
-  for (U64 i = 0; i < g_prof->event_count; i++)
+  str8_list_push(scratch.arena, &list, str8_lit("{ \"traceEvents\": [\n"));
+  
+  B32 first_event = 1;
+  OS_MutexScope(g_prof->mutex)
   {
-    ProfEvent *e = &g_prof->events[i];
-    const char *ph = "";
-    switch (e->type)
-    {
-      case ProfEventType_Begin: ph = "B"; break;
-      case ProfEventType_End:   ph = "E"; break;
-      case ProfEventType_Msg:   ph = "i"; break;
-    }
-    
-    str8_list_pushf(g_prof->arena, &list, "  { \"name\": \"%.*s\", \"ph\": \"%s\", \"ts\": %llu, \"pid\": 0, \"tid\": %u",
-                    str8_varg(e->name), ph, e->timestamp, e->thread_id);
-    
-    if (e->type == ProfEventType_Msg)
+    for (ProfThread* thread = g_prof->first_thread; thread != NULL; thread = thread->next)
     {
-      str8_list_push(g_prof->arena, &list, str8_lit(", \"s\": \"g\""));
+      //- tec: copy the ring, then keep only the events the writer cannot have overwritten meanwhile.
+      // the writer may be filling slot count_after already, which holds event count_after - PROF_RING_EVENT_COUNT
+      // the name slots are copied along, each one is rewritten together with its event
+      U64 names_size = PROF_RING_EVENT_COUNT * PROF_DYNAMIC_NAME_SIZE;
+      U64 count_before = ins_atomic_u64_eval(&thread->write_count);
+      ProfEvent* events = push_array_no_zero(scratch.arena, ProfEvent, PROF_RING_EVENT_COUNT);
+      MemoryCopy(events, thread->events, sizeof(ProfEvent) * PROF_RING_EVENT_COUNT);
+      char* names = push_array_no_zero(scratch.arena, char, names_size);
+      MemoryCopy(names, thread->names, names_size);
+      U64 count_after = ins_atomic_u64_eval(&thread->write_count);
+      
+      U64 first = (count_after + 1 > PROF_RING_EVENT_COUNT) ? count_after + 1 - PROF_RING_EVENT_COUNT : 0;
+      U64 last = count_before;
+      for (U64 i = first; i < last; i++)
+      {
+        ProfEvent* e = &events[i & (PROF_RING_EVENT_COUNT - 1)];
+        const char* name = e->name;
+        if (name >= thread->names && name < thread->names + names_size)
+        {
+          name = names + (name - thread->names);
+        }
+        F64 ts = g_prof->start_us + (F64)(S64)(e->start - g_prof->start_ticks) * us_per_tick;
+        
+        str8_list_pushf(scratch.arena, &list, "%s  { \"name\": \"%s\", \"ph\": \"%s\", \"ts\": %.3f, \"pid\": 0, \"tid\": %u",
+                        first_event ? "" : ",\n", name, (e->type == ProfEventType_Msg) ? "i" : "X", ts, thread->thread_id);
+        if (e->type == ProfEventType_Msg)
+        {
+          str8_list_push(scratch.arena, &list, str8_lit(", \"s\": \"g\""));
+        }
+        else
+        {
+          str8_list_pushf(scratch.arena, &list, ", \"dur\": %.3f", (F64)(e->end - e->start) * us_per_tick);
+        }
+        str8_list_push(scratch.arena, &list, str8_lit(" }"));
+        first_event = 0;
+      }
     }
-    
-    str8_list_pushf(g_prof->arena, &list, " }%s\n", (i+1 < g_prof->event_count) ? "," : "");
   }
   
-  str8_list_push(g_prof->arena, &list, str8_lit("] }\n"));
+  str8_list_push(scratch.arena, &list, str8_lit("\n] }\n"));
   
   os_write_data_list_to_file_path(str8_lit("profile.json"), list);
+  scratch_end(scratch);
 }
 
-internal void
-prof_record_event(ProfEventType type, const char *name, const char *file, int line)
+//~ tec: recording
+internal U64
+prof_timestamp(void)
 {
+#if ARCH_X64
+  return __rdtsc();
+#else
+  return os_now_microseconds();
+#endif
+}
+
+internal ProfThread*
+prof_thread_equip(void)
+{
+  if (g_prof == 0 || !ins_atomic_u64_eval(&g_prof->capturing))
+  {
+    return NULL;
+  }
+  
+  // tec: rings of finished threads are reused, their events are dropped
+  ProfThread* thread = 0;
   OS_MutexScope(g_prof->mutex)
   {
-    
-    if (g_prof->event_count >= g_prof->event_capacity) 
+    thread = g_prof->free_threads;
+    if (thread)
     {
-      U64 new_capacity = g_prof->event_capacity ? g_prof->event_capacity * 2 : 1024;
-      ProfEvent *new_events = push_array(g_prof->arena, ProfEvent, new_capacity);
-      
-      MemoryCopy(new_events, g_prof->events, sizeof(ProfEvent) * g_prof->event_count);
-      
-      g_prof->events = new_events;
-      g_prof->event_capacity = new_capacity;
+      g_prof->free_threads = thread->next_free;
     }
-    
-    U64 idx = g_prof->event_count++;
-    ProfEvent *ev = &g_prof->events[idx];
-    ev->type = type;
-    ev->timestamp = os_now_microseconds();
-    ev->thread_id = os_tid();
-    
-    if (type == ProfEventType_Begin) 
+    else
     {
-      ev->name = push_str8f(g_prof->arena, "%s", name);
-      ev->file = push_str8f(g_prof->arena, "%s", file);
-      ev->line = line;
-      
-      if (g_prof->begin_stack_count >= g_prof->begin_stack_capacity) 
-      {
-        g_prof->begin_stack_capacity = (g_prof->begin_stack_capacity ? g_prof->begin_stack_capacity * 2 : 128);
-        g_prof->begin_stack = push_array(g_prof->arena, U64, g_prof->begin_stack_capacity);
-      }
-      g_prof->begin_stack[g_prof->begin_stack_count++] = idx;
+      thread = push_array(g_prof->arena, ProfThread, 1);
+      thread->events = push_array(g_prof->arena, ProfEvent, PROF_RING_EVENT_COUNT);
+      thread->names = push_array_no_zero(g_prof->arena, char, PROF_RING_EVENT_COUNT * PROF_DYNAMIC_NAME_SIZE);
+      SLLStackPush(g_prof->first_thread, thread);
     }
-    else if (type == ProfEventType_End)
-    {
-      if (g_prof->begin_stack_count == 0)
-      {
-        ev->name = push_str8_copy(g_prof->arena, str8_lit("MISSING BEGIN"));
-        ev->file = push_str8f(g_prof->arena, "%s", file);
-        ev->line = line;
-      } 
-      else 
-      {
-        U64 begin_idx = g_prof->begin_stack[--g_prof->begin_stack_count];
-        ProfEvent *begin_ev = &g_prof->events[begin_idx];
-        
-        ev->name = begin_ev->name;
-        ev->file = begin_ev->file;
-        ev->line = begin_ev->line;
-      }
-    }
-    else if (type == ProfEventType_Msg)
+    thread->next_free = 0;
+    thread->thread_id = os_tid();
+    thread->depth = 0;
+    thread->write_count = 0;
+  }
+  
+  g_prof_thread = thread;
+  return thread;
+}
+
+internal void
+prof_thread_release(void)
+{
+  ProfThread* thread = g_prof_thread;
+  if (thread == 0 || g_prof == 0)
+  {
+    return;
+  }
+  
+  g_prof_thread = 0;
+  OS_MutexScope(g_prof->mutex)
+  {
+    thread->next_free = g_prof->free_threads;
+    g_prof->free_threads = thread;
+  }
+}
+
+internal void
+prof_thread_push(ProfThread* thread, ProfEventType type, const char* name, const char* file, U32 line, U64 start, U64 end)
+{
+  U64 index = thread->write_count;
+  ProfEvent* e = &thread->events[index & (PROF_RING_EVENT_COUNT - 1)];
+  e->name = name;
+  e->file = file;
+  e->start = start;
+  e->end = end;
+  e->line = line;
+  e->type = type;
+  ins_atomic_u64_eval_assign(&thread->write_count, index + 1);
+}
+
+internal void
+prof_begin(const char* name, const char* file, U32 line)
+{
+  ProfThread* thread = g_prof_thread ? g_prof_thread : prof_thread_equip();
+  if (thread == NULL)
+  {
+    return;
+  }
+  
+  if (thread->depth < PROF_MAX_DEPTH)
+  {
+    ProfOpenScope* scope = &thread->scopes[thread->depth];
+    scope->name = name;
+    scope->file = file;
+    scope->line = line;
+    scope->dynamic = 0;
+    scope->start = prof_timestamp();
+  }
+  thread->depth++;
+}
+
+internal void
+prof_begin_dynamicf(const char* file, U32 line, char* fmt, ...)
+{
+  ProfThread* thread = g_prof_thread ? g_prof_thread : prof_thread_equip();
+  if (thread == NULL)
+  {
+    return;
+  }
+  
+  // tec: formatted into the open scope, prof_end moves it to the slot of the event it becomes
+  if (thread->depth < PROF_MAX_DEPTH)
+  {
+    ProfOpenScope* scope = &thread->scopes[thread->depth];
+    va_list args;
+    va_start(args, fmt);
+    gdb_vsnprintf(scope->dynamic_name, PROF_DYNAMIC_NAME_SIZE, fmt, args);
+    va_end(args);
+    scope->name = scope->dynamic_name;
+    scope->file = file;
+    scope->line = line;
+    scope->dynamic = 1;
+    scope->start = prof_timestamp();
+  }
+  thread->depth++;
+}
+
+internal void
+prof_end(void)
+{
+  U64 end = prof_timestamp();
+  ProfThread* thread = g_prof_thread;
+  if (thread == NULL || thread->depth == 0)
+  {
+    return;
+  }
+  
+  thread->depth--;
+  if (thread->depth < PROF_MAX_DEPTH)
+  {
+    ProfOpenScope* scope = &thread->scopes[thread->depth];
+    const char* name = scope->name;
+    if (scope->dynamic)
     {
-      ev->name = push_str8f(g_prof->arena, "%s", name);
-      ev->file = push_str8f(g_prof->arena, "%s", file);
-      ev->line = line;
+      char* slot = thread->names + (thread->write_count & (PROF_RING_EVENT_COUNT - 1)) * PROF_DYNAMIC_NAME_SIZE;
+      MemoryCopy(slot, scope->dynamic_name, PROF_DYNAMIC_NAME_SIZE);
+      name = slot;
     }
+    prof_thread_push(thread, ProfEventType_Complete, name, scope->file, scope->line, scope->start, end);
+  }
+}
+
+internal void
+prof_msg(const char* name, const char* file, U32 line)
+{
+  ProfThread* thread = g_prof_thread ? g_prof_thread : prof_thread_equip();
+  if (thread == NULL)
+  {
+    return;
   }
+  
+  U64 now = prof_timestamp();
+  prof_thread_push(thread, ProfEventType_Msg, name, file, line, now, now);
 }
-#endif
\ No newline at end of file
+#endif
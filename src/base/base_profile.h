@@ -19,46 +19,66 @@
 
 //~ tec: custom
 #if PROFILE_CUSTOM
+
+// tec: events kept per thread, a full ring overwrites its oldest events. must be a power of two
+#if !defined(PROF_RING_EVENT_COUNT)
+# define PROF_RING_EVENT_COUNT (1 << 16)
+#endif
+
+// tec: scopes nested deeper than this are not recorded
+#if !defined(PROF_MAX_DEPTH)
+# define PROF_MAX_DEPTH 256
+#endif
+
+// tec: ProfBeginDynamic names are cut to this, terminator included
+#if !defined(PROF_DYNAMIC_NAME_SIZE)
+# define PROF_DYNAMIC_NAME_SIZE 64
+#endif
+
+#if ARCH_X64 && !COMPILER_MSVC
+# include <x86intrin.h>
+#endif
+
 typedef enum 
 {
   ProfEventType_Begin,
   ProfEventType_End,
-  ProfEventType_Msg
+  ProfEventType_Msg,
+  ProfEventType_Complete,
 } ProfEventType;
 
 typedef struct ProfEvent ProfEvent;
+typedef struct ProfThread ProfThread;
 typedef struct ProfState ProfState;
 
 
 global ProfState* g_prof = 0;
+thread_static ProfThread* g_prof_thread = 0;
 
 internal void prof_alloc(void);
 internal void prof_release(void);
 internal void prof_json_dump(void);
-internal void prof_record_event(ProfEventType type, const char *name, const char *file, int line);
 
-#define ProfBegin(...) do {                                   \
-char buf[256];                                            \
-snprintf(buf, sizeof(buf), __VA_ARGS__);                  \
-prof_record_event(ProfEventType_Begin, buf, __FILE__, __LINE__); \
-} while (0)
+//- tec: recording, names and files must outlive the capture (literals, __func__, __FILE__)
+internal U64         prof_timestamp(void);
+internal ProfThread* prof_thread_equip(void);
+internal void        prof_thread_release(void);
+internal void        prof_thread_push(ProfThread* thread, ProfEventType type, const char* name, const char* file, U32 line, U64 start, U64 end);
+internal void        prof_begin(const char* name, const char* file, U32 line);
+internal void        prof_begin_dynamicf(const char* file, U32 line, char* fmt, ...);
+internal void        prof_end(void);
+internal void        prof_msg(const char* name, const char* file, U32 line);
 
-# define ProfBeginDynamic(...) \
-char buf[256];                                            \
-snprintf(buf, sizeof(buf), __VA_ARGS__);                  \
-prof_record_event(ProfEventType_Begin, buf, __FILE__, __LINE__); \
-} while (0)
-
-#define ProfEnd() do {                                   \
-prof_record_event(ProfEventType_End, NULL, __FILE__, __LINE__); \
-} while (0)
+#define ProfBegin(name) prof_begin((name), __FILE__, __LINE__)
+# define ProfBeginDynamic(...) prof_begin_dynamicf(__FILE__, __LINE__, __VA_ARGS__)
+#define ProfEnd() prof_end()
 
 # define ProfTick(...) (0)
-# define ProfIsCapturing(...) (0)
+# define ProfIsCapturing(...) (g_prof != 0)
 # define ProfBeginCapture(...) prof_alloc();
 # define ProfEndCapture(...) prof_release();
 # define ProfThreadName(...) (0)
-# define ProfMsg(...) (0)
+# define ProfMsg(name) prof_msg((name), __FILE__, __LINE__)
 # define ProfBeginLockWait(...)    (0)
 # define ProfEndLockWait(...)      (0)
 # define ProfLockTake(...)         (0)
@@ -705,6 +705,59 @@ str8_from_s64(Arena *arena, S64 s64, U32 radix, U8 min_digits, U8 digit_group_se
   return result;
 }
 
+// tec: two digits per table lookup, halves the divisions of the digit at a time loop
+read_only global U8 decimal_digit_pairs[201] =
+"0001020304050607080910111213141516171819"
+"2021222324252627282930313233343536373839"
+"4041424344454647484950515253545556575859"
+"6061626364656667686970717273747576777879"
+"8081828384858687888990919293949596979899";
+
+read_only global U64 decimal_powers_of_ten[20] =
+{
+  1ull, 10ull, 100ull, 1000ull, 10000ull, 100000ull, 1000000ull, 10000000ull, 100000000ull, 1000000000ull,
+  10000000000ull, 100000000000ull, 1000000000000ull, 10000000000000ull, 100000000000000ull,
+  1000000000000000ull, 10000000000000000ull, 100000000000000000ull, 1000000000000000000ull, 10000000000000000000ull,
+};
+
+internal U64
+u64_decimal_digit_count(U64 u64)
+{
+  // tec: log10 from the bit length, 1233/4096 ~ log10(2), then one compare fixes the estimate up
+  U64 bit_count = 64 - clz64(u64 | 1);
+  U64 estimate = (bit_count * 1233) >> 12;
+  U64 result = estimate + (U64)(u64 >= decimal_powers_of_ten[estimate]);
+  result += (U64)(result == 0);
+  return result;
+}
+
+internal U64
+u64_write_decimal(U8 *buffer, U64 u64)
+{
+  U64 digit_count = u64_decimal_digit_count(u64);
+  U8 *ptr = buffer + digit_count;
+  while(u64 >= 100)
+  {
+    U64 pair = (u64 % 100) * 2;
+    u64 /= 100;
+    ptr -= 2;
+    ptr[0] = decimal_digit_pairs[pair + 0];
+    ptr[1] = decimal_digit_pairs[pair + 1];
+  }
+  if(u64 >= 10)
+  {
+    ptr -= 2;
+    ptr[0] = decimal_digit_pairs[u64 * 2 + 0];
+    ptr[1] = decimal_digit_pairs[u64 * 2 + 1];
+  }
+  else
+  {
+    ptr -= 1;
+    ptr[0] = (U8)('0' + u64);
+  }
+  return digit_count;
+}
+
 internal String8
 str8_from_f64(Arena *arena, F64 value, U32 precision)
 {
@@ -728,6 +781,63 @@ str8_from_f64(Arena *arena, F64 value, U32 precision)
   return str8_list_join(arena, &list, 0);
 }
 
+internal U64
+f64_write_shortest(U8 *buffer, F64 value)
+{
+  // tec: whole numbers below 2^53 are exact as integers and by far the most common, skip printf for them
+  F64 magnitude = value < 0 ? -value : value;
+  if(magnitude < 9007199254740992.0 && (F64)(S64)value == value && !(value == 0 && signbit(value)))
+  {
+    U64 size = 0;
+    if(value < 0)
+    {
+      buffer[size++] = '-';
+    }
+    size += u64_write_decimal(buffer + size, (U64)magnitude);
+    return size;
+  }
+  
+  // tec: 17 significant digits always round trip a double, most values need fewer
+  int size = 0;
+  for(int precision = 15; precision <= 17; precision += 1)
+  {
+    size = snprintf((char *)buffer, F64_WRITE_SHORTEST_MAX, "%.*g", precision, value);
+    if(precision == 17 || strtod((char *)buffer, 0) == value)
+    {
+      break;
+    }
+  }
+  return (U64)ClampBot(size, 0);
+}
+
+internal U64
+f32_write_shortest(U8 *buffer, F32 value)
+{
+  F32 magnitude = value < 0 ? -value : value;
+  if(magnitude < 16777216.f && (F32)(S32)value == value && !(value == 0 && signbit(value)))
+  {
+    U64 size = 0;
+    if(value < 0)
+    {
+      buffer[size++] = '-';
+    }
+    size += u64_write_decimal(buffer + size, (U64)magnitude);
+    return size;
+  }
+  
+  // tec: same search for floats, 9 significant digits always round trip
+  int size = 0;
+  for(int precision = 6; precision <= 9; precision += 1)
+  {
+    size = snprintf((char *)buffer, F64_WRITE_SHORTEST_MAX, "%.*g", precision, (F64)value);
+    if(precision == 9 || strtof((char *)buffer, 0) == value)
+    {
+      break;
+    }
+  }
+  return (U64)ClampBot(size, 0);
+}
+
 ////////////////////////////////
 //~ tec: String <=> Float Conversions
 
@@ -1818,7 +1928,7 @@ escaped_from_raw_str8(Arena *arena, String8 string)
   scratch_end(scratch);
   return result;
 }
-
+  
 internal String8
 raw_from_escaped_str8(Arena *arena, String8 string)
 {
@@ -1866,10 +1976,10 @@ raw_from_escaped_str8(Arena *arena, String8 string)
   scratch_end(scratch);
   return result;
 }
-
+  
 ////////////////////////////////
 //~ tec: Text Wrapping
-
+  
 internal String8List
 wrapped_lines_from_string(Arena *arena, String8 string, U64 first_line_max_width, U64 max_width, U64 wrap_indent)
 {
@@ -1924,17 +2034,17 @@ wrapped_lines_from_string(Arena *arena, String8 string, U64 first_line_max_width
   }
   return list;
 }
-
+  
 ////////////////////////////////
 //~ tec: String <-> Color
-
+  
 internal String8
 hex_string_from_rgba_4f32(Arena *arena, Vec4F32 rgba)
 {
   String8 hex_string = push_str8f(arena, "%02x%02x%02x%02x", (U8)(rgba.x*255.f), (U8)(rgba.y*255.f), (U8)(rgba.z*255.f), (U8)(rgba.w*255.f));
   return hex_string;
 }
-
+  
 internal Vec4F32
 rgba_from_hex_string_4f32(String8 hex_string)
 {
@@ -1956,10 +2066,10 @@ rgba_from_hex_string_4f32(String8 hex_string)
   Vec4F32 rgba = v4f32(byte_vals[0]/255.f, byte_vals[1]/255.f, byte_vals[2]/255.f, byte_vals[3]/255.f);
   return rgba;
 }
-
+  
 ////////////////////////////////
 //~ tec: String Fuzzy Matching
-
+  
 internal FuzzyMatchRangeList
 fuzzy_match_find(Arena *arena, String8 needle, String8 haystack)
 {
@@ -2001,7 +2111,7 @@ fuzzy_match_find(Arena *arena, String8 needle, String8 haystack)
   scratch_end(scratch);
   return result;
 }
-
+  
 internal FuzzyMatchRangeList
 fuzzy_match_range_list_copy(Arena *arena, FuzzyMatchRangeList *src)
 {
@@ -2017,10 +2127,10 @@ fuzzy_match_range_list_copy(Arena *arena, FuzzyMatchRangeList *src)
   dst.total_dim = src->total_dim;
   return dst;
 }
-
+  
 ////////////////////////////////
 //~ tec: Serialization Helpers
-
+  
 internal void
 str8_serial_begin(Arena *arena, String8List *srl){
   String8Node *node = push_array(arena, String8Node, 1);
@@ -2029,7 +2139,7 @@ str8_serial_begin(Arena *arena, String8List *srl){
   srl->node_count = 1;
   srl->total_size = 0;
 }
-
+  
 internal String8
 str8_serial_end(Arena *arena, String8List *srl){
   U64 size = srl->total_size;
@@ -2038,7 +2148,7 @@ str8_serial_end(Arena *arena, String8List *srl){
   String8 result = str8(out, size);
   return result;
 }
-
+  
 internal void
 str8_serial_write_to_dst(String8List *srl, void *out){
   U8 *ptr = (U8*)out;
@@ -2050,19 +2160,19 @@ str8_serial_write_to_dst(String8List *srl, void *out){
     ptr += size;
   }
 }
-
+  
 internal U64
 str8_serial_push_align(Arena *arena, String8List *srl, U64 align){
   Assert(IsPow2(align));
-  
+    
   U64 pos = srl->total_size;
   U64 new_pos = AlignPow2(pos, align);
   U64 size = (new_pos - pos);
-  
+    
   if(size != 0)
   {
     U8 *buf = push_array(arena, U8, size);
-    
+      
     String8 *str = &srl->last->string;
     if (str->str + str->size == buf){
       srl->last->string.size += size;
@@ -2074,7 +2184,7 @@ str8_serial_push_align(Arena *arena, String8List *srl, U64 align){
   }
   return size;
 }
-
+  
 internal void *
 str8_serial_push_size(Arena *arena, String8List *srl, U64 size)
 {
@@ -2094,7 +2204,7 @@ str8_serial_push_size(Arena *arena, String8List *srl, U64 size)
   }
   return result;
 }
-
+  
 internal void *
 str8_serial_push_data(Arena *arena, String8List *srl, void *data, U64 size){
   void *result = str8_serial_push_size(arena, srl, size);
@@ -2104,7 +2214,7 @@ str8_serial_push_data(Arena *arena, String8List *srl, void *data, U64 size){
   }
   return result;
 }
-
+  
 internal void
 str8_serial_push_data_list(Arena *arena, String8List *srl, String8Node *first){
   for (String8Node *node = first;
@@ -2113,7 +2223,7 @@ str8_serial_push_data_list(Arena *arena, String8List *srl, String8Node *first){
     str8_serial_push_data(arena, srl, node->string.str, node->string.size);
   }
 }
-
+  
 internal void
 str8_serial_push_u64(Arena *arena, String8List *srl, U64 x){
   U8 *buf = push_array_no_zero(arena, U8, 8);
@@ -2127,7 +2237,7 @@ str8_serial_push_u64(Arena *arena, String8List *srl, U64 x){
     str8_list_push(arena, srl, str8(buf, 8));
   }
 }
-
+  
 internal void
 str8_serial_push_u32(Arena *arena, String8List *srl, U32 x){
   U8 *buf = push_array_no_zero(arena, U8, 4);
@@ -2141,31 +2251,31 @@ str8_serial_push_u32(Arena *arena, String8List *srl, U32 x){
     str8_list_push(arena, srl, str8(buf, 4));
   }
 }
-
+  
 internal void
 str8_serial_push_u16(Arena *arena, String8List *srl, U16 x){
   str8_serial_push_data(arena, srl, &x, sizeof(x));
 }
-
+  
 internal void
 str8_serial_push_u8(Arena *arena, String8List *srl, U8 x){
   str8_serial_push_data(arena, srl, &x, sizeof(x));
 }
-
+  
 internal void
 str8_serial_push_cstr(Arena *arena, String8List *srl, String8 str){
   str8_serial_push_data(arena, srl, str.str, str.size);
   str8_serial_push_u8(arena, srl, 0);
 }
-
+  
 internal void
 str8_serial_push_string(Arena *arena, String8List *srl, String8 str){
   str8_serial_push_data(arena, srl, str.str, str.size);
 }
-
+  
 ////////////////////////////////
 //~ tec: Deserialization Helpers
-
+  
 internal U64
 str8_deserial_read(String8 string, U64 off, void *read_dst, U64 read_size, U64 granularity)
 {
@@ -2178,7 +2288,7 @@ str8_deserial_read(String8 string, U64 off, void *read_dst, U64 read_size, U64 g
   }
   return legally_readable_size;
 }
-
+  
 internal U64
 str8_deserial_find_first_match(String8 string, U64 off, U16 scan_val)
 {
@@ -2193,7 +2303,7 @@ str8_deserial_find_first_match(String8 string, U64 off, U16 scan_val)
   }
   return cursor;
 }
-
+  
 internal void *
 str8_deserial_get_raw_ptr(String8 string, U64 off, U64 size)
 {
@@ -2203,7 +2313,7 @@ str8_deserial_get_raw_ptr(String8 string, U64 off, U64 size)
   }
   return raw_ptr;
 }
-
+  
 internal U64
 str8_deserial_read_cstr(String8 string, U64 off, String8 *cstr_out)
 {
@@ -2216,7 +2326,7 @@ str8_deserial_read_cstr(String8 string, U64 off, String8 *cstr_out)
   }
   return cstr_size;
 }
-
+  
 internal U64
 str8_deserial_read_windows_utf16_string16(String8 string, U64 off, String16 *str_out)
 {
@@ -2225,11 +2335,11 @@ str8_deserial_read_windows_utf16_string16(String8 string, U64 off, String16 *str
   U16 *str = (U16 *)str8_deserial_get_raw_ptr(string, off, size);
   U64 count = size / sizeof(*str);
   *str_out = str16(str, count);
-  
+    
   U64 read_size_with_null = size + sizeof(*str);
   return read_size_with_null;
 }
-
+  
 internal U64
 str8_deserial_read_block(String8 string, U64 off, U64 size, String8 *block_out)
 {
@@ -242,6 +242,10 @@ internal String8 str8_from_memory_size(Arena *arena, U64 z);
 internal String8 str8_from_u64(Arena *arena, U64 u64, U32 radix, U8 min_digits, U8 digit_group_separator);
 internal String8 str8_from_s64(Arena *arena, S64 s64, U32 radix, U8 min_digits, U8 digit_group_separator);
 
+//- tec: integer -> buffer, base 10 without separators. buffers need room for 20 digits
+internal U64 u64_decimal_digit_count(U64 u64);
+internal U64 u64_write_decimal(U8 *buffer, U64 u64);
+
 ////////////////////////////////
 //~ tec: String <=> Float Conversions
 
@@ -249,6 +253,11 @@ internal F64 f64_from_str8(String8 string);
 
 internal String8 str8_from_f64(Arena *arena, F64 value, U32 precision);
 
+//- tec: float -> buffer, the fewest digits that parse back to the same value. buffers need 32 bytes
+#define F64_WRITE_SHORTEST_MAX 32
+internal U64 f64_write_shortest(U8 *buffer, F64 value);
+internal U64 f32_write_shortest(U8 *buffer, F32 value);
+
 ////////////////////////////////
 //~ tec: String List Construction Functions
 
@@ -20,6 +20,9 @@ tctx_init_and_equip(TCTX *tctx){
 internal void
 tctx_release(void)
 {
+#if PROFILE_CUSTOM
+  prof_thread_release();
+#endif
   for(U64 i = 0; i < ArrayCount(tctx_thread_local->arenas); i += 1)
   {
     arena_release(tctx_thread_local->arenas[i]);
@@ -0,0 +1,506 @@
+#define BUILD_ENTRY_DEFINING_UNIT 1
+#define BUILD_CONSOLE_INTERFACE 1
+#define PROFILE_CUSTOM 0
+#define ARENA_FREE_LIST 1
+
+#define FORCE_KERNEL_COMPILATION 0
+#define PRINT_SELECT_OUTPUT 0
+#define GPU_MAX_BUFFER_SIZE GB(1)
+
+#include "base/base_inc.h"
+#include "os/os_inc.h"
+#include "thread_pool/thread_pool.h"
+#include "gdb/gdb_inc.h"
+#include "ir_gen/ir_gen_inc.h"
+#include "gpu/gpu_inc.h"
+#include "application.h"
+
+#include "base/base_inc.c"
+#include "os/os_inc.c"
+#include "thread_pool/thread_pool.c"
+#include "gpu/gpu_inc.c"
+#include "ir_gen/ir_gen_inc.c"
+#include "gdb/gdb_inc.c"
+#include "application.c"
+
+//~ tec: gdb_bench, runs a fixed suite in process against a generated dataset.
+// usage: gdb_bench [-rows N] [-warmup N] [-reps N] [-filter name] [-out results.json]
+//                  [-baseline baseline.json] [-tolerance percent]
+// a missing baseline file is written from this run, an existing one fails the run when any
+// benchmark's p50 is slower than the baseline by more than the tolerance
+
+#ifndef BENCH_DEFAULT_ROWS
+#define BENCH_DEFAULT_ROWS 1000000
+#endif
+#ifndef BENCH_DEFAULT_WARMUP
+#define BENCH_DEFAULT_WARMUP 2
+#endif
+#ifndef BENCH_DEFAULT_REPETITIONS
+#define BENCH_DEFAULT_REPETITIONS 10
+#endif
+#ifndef BENCH_DEFAULT_TOLERANCE_PERCENT
+#define BENCH_DEFAULT_TOLERANCE_PERCENT 10
+#endif
+
+#define BENCH_DATA_DIR     "gdb_data/bench"
+#define BENCH_SAVE_DIR     "gdb_data/bench_save"
+#define BENCH_TABLE_NAME   "data"
+
+typedef struct BENCH_Context BENCH_Context;
+struct BENCH_Context
+{
+  Arena* arena;
+  U64 row_count;
+  String8 csv_path;
+  
+  // tec: queries run against this database, imports land in import_database and are not catalogued
+  GDB_Database* database;
+  GDB_Database* import_database;
+  GDB_Table* imported_table;
+  GDB_Table* loaded_table;
+  GDB_Table* appended_table;
+  
+  APP_QueryContext query_context;
+};
+
+typedef struct BENCH_Case BENCH_Case;
+typedef U64 BENCH_RunFunction(BENCH_Context* context, BENCH_Case* bench_case);
+struct BENCH_Case
+{
+  char* name;
+  BENCH_RunFunction* run;
+  char* query;
+};
+
+typedef struct BENCH_Result BENCH_Result;
+struct BENCH_Result
+{
+  String8 name;
+  U64 sample_count;
+  U64* samples_us;
+  U64 rows;
+  F64 p50_us;
+  F64 p99_us;
+  F64 mean_us;
+  F64 rows_per_second;
+  
+  B32 has_baseline;
+  F64 baseline_p50_us;
+  B32 regressed;
+};
+
+//- tec: dataset, the shape of the deterministic case in testing/gen_tests.py
+internal B32
+bench_write_dataset(Arena* arena, String8 path, U64 row_count)
+{
+  OS_Handle file = os_file_open(OS_AccessFlag_Write, path);
+  if (os_handle_match(os_handle_zero(), file))
+  {
+    log_error("failed to create dataset %.*s", str8_varg(path));
+    return 0;
+  }
+  
+  U64 file_pos = 0;
+  Temp temp = temp_begin(arena);
+  String8List lines = { 0 };
+  str8_list_push(temp.arena, &lines, str8_lit("col_0,col_1,col_2\n"));
+  for (U64 i = 0; i < row_count; i++)
+  {
+    str8_list_pushf(temp.arena, &lines, "%llu,%llu.0,str%llu_2\n", i, i % 10000, i);
+    
+    // tec: written in batches so the dataset never has to fit in memory
+    if (lines.node_count >= 65536 || i + 1 == row_count)
+    {
+      String8 batch = str8_list_join(temp.arena, &lines, 0);
+      os_file_write(file, r1u64(file_pos, file_pos + batch.size), batch.str);
+      file_pos += batch.size;
+      temp_end(temp);
+      MemoryZeroStruct(&lines);
+    }
+  }
+  os_file_close(file);
+  return 1;
+}
+
+// tec: removes every file below path, folders are left empty
+internal void
+bench_clear_directory(String8 path)
+{
+  Temp scratch = scratch_begin(0, 0);
+  OS_FileIter* it = os_file_iter_begin(scratch.arena, path, 0);
+  for (OS_FileInfo info = { 0 }; os_file_iter_next(scratch.arena, it, &info);)
+  {
+    String8 child = push_str8f(scratch.arena, "%.*s/%.*s", str8_varg(path), str8_varg(info.name));
+    if (info.props.flags & FilePropertyFlag_IsFolder)
+    {
+      bench_clear_directory(child);
+    }
+    else
+    {
+      os_delete_file_at_path(child);
+    }
+  }
+  os_file_iter_end(it);
+  scratch_end(scratch);
+}
+
+//- tec: cases, each returns the rows it processed
+internal U64
+bench_run_import(BENCH_Context* context, BENCH_Case* bench_case)
+{
+  if (context->imported_table)
+  {
+    gdb_table_release(context->imported_table);
+  }
+  context->imported_table = gdb_table_import_csv_streaming(context->import_database, str8_lit(BENCH_TABLE_NAME), context->csv_path);
+  return context->imported_table ? gdb_table_row_count(context->imported_table) : 0;
+}
+
+// tec: the dataset's rows built in memory and handed over as structs, what an embedding program does
+// instead of printing them to a CSV or to INSERT statements
+typedef struct BENCH_AppendRow BENCH_AppendRow;
+struct BENCH_AppendRow
+{
+  U64 col_0;
+  F64 col_1;
+  String8 col_2;
+};
+
+internal U64
+bench_run_append(BENCH_Context* context, BENCH_Case* bench_case)
+{
+  if (context->appended_table)
+  {
+    gdb_table_release(context->appended_table);
+  }
+  // tec: not catalogued like the imported table, the database only names the folder its columns go to on disk
+  GDB_Table* table = gdb_table_alloc(str8_lit(BENCH_TABLE_NAME "_append"));
+  table->parent_database = context->import_database;
+  gdb_table_add_column(table, gdb_column_schema_create(str8_lit("col_0"), GDB_ColumnType_U64));
+  gdb_table_add_column(table, gdb_column_schema_create(str8_lit("col_1"), GDB_ColumnType_F64));
+  gdb_table_add_column(table, gdb_column_schema_create(str8_lit("col_2"), GDB_ColumnType_String8));
+  context->appended_table = table;
+  
+  U64 field_offsets[] =
+  {
+    GDB_AppenderField(BENCH_AppendRow, col_0),
+    GDB_AppenderField(BENCH_AppendRow, col_1),
+    GDB_AppenderField(BENCH_AppendRow, col_2),
+  };
+  
+  GDB_Appender* appender = gdb_appender_open(table);
+  if (appender == NULL)
+  {
+    return 0;
+  }
+  
+  Temp temp = temp_begin(context->arena);
+  BENCH_AppendRow* rows = push_array(temp.arena, BENCH_AppendRow, GDB_APPENDER_BATCH_ROWS);
+  for (U64 first = 0; first < context->row_count; first += GDB_APPENDER_BATCH_ROWS)
+  {
+    U64 count = Min(context->row_count - first, GDB_APPENDER_BATCH_ROWS);
+    Temp strings = temp_begin(temp.arena);
+    for (U64 i = 0; i < count; i++)
+    {
+      rows[i].col_0 = first + i;
+      rows[i].col_1 = (F64)((first + i) % 10000);
+      rows[i].col_2 = push_str8f(strings.arena, "str%llu_2", first + i);
+    }
+    gdb_appender_append_structs(appender, rows, sizeof(BENCH_AppendRow), field_offsets, count);
+    temp_end(strings);
+  }
+  gdb_appender_close(appender);
+  temp_end(temp);
+  
+  return gdb_table_row_count(table);
+}
+
+internal U64
+bench_run_query(BENCH_Context* context, BENCH_Case* bench_case)
+{
+  // tec: rows are encoded as they would be for a client, then dropped
+  Temp temp = temp_begin(context->arena);
+  context->query_context.output_arena = temp.arena;
+  MemoryZeroStruct(&context->query_context.output);
+  app_execute_query(str8_cstring(bench_case->query), &context->query_context);
+  temp_end(temp);
+  return context->row_count;
+}
+
+internal U64
+bench_run_save(BENCH_Context* context, BENCH_Case* bench_case)
+{
+  // tec: every column is rewritten, not only the ones changed since the last save
+  GDB_Table* table = context->imported_table;
+  for (U64 i = 0; i < table->column_count; i++)
+  {
+    gdb_column_mark_dirty(table->columns[i]);
+  }
+  gdb_table_mark_dirty(table);
+  gdb_table_save(table, str8_lit(BENCH_SAVE_DIR "/" BENCH_TABLE_NAME));
+  return gdb_table_row_count(table);
+}
+
+internal U64
+bench_run_load(BENCH_Context* context, BENCH_Case* bench_case)
+{
+  if (context->loaded_table)
+  {
+    gdb_table_release(context->loaded_table);
+  }
+  context->loaded_table = gdb_table_load(str8_lit(BENCH_SAVE_DIR "/" BENCH_TABLE_NAME),
+                                         str8_lit(BENCH_SAVE_DIR "/" BENCH_TABLE_NAME "/" BENCH_TABLE_NAME ".meta"));
+  return context->loaded_table ? gdb_table_row_count(context->loaded_table) : 0;
+}
+
+// tec: save runs before load so load always has files to read. the sql layer has no aggregates yet,
+// scan_all_rows stands in as the full table pass
+global BENCH_Case g_bench_cases[] =
+{
+  { "import",          bench_run_import, 0 },
+  { "append",          bench_run_append, 0 },
+  { "point_filter",    bench_run_query,  "SELECT * FROM " BENCH_TABLE_NAME " WHERE col_0 == 500007;" },
+  { "range_filter",    bench_run_query,  "SELECT * FROM " BENCH_TABLE_NAME " WHERE ((1000 < col_1) AND (col_1 < 1100));" },
+  { "string_equals",   bench_run_query,  "SELECT * FROM " BENCH_TABLE_NAME " WHERE col_2 == 'str500007_2';" },
+  { "string_contains", bench_run_query,  "SELECT * FROM " BENCH_TABLE_NAME " WHERE col_2 CONTAINS '12345';" },
+  { "scan_all_rows",   bench_run_query,  "SELECT col_0 FROM " BENCH_TABLE_NAME " WHERE col_0 >= 0;" },
+  { "save",            bench_run_save,   0 },
+  { "load",            bench_run_load,   0 },
+};
+
+//- tec: statistics
+internal F64
+bench_percentile(U64* sorted, U64 count, F64 percentile)
+{
+  // tec: nearest rank
+  U64 rank = (U64)ceil_f64(percentile * count);
+  U64 index = rank > 0 ? rank - 1 : 0;
+  return (F64)sorted[Min(index, count - 1)];
+}
+
+internal BENCH_Result
+bench_measure(BENCH_Context* context, BENCH_Case* bench_case, U64 warmup, U64 repetitions)
+{
+  BENCH_Result result = { 0 };
+  result.name = str8_cstring(bench_case->name);
+  result.sample_count = repetitions;
+  result.samples_us = push_array(context->arena, U64, repetitions);
+  
+  for (U64 i = 0; i < warmup; i++)
+  {
+    bench_case->run(context, bench_case);
+  }
+  
+  U64 total_us = 0;
+  for (U64 i = 0; i < repetitions; i++)
+  {
+    U64 start_us = os_now_microseconds();
+    result.rows = bench_case->run(context, bench_case);
+    result.samples_us[i] = os_now_microseconds() - start_us;
+    total_us += result.samples_us[i];
+  }
+  
+  // tec: insertion sort, repetitions are few
+  U64* sorted = push_array(context->arena, U64, repetitions);
+  for (U64 i = 0; i < repetitions; i++)
+  {
+    U64 j = i;
+    for (; j > 0 && sorted[j - 1] > result.samples_us[i]; j--)
+    {
+      sorted[j] = sorted[j - 1];
+    }
+    sorted[j] = result.samples_us[i];
+  }
+  
+  result.p50_us = bench_percentile(sorted, repetitions, 0.50);
+  result.p99_us = bench_percentile(sorted, repetitions, 0.99);
+  result.mean_us = (F64)total_us / (F64)repetitions;
+  result.rows_per_second = result.p50_us > 0 ? (F64)result.rows * 1000000.0 / result.p50_us : 0;
+  return result;
+}
+
+//- tec: baseline, a results file from an earlier run
+internal B32
+bench_baseline_p50(String8 baseline, String8 name, F64* out_p50_us)
+{
+  Temp scratch = scratch_begin(0, 0);
+  String8 name_key = push_str8f(scratch.arena, "\"name\": \"%.*s\"", str8_varg(name));
+  String8 p50_key = str8_lit("\"p50_us\": ");
+  
+  B32 found = 0;
+  U64 name_pos = str8_find_needle(baseline, 0, name_key, 0);
+  U64 p50_pos = str8_find_needle(baseline, name_pos, p50_key, 0);
+  if (name_pos < baseline.size && p50_pos < baseline.size)
+  {
+    String8 rest = str8_skip(baseline, p50_pos + p50_key.size);
+    U64 size = 0;
+    while (size < rest.size && (char_is_digit(rest.str[size], 10) || rest.str[size] == '.'))
+    {
+      size++;
+    }
+    *out_p50_us = f64_from_str8(str8_prefix(rest, size));
+    found = (size > 0);
+  }
+  
+  scratch_end(scratch);
+  return found;
+}
+
+internal String8List
+bench_results_to_json(Arena* arena, BENCH_Context* context, BENCH_Result* results, U64 result_count, U64 warmup, U64 repetitions)
+{
+  String8List json = { 0 };
+  str8_list_pushf(arena, &json, "{\n  \"device\": \"%.*s\",\n  \"rows\": %llu,\n  \"warmup\": %llu,\n  \"repetitions\": %llu,\n  \"benchmarks\": [\n",
+                  str8_varg(gpu_get_device_id_string(arena)), context->row_count, warmup, repetitions);
+  for (U64 i = 0; i < result_count; i++)
+  {
+    BENCH_Result* r = &results[i];
+    str8_list_pushf(arena, &json, "    { \"name\": \"%.*s\", \"p50_us\": %.1f, \"p99_us\": %.1f, \"mean_us\": %.1f, \"rows\": %llu, \"rows_per_second\": %.1f",
+                    str8_varg(r->name), r->p50_us, r->p99_us, r->mean_us, r->rows, r->rows_per_second);
+    if (r->has_baseline)
+    {
+      str8_list_pushf(arena, &json, ", \"baseline_p50_us\": %.1f, \"regressed\": %s", r->baseline_p50_us, r->regressed ? "true" : "false");
+    }
+    str8_list_pushf(arena, &json, " }%s\n", (i + 1 < result_count) ? "," : "");
+  }
+  str8_list_push(arena, &json, str8_lit("  ]\n}\n"));
+  return json;
+}
+
+internal void
+entry_point(CmdLine* cmdline)
+{
+  log_alloc();
+  
+  if (!os_file_path_exists(str8_lit("gdb_data/")))
+  {
+    os_make_directory(str8_lit("gdb_data/"));
+  }
+  if (!os_file_path_exists(str8_lit("kernel_cache/")))
+  {
+    os_make_directory(str8_lit("kernel_cache/"));
+  }
+  
+  gdb_init();
+  gpu_init();
+  app_init();
+  
+  Arena* arena = arena_alloc();
+  
+  //- tec: options
+  String8 rows_str = cmd_line_string(cmdline, str8_lit("rows"));
+  String8 warmup_str = cmd_line_string(cmdline, str8_lit("warmup"));
+  String8 reps_str = cmd_line_string(cmdline, str8_lit("reps"));
+  String8 tolerance_str = cmd_line_string(cmdline, str8_lit("tolerance"));
+  String8 filter = cmd_line_string(cmdline, str8_lit("filter"));
+  String8 out_path = cmd_line_string(cmdline, str8_lit("out"));
+  String8 baseline_path = cmd_line_string(cmdline, str8_lit("baseline"));
+  
+  U64 warmup = warmup_str.size ? u64_from_str8(warmup_str, 10) : BENCH_DEFAULT_WARMUP;
+  U64 repetitions = Max(1, reps_str.size ? u64_from_str8(reps_str, 10) : BENCH_DEFAULT_REPETITIONS);
+  F64 tolerance_percent = tolerance_str.size ? f64_from_str8(tolerance_str) : BENCH_DEFAULT_TOLERANCE_PERCENT;
+  out_path = out_path.size ? out_path : str8_lit("bench_results.json");
+  
+  BENCH_Context context = { 0 };
+  context.arena = arena;
+  context.row_count = rows_str.size ? u64_from_str8(rows_str, 10) : BENCH_DEFAULT_ROWS;
+  context.csv_path = push_str8f(arena, "gdb_data/bench_%llu.csv", context.row_count);
+  
+  //- tec: dataset and database are rebuilt every run so numbers never depend on an earlier run's files
+  if (!os_file_path_exists(context.csv_path))
+  {
+    log_info("generating %llu rows into %.*s", context.row_count, str8_varg(context.csv_path));
+    if (!bench_write_dataset(arena, context.csv_path, context.row_count))
+    {
+      os_abort(1);
+    }
+  }
+  String8 bench_dirs[] = { str8_lit(BENCH_DATA_DIR), str8_lit(BENCH_SAVE_DIR), str8_lit(BENCH_SAVE_DIR "/" BENCH_TABLE_NAME) };
+  for (U64 i = 0; i < ArrayCount(bench_dirs); i++)
+  {
+    if (os_file_path_exists(bench_dirs[i]))
+    {
+      bench_clear_directory(bench_dirs[i]);
+    }
+    else
+    {
+      os_make_directory(bench_dirs[i]);
+    }
+  }
+  
+  String8 setup_query = push_str8f(arena, "CREATE DATABASE bench; IMPORT INTO " BENCH_TABLE_NAME " FROM '%.*s';", str8_varg(context.csv_path));
+  app_execute_query(setup_query, &context.query_context);
+  context.database = context.query_context.database;
+  context.import_database = gdb_database_alloc(str8_lit("bench_import"));
+  if (context.database == NULL || gdb_database_find_table(context.database, str8_lit(BENCH_TABLE_NAME)) == NULL)
+  {
+    log_error("failed to set up the bench database");
+    os_abort(1);
+  }
+  
+  //- tec: run
+  BENCH_Result* results = push_array(arena, BENCH_Result, ArrayCount(g_bench_cases));
+  U64 result_count = 0;
+  for (U64 i = 0; i < ArrayCount(g_bench_cases); i++)
+  {
+    BENCH_Case* bench_case = &g_bench_cases[i];
+    String8 name = str8_cstring(bench_case->name);
+    
+    // tec: save and load need the table import leaves behind
+    B32 needs_import = (bench_case->run == bench_run_save || bench_case->run == bench_run_load);
+    if (filter.size && str8_find_needle(name, 0, filter, StringMatchFlag_CaseInsensitive) == name.size)
+    {
+      continue;
+    }
+    if (needs_import && context.imported_table == NULL)
+    {
+      bench_run_import(&context, bench_case);
+    }
+    if (bench_case->run == bench_run_load && !os_file_path_exists(str8_lit(BENCH_SAVE_DIR "/" BENCH_TABLE_NAME "/" BENCH_TABLE_NAME ".meta")))
+    {
+      bench_run_save(&context, bench_case);
+    }
+    
+    results[result_count] = bench_measure(&context, bench_case, warmup, repetitions);
+    BENCH_Result* r = &results[result_count++];
+    printf("%-16.*s p50 %12.1f us  p99 %12.1f us  %14.1f rows/s\n", str8_varg(r->name), r->p50_us, r->p99_us, r->rows_per_second);
+  }
+  
+  //- tec: compare against the baseline, or make this run the baseline
+  B32 any_regressed = 0;
+  if (baseline_path.size)
+  {
+    String8 baseline = os_data_from_file_path(arena, baseline_path);
+    if (baseline.size == 0)
+    {
+      log_info("no baseline at %.*s, this run becomes the baseline", str8_varg(baseline_path));
+    }
+    for (U64 i = 0; i < result_count && baseline.size; i++)
+    {
+      BENCH_Result* r = &results[i];
+      r->has_baseline = bench_baseline_p50(baseline, r->name, &r->baseline_p50_us);
+      r->regressed = r->has_baseline && r->p50_us > r->baseline_p50_us * (1.0 + tolerance_percent / 100.0);
+      if (r->regressed)
+      {
+        log_error("REGRESSION %.*s: p50 %.1f us, baseline %.1f us (+%.1f%%, tolerance %.1f%%)",
+                  str8_varg(r->name), r->p50_us, r->baseline_p50_us,
+                  (r->p50_us / r->baseline_p50_us - 1.0) * 100.0, tolerance_percent);
+        printf("REGRESSION %.*s: p50 %.1f us, baseline %.1f us\n", str8_varg(r->name), r->p50_us, r->baseline_p50_us);
+        any_regressed = 1;
+      }
+    }
+    if (baseline.size == 0)
+    {
+      os_write_data_list_to_file_path(baseline_path, bench_results_to_json(arena, &context, results, result_count, warmup, repetitions));
+    }
+  }
+  
+  os_write_data_list_to_file_path(out_path, bench_results_to_json(arena, &context, results, result_count, warmup, repetitions));
+  log_info("results written to %.*s", str8_varg(out_path));
+  
+  log_release();
+  if (any_regressed)
+  {
+    os_abort(1);
+  }
+}
@@ -9,6 +9,13 @@ gdb_init(void)
   
   g_gdb_state->databases = NULL;
   g_gdb_state->rw_mutex = os_rw_mutex_alloc();
+  g_gdb_state->load_mutex = os_mutex_alloc();
+  g_gdb_state->flush_mutex = os_mutex_alloc();
+  
+  // tec: workers used for flushing columns in parallel
+  U32 worker_count = Max(1, os_get_system_info()->logical_processor_count);
+  g_gdb_state->thread_pool = tp_alloc(arena, worker_count, worker_count, str8_zero());
+  g_gdb_state->thread_pool_arena = tp_arena_alloc(g_gdb_state->thread_pool);
   
   ProfEnd();
 }
@@ -16,7 +23,11 @@ gdb_init(void)
 internal void
 gdb_release(void)
 {
-  os_mutex_release(g_gdb_state->rw_mutex);
+  tp_arena_release(&g_gdb_state->thread_pool_arena);
+  tp_release(g_gdb_state->thread_pool);
+  os_mutex_release(g_gdb_state->flush_mutex);
+  os_mutex_release(g_gdb_state->load_mutex);
+  os_rw_mutex_release(g_gdb_state->rw_mutex);
   arena_release(g_gdb_state->arena);
 }
 
@@ -24,6 +35,7 @@ internal void
 gdb_add_database(GDB_Database* database)
 {
   ProfBeginFunction();
+  os_rw_mutex_take_w(g_gdb_state->rw_mutex);
   
   if (g_gdb_state->database_count == 0)
   {
@@ -40,7 +52,51 @@ gdb_add_database(GDB_Database* database)
   }
   
   g_gdb_state->databases[g_gdb_state->database_count++] = database;
+  
+  os_rw_mutex_drop_w(g_gdb_state->rw_mutex);
+  ProfEnd();
+}
+
+internal GDB_Database*
+gdb_find_database(String8 name)
+{
+  GDB_Database* result = NULL;
+  OS_MutexScopeR(g_gdb_state->rw_mutex)
+  {
+    for (U64 i = 0; i < g_gdb_state->database_count; i++)
+    {
+      if (str8_match(g_gdb_state->databases[i]->name, name, 0))
+      {
+        result = g_gdb_state->databases[i];
+        break;
+      }
+    }
+  }
+  return result;
+}
+
+internal GDB_Database*
+gdb_find_or_load_database(String8 name, String8 directory)
+{
+  ProfBeginFunction();
+  
+  GDB_Database* database = gdb_find_database(name);
+  if (database == NULL)
+  {
+    // tec: checked again under the lock, another query may have loaded it while this one waited
+    OS_MutexScope(g_gdb_state->load_mutex)
+    {
+      database = gdb_find_database(name);
+      if (database == NULL)
+      {
+        database = gdb_database_load(directory);
+        gdb_add_database(database);
+      }
+    }
+  }
+  
   ProfEnd();
+  return database;
 }
 
 //~ tec: database
@@ -65,6 +121,102 @@ gdb_database_release(GDB_Database* database)
 
 internal void
 gdb_database_add_table(GDB_Database* database, GDB_Table* table)
+{
+  os_rw_mutex_take_w(g_gdb_state->rw_mutex);
+  gdb_database_push_table(database, table);
+  os_rw_mutex_drop_w(g_gdb_state->rw_mutex);
+}
+
+// tec: find or create for statements that build a table before adding it. returns the table when it exists,
+// otherwise the name is reserved for the caller, who builds the table and hands it to
+// gdb_database_add_reserved_table. out_reserved is 0 when another statement holds the name
+internal GDB_Table*
+gdb_database_find_or_reserve_table(GDB_Database* database, String8 table_name, B32* out_reserved)
+{
+  GDB_Table* result = 0;
+  B32 reserved = 0;
+  os_rw_mutex_take_w(g_gdb_state->rw_mutex);
+  for (U64 i = 0; i < database->table_count && result == 0; i++)
+  {
+    if (str8_match(database->tables[i]->name, table_name, 0))
+    {
+      result = database->tables[i];
+    }
+  }
+  if (result == 0)
+  {
+    reserved = 1;
+    for (String8Node* node = database->reserved_table_names.first; node != NULL && reserved; node = node->next)
+    {
+      reserved = !str8_match(node->string, table_name, 0);
+    }
+  }
+  if (reserved)
+  {
+    String8Node* node = database->free_reserved_table_name;
+    if (node)
+    {
+      SLLStackPop(database->free_reserved_table_name);
+    }
+    else
+    {
+      node = push_array(database->arena, String8Node, 1);
+    }
+    node->next = 0;
+    node->string = table_name;
+    SLLQueuePush(database->reserved_table_names.first, database->reserved_table_names.last, node);
+    database->reserved_table_names.node_count++;
+  }
+  os_rw_mutex_drop_w(g_gdb_state->rw_mutex);
+  
+  *out_reserved = reserved;
+  return result;
+}
+
+// tec: ends a reservation, adding the table that was built under it
+internal void
+gdb_database_add_reserved_table(GDB_Database* database, String8 table_name, GDB_Table* table)
+{
+  os_rw_mutex_take_w(g_gdb_state->rw_mutex);
+  gdb_database_unreserve_table_name(database, table_name);
+  gdb_database_push_table(database, table);
+  os_rw_mutex_drop_w(g_gdb_state->rw_mutex);
+}
+
+// tec: ends a reservation whose table could not be built, the name is free for the next statement
+internal void
+gdb_database_drop_reserved_table(GDB_Database* database, String8 table_name)
+{
+  os_rw_mutex_take_w(g_gdb_state->rw_mutex);
+  gdb_database_unreserve_table_name(database, table_name);
+  os_rw_mutex_drop_w(g_gdb_state->rw_mutex);
+}
+
+// tec: the caller holds the state's rw mutex for writing
+internal void
+gdb_database_unreserve_table_name(GDB_Database* database, String8 table_name)
+{
+  String8List* names = &database->reserved_table_names;
+  for (String8Node** node = &names->first, *prev = 0; *node != NULL; prev = *node, node = &(*node)->next)
+  {
+    if (str8_match((*node)->string, table_name, 0))
+    {
+      String8Node* removed = *node;
+      *node = removed->next;
+      if (names->last == removed)
+      {
+        names->last = prev;
+      }
+      names->node_count--;
+      SLLStackPush(database->free_reserved_table_name, removed);
+      break;
+    }
+  }
+}
+
+// tec: the caller holds the state's rw mutex for writing
+internal void
+gdb_database_push_table(GDB_Database* database, GDB_Table* table)
 {
   if (database->table_count == 0)
   {
@@ -88,40 +240,80 @@ global String8 g_gdb_database_save_path = str8_lit_comp("gdb_data/");
 
 internal B32
 gdb_database_save(GDB_Database* database, String8 directory)
+{
+  ProfBeginFunction();
+  B32 result = gdb_database_flush(database, directory, 0);
+  ProfEnd();
+  return result;
+}
+
+internal B32
+gdb_database_flush(GDB_Database* database, String8 directory, B32 include_logged)
 {
   ProfBeginFunction();
   
   Temp scratch = scratch_begin(0, 0);
   
-  if (!os_make_directory(directory))
-  {
-    log_error("failed to create/open database directory: %s", directory.str);
-    return 0;
-  }
-  
+  // tec: only tables with unflushed changes are written, a read-only query touches nothing on disk.
+  // changes already in the write-ahead log wait for a checkpoint
+  os_rw_mutex_take_r(g_gdb_state->rw_mutex);
+  GDB_Table** dirty_tables = push_array(scratch.arena, GDB_Table*, database->table_count);
+  String8* dirty_table_dirs = push_array(scratch.arena, String8, database->table_count);
+  U64 dirty_table_count = 0;
   for (U64 i = 0; i < database->table_count; i++)
   {
     GDB_Table* table = database->tables[i];
-    String8 table_dir = push_str8f(scratch.arena, "%.*s/%.*s", str8_varg(directory), str8_varg(table->name));
     
-    if (!os_make_directory(table_dir))
+    // tec: taking the write lock waits out an insert that is logged but not applied yet
+    B32 needs_flush = 0;
+    OS_MutexScope(table->write_mutex)
     {
-      log_error("failed to create/open table directory: %.*s", str8_varg(table_dir));
-      ProfEnd();
-      return 0;
+      needs_flush = include_logged ? gdb_table_is_dirty(table) : gdb_table_has_unlogged_changes(table);
     }
-    
-    if (!gdb_table_save(table, table_dir))
+    if (needs_flush)
+    {
+      dirty_tables[dirty_table_count] = table;
+      dirty_table_dirs[dirty_table_count] = push_str8f(scratch.arena, "%.*s/%.*s", str8_varg(directory), str8_varg(table->name));
+      dirty_table_count++;
+    }
+  }
+  os_rw_mutex_drop_r(g_gdb_state->rw_mutex);
+  
+  if (dirty_table_count == 0)
+  {
+    scratch_end(scratch);
+    ProfEnd();
+    return 1;
+  }
+  
+  if (!os_make_directory(directory))
+  {
+    log_error("failed to create/open database directory: %.*s", str8_varg(directory));
+    scratch_end(scratch);
+    ProfEnd();
+    return 0;
+  }
+  
+  for (U64 i = 0; i < dirty_table_count; i++)
+  {
+    if (!os_make_directory(dirty_table_dirs[i]))
     {
-      log_error("failed to save table: %s", table->name.str);
+      log_error("failed to create/open table directory: %.*s", str8_varg(dirty_table_dirs[i]));
+      scratch_end(scratch);
       ProfEnd();
       return 0;
     }
   }
-  scratch_end(scratch);
   
+  B32 result = gdb_tables_flush(dirty_tables, dirty_table_dirs, dirty_table_count);
+  if (!result)
+  {
+    log_error("failed to save database: %.*s", str8_varg(database->name));
+  }
+  
+  scratch_end(scratch);
   ProfEnd();
-  return 1;
+  return result;
 }
 
 internal GDB_Database*
@@ -163,6 +355,10 @@ gdb_database_load(String8 directory_path)
     }
   }
   
+  // tec: bring the tables up to date with inserts that were logged but not checkpointed
+  database->wal = gdb_wal_open(database, directory_path);
+  gdb_wal_replay(database);
+  
   scratch_end(scratch);
   ProfEnd();
   return database;
@@ -178,36 +374,25 @@ internal GDB_Table*
 gdb_database_find_table(GDB_Database* database, String8 table_name)
 {
   ProfBeginFunction();
-  for (U64 i = 0; i < database->table_count; i++)
+  GDB_Table* result = NULL;
+  OS_MutexScopeR(g_gdb_state->rw_mutex)
   {
-    GDB_Table* table = database->tables[i];
-    if (str8_match(table->name, table_name, 0))
+    for (U64 i = 0; i < database->table_count; i++)
     {
-      ProfEnd();
-      return table;
+      GDB_Table* table = database->tables[i];
+      if (str8_match(table->name, table_name, 0))
+      {
+        result = table;
+        break;
+      }
     }
   }
-  log_error("failed to find table '%.*s' in database '%.*s'", str8_varg(table_name), str8_varg(database->name));
-  ProfEnd();
-  return NULL;
-}
-
-
-internal B32
-gdb_database_contains_table(GDB_Database* database, String8 table_name)
-{
-  ProfBeginFunction();
-  
-  for (U64 i = 0; i < database->table_count; i++)
+  if (result == NULL)
   {
-    if (str8_match(database->tables[i]->name, table_name, 0))
-    {
-      ProfEnd();
-      return 1;
-    }
+    log_error("failed to find table '%.*s' in database '%.*s'", str8_varg(table_name), str8_varg(database->name));
   }
   ProfEnd();
-  return 0;
+  return result;
 }
 
 
@@ -220,6 +405,10 @@ gdb_table_alloc(String8 name)
   
   table->name = name;
   table->arena = arena;
+  table->write_mutex = os_mutex_alloc();
+  
+  // tec: a new table has never been written
+  table->version = 1;
   
   return table;
 }
@@ -227,6 +416,7 @@ gdb_table_alloc(String8 name)
 internal void
 gdb_table_release(GDB_Table* table)
 {
+  os_mutex_release(table->write_mutex);
   arena_release(table->arena);
 }
 
@@ -253,6 +443,7 @@ gdb_table_add_column(GDB_Table* table, GDB_ColumnSchema schema)
   GDB_Column* column = gdb_column_alloc(schema.name, schema.type, schema.size);
   column->parent_table = table;
   table->columns[table->column_count++] = column;
+  gdb_column_mark_dirty(column);
   
   ProfEnd();
 }
@@ -264,223 +455,567 @@ gdb_table_add_row(GDB_Table* table, void** row_data)
   {
     gdb_column_add_data(table->columns[i], row_data[i]);
   }
-  table->row_count++;
+  
+  // tec: publish the row only after every column holds it
+  ins_atomic_u64_eval_assign(&table->row_count, table->row_count + 1);
+  gdb_table_mark_dirty(table);
 }
 
 internal void
 gdb_table_remove_row(GDB_Table* table, U64 row_index)
 {
+  os_mutex_take(table->write_mutex);
   if (row_index >= table->row_count)
   {
     log_error("row index out of bounds: %llu", row_index);
+    os_mutex_drop(table->write_mutex);
     return;
   }
   
+  // tec: rows shift in place, this is the one write that waits for readers
   for (U64 i = 0; i < table->column_count; ++i)
   {
-    gdb_column_remove_data(table->columns[i], row_index);
+    GDB_Column* column = table->columns[i];
+    OS_MutexScopeW(column->rw_mutex)
+    {
+      gdb_column_remove_data(column, row_index);
+    }
   }
   
-  table->row_count--;
+  ins_atomic_u64_eval_assign(&table->row_count, table->row_count - 1);
+  gdb_table_invalidate_indexes(table);
+  gdb_table_mark_dirty(table);
+  os_mutex_drop(table->write_mutex);
+}
+
+internal U64
+gdb_table_row_count(GDB_Table* table)
+{
+  U64 result = ins_atomic_u64_eval(&table->row_count);
+  return result;
 }
 
 internal B32
 gdb_table_save(GDB_Table* table, String8 table_dir)
+{
+  ProfBeginFunction();
+  B32 result = gdb_tables_flush(&table, &table_dir, 1);
+  ProfEnd();
+  return result;
+}
+
+internal B32
+gdb_table_is_dirty(GDB_Table* table)
+{
+  B32 result = (table->version != table->flushed_version);
+  for (U64 i = 0; i < table->column_count && !result; i++)
+  {
+    result = gdb_column_is_dirty(table->columns[i]);
+  }
+  return result;
+}
+
+internal B32
+gdb_table_has_unlogged_changes(GDB_Table* table)
+{
+  B32 result = (table->version != Max(table->flushed_version, table->logged_version));
+  for (U64 i = 0; i < table->column_count && !result; i++)
+  {
+    result = gdb_column_has_unlogged_changes(table->columns[i]);
+  }
+  return result;
+}
+
+internal void
+gdb_table_mark_dirty(GDB_Table* table)
+{
+  table->version++;
+}
+
+internal B32
+gdb_table_save_meta(GDB_Table* table, String8 table_dir)
 {
   ProfBeginFunction();
   
-  //- tec: table meta file
   Temp scratch = scratch_begin(0, 0);
+  String8 meta_path = push_str8f(scratch.arena, "%.*s/%.*s.meta", str8_varg(table_dir), str8_varg(table->name));
+  
+  U64 meta_size = sizeof(U64) * 2;
+  for (U64 i = 0; i < table->column_count; i++)
   {
-    String8 meta_path = push_str8f(scratch.arena, "%.*s/%.*s.meta", str8_varg(table_dir), str8_varg(table->name));
-    OS_Handle meta_file = os_file_open(OS_AccessFlag_Write, meta_path);
-    if (os_handle_match(os_handle_zero(), meta_file))
-    {
-      log_error("Failed to open metadata file: %.*s", str8_varg(meta_path));
-      return 0;
-    }
-    
-    U64 meta_size = sizeof(U64) * 2;
-    for (U64 i = 0; i < table->column_count; i++)
-    {
-      GDB_Column* column = table->columns[i];
-      meta_size += sizeof(GDB_ColumnType) + (sizeof(U64) * 3) + column->name.size;
-    }
-    
-    U8* meta_buffer = push_array(scratch.arena, U8, meta_size);
-    U8* meta_ptr = meta_buffer;
-    
-    *(U64*)meta_ptr = table->column_count; meta_ptr += sizeof(U64);
-    *(U64*)meta_ptr = table->row_count; meta_ptr += sizeof(U64);
-    
-    for (U64 i = 0; i < table->column_count; i++)
-    {
-      GDB_Column* column = table->columns[i];
-      
-      *(GDB_ColumnType*)meta_ptr = column->type; meta_ptr += sizeof(GDB_ColumnType);
-      *(U64*)meta_ptr = column->size; meta_ptr += sizeof(U64);
-      *(U64*)meta_ptr = column->capacity; meta_ptr += sizeof(U64);
-      *(U64*)meta_ptr = column->name.size; meta_ptr += sizeof(U64);
-      MemoryCopy(meta_ptr, column->name.str, column->name.size);
-      meta_ptr += column->name.size;
-    }
-    
-    os_file_write(meta_file, r1u64(0, meta_size), meta_buffer);
-    os_file_close(meta_file);
+    GDB_Column* column = table->columns[i];
+    meta_size += sizeof(GDB_ColumnType) + (sizeof(U64) * 3) + column->name.size;
   }
-  scratch_end(scratch);
+  meta_size += sizeof(U64);
+  
+  U8* meta_buffer = push_array(scratch.arena, U8, meta_size);
+  U8* meta_ptr = meta_buffer;
+  
+  *(U64*)meta_ptr = table->column_count; meta_ptr += sizeof(U64);
+  *(U64*)meta_ptr = table->row_count; meta_ptr += sizeof(U64);
   
-  //- tec: column files
-  scratch = scratch_begin(0, 0);
   for (U64 i = 0; i < table->column_count; i++)
   {
     GDB_Column* column = table->columns[i];
     
-    if (!column->is_disk_backed)
-    {
-      String8 column_path = push_str8f(scratch.arena, "%.*s/%.*s.dat", str8_varg(table_dir), str8_varg(column->name));
-      OS_Handle file = os_file_open(OS_AccessFlag_Write, column_path);
-      if (os_handle_match(os_handle_zero(), file))
-      {
-        log_error("Failed to open column file for saving: %.*s", str8_varg(column_path));
-        break;
-        //return 0;
-      }
-      
-      if (column->type == GDB_ColumnType_String8)
-      {
-        U64 header_size = sizeof(U64);
-        U64 data_size = column->variable_capacity;
-        U64 offset_size = column->capacity * sizeof(U64);
-        U64 total_size = header_size + data_size + offset_size;
-        
-        U8* buffer = push_array(scratch.arena, U8, total_size);
-        U8* write_ptr = buffer;
-        
-        *(U64*)write_ptr = column->variable_capacity;
-        write_ptr += sizeof(U64);
-        MemoryCopy(write_ptr, column->data, column->variable_capacity);
-        write_ptr += column->variable_capacity;
-        MemoryCopy(write_ptr, column->offsets, column->capacity * sizeof(U64));
-        
-        os_file_write(file, r1u64(0, total_size), buffer);
-      }
-      else
-      {
-        U64 data_size = column->capacity * column->size;
-        os_file_write(file, r1u64(0, data_size), column->data);
-      }
-      os_file_close(file);
-    }
+    // tec: in memory columns are written without their spare capacity
+    U64 capacity = column->is_disk_backed ? column->capacity : column->row_count;
+    
+    *(GDB_ColumnType*)meta_ptr = column->type; meta_ptr += sizeof(GDB_ColumnType);
+    *(U64*)meta_ptr = column->size; meta_ptr += sizeof(U64);
+    *(U64*)meta_ptr = capacity; meta_ptr += sizeof(U64);
+    *(U64*)meta_ptr = column->name.size; meta_ptr += sizeof(U64);
+    MemoryCopy(meta_ptr, column->name.str, column->name.size);
+    meta_ptr += column->name.size;
   }
-  scratch_end(scratch);
   
+  // tec: trailer, the last write-ahead log record contained in the column files
+  *(U64*)meta_ptr = table->wal_lsn; meta_ptr += sizeof(U64);
+  
+  String8List meta_list = {0};
+  str8_list_push(scratch.arena, &meta_list, str8(meta_buffer, meta_size));
+  B32 result = gdb_write_file_atomic(meta_path, meta_list);
+  if (!result)
+  {
+    log_error("failed to write metadata file: %.*s", str8_varg(meta_path));
+  }
+  
+  scratch_end(scratch);
   ProfEnd();
-  return 1;
+  return result;
+}
+
+internal
+THREAD_POOL_TASK_FUNC(gdb_save_task)
+{
+  GDB_SaveTaskArray* tasks = (GDB_SaveTaskArray*)raw_task;
+  GDB_SaveTask* task = &tasks->v[task_id];
+  
+  if (task->index)
+  {
+    task->success = gdb_index_save(task->index, task->table_dir);
+  }
+  else if (task->column)
+  {
+    task->success = gdb_column_save(task->column, task->table_dir);
+  }
+  else
+  {
+    task->success = gdb_table_save_meta(task->table, task->table_dir);
+  }
 }
 
 internal B32
-gdb_table_export_csv(GDB_Table* table, String8 path)
+gdb_tables_flush(GDB_Table** tables, String8* table_dirs, U64 table_count)
 {
   ProfBeginFunction();
   
-  OS_Handle file = os_file_open(OS_AccessFlag_Write, path);
-  if (os_handle_match(os_handle_zero(), file))
+  // tec: flushes share the thread pool and run one at a time. every table stays locked against writers
+  // until its files are out so a column file and the meta file agree on the row count, readers carry on
+  os_mutex_take(g_gdb_state->flush_mutex);
+  for (U64 i = 0; i < table_count; i++)
   {
-    log_error("failed to open CSV file for writing: %s", path.str);
-    return 0;
+    os_mutex_take(tables[i]->write_mutex);
   }
   
-  Temp scratch = temp_begin(g_gdb_state->arena);
-  U64 chunk_cap = KB(8);
-  String8 chunk = str8_from_memory_size(scratch.arena, chunk_cap);
-  chunk.size = 0;
-  
-  // Save the original arena position
-  U64 arena_restore_point = scratch.arena->pos;
-  
-  U64 file_off = 0;
-  
-#define FLUSH_CHUNK() do { \
-if (chunk.size > 0) { \
-os_file_write(file, r1u64(file_off, file_off + chunk.size), chunk.str); \
-file_off += chunk.size; \
-chunk.size = 0; \
-scratch.arena->pos = arena_restore_point; \
-} \
-} while (0)
-  
-#define APPEND_TO_CHUNK(str8_expr) do { \
-String8 __s = (str8_expr); \
-if (chunk.size + __s.size > chunk_cap) FLUSH_CHUNK(); \
-MemoryCopy(chunk.str + chunk.size, __s.str, __s.size); \
-chunk.size += __s.size; \
-} while (0)
+  Temp scratch = scratch_begin(0, 0);
   
-  for (U64 i = 0; i < table->column_count; i++)
+  //- tec: gather dirty columns and meta files
+  GDB_SaveTaskArray column_tasks = {0};
+  GDB_SaveTaskArray meta_tasks = {0};
   {
-    APPEND_TO_CHUNK(table->columns[i]->name);
-    if (i < table->column_count - 1)
+    U64 column_count = 0;
+    for (U64 i = 0; i < table_count; i++)
     {
-      APPEND_TO_CHUNK(str8_lit(","));
+      column_count += tables[i]->column_count + tables[i]->index_count;
     }
+    column_tasks.v = push_array(scratch.arena, GDB_SaveTask, column_count);
+    meta_tasks.v = push_array(scratch.arena, GDB_SaveTask, table_count);
   }
-  APPEND_TO_CHUNK(str8_lit("\n"));
   
-  for (U64 row = 0; row < table->row_count; row++)
+  for (U64 i = 0; i < table_count; i++)
   {
-    for (U64 col = 0; col < table->column_count; col++)
+    GDB_Table* table = tables[i];
+    B32 any_column_dirty = 0;
+    
+    for (U64 c = 0; c < table->column_count; c++)
     {
-      GDB_Column* column = table->columns[col];
-      String8 output = {0};
-      
-      if (column->type == GDB_ColumnType_U64)
-      {
-        U64* data = (U64*)gdb_column_get_data(column, row);
-        output = str8_from_u64(scratch.arena, *data, 10, 0, 0);
-      }
-      else if (column->type == GDB_ColumnType_U32)
-      {
-        U32* data = (U32*)gdb_column_get_data(column, row);
-        output = str8_from_u64(scratch.arena, *data, 10, 0, 0);
-      }
-      else if (column->type == GDB_ColumnType_F64)
-      {
-        F64* data = (F64*)gdb_column_get_data(column, row);
-        output = str8_from_f64(scratch.arena, *data, 6);
-      }
-      else if (column->type == GDB_ColumnType_F32)
-      {
-        F32* data = (F32*)gdb_column_get_data(column, row);
-        output = str8_from_f64(scratch.arena, *data, 6);
-      }
-      else if (column->type == GDB_ColumnType_String8)
+      GDB_Column* column = table->columns[c];
+      if (!gdb_column_is_dirty(column))
       {
-        output = gdb_column_get_string(scratch.arena, column, row);
+        continue;
       }
+      any_column_dirty = 1;
       
-      if (output.size && output.str)
+      // tec: disk backed columns are written through on every append, only a null bitmap is left to save
+      if (column->is_disk_backed && !column->validity)
       {
-        APPEND_TO_CHUNK(output);
+        column->flushed_version = column->version;
+        continue;
       }
       
-      if (col < table->column_count - 1)
+      GDB_SaveTask* task = &column_tasks.v[column_tasks.count++];
+      task->table = table;
+      task->column = column;
+      task->table_dir = table_dirs[i];
+      task->version = column->version;
+    }
+    
+    // tec: indexes go with the columns, they never cover rows past the ones being written
+    for (U64 idx = 0; idx < table->index_count; idx++)
+    {
+      GDB_Index* index = table->indexes[idx];
+      if (index->version == index->flushed_version)
       {
-        APPEND_TO_CHUNK(str8_lit(","));
+        continue;
       }
+      
+      GDB_SaveTask* task = &column_tasks.v[column_tasks.count++];
+      task->table = table;
+      task->index = index;
+      task->table_dir = table_dirs[i];
+      task->version = index->version;
+    }
+    
+    if (any_column_dirty || table->version != table->flushed_version)
+    {
+      GDB_SaveTask* task = &meta_tasks.v[meta_tasks.count++];
+      task->table = table;
+      task->table_dir = table_dirs[i];
+      task->version = table->version;
     }
-    APPEND_TO_CHUNK(str8_lit("\n"));
   }
   
-  FLUSH_CHUNK();
-  
-  os_file_close(file);
-  temp_end(scratch);
+  //- tec: columns go first so a meta file never references rows that are not on disk yet
+  tp_for_parallel(g_gdb_state->thread_pool, g_gdb_state->thread_pool_arena, column_tasks.count, gdb_save_task, &column_tasks);
   
-  ProfEnd();
-  return 1;
-}
-
+  B32 result = 1;
+  for (U64 i = 0; i < column_tasks.count; i++)
+  {
+    GDB_SaveTask* task = &column_tasks.v[i];
+    if (task->success)
+    {
+      if (task->index) task->index->flushed_version = task->version;
+      else             task->column->flushed_version = task->version;
+    }
+    else if (task->index)
+    {
+      log_error("failed to save index '%.*s' of table '%.*s'", str8_varg(task->index->name), str8_varg(task->table->name));
+      result = 0;
+    }
+    else
+    {
+      log_error("failed to save column '%.*s' of table '%.*s'", str8_varg(task->column->name), str8_varg(task->table->name));
+      result = 0;
+    }
+  }
+  
+  if (result)
+  {
+    tp_for_parallel(g_gdb_state->thread_pool, g_gdb_state->thread_pool_arena, meta_tasks.count, gdb_save_task, &meta_tasks);
+    for (U64 i = 0; i < meta_tasks.count; i++)
+    {
+      GDB_SaveTask* task = &meta_tasks.v[i];
+      if (task->success)
+      {
+        task->table->flushed_version = task->version;
+      }
+      else
+      {
+        log_error("failed to save table: %.*s", str8_varg(task->table->name));
+        result = 0;
+      }
+    }
+  }
+  
+  log_info("flushed %llu column and index files and %llu meta files", column_tasks.count, meta_tasks.count);
+  
+  scratch_end(scratch);
+  for (U64 i = 0; i < table_count; i++)
+  {
+    os_mutex_drop(tables[i]->write_mutex);
+  }
+  os_mutex_drop(g_gdb_state->flush_mutex);
+  ProfEnd();
+  return result;
+}
+
+// tec: start offsets of every row in the block relative to the returned bytes, count + 1 entries.
+// disk backed columns take two reads, the end offsets of the rows before and in the block then the bytes they cover
+internal U8*
+gdb_table_export_string_block(Arena* arena, GDB_Column* column, Rng1U64 rows, U64** out_bounds)
+{
+  ProfBeginFunction();
+  
+  U64 row_count = dim_1u64(rows);
+  U64* bounds = push_array(arena, U64, row_count + 1);
+  U8* result = 0;
+  
+  os_rw_mutex_take_r(column->rw_mutex);
+  if (rows.max > column->row_count)
+  {
+    log_error("invalid row range [%llu - %llu] for column with %llu rows", rows.min, rows.max, column->row_count);
+  }
+  else if (!column->is_disk_backed)
+  {
+    U64 base = (rows.min > 0) ? column->offsets[rows.min - 1] : 0;
+    for (U64 i = 0; i < row_count; i++)
+    {
+      bounds[i + 1] = column->offsets[rows.min + i] - base;
+    }
+    // tec: a column of empty strings never allocates its data
+    local_persist U8 empty_data = 0;
+    result = column->data ? column->data + base : &empty_data;
+  }
+  else
+  {
+    OS_Handle file = column->file;
+    B32 temp_opened = 0;
+    if (os_handle_match(os_handle_zero(), file))
+    {
+      file = os_file_open(OS_AccessFlag_Read, column->disk_path);
+      temp_opened = 1;
+    }
+    
+    U64 read_start_time = os_now_microseconds();
+    U64 var_reserved = 0;
+    os_file_read(file, r1u64(0, sizeof(U64)), &var_reserved);
+    
+    // tec: row 0 has no end offset before it, it starts at 0
+    U64 offset_base = sizeof(U64) + var_reserved;
+    U64 first_entry = (rows.min > 0) ? rows.min - 1 : 0;
+    U64* entries = (rows.min > 0) ? bounds : bounds + 1;
+    U64 entry_count = rows.max - first_entry;
+    U64 entry_bytes = entry_count * sizeof(U64);
+    U64 read_bytes = os_file_read(file, r1u64(offset_base + first_entry * sizeof(U64), offset_base + first_entry * sizeof(U64) + entry_bytes), entries);
+    
+    U64 base = bounds[0];
+    B32 valid = (read_bytes == entry_bytes);
+    for (U64 i = 1; valid && i <= row_count; i++)
+    {
+      valid = (bounds[i] >= bounds[i - 1]);
+      bounds[i - 1] -= base;
+    }
+    
+    if (valid)
+    {
+      U64 data_size = bounds[row_count] - base;
+      bounds[row_count] = data_size;
+      result = push_array_no_zero(arena, U8, data_size + 1);
+      if (os_file_read(file, r1u64(sizeof(U64) + base, sizeof(U64) + base + data_size), result) != data_size)
+      {
+        log_error("failed to read string data for rows [%llu - %llu] of column: %.*s", rows.min, rows.max, str8_varg(column->name));
+        result = 0;
+      }
+      g_gdb_io_stats.bytes_read += entry_bytes + data_size;
+    }
+    else
+    {
+      log_error("invalid string offsets for rows [%llu - %llu] of column: %.*s", rows.min, rows.max, str8_varg(column->name));
+    }
+    g_gdb_io_stats.read_time_us += os_now_microseconds() - read_start_time;
+    
+    if (temp_opened)
+    {
+      os_file_close(file);
+    }
+  }
+  os_rw_mutex_drop_r(column->rw_mutex);
+  
+  *out_bounds = bounds;
+  ProfEnd();
+  return result;
+}
+
+internal
+THREAD_POOL_TASK_FUNC(gdb_export_task)
+{
+  ProfBeginFunction();
+  
+  GDB_ExportTaskArray* tasks = (GDB_ExportTaskArray*)raw_task;
+  GDB_ExportTask* task = &tasks->v[task_id];
+  GDB_Table* table = task->table;
+  U64 row_count = dim_1u64(task->rows);
+  U64 column_count = table->column_count;
+  
+  //- tec: pull the whole block of every column in once instead of a read per cell
+  U8** values = push_array(arena, U8*, column_count);
+  U64** string_bounds = push_array(arena, U64*, column_count);
+  B32* has_nulls = push_array(arena, B32, column_count);
+  task->success = 1;
+  for (U64 col = 0; col < column_count && task->success; col++)
+  {
+    GDB_Column* column = table->columns[col];
+    has_nulls[col] = gdb_column_has_nulls(column);
+    if (column->type == GDB_ColumnType_String8)
+    {
+      values[col] = gdb_table_export_string_block(arena, column, task->rows, &string_bounds[col]);
+      task->success = (values[col] != 0 || row_count == 0);
+    }
+    else
+    {
+      U64 size = 0;
+      values[col] = (U8*)gdb_column_get_data_range(arena, column, task->rows, &size);
+      task->success = (values[col] != 0 && size == row_count * column->size);
+    }
+  }
+  
+  if (!task->success)
+  {
+    ProfEnd();
+    return;
+  }
+  
+  //- tec: format into fixed chunks, each field reserves room for itself and the separator after it
+  U64 chunk_cap = KB(64);
+  U8* chunk = push_array_no_zero(arena, U8, chunk_cap);
+  U64 chunk_size = 0;
+  
+  for (U64 i = 0; i < row_count; i++)
+  {
+    U64 row = task->rows.min + i;
+    for (U64 col = 0; col < column_count; col++)
+    {
+      GDB_Column* column = table->columns[col];
+      String8 string = {0};
+      U64 needed = F64_WRITE_SHORTEST_MAX + 1;
+      if (column->type == GDB_ColumnType_String8)
+      {
+        string = str8(values[col] + string_bounds[col][i], string_bounds[col][i + 1] - string_bounds[col][i]);
+        needed = string.size + 1;
+      }
+      
+      if (chunk_size + needed > chunk_cap)
+      {
+        str8_list_push(arena, &task->output, str8(chunk, chunk_size));
+        chunk = push_array_no_zero(arena, U8, chunk_cap);
+        chunk_size = 0;
+      }
+      
+      // tec: nulls are written as empty fields
+      if (has_nulls[col] && gdb_column_is_null(column, row))
+      {
+      }
+      else if (needed > chunk_cap)
+      {
+        // tec: longer than a chunk, goes out as its own segment
+        str8_list_push(arena, &task->output, push_str8_copy(arena, string));
+      }
+      else
+      {
+        switch (column->type)
+        {
+          case GDB_ColumnType_U32:     chunk_size += u64_write_decimal(chunk + chunk_size, ((U32*)values[col])[i]); break;
+          case GDB_ColumnType_U64:     chunk_size += u64_write_decimal(chunk + chunk_size, ((U64*)values[col])[i]); break;
+          case GDB_ColumnType_F32:     chunk_size += f32_write_shortest(chunk + chunk_size, ((F32*)values[col])[i]); break;
+          case GDB_ColumnType_F64:     chunk_size += f64_write_shortest(chunk + chunk_size, ((F64*)values[col])[i]); break;
+          case GDB_ColumnType_String8:
+          {
+            MemoryCopy(chunk + chunk_size, string.str, string.size);
+            chunk_size += string.size;
+          } break;
+          default: break;
+        }
+      }
+      
+      chunk[chunk_size++] = (col < column_count - 1) ? ',' : '\n';
+    }
+  }
+  
+  if (chunk_size > 0)
+  {
+    str8_list_push(arena, &task->output, str8(chunk, chunk_size));
+  }
+  
+  ProfEnd();
+}
+
+internal B32
+gdb_table_export_csv(GDB_Table* table, String8 path)
+{
+  ProfBeginFunction();
+  
+  OS_Handle file = os_file_open(OS_AccessFlag_Write, path);
+  if (os_handle_match(os_handle_zero(), file))
+  {
+    log_error("failed to open CSV file for writing: %s", path.str);
+    return 0;
+  }
+  
+  Temp scratch = scratch_begin(0, 0);
+  
+  //- tec: header line
+  String8List header = {0};
+  for (U64 i = 0; i < table->column_count; i++)
+  {
+    str8_list_push(scratch.arena, &header, table->columns[i]->name);
+    str8_list_push(scratch.arena, &header, (i < table->column_count - 1) ? str8_lit(",") : str8_lit("\n"));
+  }
+  String8 header_text = str8_list_join(scratch.arena, &header, 0);
+  os_file_write(file, r1u64(0, header_text.size), header_text.str);
+  U64 file_off = header_text.size;
+  
+  // tec: exports share the thread pool with flushes and take their turn the same way
+  os_mutex_take(g_gdb_state->flush_mutex);
+  
+  // tec: rows inserted while exporting are left for the next export
+  U64 row_count = gdb_table_row_count(table);
+  U64 block_count = (row_count + GDB_EXPORT_BLOCK_ROWS - 1) / GDB_EXPORT_BLOCK_ROWS;
+  
+  // tec: a few blocks per worker at a time bounds the formatted text held in memory
+  U64 wave_size = Max(1, 2 * (U64)g_gdb_state->thread_pool->worker_count);
+  GDB_ExportTaskArray tasks = {0};
+  tasks.v = push_array(scratch.arena, GDB_ExportTask, wave_size);
+  
+  B32 result = 1;
+  for (U64 first_block = 0; first_block < block_count && result; first_block += wave_size)
+  {
+    tasks.count = Min(wave_size, block_count - first_block);
+    MemoryZero(tasks.v, sizeof(GDB_ExportTask) * tasks.count);
+    for (U64 i = 0; i < tasks.count; i++)
+    {
+      U64 block_start = (first_block + i) * GDB_EXPORT_BLOCK_ROWS;
+      tasks.v[i].table = table;
+      tasks.v[i].rows = r1u64(block_start, Min(row_count, block_start + GDB_EXPORT_BLOCK_ROWS));
+    }
+    
+    TP_Temp tp_temp = tp_temp_begin(g_gdb_state->thread_pool_arena);
+    tp_for_parallel(g_gdb_state->thread_pool, g_gdb_state->thread_pool_arena, tasks.count, gdb_export_task, &tasks);
+    
+    //- tec: segments go out in block order so the file keeps the table's row order
+    for (U64 i = 0; i < tasks.count && result; i++)
+    {
+      GDB_ExportTask* task = &tasks.v[i];
+      if (!task->success)
+      {
+        log_error("failed to export rows [%llu - %llu] of table: %.*s", task->rows.min, task->rows.max, str8_varg(table->name));
+        result = 0;
+        break;
+      }
+      
+      for (String8Node* node = task->output.first; node != 0; node = node->next)
+      {
+        if (os_file_write(file, r1u64(file_off, file_off + node->string.size), node->string.str) != node->string.size)
+        {
+          log_error("failed to write CSV file: %.*s", str8_varg(path));
+          result = 0;
+          break;
+        }
+        file_off += node->string.size;
+      }
+    }
+    tp_temp_end(tp_temp);
+  }
+  
+  os_mutex_drop(g_gdb_state->flush_mutex);
+  
+  os_file_close(file);
+  scratch_end(scratch);
+  
+  ProfEnd();
+  return result;
+}
+
 internal GDB_Table*
 gdb_table_load(String8 table_dir, String8 meta_path)
 {
@@ -530,7 +1065,14 @@ gdb_table_load(String8 table_dir, String8 meta_path)
     
     if (props.size == 0)
     {
-      log_error("%.*s contains no data", str8_varg(column_path));
+      if (column->row_count != 0)
+      {
+        log_error("%.*s contains no data", str8_varg(column_path));
+      }
+      os_file_close(file);
+      gdb_column_load_validity(column, table_dir);
+      table->columns[i] = column;
+      column->parent_table = table;
       continue;
     }
     
@@ -575,321 +1117,990 @@ gdb_table_load(String8 table_dir, String8 meta_path)
       os_file_map_view_close(map, mapped_ptr, r1u64(0, props.size));
       os_file_map_close(map);
     }
-    os_file_close(file);
-    table->columns[i] = column;
-    column->parent_table = table;
+    os_file_close(file);
+    gdb_column_load_validity(column, table_dir);
+    table->columns[i] = column;
+    column->parent_table = table;
+  }
+  
+  // tec: meta files written before the write-ahead log existed have no trailer
+  if (read_ptr + sizeof(U64) <= meta_data.str + meta_data.size)
+  {
+    table->wal_lsn = *(U64*)read_ptr; read_ptr += sizeof(U64);
+  }
+  
+  table->name = push_str8_copy(table->arena, str8_skip_last_slash(table_dir));
+  gdb_table_load_indexes(table, table_dir);
+  table->flushed_version = table->version;
+  temp_end(scratch);
+  
+  ProfEnd();
+  
+  return table;
+}
+
+internal U64
+parse_csv_line(U8 *input, U64 len, String8 *fields, U64 max_fields)
+{
+  U64 count = 0;
+  U64 i = 0;
+  while (i < len && count < max_fields)
+  {
+    B32 in_quote = 0;
+    U64 start = i;
+    if (input[i] == '"') { in_quote = 1; i++; start++; }
+    
+    U64 field_len = 0;
+    for (; i < len; i++)
+    {
+      if (in_quote)
+      {
+        if (input[i] == '"' && (i + 1 == len || input[i + 1] == ',' || input[i + 1] == '\n'))
+        {
+          i++;
+          break;
+        }
+        else if (input[i] == '"' && input[i + 1] == '"')
+        {
+          i++; // skip escaped quote
+        }
+      }
+      else if (input[i] == ',') break;
+    }
+    
+    U64 end = i;
+    if (in_quote && end > start && input[end - 1] == '"') end--;
+    fields[count++] = str8(input + start, end - start);
+    
+    // skip delimiter
+    if (i < len && input[i] == ',') i++;
+  }
+  
+  return count;
+}
+
+//~ tec: import sources
+internal GDB_ImportSource*
+gdb_import_source_open(String8 path)
+{
+  Arena* arena = arena_alloc(.reserve_size = GDB_IMPORT_RING_SIZE * 2 + MB(1), .commit_size = MB(1));
+  GDB_ImportSource* source = push_array(arena, GDB_ImportSource, 1);
+  source->arena = arena;
+  source->name = push_str8_copy(arena, path);
+  
+  // tec: '-' is stdin, so an import can read from another process, e.g. 'zcat dump.csv.gz | gdb'
+  if (str8_match(path, str8_lit("-"), 0))
+  {
+    source->handle = os_stdin();
+  }
+  else
+  {
+    source->handle = os_file_open(OS_AccessFlag_Read | OS_AccessFlag_ShareRead, path);
+    source->owns_handle = 1;
+  }
+  if (os_handle_match(source->handle, os_handle_zero()))
+  {
+    log_error("failed to open import source: %.*s", str8_varg(path));
+    arena_release(arena);
+    return NULL;
+  }
+  
+  source->capacity = GDB_IMPORT_RING_SIZE;
+  source->ring = push_array_no_zero(arena, U8, source->capacity);
+  source->line_buffer = push_array_no_zero(arena, U8, source->capacity);
+  source->mutex = os_mutex_alloc();
+  source->cv = os_condition_variable_alloc();
+  source->thread = os_thread_launch(gdb_import_source_thread, source, 0);
+  return source;
+}
+
+internal void
+gdb_import_source_free(GDB_ImportSource* source)
+{
+  if (source->owns_handle)
+  {
+    os_file_close(source->handle);
+  }
+  os_condition_variable_release(source->cv);
+  os_mutex_release(source->mutex);
+  arena_release(source->arena);
+}
+
+internal void
+gdb_import_source_close(GDB_ImportSource* source)
+{
+  os_mutex_take(source->mutex);
+  source->closed = 1;
+  B32 reader_done = source->reader_done;
+  os_condition_variable_broadcast(source->cv);
+  os_mutex_drop(source->mutex);
+  
+  if (reader_done)
+  {
+    os_thread_join(source->thread, max_U64);
+    gdb_import_source_free(source);
+  }
+  else
+  {
+    os_thread_detach(source->thread);
+  }
+}
+
+internal void
+gdb_import_source_thread(void* ptr)
+{
+  GDB_ImportSource* source = (GDB_ImportSource*)ptr;
+  for (;;)
+  {
+    //- tec: the next free run of the ring, up to its end
+    os_mutex_take(source->mutex);
+    while (!source->closed && source->write_pos - source->read_pos == source->capacity)
+    {
+      os_condition_variable_wait(source->cv, source->mutex, max_U64);
+    }
+    B32 closed = source->closed;
+    U64 at = source->write_pos % source->capacity;
+    U64 free_size = Min(source->capacity - at, source->capacity - (source->write_pos - source->read_pos));
+    os_mutex_drop(source->mutex);
+    if (closed)
+    {
+      break;
+    }
+    
+    U64 read_size = os_file_read_stream(source->handle, source->ring + at, free_size);
+    
+    os_mutex_take(source->mutex);
+    source->write_pos += read_size;
+    source->eof = (read_size == 0);
+    os_condition_variable_broadcast(source->cv);
+    os_mutex_drop(source->mutex);
+    if (read_size == 0)
+    {
+      break;
+    }
+  }
+  
+  os_mutex_take(source->mutex);
+  source->reader_done = 1;
+  B32 closed = source->closed;
+  os_condition_variable_broadcast(source->cv);
+  os_mutex_drop(source->mutex);
+  if (closed)
+  {
+    gdb_import_source_free(source);
+  }
+}
+
+// tec: the start of the input, once the ring is full or the input ended. only valid before the first line is taken
+internal String8
+gdb_import_source_head(GDB_ImportSource* source)
+{
+  os_mutex_take(source->mutex);
+  while (!source->eof && source->write_pos < source->capacity)
+  {
+    os_condition_variable_wait(source->cv, source->mutex, max_U64);
+  }
+  String8 head = str8(source->ring, source->write_pos);
+  os_mutex_drop(source->mutex);
+  return head;
+}
+
+// tec: the next line without its newline, valid until the next call. returns 0 at the end of the input
+// or when a line does not fit in the ring, failed tells the two apart
+internal B32
+gdb_import_source_next_line(GDB_ImportSource* source, String8* out_line)
+{
+  os_mutex_take(source->mutex);
+  source->read_pos = source->next_read_pos;
+  os_condition_variable_broadcast(source->cv);
+  os_mutex_drop(source->mutex);
+  
+  U64 line_start = source->read_pos;
+  U64 line_end = 0;
+  B32 result = 0;
+  for (;;)
+  {
+    os_mutex_take(source->mutex);
+    U64 write_pos = source->write_pos;
+    B32 eof = source->eof;
+    os_mutex_drop(source->mutex);
+    
+    //- tec: the bytes below write_pos are not touched by the reader until they are released
+    B32 found = 0;
+    while (source->scan_pos < write_pos && !found)
+    {
+      U64 at = source->scan_pos % source->capacity;
+      U64 run = Min(write_pos - source->scan_pos, source->capacity - at);
+      U8* newline = (U8*)memchr(source->ring + at, '\n', run);
+      if (newline)
+      {
+        source->scan_pos += (U64)(newline - (source->ring + at));
+        found = 1;
+      }
+      else
+      {
+        source->scan_pos += run;
+      }
+    }
+    
+    if (found)
+    {
+      line_end = source->scan_pos;
+      source->scan_pos += 1;
+      source->next_read_pos = source->scan_pos;
+      result = 1;
+      break;
+    }
+    if (eof)
+    {
+      // tec: a last line without a newline
+      if (write_pos > line_start)
+      {
+        line_end = write_pos;
+        source->next_read_pos = write_pos;
+        result = 1;
+      }
+      break;
+    }
+    if (write_pos - line_start == source->capacity)
+    {
+      log_error("line longer than %llu bytes in import source: %.*s", source->capacity, str8_varg(source->name));
+      source->failed = 1;
+      break;
+    }
+    
+    os_mutex_take(source->mutex);
+    while (source->write_pos == write_pos && !source->eof)
+    {
+      os_condition_variable_wait(source->cv, source->mutex, max_U64);
+    }
+    os_mutex_drop(source->mutex);
+  }
+  
+  if (result)
+  {
+    U64 size = line_end - line_start;
+    U64 at = line_start % source->capacity;
+    if (at + size <= source->capacity)
+    {
+      *out_line = str8(source->ring + at, size);
+    }
+    else
+    {
+      U64 first = source->capacity - at;
+      MemoryCopy(source->line_buffer, source->ring + at, first);
+      MemoryCopy(source->line_buffer + first, source->ring, size - first);
+      *out_line = str8(source->line_buffer, size);
+    }
+    if (out_line->size && out_line->str[out_line->size - 1] == '\r')
+    {
+      out_line->size -= 1;
+    }
+  }
+  return result;
+}
+
+//~ tec: import blocks
+internal void
+gdb_import_block_push_row(GDB_ImportBlock* block, String8* fields, U64 field_count)
+{
+  GDB_Table* table = block->table;
+  U64 row = block->row_count;
+  for (U64 col_i = 0; col_i < table->column_count; col_i++)
+  {
+    GDB_Column* column = table->columns[col_i];
+    U8* dst = block->values[col_i] + row * column->size;
+    
+    // tec: short rows are padded with nulls so every column keeps the same row count
+    String8 val = (col_i < field_count) ? str8_skip_chop_whitespace(fields[col_i]) : str8_zero();
+    if (val.size == 0 || str8_match(val, str8_lit("NULL"), StringMatchFlag_CaseInsensitive))
+    {
+      block->valid[col_i][row] = 0;
+      MemoryZero(dst, column->size);
+      continue;
+    }
+    
+    block->valid[col_i][row] = 1;
+    switch (column->type)
+    {
+      case GDB_ColumnType_U32: { U32 v = (U32)u64_from_str8(val, 10); MemoryCopy(dst, &v, sizeof(v)); } break;
+      case GDB_ColumnType_U64: { U64 v = u64_from_str8(val, 10); MemoryCopy(dst, &v, sizeof(v)); } break;
+      case GDB_ColumnType_F32: { F32 v = (F32)f64_from_str8(val); MemoryCopy(dst, &v, sizeof(v)); } break;
+      case GDB_ColumnType_F64: { F64 v = f64_from_str8(val); MemoryCopy(dst, &v, sizeof(v)); } break;
+      case GDB_ColumnType_String8:
+      default:
+      {
+        // tec: the line goes back to the ring, the block keeps its own copy
+        String8 copy = push_str8_copy(block->arena, val);
+        MemoryCopy(dst, &copy, sizeof(copy));
+      } break;
+    }
+  }
+  block->row_count++;
+}
+
+internal void
+gdb_import_block_append(GDB_ImportBlock* block)
+{
+  ProfBeginFunction();
+  
+  GDB_Table* table = block->table;
+  for (U64 col_i = 0; col_i < table->column_count; col_i++)
+  {
+    GDB_Column* column = table->columns[col_i];
+    
+    // tec: a column without validity holds no nulls
+    B8* valid = block->valid ? block->valid[col_i] : 0;
+    if (column->type == GDB_ColumnType_String8)
+    {
+      String8* strings = (String8*)block->values[col_i];
+      for (U64 row = 0; row < block->row_count; row++)
+      {
+        gdb_column_add_data(column, (!valid || valid[row]) ? &strings[row] : NULL);
+      }
+    }
+    else
+    {
+      gdb_column_add_values(column, block->values[col_i], valid, block->row_count);
+    }
+  }
+  
+  // tec: publish the block only after every column holds it
+  U64 previous_row_count = table->row_count;
+  ins_atomic_u64_eval_assign(&table->row_count, previous_row_count + block->row_count);
+  if (table->row_count / 1000000 != previous_row_count / 1000000)
+  {
+    log_info("processing row %llu", table->row_count);
+  }
+  
+  ProfEnd();
+}
+
+internal void
+gdb_import_block_flush_thread(void* ptr)
+{
+  gdb_import_block_append((GDB_ImportBlock*)ptr);
+}
+
+// tec: reads the input once, front to back, so it can come from a pipe. the types are sampled from
+// the head of the input while it sits in the ring, then parsed blocks are appended to the columns on a
+// flush thread while the next block is parsed
+internal GDB_Table*
+gdb_table_import_csv_streaming(GDB_Database *db, String8 table_name, String8 path)
+{
+  ProfBeginFunction();
+  
+  GDB_ImportSource* source = gdb_import_source_open(path);
+  if (source == NULL)
+  {
+    ProfEnd();
+    return NULL;
+  }
+  
+  log_info("starting import csv file %.*s", str8_varg(path));
+  
+  Temp scratch = scratch_begin(0, 0);
+  GDB_Table *table = gdb_table_alloc(table_name);
+  table->parent_database = db;
+  
+  GDB_ColumnType *types = 0;
+  String8 *column_names = 0;
+  U64 column_count = 0;
+  
+  ProfBegin("column type parsing");
+  {
+    String8 head = gdb_import_source_head(source);
+    B32 head_is_input = (head.size < source->capacity);
+    U64 sample_rows = 0;
+    U64 at = 0;
+    while (sample_rows <= GDB_IMPORT_SAMPLE_ROWS && at < head.size)
+    {
+      U64 line_start = at;
+      while (at < head.size && head.str[at] != '\n') at++;
+      
+      // tec: a partial line at the end of a full ring is left out
+      if (at == head.size && !head_is_input)
+      {
+        break;
+      }
+      
+      String8 line = str8(head.str + line_start, at - line_start);
+      at++;
+      if (line.size && line.str[line.size - 1] == '\r')
+      {
+        line.size -= 1;
+      }
+      
+      if (sample_rows == 0)
+      {
+        String8List headers = str8_split_by_string_chars(scratch.arena, line, str8_lit(","), StringSplitFlag_RespectQuotes);
+        column_count = headers.node_count;
+        column_names = push_array(scratch.arena, String8, column_count);
+        
+        U64 col_i = 0;
+        for (String8Node *node = headers.first; node; node = node->next, col_i++)
+        {
+          column_names[col_i] = push_str8_copy(scratch.arena, str8_skip_chop_whitespace(node->string));
+        }
+        types = push_array(scratch.arena, GDB_ColumnType, column_count);
+        MemorySet(types, GDB_ColumnType_Invalid, column_count * sizeof(*types));
+      }
+      else
+      {
+        Temp temp = temp_begin(scratch.arena);
+        String8List values = str8_split_by_string_chars(temp.arena, line, str8_lit(","), StringSplitFlag_RespectQuotes | StringSplitFlag_KeepEmpties);
+        U64 col_i = 0;
+        for (String8Node *node = values.first; node && col_i < column_count; node = node->next, col_i++)
+        {
+          GDB_ColumnType type = gdb_infer_column_type(node->string);
+          types[col_i] = gdb_promote_type(types[col_i], type);
+        }
+        temp_end(temp);
+      }
+      
+      sample_rows++;
+    }
+    
+    for (U64 i = 0; i < column_count; i++)
+    {
+      if (types[i] == GDB_ColumnType_Invalid)
+        types[i] = GDB_ColumnType_String8;
+      
+      GDB_ColumnSchema schema = gdb_column_schema_create(push_str8_copy(table->arena, column_names[i]), types[i]);
+      gdb_table_add_column(table, schema);
+    }
+  }
+  ProfEnd();
+  
+  if (column_count == 0)
+  {
+    log_error("no header found in CSV input: %.*s", str8_varg(path));
+    gdb_import_source_close(source);
+    gdb_table_release(table);
+    scratch_end(scratch);
+    ProfEnd();
+    return NULL;
+  }
+  
+  //- tec: two blocks, one parsing and one being appended
+  GDB_ImportBlock blocks[2] = { 0 };
+  for (U32 b = 0; b < 2; b++)
+  {
+    blocks[b].arena = arena_alloc(.reserve_size = GB(1), .commit_size = MB(4));
+    blocks[b].table = table;
+    blocks[b].values = push_array(scratch.arena, U8*, column_count);
+    blocks[b].valid = push_array(scratch.arena, B8*, column_count);
+    for (U64 col_i = 0; col_i < column_count; col_i++)
+    {
+      blocks[b].values[col_i] = push_array_no_zero(scratch.arena, U8, GDB_IMPORT_BLOCK_ROWS * table->columns[col_i]->size);
+      blocks[b].valid[col_i] = push_array_no_zero(scratch.arena, B8, GDB_IMPORT_BLOCK_ROWS);
+    }
+  }
+  
+  String8* fields = push_array(scratch.arena, String8, column_count);
+  OS_Handle flush_thread = os_handle_zero();
+  U32 current = 0;
+  B32 skipped_header = 0;
+  String8 line = { 0 };
+  while (gdb_import_source_next_line(source, &line))
+  {
+    if (!skipped_header)
+    {
+      skipped_header = 1;
+      continue;
+    }
+    
+    U64 field_count = parse_csv_line(line.str, line.size, fields, column_count);
+    gdb_import_block_push_row(&blocks[current], fields, field_count);
+    
+    if (blocks[current].row_count == GDB_IMPORT_BLOCK_ROWS)
+    {
+      if (!os_handle_match(flush_thread, os_handle_zero()))
+      {
+        os_thread_join(flush_thread, max_U64);
+      }
+      flush_thread = os_thread_launch(gdb_import_block_flush_thread, &blocks[current], 0);
+      
+      current ^= 1;
+      arena_clear(blocks[current].arena);
+      blocks[current].row_count = 0;
+    }
+  }
+  B32 failed = source->failed;
+  gdb_import_source_close(source);
+  
+  if (!os_handle_match(flush_thread, os_handle_zero()))
+  {
+    os_thread_join(flush_thread, max_U64);
+  }
+  if (blocks[current].row_count > 0)
+  {
+    gdb_import_block_append(&blocks[current]);
+  }
+  for (U32 b = 0; b < 2; b++)
+  {
+    arena_release(blocks[b].arena);
+  }
+  scratch_end(scratch);
+  
+  if (failed)
+  {
+    for (U64 col_i = 0; col_i < table->column_count; col_i++)
+    {
+      gdb_column_release(table->columns[col_i]);
+    }
+    gdb_table_release(table);
+    ProfEnd();
+    return NULL;
+  }
+  
+  log_info("ending import csv file %.*s", str8_varg(path));
+  ProfEnd();
+  return table;
+}
+
+//~ tec: appending imports
+
+// tec: the value as the column's type, 0 with a reason when it does not fit. a new table's types come from the
+// head of its input, so a later load can carry values wider than the type a column was given
+internal B32
+gdb_import_coerce_value(GDB_ColumnType type, String8 value, U8* dst, String8* out_reason)
+{
+  B32 result = 1;
+  switch (type)
+  {
+    case GDB_ColumnType_U32:
+    case GDB_ColumnType_U64:
+    {
+      // tec: leading zeros do not count towards the width
+      String8 digits = value;
+      while (digits.size > 1 && digits.str[0] == '0')
+      {
+        digits = str8_skip(digits, 1);
+      }
+      
+      if (!str8_is_integer(digits, 10))
+      {
+        *out_reason = str8_lit("not an unsigned integer");
+        result = 0;
+      }
+      else if (digits.size > 20 || (digits.size == 20 && MemoryCompare(digits.str, "18446744073709551615", 20) > 0))
+      {
+        *out_reason = str8_lit("out of range for u64");
+        result = 0;
+      }
+      else if (type == GDB_ColumnType_U32)
+      {
+        U64 v = u64_from_str8(digits, 10);
+        if (v > max_U32)
+        {
+          *out_reason = str8_lit("out of range for u32");
+          result = 0;
+        }
+        else
+        {
+          U32 v32 = (U32)v;
+          MemoryCopy(dst, &v32, sizeof(v32));
+        }
+      }
+      else
+      {
+        U64 v = u64_from_str8(digits, 10);
+        MemoryCopy(dst, &v, sizeof(v));
+      }
+    } break;
+    
+    case GDB_ColumnType_F32:
+    case GDB_ColumnType_F64:
+    {
+      B32 has_digit = 0;
+      B32 is_number = 1;
+      for (U64 i = 0; i < value.size && is_number; i++)
+      {
+        U8 c = value.str[i];
+        has_digit |= char_is_digit(c, 10);
+        is_number = (char_is_digit(c, 10) || c == '.' || c == 'e' || c == '+' || c == '-');
+      }
+      
+      if (!is_number || !has_digit)
+      {
+        *out_reason = str8_lit("not a number");
+        result = 0;
+      }
+      else if (type == GDB_ColumnType_F32)
+      {
+        F32 v = (F32)f64_from_str8(value);
+        if (v == inf32() || v == neg_inf32())
+        {
+          *out_reason = str8_lit("out of range for f32");
+          result = 0;
+        }
+        else
+        {
+          MemoryCopy(dst, &v, sizeof(v));
+        }
+      }
+      else
+      {
+        F64 v = f64_from_str8(value);
+        MemoryCopy(dst, &v, sizeof(v));
+      }
+    } break;
+    
+    case GDB_ColumnType_String8:
+    default:
+    {
+      // tec: points into the block's copy of the line
+      MemoryCopy(dst, &value, sizeof(value));
+    } break;
+  }
+  return result;
+}
+
+THREAD_POOL_TASK_FUNC(gdb_import_coerce_task)
+{
+  ProfBeginFunction();
+  
+  GDB_ImportCoerceTaskArray* tasks = (GDB_ImportCoerceTaskArray*)raw_task;
+  GDB_ImportCoerceTask* task = &tasks->v[task_id];
+  GDB_ImportBlock* block = tasks->block;
+  GDB_Table* table = block->table;
+  
+  // tec: room for one field past the header so over-long rows are caught
+  String8* fields = push_array(arena, String8, tasks->field_count + 1);
+  for (U64 row = task->rows.min; row < task->rows.max; row++)
+  {
+    String8 line = block->lines[row];
+    U64 field_count = parse_csv_line(line.str, line.size, fields, tasks->field_count + 1);
+    
+    // tec: columns the input leaves out, and fields short rows leave out, are null
+    for (U64 col_i = 0; col_i < table->column_count; col_i++)
+    {
+      GDB_Column* column = table->columns[col_i];
+      block->valid[col_i][row] = 0;
+      MemoryZero(block->values[col_i] + row * column->size, column->size);
+    }
+    
+    String8 reason = str8_zero();
+    String8 column_name = str8_zero();
+    B32 accepted = 1;
+    if (field_count > tasks->field_count)
+    {
+      reason = str8_lit("more fields than the header");
+      accepted = 0;
+    }
+    
+    for (U64 field_i = 0; field_i < field_count && accepted; field_i++)
+    {
+      U64 col_i = tasks->field_columns[field_i];
+      GDB_Column* column = table->columns[col_i];
+      String8 val = str8_skip_chop_whitespace(fields[field_i]);
+      if (val.size == 0 || str8_match(val, str8_lit("NULL"), StringMatchFlag_CaseInsensitive))
+      {
+        continue;
+      }
+      
+      accepted = gdb_import_coerce_value(column->type, val, block->values[col_i] + row * column->size, &reason);
+      block->valid[col_i][row] = (B8)accepted;
+      if (!accepted)
+      {
+        column_name = column->name;
+      }
+    }
+    
+    block->rejected[row] = (B8)!accepted;
+    if (!accepted)
+    {
+      str8_list_pushf(arena, &task->errors, "%llu,%.*s,%.*s,%.*s\n", block->first_line + row,
+                      str8_varg(column_name), str8_varg(reason), str8_varg(line));
+      task->rejected_count++;
+    }
   }
   
-  table->name = push_str8_copy(table->arena, str8_skip_last_slash(table_dir));
-  temp_end(scratch);
-  
   ProfEnd();
-  
-  return table;
 }
 
-internal U64
-parse_csv_line(U8 *input, U64 len, String8 *fields, U64 max_fields)
+// tec: closes the gaps rejected rows left, the kept rows stay in input order
+internal void
+gdb_import_block_compact(GDB_ImportBlock* block)
 {
-  U64 count = 0;
-  U64 i = 0;
-  while (i < len && count < max_fields)
+  GDB_Table* table = block->table;
+  U64 kept = 0;
+  for (U64 row = 0; row < block->row_count; row++)
   {
-    B32 in_quote = 0;
-    U64 start = i;
-    if (input[i] == '"') { in_quote = 1; i++; start++; }
+    if (block->rejected[row])
+    {
+      continue;
+    }
     
-    U64 field_len = 0;
-    for (; i < len; i++)
+    if (kept != row)
     {
-      if (in_quote)
+      for (U64 col_i = 0; col_i < table->column_count; col_i++)
       {
-        if (input[i] == '"' && (i + 1 == len || input[i + 1] == ',' || input[i + 1] == '\n'))
-        {
-          i++;
-          break;
-        }
-        else if (input[i] == '"' && input[i + 1] == '"')
-        {
-          i++; // skip escaped quote
-        }
+        U64 size = table->columns[col_i]->size;
+        MemoryCopy(block->values[col_i] + kept * size, block->values[col_i] + row * size, size);
+        block->valid[col_i][kept] = block->valid[col_i][row];
       }
-      else if (input[i] == ',') break;
     }
-    
-    U64 end = i;
-    if (in_quote && end > start && input[end - 1] == '"') end--;
-    fields[count++] = str8(input + start, end - start);
-    
-    // skip delimiter
-    if (i < len && input[i] == ',') i++;
+    kept++;
   }
+  block->row_count = kept;
+}
+
+// tec: the table already has readers, so the rows are published under the write mutex the way inserts are.
+// its indexes pick the new rows up on their next refresh
+internal void
+gdb_import_block_publish(GDB_ImportBlock* block)
+{
+  GDB_Table* table = block->table;
   
-  return count;
+  os_mutex_take(table->write_mutex);
+  gdb_import_block_append(block);
+  gdb_table_mark_dirty(table);
+  os_mutex_drop(table->write_mutex);
 }
 
-// tec: TODO make this function faster with multithreading
-internal GDB_Table*
-gdb_table_import_csv_streaming(GDB_Database *db, String8 table_name, String8 path)
+internal void
+gdb_import_block_append_thread(void* ptr)
+{
+  gdb_import_block_publish((GDB_ImportBlock*)ptr);
+}
+
+// tec: adds the rows of a CSV input to a table that already exists, so a daily load does not rebuild the
+// table. fields are matched to columns by the header's names and converted to the table's types on the thread
+// pool. rows that do not convert are left out and listed in <path>.errors (<table>.errors for stdin).
+// appended rows are not logged, they reach the column files with the next flush like any import
+internal B32
+gdb_table_import_csv_append(GDB_Table* table, String8 path)
 {
   ProfBeginFunction();
   
-  Temp scratch = temp_begin(g_gdb_state->arena);
-  
-  GDB_Table *table = gdb_table_alloc(table_name);
-  table->parent_database = db;
-  
-  OS_Handle file = os_file_open(OS_AccessFlag_Read, path);
-  if (os_handle_match(file, os_handle_zero()))
+  GDB_ImportSource* source = gdb_import_source_open(path);
+  if (source == NULL)
   {
-    log_error("Failed to open CSV file: %.*s", str8_varg(path));
-    return NULL;
+    ProfEnd();
+    return 0;
   }
   
-  log_info("starting import csv file %.*s", str8_varg(path));
+  log_info("starting append of csv file %.*s to table %.*s", str8_varg(path), str8_varg(table->name));
   
-  U64 file_size = os_properties_from_file(file).size;
-  U64 buffer_size = MB(64);
-  U8 *buffer = push_array(scratch.arena, U8, buffer_size);
+  Temp scratch = scratch_begin(0, 0);
+  String8 error_path = push_str8f(scratch.arena, "%.*s.errors", str8_varg(path));
+  if (str8_match(path, str8_lit("-"), 0))
+  {
+    error_path = push_str8f(scratch.arena, "%.*s.errors", str8_varg(table->name));
+  }
   
-  GDB_ColumnType *types = 0;
-  String8 *column_names = 0;
-  U64 column_count = 0;
+  // tec: an error file left by an earlier load of the same input would be mistaken for this one's
+  if (os_file_path_exists(error_path))
+  {
+    os_delete_file_at_path(error_path);
+  }
   
-  ProfBegin("column type parsing");
+  //- tec: match the header to the table's columns
+  B32 result = 1;
+  U64 column_count = table->column_count;
+  U64 field_count = 0;
+  U64* field_columns = 0;
+  String8 line = { 0 };
+  if (!gdb_import_source_next_line(source, &line))
   {
-    U64 file_pos = 0;
-    U64 sample_rows = 0;
-    Arena *parse_arena = arena_alloc(.reserve_size=MB(128), .commit_size=MB(4));
-    
-    String8 leftover = {0};
+    log_error("no header found in CSV input: %.*s", str8_varg(path));
+    result = 0;
+  }
+  else
+  {
+    String8List headers = str8_split_by_string_chars(scratch.arena, line, str8_lit(","), StringSplitFlag_RespectQuotes);
+    field_count = headers.node_count;
+    field_columns = push_array(scratch.arena, U64, field_count);
+    B8* mapped = push_array(scratch.arena, B8, column_count);
     
-    while (sample_rows < 256 && file_pos < file_size)
+    U64 field_i = 0;
+    for (String8Node* node = headers.first; node && result; node = node->next, field_i++)
     {
-      U64 read_size = Min(buffer_size, file_size - file_pos);
-      os_file_read(file, r1u64(file_pos, file_pos + read_size), buffer);
-      file_pos += read_size;
-      
-      String8 chunk = str8(buffer, read_size);
-      if (leftover.size)
+      String8 name = str8_skip_chop_whitespace(node->string);
+      field_columns[field_i] = max_U64;
+      for (U64 col_i = 0; col_i < column_count; col_i++)
       {
-        chunk = push_str8_cat(parse_arena, leftover, chunk);
-        leftover = (String8){0};
-      }
-      
-      U64 at = 0;
-      while (at < chunk.size)
-      {
-        U64 line_start = at;
-        while (at < chunk.size && chunk.str[at] != '\n') at++;
-        if (at == chunk.size)
+        if (str8_match(table->columns[col_i]->name, name, 0))
         {
-          leftover = push_str8_copy(parse_arena, str8(chunk.str + line_start, at - line_start));
+          field_columns[field_i] = col_i;
           break;
         }
-        
-        String8 line = str8(chunk.str + line_start, at - line_start);
-        at++;
-        if (line.size && line.str[line.size - 1] == '\r')
-        {
-          line.size -= 1;
-        }
-        
-        if (sample_rows == 0)
-        {
-          String8List headers = str8_split_by_string_chars(parse_arena, line, str8_lit(","), StringSplitFlag_RespectQuotes);
-          column_count = headers.node_count;
-          column_names = push_array(scratch.arena, String8, column_count);
-          
-          U64 col_i = 0;
-          for (String8Node *node = headers.first; node; node = node->next, col_i++)
-          {
-            column_names[col_i] = str8_skip_chop_whitespace(node->string);
-          }
-          types = push_array(scratch.arena, GDB_ColumnType, column_count);
-          MemorySet(types, GDB_ColumnType_Invalid, column_count * sizeof(*types));
-        }
-        else
-        {
-          String8List values = str8_split_by_string_chars(parse_arena, line, str8_lit(","), StringSplitFlag_RespectQuotes | StringSplitFlag_KeepEmpties);
-          U64 col_i = 0;
-          for (String8Node *node = values.first; node && col_i < column_count; node = node->next, col_i++)
-          {
-            GDB_ColumnType type = gdb_infer_column_type(node->string);
-            types[col_i] = gdb_promote_type(types[col_i], type);
-          }
-        }
-        
-        sample_rows++;
+      }
+      
+      if (field_columns[field_i] == max_U64)
+      {
+        log_error("column '%.*s' of %.*s is not in table '%.*s'", str8_varg(name), str8_varg(path), str8_varg(table->name));
+        result = 0;
+      }
+      else if (mapped[field_columns[field_i]])
+      {
+        log_error("column '%.*s' appears twice in the header of %.*s", str8_varg(name), str8_varg(path));
+        result = 0;
+      }
+      else
+      {
+        mapped[field_columns[field_i]] = 1;
       }
     }
-    
-    for (U64 i = 0; i < column_count; i++)
+  }
+  
+  if (!result)
+  {
+    gdb_import_source_close(source);
+    scratch_end(scratch);
+    ProfEnd();
+    return 0;
+  }
+  
+  //- tec: two blocks, one being read and converted while the other is appended
+  GDB_ImportBlock blocks[2] = { 0 };
+  for (U32 b = 0; b < 2; b++)
+  {
+    blocks[b].arena = arena_alloc(.reserve_size = GB(1), .commit_size = MB(4));
+    blocks[b].table = table;
+    blocks[b].values = push_array(scratch.arena, U8*, column_count);
+    blocks[b].valid = push_array(scratch.arena, B8*, column_count);
+    for (U64 col_i = 0; col_i < column_count; col_i++)
     {
-      if (types[i] == GDB_ColumnType_Invalid)
-        types[i] = GDB_ColumnType_String8;
-      
-      GDB_ColumnSchema schema = gdb_column_schema_create(column_names[i], types[i]);
-      gdb_table_add_column(table, schema);
-      //log_info("column type: %.*s", str8_varg(string_from_gdb_column_type(types[i])));
+      blocks[b].values[col_i] = push_array_no_zero(scratch.arena, U8, GDB_IMPORT_BLOCK_ROWS * table->columns[col_i]->size);
+      blocks[b].valid[col_i] = push_array_no_zero(scratch.arena, B8, GDB_IMPORT_BLOCK_ROWS);
     }
+    blocks[b].lines = push_array_no_zero(scratch.arena, String8, GDB_IMPORT_BLOCK_ROWS);
+    blocks[b].rejected = push_array_no_zero(scratch.arena, B8, GDB_IMPORT_BLOCK_ROWS);
   }
-  ProfEnd();
   
+  GDB_ImportCoerceTaskArray tasks = { 0 };
+  tasks.v = push_array(scratch.arena, GDB_ImportCoerceTask, (GDB_IMPORT_BLOCK_ROWS + GDB_IMPORT_COERCE_TASK_ROWS - 1) / GDB_IMPORT_COERCE_TASK_ROWS);
+  tasks.field_columns = field_columns;
+  tasks.field_count = field_count;
+  
+  OS_Handle append_thread = os_handle_zero();
+  OS_Handle error_file = os_handle_zero();
+  B32 error_file_failed = 0;
+  U64 error_off = 0;
+  U64 appended_rows = 0;
+  U64 rejected_rows = 0;
+  U32 current = 0;
+  
+  // tec: the header is line 1
+  blocks[current].first_line = 2;
+  
+  B32 more = 1;
+  while (more)
   {
-    Arena *row_arena = arena_alloc(.reserve_size = GB(1), .commit_size = MB(32));
-    U64 file_pos = 0;
-    U8 *buffer = push_array(scratch.arena, U8, buffer_size);
-    
-    String8 leftover = {0};
-    B32 skipped_header = 0;
+    GDB_ImportBlock* block = &blocks[current];
+    more = gdb_import_source_next_line(source, &line);
+    if (more)
+    {
+      // tec: the line goes back to the ring, the block keeps its own copy for the tasks to parse
+      block->lines[block->row_count++] = push_str8_copy(block->arena, line);
+    }
     
-    while (file_pos < file_size)
+    if (block->row_count == GDB_IMPORT_BLOCK_ROWS || (!more && block->row_count > 0))
     {
-      U64 read_size = Min(buffer_size, file_size - file_pos);
-      os_file_read(file, r1u64(file_pos, file_pos + read_size), buffer);
-      file_pos += read_size;
+      U64 line_count = block->row_count;
       
-      String8 chunk = str8(buffer, read_size);
-      if (leftover.size)
+      //- tec: convert the block on the thread pool, taking its turn with flushes and exports
+      tasks.block = block;
+      tasks.count = (line_count + GDB_IMPORT_COERCE_TASK_ROWS - 1) / GDB_IMPORT_COERCE_TASK_ROWS;
+      MemoryZero(tasks.v, sizeof(GDB_ImportCoerceTask) * tasks.count);
+      for (U64 i = 0; i < tasks.count; i++)
       {
-        chunk = push_str8_cat(row_arena, leftover, chunk);
-        leftover = (String8){0};
+        U64 first_row = i * GDB_IMPORT_COERCE_TASK_ROWS;
+        tasks.v[i].rows = r1u64(first_row, Min(line_count, first_row + GDB_IMPORT_COERCE_TASK_ROWS));
       }
       
-      U64 at = 0;
-      while (at < chunk.size)
+      os_mutex_take(g_gdb_state->flush_mutex);
+      TP_Temp tp_temp = tp_temp_begin(g_gdb_state->thread_pool_arena);
+      tp_for_parallel(g_gdb_state->thread_pool, g_gdb_state->thread_pool_arena, tasks.count, gdb_import_coerce_task, &tasks);
+      
+      //- tec: rejected rows go to the error file in line order, it is only created once there is one
+      U64 block_rejected = 0;
+      for (U64 i = 0; i < tasks.count; i++)
       {
-        U64 line_start = at;
-        while (at < chunk.size && chunk.str[at] != '\n') at++;
-        
-        B32 is_last_in_chunk = (at == chunk.size);
-        
-        String8 line = str8(chunk.str + line_start, at - line_start);
-        if (!is_last_in_chunk) at++; // skip newline if not last
-        
-        if (is_last_in_chunk)
-        {
-          leftover = push_str8_copy(row_arena, line);
-          break;
-        }
-        
-        if (!skipped_header)
+        GDB_ImportCoerceTask* task = &tasks.v[i];
+        block_rejected += task->rejected_count;
+        for (String8Node* node = task->errors.first; node != 0 && !error_file_failed; node = node->next)
         {
-          skipped_header = 1;
-          continue;
-        }
-        
-        table->row_count++;
-        if ((table->row_count % 1000000) == 0)
-        {
-          log_info("processing row %llu", table->row_count);
-        }
-        
-        String8* values = push_array(row_arena, String8, column_count);
-        U64 value_count = parse_csv_line(line.str, line.size, values, column_count);
-        
-        for (U64 col_i = 0; col_i < value_count; col_i++)
-        {
-          /*
-          String8List values = str8_split_by_string_chars(row_arena, line, str8_lit(","), StringSplitFlag_RespectQuotes | StringSplitFlag_KeepEmpties);
-          
-          U64 col_i = 0;
-          for (String8Node *node = values.first; node && col_i < column_count; node = node->next, col_i++)
+          if (os_handle_match(error_file, os_handle_zero()))
           {
-          String8 val = str8_skip_chop_whitespace(node->string);
-            */
-          String8 val = str8_skip_chop_whitespace(values[col_i]);
-          GDB_Column *column = table->columns[col_i];
-          
-          if (val.size == 0)
-          {
-            gdb_column_add_data(column, NULL);
-          }
-          else
-          {
-            switch (column->type)
+            error_file = os_file_open(OS_AccessFlag_Write, error_path);
+            error_file_failed = os_handle_match(error_file, os_handle_zero());
+            if (error_file_failed)
             {
-              case GDB_ColumnType_U32:
-              {
-                U32 value = (U32)u64_from_str8(val, 10);
-                gdb_column_add_data(column, &value);
-              } break;
-              
-              case GDB_ColumnType_U64:
-              {
-                U64 value = u64_from_str8(val, 10);
-                gdb_column_add_data(column, &value);
-              } break;
-              
-              case GDB_ColumnType_F32:
-              {
-                F32 value = (F32)f64_from_str8(val);
-                gdb_column_add_data(column, &value);
-              } break;
-              
-              case GDB_ColumnType_F64:
-              {
-                F64 value = f64_from_str8(val);
-                gdb_column_add_data(column, &value);
-              } break;
-              
-              case GDB_ColumnType_String8:
-              default:
-              {
-                gdb_column_add_data(column, &val);
-              } break;
+              log_error("failed to open import error file: %.*s", str8_varg(error_path));
+              break;
             }
+            
+            String8 header = str8_lit("line,column,error,row\n");
+            os_file_write(error_file, r1u64(0, header.size), header.str);
+            error_off = header.size;
           }
+          
+          os_file_write(error_file, r1u64(error_off, error_off + node->string.size), node->string.str);
+          error_off += node->string.size;
         }
-        
-        arena_clear(row_arena); // reuse arena after each line
       }
-    }
-    
-    // Process leftover if it's a valid line
-    if (leftover.size > 0)
-    {
-      if (!skipped_header)
+      tp_temp_end(tp_temp);
+      os_mutex_drop(g_gdb_state->flush_mutex);
+      
+      if (block_rejected > 0)
       {
-        skipped_header = 1;
+        gdb_import_block_compact(block);
       }
-      else
+      appended_rows += block->row_count;
+      rejected_rows += block_rejected;
+      
+      //- tec: append on a thread while the next block is read
+      if (!os_handle_match(append_thread, os_handle_zero()))
       {
-        table->row_count++;
-        String8List values = str8_split_by_string_chars(row_arena, leftover, str8_lit(","), StringSplitFlag_RespectQuotes | StringSplitFlag_KeepEmpties);
-        U64 col_i = 0;
-        for (String8Node *node = values.first; node && col_i < column_count; node = node->next, col_i++)
-        {
-          GDB_Column *column = table->columns[col_i];
-          String8 val = str8_skip_chop_whitespace(node->string);
-          
-          if (val.size == 0)
-          {
-            gdb_column_add_data(column, NULL);
-          }
-          else
-          {
-            switch (column->type)
-            {
-              case GDB_ColumnType_U32: { U32 v = (U32)u64_from_str8(val, 10); gdb_column_add_data(column, &v); } break;
-              case GDB_ColumnType_U64: { U64 v = u64_from_str8(val, 10); gdb_column_add_data(column, &v); } break;
-              case GDB_ColumnType_F32: { F32 v = (F32)f64_from_str8(val); gdb_column_add_data(column, &v); } break;
-              case GDB_ColumnType_F64: { F64 v = f64_from_str8(val); gdb_column_add_data(column, &v); } break;
-              case GDB_ColumnType_String8:
-              default: { gdb_column_add_data(column, &val); } break;
-            }
-          }
-        }
+        os_thread_join(append_thread, max_U64);
       }
-      arena_clear(row_arena);
+      append_thread = os_thread_launch(gdb_import_block_append_thread, block, 0);
+      
+      current ^= 1;
+      arena_clear(blocks[current].arena);
+      blocks[current].row_count = 0;
+      blocks[current].first_line = block->first_line + line_count;
     }
   }
-  os_file_close(file);
-  temp_end(scratch);
-  log_info("ending import csv file %.*s", str8_varg(path));
+  
+  // tec: rows before a failure are already in the table, the import still reports failing
+  if (source->failed)
+  {
+    log_error("append of %.*s stopped at line %llu, the rows before it were appended", str8_varg(path), blocks[current].first_line);
+    result = 0;
+  }
+  gdb_import_source_close(source);
+  
+  if (!os_handle_match(append_thread, os_handle_zero()))
+  {
+    os_thread_join(append_thread, max_U64);
+  }
+  for (U32 b = 0; b < 2; b++)
+  {
+    arena_release(blocks[b].arena);
+  }
+  if (!os_handle_match(error_file, os_handle_zero()))
+  {
+    os_file_close(error_file);
+  }
+  
+  if (rejected_rows > 0)
+  {
+    log_warn("appended %llu rows to table %.*s, %llu rows did not fit its columns, see %.*s",
+             appended_rows, str8_varg(table->name), rejected_rows, str8_varg(error_path));
+  }
+  else
+  {
+    log_info("appended %llu rows to table %.*s", appended_rows, str8_varg(table->name));
+  }
+  
+  scratch_end(scratch);
   ProfEnd();
-  return table;
+  return result;
 }
 
 internal GDB_Column*
@@ -912,13 +2123,21 @@ gdb_table_find_column(GDB_Table* table, String8 column_name)
 internal GDB_Column*
 gdb_column_alloc(String8 name, GDB_ColumnType type, U64 size)
 {
-  Arena* arena = arena_alloc(.reserve_size=GDB_COLUMN_ARENA_RESERVE_SIZE, .commit_size=GDB_COLUMN_ARENA_COMMIT_SIZE);
+  ArenaFlags flags = GDB_COLUMN_ARENA_FLAGS;
+  U32 numa_node_count = os_get_system_info()->numa_node_count;
+  if (g_gdb_state && numa_node_count > 1)
+  {
+    flags |= ArenaFlagsFromNumaNode((U32)(ins_atomic_u64_inc_eval(&g_gdb_state->next_column_numa_node) % numa_node_count));
+  }
+  
+  Arena* arena = arena_alloc(.reserve_size=GDB_COLUMN_ARENA_RESERVE_SIZE, .commit_size=GDB_COLUMN_ARENA_COMMIT_SIZE, .flags=flags);
   GDB_Column* column = push_array(arena, GDB_Column, 1);
   
   column->name = name;
   column->type = type;
   column->size = size;
   column->arena = arena;
+  column->rw_mutex = os_rw_mutex_alloc();
   
   return column;
 }
@@ -926,6 +2145,11 @@ gdb_column_alloc(String8 name, GDB_ColumnType type, U64 size)
 internal void
 gdb_column_release(GDB_Column* column)
 {
+  if (column->adopted_view)
+  {
+    os_file_map_view_close(os_handle_zero(), column->adopted_view, column->adopted_range);
+  }
+  os_rw_mutex_release(column->rw_mutex);
   arena_release(column->arena);
 }
 
@@ -947,6 +2171,76 @@ gdb_column_close(GDB_Column* column)
   }
 }
 
+internal void
+gdb_column_mark_dirty(GDB_Column* column)
+{
+  column->version++;
+  if (column->parent_table)
+  {
+    gdb_table_mark_dirty(column->parent_table);
+  }
+}
+
+internal B32
+gdb_column_is_dirty(GDB_Column* column)
+{
+  B32 result = (column->version != column->flushed_version);
+  return result;
+}
+
+internal B32
+gdb_column_has_unlogged_changes(GDB_Column* column)
+{
+  B32 result = (column->version != Max(column->flushed_version, column->logged_version));
+  return result;
+}
+
+internal B32
+gdb_column_save(GDB_Column* column, String8 table_dir)
+{
+  ProfBeginFunction();
+  
+  Temp scratch = scratch_begin(0, 0);
+  String8 column_path = push_str8f(scratch.arena, "%.*s/%.*s.dat", str8_varg(table_dir), str8_varg(column->name));
+  
+  B32 result = 1;
+  
+  // tec: disk backed columns already live in their file
+  if (!column->is_disk_backed)
+  {
+    // tec: only the live rows are written, not the spare capacity
+    String8List data = {0};
+    if (column->type == GDB_ColumnType_String8)
+    {
+      U64* variable_size = push_array(scratch.arena, U64, 1);
+      *variable_size = (column->row_count > 0) ? column->offsets[column->row_count - 1] : 0;
+      
+      str8_list_push(scratch.arena, &data, str8((U8*)variable_size, sizeof(U64)));
+      str8_list_push(scratch.arena, &data, str8(column->data, *variable_size));
+      str8_list_push(scratch.arena, &data, str8((U8*)column->offsets, column->row_count * sizeof(U64)));
+    }
+    else
+    {
+      str8_list_push(scratch.arena, &data, str8(column->data, column->row_count * column->size));
+    }
+    
+    result = gdb_write_file_atomic(column_path, data);
+    if (!result)
+    {
+      log_error("failed to write column file: %.*s", str8_varg(column_path));
+    }
+  }
+  
+  if (result)
+  {
+    result = gdb_column_save_validity(column, table_dir);
+  }
+  
+  scratch_end(scratch);
+  ProfEnd();
+  return result;
+}
+
 internal void
 gdb_column_add_data_disk_backed(GDB_Column* column, void* data)
 {
@@ -977,6 +2271,10 @@ gdb_column_add_data_disk_backed(GDB_Column* column, void* data)
     if (needs_growth)
     {
       ProfBegin("gdb_column_add_data_disk_backed growth");
+      
+      // tec: the offsets move to the end of the file, readers wait until they are back in place
+      os_rw_mutex_take_w(column->rw_mutex);
+      
       U64 new_reserved = var_reserved * 2;
       if (new_reserved < column->variable_capacity + str->size)
       {
@@ -986,7 +2284,7 @@ gdb_column_add_data_disk_backed(GDB_Column* column, void* data)
       U64 old_offset_pos = sizeof(U64) + var_reserved;
       U64 new_offset_pos = sizeof(U64) + new_reserved;
       
-      Temp scratch = temp_begin(g_gdb_state->arena);
+      Temp scratch = scratch_begin(0, 0);
       void *buffer = push_array(scratch.arena, U8, total_offsets_size);
       
       os_file_read(file, r1u64(old_offset_pos, old_offset_pos + total_offsets_size), buffer);
@@ -1004,7 +2302,8 @@ gdb_column_add_data_disk_backed(GDB_Column* column, void* data)
       MemoryZero(zero_buf, old_offset_array_size);
       os_file_write(file, r1u64(old_offset_pos, old_offset_pos + old_offset_array_size), zero_buf);
       
-      temp_end(scratch);
+      scratch_end(scratch);
+      os_rw_mutex_drop_w(column->rw_mutex);
       ProfEnd();
     }
     U64 string_offset = column->variable_capacity;
@@ -1038,6 +2337,9 @@ gdb_column_add_data_disk_backed(GDB_Column* column, void* data)
 internal void
 gdb_column_add_data(GDB_Column* column, void* data)
 {
+  // tec: a null still takes a slot in the data so row indices line up, the validity bit tells them apart
+  B32 is_valid = (data != NULL);
+  
   if (column->type == GDB_ColumnType_String8)
   {
     String8* str = (String8*)data;
@@ -1049,7 +2351,7 @@ gdb_column_add_data(GDB_Column* column, void* data)
     
     if (column->is_disk_backed)
     {
-      gdb_column_add_data_disk_backed(column, data);
+      gdb_column_add_data_disk_backed(column, str);
     }
     else
     {
@@ -1109,6 +2411,12 @@ gdb_column_add_data(GDB_Column* column, void* data)
   }
   else
   {
+    U64 zero_value = 0;
+    if (data == NULL)
+    {
+      data = &zero_value;
+    }
+    
     if (column->is_disk_backed)
     {
       gdb_column_add_data_disk_backed(column, data);
@@ -1157,7 +2465,55 @@ gdb_column_add_data(GDB_Column* column, void* data)
       }
     }
   }
-  column->row_count++;
+  gdb_column_set_valid(column, column->row_count, is_valid);
+  column->row_count++;
+  gdb_column_mark_dirty(column);
+}
+
+// tec: appends count fixed width values, valid NULL means every one of them is. null slots are expected to
+// hold zero like gdb_column_add_data writes. once the column is on disk the rest go out in a single write
+internal void
+gdb_column_add_values(GDB_Column* column, void* values, B8* valid, U64 count)
+{
+  ProfBeginFunction();
+  
+  U64 i = 0;
+  for (; i < count && !column->is_disk_backed; i++)
+  {
+    gdb_column_add_data(column, (valid && !valid[i]) ? NULL : (U8*)values + i * column->size);
+  }
+  
+  if (i < count)
+  {
+    U64 rest = count - i;
+    OS_Handle file = column->file;
+    if (os_handle_match(os_handle_zero(), file))
+    {
+      file = os_file_open(OS_AccessFlag_Write | OS_AccessFlag_Append, column->disk_path);
+    }
+    
+    U64 offset = column->row_count * column->size;
+    U64 size = rest * column->size;
+    U64 written = os_file_write(file, r1u64(offset, offset + size), (U8*)values + i * column->size);
+    if (written != size)
+    {
+      log_error("failed to append %llu rows to column %.*s", rest, str8_varg(column->name));
+    }
+    
+    if (os_handle_match(os_handle_zero(), column->file))
+    {
+      os_file_close(file);
+    }
+    
+    for (U64 j = 0; j < rest; j++)
+    {
+      gdb_column_set_valid(column, column->row_count + j, valid ? valid[i + j] : 1);
+    }
+    column->row_count += rest;
+    gdb_column_mark_dirty(column);
+  }
+  
+  ProfEnd();
 }
 
 internal void
@@ -1194,11 +2550,209 @@ gdb_column_remove_data(GDB_Column* column, U64 row_index)
     MemoryCopy(column->data + row_index * column->size, column->data + (row_index + 1) * column->size, size_to_move);
   }
   
+  if (column->validity)
+  {
+    if (gdb_column_is_null(column, row_index))
+    {
+      column->null_count--;
+    }
+    for (U64 i = row_index; i + 1 < column->row_count; i++)
+    {
+      B32 next_valid = (column->validity[(i + 1) >> 6] >> ((i + 1) & 63)) & 1;
+      if (next_valid) column->validity[i >> 6] |= (1ull << (i & 63));
+      else            column->validity[i >> 6] &= ~(1ull << (i & 63));
+    }
+  }
+  
   column->row_count--;
+  gdb_column_mark_dirty(column);
+}
+
+internal void
+gdb_column_validity_reserve(GDB_Column* column, U64 row_count)
+{
+  U64 word_count = (row_count + 63) / 64;
+  if (word_count <= column->validity_capacity)
+  {
+    return;
+  }
+  
+  U64 new_capacity = Max(word_count, column->validity_capacity * 2);
+  U64* new_validity = push_array_no_zero(column->arena, U64, new_capacity);
+  
+  // tec: rows added before the bitmap existed all hold values
+  MemorySet(new_validity, 0xff, new_capacity * sizeof(U64));
+  if (column->validity)
+  {
+    MemoryCopy(new_validity, column->validity, column->validity_capacity * sizeof(U64));
+  }
+  column->validity = new_validity;
+  column->validity_capacity = new_capacity;
+}
+
+internal void
+gdb_column_set_valid(GDB_Column* column, U64 row_index, B32 is_valid)
+{
+  if (column->validity == NULL && is_valid)
+  {
+    return;
+  }
+  
+  gdb_column_validity_reserve(column, row_index + 1);
+  
+  U64 mask = 1ull << (row_index & 63);
+  U64* word = &column->validity[row_index >> 6];
+  B32 was_valid = (*word & mask) != 0;
+  if (is_valid)
+  {
+    *word |= mask;
+  }
+  else
+  {
+    *word &= ~mask;
+  }
+  
+  // tec: only rows that already exist were counted
+  if (row_index < column->row_count)
+  {
+    if (was_valid && !is_valid) column->null_count++;
+    if (!was_valid && is_valid) column->null_count--;
+  }
+  else if (!is_valid)
+  {
+    column->null_count++;
+  }
+}
+
+internal B32
+gdb_column_is_null(GDB_Column* column, U64 row_index)
+{
+  if (column->validity == NULL || row_index >= column->row_count)
+  {
+    return 0;
+  }
+  B32 result = ((column->validity[row_index >> 6] >> (row_index & 63)) & 1) == 0;
+  return result;
+}
+
+internal B32
+gdb_column_has_nulls(GDB_Column* column)
+{
+  B32 result = (column->validity != NULL && column->null_count > 0);
+  return result;
+}
+
+internal U64*
+gdb_column_get_validity_range(Arena* arena, GDB_Column* column, Rng1U64 row_range, U64* out_size)
+{
+  ProfBeginFunction();
+  
+  U64 row_count = row_range.max - row_range.min;
+  U64 word_count = Max(1, (row_count + 63) / 64);
+  *out_size = word_count * sizeof(U64);
+  
+  if (!gdb_column_has_nulls(column))
+  {
+    log_error("column '%.*s' has no null bitmap", str8_varg(column->name));
+    *out_size = 0;
+    ProfEnd();
+    return NULL;
+  }
+  
+  U64* result = 0;
+  U64 first_word = row_range.min >> 6;
+  U64 shift = row_range.min & 63;
+  if (shift == 0 && first_word + word_count <= column->validity_capacity)
+  {
+    // tec: word aligned ranges point straight into the bitmap
+    result = column->validity + first_word;
+  }
+  else
+  {
+    result = push_array(arena, U64, word_count);
+    for (U64 i = 0; i < word_count; i++)
+    {
+      U64 lo_index = first_word + i;
+      U64 hi_index = lo_index + 1;
+      U64 lo = (lo_index < column->validity_capacity) ? column->validity[lo_index] : max_U64;
+      U64 hi = (hi_index < column->validity_capacity) ? column->validity[hi_index] : max_U64;
+      result[i] = shift ? ((lo >> shift) | (hi << (64 - shift))) : lo;
+    }
+  }
+  
+  ProfEnd();
+  return result;
+}
+
+internal B32
+gdb_column_save_validity(GDB_Column* column, String8 table_dir)
+{
+  ProfBeginFunction();
+  
+  Temp scratch = scratch_begin(0, 0);
+  String8 null_path = push_str8f(scratch.arena, "%.*s/%.*s" GDB_NULL_FILE_EXTENSION, str8_varg(table_dir), str8_varg(column->name));
+  
+  B32 result = 1;
+  if (gdb_column_has_nulls(column))
+  {
+    String8List data = {0};
+    str8_list_push(scratch.arena, &data, str8((U8*)column->validity, ((column->row_count + 63) / 64) * sizeof(U64)));
+    result = gdb_write_file_atomic(null_path, data);
+    if (!result)
+    {
+      log_error("failed to write null bitmap: %.*s", str8_varg(null_path));
+    }
+  }
+  else if (os_file_path_exists(null_path))
+  {
+    // tec: every null was removed since the last save
+    os_delete_file_at_path(null_path);
+  }
+  
+  scratch_end(scratch);
+  ProfEnd();
+  return result;
+}
+
+internal void
+gdb_column_load_validity(GDB_Column* column, String8 table_dir)
+{
+  Temp scratch = scratch_begin(0, 0);
+  String8 null_path = push_str8f(scratch.arena, "%.*s/%.*s" GDB_NULL_FILE_EXTENSION, str8_varg(table_dir), str8_varg(column->name));
+  
+  if (os_file_path_exists(null_path))
+  {
+    String8 data = os_data_from_file_path(scratch.arena, null_path);
+    U64 word_count = (column->row_count + 63) / 64;
+    if (data.size < word_count * sizeof(U64))
+    {
+      log_error("null bitmap is too small: %.*s", str8_varg(null_path));
+    }
+    else if (word_count > 0)
+    {
+      gdb_column_validity_reserve(column, column->row_count);
+      MemoryCopy(column->validity, data.str, word_count * sizeof(U64));
+      
+      // tec: bits past the last row are padding
+      U64 tail = column->row_count & 63;
+      if (tail)
+      {
+        column->validity[word_count - 1] |= ~((1ull << tail) - 1);
+      }
+      
+      column->null_count = 0;
+      for (U64 i = 0; i < word_count; i++)
+      {
+        column->null_count += 64 - count_bits_set64(column->validity[i]);
+      }
+    }
+  }
+  
+  scratch_end(scratch);
 }
 
 internal void*
-gdb_column_get_data(GDB_Column* column, U64 index)
+gdb_column_get_data(Arena* arena, GDB_Column* column, U64 index)
 {
   if (index >= column->row_count)
   {
@@ -1206,23 +2760,32 @@ gdb_column_get_data(GDB_Column* column, U64 index)
     return NULL;
   }
   
+  void* result = NULL;
+  os_rw_mutex_take_r(column->rw_mutex);
   if (column->is_disk_backed)
   {
+    // tec: read into the caller's arena, the column arena belongs to the writer
     U64 offset = index * column->size;
     OS_Handle file = column->file;
+    B32 temp_opened = 0;
     if (os_handle_match(os_handle_zero(), file))
     {
       file = os_file_open(OS_AccessFlag_Read, column->disk_path);
+      temp_opened = 1;
+    }
+    result = arena_push(arena, column->size, 8);
+    g_gdb_io_stats.bytes_read += os_file_read(file, r1u64(offset, offset + column->size), result);
+    if (temp_opened)
+    {
+      os_file_close(file);
     }
-    void* data = arena_push(column->arena, column->size, 8);
-    os_file_read(file, r1u64(offset, offset + column->size), data);
-    os_file_close(file);
-    return data;
   }
   else
   {
-    return (void*)(column->data + index * column->size);
+    result = (void*)(column->data + index * column->size);
   }
+  os_rw_mutex_drop_r(column->rw_mutex);
+  return result;
 }
 
 internal String8
@@ -1233,6 +2796,7 @@ gdb_column_get_string(Arena *arena, GDB_Column *column, U64 index)
   if (index >= column->row_count || column->type != GDB_ColumnType_String8)
     return result;
   
+  os_rw_mutex_take_r(column->rw_mutex);
   if (column->is_disk_backed)
   {
     OS_Handle file = column->file;
@@ -1265,6 +2829,7 @@ gdb_column_get_string(Arena *arena, GDB_Column *column, U64 index)
       U64 data_pos = sizeof(U64) + start;
       os_file_read(file, r1u64(data_pos, data_pos + size), result.str);
       result.size = size;
+      g_gdb_io_stats.bytes_read += size + 3 * sizeof(U64);
     }
     
     if (temp_opened)
@@ -1283,6 +2848,7 @@ gdb_column_get_string(Arena *arena, GDB_Column *column, U64 index)
       result.size = end - start;
     }
   }
+  os_rw_mutex_drop_r(column->rw_mutex);
   
   return result;
 }
@@ -1352,9 +2918,12 @@ gdb_column_get_data_range(Arena* arena, GDB_Column* column, Rng1U64 row_range, U
   U64 size = row_count * column->size;
   *out_size = size;
   
+  // tec: in memory buffers are never freed while the column lives, the pointer stays valid after growth
+  os_rw_mutex_take_r(column->rw_mutex);
   if (!column->is_disk_backed)
   {
     void* data_ptr = column->data + (row_range.min * column->size);
+    os_rw_mutex_drop_r(column->rw_mutex);
     ProfEnd();
     return data_ptr;
   }
@@ -1365,13 +2934,17 @@ gdb_column_get_data_range(Arena* arena, GDB_Column* column, Rng1U64 row_range, U
   {
     log_error("failed to open disk-backed column: %.*s", str8_varg(column->disk_path));
     *out_size = 0;
+    os_rw_mutex_drop_r(column->rw_mutex);
     ProfEnd();
     return NULL;
   }
   
   U64 offset = row_range.min * column->size;
   U64 expected_bytes = size;
+  U64 read_start_time = os_now_microseconds();
   U64 actual_bytes = os_file_read(file, r1u64(offset, offset + size), data_ptr);
+  g_gdb_io_stats.bytes_read += actual_bytes;
+  g_gdb_io_stats.read_time_us += os_now_microseconds() - read_start_time;
   
   if (actual_bytes != expected_bytes)
   {
@@ -1401,10 +2974,176 @@ gdb_column_get_data_range(Arena* arena, GDB_Column* column, Rng1U64 row_range, U
   */
   
   os_file_close(file);
+  os_rw_mutex_drop_r(column->rw_mutex);
   ProfEnd();
   return data_ptr;
 }
 
+//~ tec: chunk reads
+// tec: bytes a read of the rows takes, direct reads widen the range to GDB_DIRECT_IO_ALIGNMENT on both ends
+internal U64
+gdb_chunk_read_capacity(GDB_Column* column, Rng1U64 row_range, B32 direct)
+{
+  U64 start = row_range.min * column->size;
+  U64 end = row_range.max * column->size;
+  if (direct)
+  {
+    start = AlignDownPow2(start, GDB_DIRECT_IO_ALIGNMENT);
+    end = AlignPow2(end, GDB_DIRECT_IO_ALIGNMENT);
+  }
+  return end - start;
+}
+
+// tec: full scans read columns this large past the page cache, so one big scan does not push out the hot set.
+// fixed width only, so the size comes from the row count instead of asking the file system
+internal B32
+gdb_column_prefers_direct_io(GDB_Column* column)
+{
+  B32 result = (GDB_DIRECT_IO_MIN_COLUMN_SIZE > 0 && column->type != GDB_ColumnType_String8 && column->is_disk_backed &&
+                column->row_count * column->size >= GDB_DIRECT_IO_MIN_COLUMN_SIZE);
+  return result;
+}
+
+// tec: only fixed width disk-backed columns are queued, everything else is already in memory or read through
+// gdb_column_get_string_chunk. rows below row_count never move once a column is on disk, so the lock only
+// covers opening the file and queueing the reads, not their completion. the data lands in dst when given,
+// which must hold gdb_chunk_read_capacity bytes and be aligned for direct reads, otherwise in the arena.
+// returns whether the column was queued
+internal B32
+gdb_chunk_read_submit(Arena* arena, GDB_ChunkReadBatch* batch, GDB_Column* column, Rng1U64 row_range, B32 direct, void* dst)
+{
+  ProfBeginFunction();
+  
+  if (column->type == GDB_ColumnType_String8 || row_range.max < row_range.min || row_range.max > column->row_count)
+  {
+    ProfEnd();
+    return 0;
+  }
+  
+  B32 queued = 0;
+  U64 read_start_time = os_now_microseconds();
+  os_rw_mutex_take_r(column->rw_mutex);
+  if (column->is_disk_backed)
+  {
+    queued = 1;
+    GDB_ChunkRead* read = push_array(arena, GDB_ChunkRead, 1);
+    U64 offset = row_range.min * column->size;
+    U64 start = direct ? AlignDownPow2(offset, GDB_DIRECT_IO_ALIGNMENT) : offset;
+    read->column = column;
+    read->size = dim_1u64(row_range) * column->size;
+    read->span = gdb_chunk_read_capacity(column, row_range, direct);
+    read->head = offset - start;
+    read->buffer = dst ? (U8*)dst : (U8*)arena_push(arena, Max(1, read->span), direct ? GDB_DIRECT_IO_ALIGNMENT : 8);
+    read->data = read->buffer + read->head;
+    SLLQueuePush(batch->first, batch->last, read);
+    
+    U64 submitted = 0;
+    OS_AccessFlags flags = OS_AccessFlag_Read | OS_AccessFlag_Async | (direct ? OS_AccessFlag_Direct : 0);
+    read->file = os_file_open(flags, column->disk_path);
+    if (os_io_queue_add_file(batch->queue, read->file))
+    {
+      while (submitted < read->span)
+      {
+        U64 piece = Min(GDB_CHUNK_READ_PIECE_SIZE, read->span - submitted);
+        Rng1U64 range = r1u64(start + submitted, start + submitted + piece);
+        if (!os_io_queue_read(batch->queue, read->file, range, read->buffer + submitted, IntFromPtr(read)))
+        {
+          break;
+        }
+        read->pieces_pending++;
+        batch->pieces_pending++;
+        submitted += piece;
+      }
+    }
+    
+    //- tec: whatever could not be queued is read here, an async handle can not do plain reads so it gets its own.
+    // the tail of a direct span past the end of the file reads short, only the rows asked for have to arrive
+    if (submitted < read->span)
+    {
+      OS_Handle file = os_file_open(OS_AccessFlag_Read, column->disk_path);
+      if (os_handle_match(os_handle_zero(), file))
+      {
+        log_error("failed to open disk-backed column: %.*s", str8_varg(column->disk_path));
+        read->failed = 1;
+      }
+      else
+      {
+        read->bytes_read += os_file_read(file, r1u64(start + submitted, start + read->span), read->buffer + submitted);
+        os_file_close(file);
+      }
+    }
+  }
+  os_rw_mutex_drop_r(column->rw_mutex);
+  g_gdb_io_stats.read_time_us += os_now_microseconds() - read_start_time;
+  
+  ProfEnd();
+  return queued;
+}
+
+// tec: blocks until every queued piece of the batch is back, read_time_us counts only the time spent stalled here
+internal void
+gdb_chunk_read_wait(GDB_ChunkReadBatch* batch)
+{
+  ProfBeginFunction();
+  
+  U64 read_start_time = os_now_microseconds();
+  OS_IOCompletion completions[64];
+  while (batch->pieces_pending > 0)
+  {
+    U64 count = os_io_queue_wait(batch->queue, completions, ArrayCount(completions), max_U64);
+    if (count == 0)
+    {
+      log_error("io queue wait failed with %llu reads in flight", batch->pieces_pending);
+      break;
+    }
+    for (U64 i = 0; i < count; i++)
+    {
+      GDB_ChunkRead* read = (GDB_ChunkRead*)PtrFromInt(completions[i].user_data);
+      read->bytes_read += completions[i].bytes;
+      read->failed |= completions[i].failed;
+      read->pieces_pending--;
+      batch->pieces_pending--;
+    }
+  }
+  
+  for (GDB_ChunkRead* read = batch->first; read != NULL; read = read->next)
+  {
+    if (read->pieces_pending == 0)
+    {
+      os_file_close(read->file);
+      read->file = os_handle_zero();
+    }
+    if (read->bytes_read < read->head + read->size)
+    {
+      log_warn("Partial read for column %.*s: expected %llu bytes, got %llu",
+               str8_varg(read->column->name), read->head + read->size, read->bytes_read);
+      read->failed = 1;
+    }
+    g_gdb_io_stats.bytes_read += read->bytes_read;
+  }
+  g_gdb_io_stats.read_time_us += os_now_microseconds() - read_start_time;
+  
+  ProfEnd();
+}
+
+// tec: the column's data for the batch's rows, NULL when it was not queued or its read failed
+internal void*
+gdb_chunk_read_find(GDB_ChunkReadBatch* batch, GDB_Column* column, U64* out_size)
+{
+  void* result = NULL;
+  *out_size = 0;
+  for (GDB_ChunkRead* read = batch->first; read != NULL; read = read->next)
+  {
+    if (read->column == column && !read->failed)
+    {
+      result = read->data;
+      *out_size = read->size;
+      break;
+    }
+  }
+  return result;
+}
+
 internal GDB_StringDataChunk 
 gdb_column_get_string_chunk(Arena* arena, GDB_Column* column, Rng1U64 row_range)
 {
@@ -1422,19 +3161,19 @@ gdb_column_get_string_chunk(Arena* arena, GDB_Column* column, Rng1U64 row_range)
     return result;
   }
   
+  os_rw_mutex_take_r(column->rw_mutex);
   if (column->is_disk_backed)
   {
+    U64 read_start_time = os_now_microseconds();
     OS_Handle file = column->file;
     if (os_handle_match(os_handle_zero(), file))
     {
       file = os_file_open(OS_AccessFlag_Read, column->disk_path);
     }
-    OS_Handle file_map = column->file_map;
-    if (os_handle_match(os_handle_zero(), file_map))
-    {
-      file_map = os_file_map_open(OS_AccessFlag_Read, file);
-      column->file_map = file_map;
-    }
+    
+    // tec: each chunk maps the file itself, gdb_column_close_string_chunk releases it
+    OS_Handle file_map = os_file_map_open(OS_AccessFlag_Read, file);
+    result.file_map = file_map;
     
     U64 variable_reserved = 0;
     os_file_read(file, r1u64(0, sizeof(U64)), &variable_reserved);
@@ -1473,10 +3212,9 @@ gdb_column_get_string_chunk(Arena* arena, GDB_Column* column, Rng1U64 row_range)
       log_error("Failed to read string data for rows [%llu - %llu]", row_range.min, row_range.max);
     }
     */
-    column->mapped_ptr = os_file_map_view_open(file_map, OS_AccessFlag_Read, str_data_range);
-    result.data = column->mapped_ptr;
-    column->current_mapped_range = str_data_range;
-    if (column->mapped_ptr)
+    result.data = os_file_map_view_open(file_map, OS_AccessFlag_Read, str_data_range);
+    result.mapped_range = str_data_range;
+    if (result.data)
     {
       /*
       ProfBegin("memory copy");
@@ -1512,6 +3250,10 @@ gdb_column_get_string_chunk(Arena* arena, GDB_Column* column, Rng1U64 row_range)
     
     result.size = size;
     result.row_count = row_count;
+    
+    // tec: the string bytes are mapped, they count as read once the kernel upload touches them
+    g_gdb_io_stats.bytes_read += size + (row_count + 2) * sizeof(U64);
+    g_gdb_io_stats.read_time_us += os_now_microseconds() - read_start_time;
   }
   else
   {
@@ -1530,16 +3272,21 @@ gdb_column_get_string_chunk(Arena* arena, GDB_Column* column, Rng1U64 row_range)
       result.offsets[i] = (row_range.min + i > 0) ? column->offsets[row_range.min + i - 1] - start_offset : 0;
     }
   }
+  os_rw_mutex_drop_r(column->rw_mutex);
   
   ProfEnd();
   return result;
 }
 
 internal void
-gdb_column_close_string_chunk(GDB_Column* column)
+gdb_column_close_string_chunk(GDB_StringDataChunk* chunk)
 {
-  OS_Handle file_map = column->file_map;
-  os_file_map_view_close(file_map, column->mapped_ptr, column->current_mapped_range);
+  if (!os_handle_match(os_handle_zero(), chunk->file_map))
+  {
+    os_file_map_view_close(chunk->file_map, chunk->data, chunk->mapped_range);
+    os_file_map_close(chunk->file_map);
+    chunk->file_map = os_handle_zero();
+  }
 }
 
 internal String8
@@ -1577,6 +3324,9 @@ gdb_column_convert_to_disk_backed(GDB_Column* column)
 {
   ProfBeginFunction();
   
+  // tec: readers wait while the column moves to disk
+  os_rw_mutex_take_w(column->rw_mutex);
+  
   Temp scratch = scratch_begin(0, 0);
   String8 column_path = gdb_generate_disk_path_for_column(scratch.arena, column);
   OS_Handle file = os_file_open(OS_AccessFlag_Read | OS_AccessFlag_Write | OS_AccessFlag_Append, column_path);
@@ -1605,11 +3355,60 @@ gdb_column_convert_to_disk_backed(GDB_Column* column)
   column->capacity = 0;
   
   scratch_end(scratch);
+  os_rw_mutex_drop_w(column->rw_mutex);
   
   ProfEnd();
 }
 
 //~ tec: utils
+internal B32
+gdb_write_file_atomic(String8 path, String8List data)
+{
+  ProfBeginFunction();
+  
+  // tec: write next to the destination then rename over it, readers see the old or the new file, never half of one
+  Temp scratch = scratch_begin(0, 0);
+  String8 temp_path = push_str8f(scratch.arena, "%.*s" GDB_SAVE_TEMP_EXTENSION, str8_varg(path));
+  
+  B32 result = 0;
+  OS_Handle file = os_file_open(OS_AccessFlag_Write, temp_path);
+  if (!os_handle_match(os_handle_zero(), file))
+  {
+    result = 1;
+    U64 offset = 0;
+    for (String8Node* node = data.first; node != NULL; node = node->next)
+    {
+      U64 written = os_file_write(file, r1u64(offset, offset + node->string.size), node->string.str);
+      if (written != node->string.size)
+      {
+        result = 0;
+        break;
+      }
+      offset += written;
+    }
+    
+    result = result && os_file_flush(file);
+    os_file_close(file);
+    
+    if (result)
+    {
+      result = os_move_file_path(path, temp_path);
+    }
+    if (!result)
+    {
+      os_delete_file_at_path(temp_path);
+    }
+  }
+  else
+  {
+    log_error("failed to open temp file: %.*s", str8_varg(temp_path));
+  }
+  
+  scratch_end(scratch);
+  ProfEnd();
+  return result;
+}
+
 internal GDB_ColumnType
 gdb_column_type_from_string(String8 str)
 {
@@ -39,6 +39,12 @@
 #ifndef GDB_COLUMN_ARENA_COMMIT_SIZE
 #define GDB_COLUMN_ARENA_COMMIT_SIZE MB(32)
 #endif
+// tec: ArenaFlag_LargePages here commits the whole reserve of every column up front, so it is left to builds
+// for hosts with the memory for it. only in memory columns keep their data in the arena, past
+// GDB_DISK_BACKED_THRESHOLD_SIZE it moves to the column file
+#ifndef GDB_COLUMN_ARENA_FLAGS
+#define GDB_COLUMN_ARENA_FLAGS 0
+#endif
 #ifndef GDB_COLUMN_VARIABLE_CAPACITY_ALLOC_SIZE
 #define GDB_COLUMN_VARIABLE_CAPACITY_ALLOC_SIZE KB(4)
 #endif
@@ -50,6 +56,14 @@
 #define GDB_DISK_BACKED_THRESHOLD_SIZE KB(4)
 #endif
 
+#ifndef GDB_NULL_FILE_EXTENSION
+#define GDB_NULL_FILE_EXTENSION ".null"
+#endif
+
+#ifndef GDB_SAVE_TEMP_EXTENSION
+#define GDB_SAVE_TEMP_EXTENSION ".tmp"
+#endif
+
 typedef U32 GDB_ColumnType;
 enum
 {
@@ -87,6 +101,10 @@ struct GDB_StringDataChunk
   U64* offsets;
   U64 size;
   U64 row_count;
+  
+  // tec: disk backed chunks own their mapping so concurrent readers never share a view
+  OS_Handle file_map;
+  Rng1U64 mapped_range;
 };
 
 typedef struct GDB_Column GDB_Column;
@@ -110,10 +128,27 @@ struct GDB_Column
   B32 disk_backed_offset_initialized;
   String8 disk_path;
   OS_Handle file;
-  OS_Handle file_map;
   U64 mapped_size;
-  void* mapped_ptr;
-  Rng1U64 current_mapped_range;
+  
+  // tec: an imported Arrow file the column reads in place, mapped copy on write so changes stay private
+  void* adopted_view;
+  Rng1U64 adopted_range;
+  
+  // tec: reads take this shared. in memory growth copies into new buffers so it is never needed there,
+  // only conversion to disk and relocating the string offsets on disk take it exclusive
+  OS_Handle rw_mutex;
+  
+  // tec: null bitmap, one bit per row, a set bit means the row holds a value.
+  // stays NULL until the first null is added so columns without nulls cost nothing
+  U64* validity;
+  U64 validity_capacity;
+  U64 null_count;
+  
+  // tec: dirty tracking, the column needs flushing when version != flushed_version.
+  // logged_version marks changes that the write-ahead log already holds
+  U64 version;
+  U64 flushed_version;
+  U64 logged_version;
   
   struct GDB_Table* parent_table;
 };
@@ -126,9 +161,28 @@ struct GDB_Table
   String8 name;
   U64 column_count;
   U64 column_capacity;
-  U64 row_count;
   GDB_Column** columns;
   
+  // tec: row_count is the snapshot watermark, it only moves once every column holds the new row.
+  // readers take it with gdb_table_row_count and never look past it, writers append beyond it
+  U64 row_count;
+  
+  // tec: writers to the table take this, readers never do
+  OS_Handle write_mutex;
+  
+  // tec: dirty tracking for the meta file
+  U64 version;
+  U64 flushed_version;
+  U64 logged_version;
+  
+  // tec: last write-ahead log record applied to this table
+  U64 wal_lsn;
+  
+  // tec: secondary indexes, stored as <index name>.idx next to the column files
+  struct GDB_Index** indexes;
+  U64 index_count;
+  U64 index_capacity;
+  
   struct GDB_Database* parent_database;
 };
 
@@ -164,6 +218,12 @@ struct GDB_Database
   U64 table_count;
   U64 table_capacity;
   GDB_Table** tables;
+  
+  // tec: names of tables a statement is building and has not added yet, guarded by the state's rw mutex
+  String8List reserved_table_names;
+  String8Node* free_reserved_table_name;
+  
+  struct GDB_Wal* wal;
 };
 
 typedef struct GDB_State GDB_State;
@@ -175,20 +235,221 @@ struct GDB_State
   U64 database_count;
   U64 database_capacity;
   
+  // tec: guards the database list and each database's table list
   OS_Handle rw_mutex;
+  
+  // tec: one query loads a database while others wait for it, flushes share the thread pool one at a time
+  OS_Handle load_mutex;
+  OS_Handle flush_mutex;
+  
+  TP_Context* thread_pool;
+  TP_Arena* thread_pool_arena;
+  
+  // tec: columns are read by every scan worker, so they are spread over the numa nodes round robin
+  U64 next_column_numa_node;
+};
+
+// tec: one file flush, a column .dat, an index .idx or the table .meta when both are NULL
+typedef struct GDB_SaveTask GDB_SaveTask;
+struct GDB_SaveTask
+{
+  GDB_Table* table;
+  GDB_Column* column;
+  struct GDB_Index* index;
+  String8 table_dir;
+  U64 version;
+  B32 success;
+};
+
+typedef struct GDB_SaveTaskArray GDB_SaveTaskArray;
+struct GDB_SaveTaskArray
+{
+  GDB_SaveTask* v;
+  U64 count;
+};
+
+// tec: rows one export task formats, every column of the block is read in one go
+#if !defined(GDB_EXPORT_BLOCK_ROWS)
+#define GDB_EXPORT_BLOCK_ROWS (1 << 16)
+#endif
+
+// tec: one block of CSV rows, the segments are written out in block order once the wave finishes
+typedef struct GDB_ExportTask GDB_ExportTask;
+struct GDB_ExportTask
+{
+  GDB_Table* table;
+  Rng1U64 rows;
+  String8List output;
+  B32 success;
+};
+
+typedef struct GDB_ExportTaskArray GDB_ExportTaskArray;
+struct GDB_ExportTaskArray
+{
+  GDB_ExportTask* v;
+  U64 count;
+};
+
+// tec: input an import keeps in memory, every line has to fit in it
+#if !defined(GDB_IMPORT_RING_SIZE)
+#define GDB_IMPORT_RING_SIZE MB(64)
+#endif
+
+// tec: rows parsed into one block before it is appended to the columns
+#if !defined(GDB_IMPORT_BLOCK_ROWS)
+#define GDB_IMPORT_BLOCK_ROWS (1 << 16)
+#endif
+
+#if !defined(GDB_IMPORT_SAMPLE_ROWS)
+#define GDB_IMPORT_SAMPLE_ROWS 256
+#endif
+
+// tec: sequential input for an import, a file, a pipe or stdin ('-'). a reader thread fills the ring while
+// the import parses what is already in it, so the writer of a pipe is not held up by parsing.
+// positions are running totals, the ring holds the bytes [read_pos, write_pos)
+typedef struct GDB_ImportSource GDB_ImportSource;
+struct GDB_ImportSource
+{
+  Arena* arena;
+  String8 name;
+  OS_Handle handle;
+  B32 owns_handle;
+  
+  U8* ring;
+  U64 capacity;
+  U64 read_pos;
+  U64 write_pos;
+  B32 eof;
+  
+  // tec: whoever of the reader and close comes last frees the source, a read blocked on a pipe can not be cut short
+  OS_Handle mutex;
+  OS_Handle cv;
+  OS_Handle thread;
+  B32 closed;
+  B32 reader_done;
+  
+  //- tec: importing thread only. the last line handed out stays in the ring until the next call,
+  // one that wraps around the end of the ring is copied to line_buffer
+  U64 scan_pos;
+  U64 next_read_pos;
+  U8* line_buffer;
+  B32 failed;
+};
+
+// tec: parsed rows waiting to be appended to the table. one block fills while the other is appended on a flush
+// thread. values hold GDB_IMPORT_BLOCK_ROWS slots per column, strings as String8s into the arena, nulls as zero
+typedef struct GDB_ImportBlock GDB_ImportBlock;
+struct GDB_ImportBlock
+{
+  Arena* arena;
+  GDB_Table* table;
+  U64 row_count;
+  U8** values;
+  B8** valid;
+  
+  //- tec: appends to an existing table only, the raw lines are copied in and parsed on the thread pool
+  String8* lines;
+  U64 first_line;
+  B8* rejected;
+};
+
+// tec: rows one coerce task parses when appending to an existing table
+#if !defined(GDB_IMPORT_COERCE_TASK_ROWS)
+#define GDB_IMPORT_COERCE_TASK_ROWS (1 << 12)
+#endif
+
+// tec: one range of rows of an appended block, parsed and converted to the table's column types.
+// rows that do not fit are marked rejected and described in errors, one line of the error file each
+typedef struct GDB_ImportCoerceTask GDB_ImportCoerceTask;
+struct GDB_ImportCoerceTask
+{
+  Rng1U64 rows;
+  String8List errors;
+  U64 rejected_count;
+};
+
+// tec: field_columns maps each field of the input's header to a table column
+typedef struct GDB_ImportCoerceTaskArray GDB_ImportCoerceTaskArray;
+struct GDB_ImportCoerceTaskArray
+{
+  GDB_ImportCoerceTask* v;
+  U64 count;
+  GDB_ImportBlock* block;
+  U64* field_columns;
+  U64 field_count;
 };
 
 global GDB_State* g_gdb_state = 0;
 
+// tec: column data the calling thread read from disk, EXPLAIN ANALYZE takes the difference around each operator
+typedef struct GDB_IOStats GDB_IOStats;
+struct GDB_IOStats
+{
+  U64 bytes_read;
+  U64 read_time_us;
+};
+
+thread_static GDB_IOStats g_gdb_io_stats = { 0 };
+
+// tec: reads of a chunk's disk-backed columns, submitted together on one io queue so the device sees
+// all of them at once. reads are cut into pieces so a large column keeps several in flight
+#ifndef GDB_CHUNK_READ_PIECE_SIZE
+#define GDB_CHUNK_READ_PIECE_SIZE MB(8)
+#endif
+
+// tec: full scans read fixed width columns at least this large with direct io, 0 turns it off
+#ifndef GDB_DIRECT_IO_MIN_COLUMN_SIZE
+#define GDB_DIRECT_IO_MIN_COLUMN_SIZE MB(512)
+#endif
+// tec: offsets, sizes and buffers of direct reads are multiples of this, no disk in use has larger sectors
+#ifndef GDB_DIRECT_IO_ALIGNMENT
+#define GDB_DIRECT_IO_ALIGNMENT KB(4)
+#endif
+
+typedef struct GDB_ChunkRead GDB_ChunkRead;
+struct GDB_ChunkRead
+{
+  GDB_ChunkRead* next;
+  GDB_Column* column;
+  OS_Handle file;
+  
+  // tec: the read covers span bytes of buffer, the rows asked for start head bytes in, at data
+  U8* buffer;
+  U64 span;
+  U64 head;
+  U8* data;
+  U64 size;
+  U64 bytes_read;
+  U64 pieces_pending;
+  B32 failed;
+};
+
+typedef struct GDB_ChunkReadBatch GDB_ChunkReadBatch;
+struct GDB_ChunkReadBatch
+{
+  OS_Handle queue;
+  GDB_ChunkRead* first;
+  GDB_ChunkRead* last;
+  U64 pieces_pending;
+};
+
 internal void gdb_init(void);
 internal void gdb_add_database(GDB_Database* database);
+internal GDB_Database* gdb_find_database(String8 name);
+internal GDB_Database* gdb_find_or_load_database(String8 name, String8 directory);
 
 //~ tec: databases
 
 internal GDB_Database* gdb_database_alloc(String8 name);
 internal void gdb_database_release(GDB_Database* database);
 internal void gdb_database_add_table(GDB_Database* database, GDB_Table* table);
+internal GDB_Table* gdb_database_find_or_reserve_table(GDB_Database* database, String8 table_name, B32* out_reserved);
+internal void gdb_database_add_reserved_table(GDB_Database* database, String8 table_name, GDB_Table* table);
+internal void gdb_database_drop_reserved_table(GDB_Database* database, String8 table_name);
+internal void gdb_database_unreserve_table_name(GDB_Database* database, String8 table_name);
+internal void gdb_database_push_table(GDB_Database* database, GDB_Table* table);
 internal B32 gdb_database_save(GDB_Database* database, String8 directory);
+internal B32 gdb_database_flush(GDB_Database* database, String8 directory, B32 include_logged);
 internal GDB_Database* gdb_database_load(String8 directory);
 internal void gdb_database_close(GDB_Database* database);
 internal GDB_Table* gdb_database_find_table(GDB_Database* database, String8 table_name);
@@ -199,32 +460,72 @@ internal void gdb_table_release(GDB_Table* table);
 internal void gdb_table_add_column(GDB_Table* table, GDB_ColumnSchema schema);
 internal void gdb_table_add_row(GDB_Table* table, void** row_data);
 internal void gdb_table_remove_row(GDB_Table* table, U64 row_index);
+internal U64 gdb_table_row_count(GDB_Table* table);
 internal B32 gdb_table_save(GDB_Table* table, String8 table_dir);
+internal B32 gdb_table_is_dirty(GDB_Table* table);
+internal B32 gdb_table_has_unlogged_changes(GDB_Table* table);
+internal void gdb_table_mark_dirty(GDB_Table* table);
+internal B32 gdb_tables_flush(GDB_Table** tables, String8* table_dirs, U64 table_count);
 internal B32 gdb_table_export_csv(GDB_Table* table, String8 path);
+internal U8* gdb_table_export_string_block(Arena* arena, GDB_Column* column, Rng1U64 rows, U64** out_bounds);
 internal GDB_Table* gdb_table_load(String8 table_dir, String8 meta_path);
 internal GDB_Table* gdb_table_import_csv(GDB_Database* database, String8 path);
 internal GDB_Table* gdb_table_import_csv_streaming(GDB_Database *db, String8 table_name, String8 path);
+
+internal GDB_ImportSource* gdb_import_source_open(String8 path);
+internal void gdb_import_source_close(GDB_ImportSource* source);
+internal void gdb_import_source_free(GDB_ImportSource* source);
+internal void gdb_import_source_thread(void* ptr);
+internal String8 gdb_import_source_head(GDB_ImportSource* source);
+internal B32 gdb_import_source_next_line(GDB_ImportSource* source, String8* out_line);
+internal void gdb_import_block_push_row(GDB_ImportBlock* block, String8* fields, U64 field_count);
+internal void gdb_import_block_append(GDB_ImportBlock* block);
+internal void gdb_import_block_flush_thread(void* ptr);
+internal B32 gdb_import_coerce_value(GDB_ColumnType type, String8 value, U8* dst, String8* out_reason);
+internal void gdb_import_block_compact(GDB_ImportBlock* block);
+internal void gdb_import_block_publish(GDB_ImportBlock* block);
+internal void gdb_import_block_append_thread(void* ptr);
+internal B32 gdb_table_import_csv_append(GDB_Table* table, String8 path);
 internal GDB_Column* gdb_table_find_column(GDB_Table* table, String8 column_name);
 
 //~ tec: columns
 internal GDB_Column* gdb_column_alloc(String8 name, GDB_ColumnType type, U64 size);
 internal void gdb_column_release(GDB_Column* column);
 internal void gdb_column_close(GDB_Column* column);
+internal void gdb_column_mark_dirty(GDB_Column* column);
+internal B32 gdb_column_is_dirty(GDB_Column* column);
+internal B32 gdb_column_has_unlogged_changes(GDB_Column* column);
+internal B32 gdb_column_save(GDB_Column* column, String8 table_dir);
 
 internal String8 gdb_column_get_string(Arena* arena, GDB_Column* column, U64 index);
 internal U64 gdb_column_get_total_size(GDB_Column* column);
 
 internal void gdb_column_add_data_disk_backed(GDB_Column* column, void* data);
 internal void gdb_column_add_data(GDB_Column* column, void* data);
-internal void* gdb_column_get_data(GDB_Column* column, U64 index);
+internal void gdb_column_add_values(GDB_Column* column, void* values, B8* valid, U64 count);
+internal void* gdb_column_get_data(Arena* arena, GDB_Column* column, U64 index);
 internal void gdb_column_remove_data(GDB_Column* column, U64 row_index);
+internal void gdb_column_set_valid(GDB_Column* column, U64 row_index, B32 is_valid);
+internal B32 gdb_column_is_null(GDB_Column* column, U64 row_index);
+internal B32 gdb_column_has_nulls(GDB_Column* column);
+internal U64* gdb_column_get_validity_range(Arena* arena, GDB_Column* column, Rng1U64 row_range, U64* out_size);
+internal B32 gdb_column_save_validity(GDB_Column* column, String8 table_dir);
+internal void gdb_column_load_validity(GDB_Column* column, String8 table_dir);
 internal void* gdb_column_get_data_range(Arena* arena, GDB_Column* column, Rng1U64 row_range, U64* out_size);
 internal GDB_StringDataChunk gdb_column_get_string_chunk(Arena* arena, GDB_Column* column, Rng1U64 row_range);
+internal void gdb_column_close_string_chunk(GDB_StringDataChunk* chunk);
+
+internal U64 gdb_chunk_read_capacity(GDB_Column* column, Rng1U64 row_range, B32 direct);
+internal B32 gdb_column_prefers_direct_io(GDB_Column* column);
+internal B32 gdb_chunk_read_submit(Arena* arena, GDB_ChunkReadBatch* batch, GDB_Column* column, Rng1U64 row_range, B32 direct, void* dst);
+internal void gdb_chunk_read_wait(GDB_ChunkReadBatch* batch);
+internal void* gdb_chunk_read_find(GDB_ChunkReadBatch* batch, GDB_Column* column, U64* out_size);
 
 internal String8 gdb_generate_disk_path_for_column(Arena* arena, GDB_Column* column);
 internal void gdb_column_convert_to_disk_backed(GDB_Column* column);
 
 //~ tec: utils
+internal B32 gdb_write_file_atomic(String8 path, String8List data);
 internal GDB_ColumnType gdb_column_type_from_string(String8 str);
 internal String8 string_from_gdb_column_type(GDB_ColumnType type);
 internal GDB_ColumnSchema gdb_column_schema_create(String8 name, GDB_ColumnType type);
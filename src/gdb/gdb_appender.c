@@ -0,0 +1,285 @@
+internal GDB_Appender*
+gdb_appender_open(GDB_Table* table)
+{
+  ProfBeginFunction();
+  
+  // tec: appended columns move to disk under their database's folder, a table outside any database has none
+  if (table->parent_database == NULL)
+  {
+    log_error("table '%.*s' belongs to no database, rows can not be appended to it", str8_varg(table->name));
+    ProfEnd();
+    return 0;
+  }
+  
+  Arena* arena = arena_alloc(.reserve_size = GDB_APPENDER_ARENA_RESERVE_SIZE, .commit_size = GDB_APPENDER_ARENA_COMMIT_SIZE);
+  GDB_Appender* appender = push_array(arena, GDB_Appender, 1);
+  appender->arena = arena;
+  appender->table = table;
+  appender->column_count = table->column_count;
+  
+  GDB_ImportBlock* batch = &appender->batch;
+  batch->arena = arena_alloc(.reserve_size = GDB_APPENDER_ARENA_RESERVE_SIZE, .commit_size = GDB_APPENDER_ARENA_COMMIT_SIZE);
+  batch->table = table;
+  batch->values = push_array(arena, U8*, appender->column_count);
+  batch->valid = push_array(arena, B8*, appender->column_count);
+  for (U64 col_i = 0; col_i < appender->column_count; col_i++)
+  {
+    batch->values[col_i] = push_array_no_zero(arena, U8, GDB_APPENDER_BATCH_ROWS * table->columns[col_i]->size);
+    batch->valid[col_i] = push_array_no_zero(arena, B8, GDB_APPENDER_BATCH_ROWS);
+  }
+  
+  ProfEnd();
+  return appender;
+}
+
+// tec: publishes what is left, the appender is gone afterwards either way
+internal B32
+gdb_appender_close(GDB_Appender* appender)
+{
+  B32 result = gdb_appender_flush(appender);
+  log_info("appender on table %.*s appended %llu rows", str8_varg(appender->table->name), appender->appended_row_count);
+  arena_release(appender->batch.arena);
+  arena_release(appender->arena);
+  return result;
+}
+
+internal B32
+gdb_appender_schema_matches(GDB_Appender* appender)
+{
+  if (!appender->failed && appender->table->column_count != appender->column_count)
+  {
+    log_error("table '%.*s' changed its columns while an appender was open, its rows are refused", str8_varg(appender->table->name));
+    appender->failed = 1;
+  }
+  return !appender->failed;
+}
+
+internal B32
+gdb_appender_flush(GDB_Appender* appender)
+{
+  ProfBeginFunction();
+  
+  GDB_ImportBlock* batch = &appender->batch;
+  B32 result = gdb_appender_schema_matches(appender);
+  if (result && batch->row_count > 0)
+  {
+    result = gdb_table_insert_block(batch);
+    appender->appended_row_count += result ? batch->row_count : 0;
+    appender->failed |= !result;
+  }
+  batch->row_count = 0;
+  arena_clear(batch->arena);
+  
+  ProfEnd();
+  return result;
+}
+
+// tec: one value into the batch, NULL is a null. a null fixed size value is stored as zero
+internal void
+gdb_appender_put_value(GDB_Appender* appender, U64 col_i, U64 row, void* value)
+{
+  GDB_ImportBlock* batch = &appender->batch;
+  GDB_Column* column = appender->table->columns[col_i];
+  U8* dst = batch->values[col_i] + row * column->size;
+  
+  batch->valid[col_i][row] = (value != 0);
+  if (value == 0)
+  {
+    MemoryZero(dst, column->size);
+  }
+  else if (column->type == GDB_ColumnType_String8)
+  {
+    String8 copy = push_str8_copy(batch->arena, *(String8*)value);
+    MemoryCopy(dst, &copy, sizeof(copy));
+  }
+  else
+  {
+    MemoryCopy(dst, value, column->size);
+  }
+}
+
+// tec: row_data holds a pointer per column the way gdb_table_add_row takes it
+internal B32
+gdb_appender_append_row(GDB_Appender* appender, void** row_data)
+{
+  if (appender->failed)
+  {
+    return 0;
+  }
+  
+  GDB_ImportBlock* batch = &appender->batch;
+  for (U64 col_i = 0; col_i < appender->column_count; col_i++)
+  {
+    gdb_appender_put_value(appender, col_i, batch->row_count, row_data[col_i]);
+  }
+  batch->row_count++;
+  
+  B32 result = 1;
+  if (batch->row_count == GDB_APPENDER_BATCH_ROWS)
+  {
+    result = gdb_appender_flush(appender);
+  }
+  return result;
+}
+
+// tec: columns holds one array of row_count values per column. valid is optional, as is each column's entry,
+// a missing one means the column has no nulls in this call
+internal B32
+gdb_appender_append_columns(GDB_Appender* appender, void** columns, B8** valid, U64 row_count)
+{
+  ProfBeginFunction();
+  
+  GDB_ImportBlock* batch = &appender->batch;
+  GDB_Table* table = appender->table;
+  B32 result = !appender->failed;
+  
+  //- tec: a full batch or more skips the copy, the caller's arrays are appended as they are. a fixed size
+  // column with nulls is the exception, it is copied so the values under its nulls can be zeroed
+  if (result && row_count >= GDB_APPENDER_BATCH_ROWS)
+  {
+    result = gdb_appender_flush(appender);
+    if (result)
+    {
+      GDB_ImportBlock direct = { 0 };
+      direct.table = table;
+      direct.row_count = row_count;
+      direct.values = push_array_no_zero(batch->arena, U8*, appender->column_count);
+      direct.valid = valid;
+      for (U64 col_i = 0; col_i < appender->column_count; col_i++)
+      {
+        GDB_Column* column = table->columns[col_i];
+        B8* src_valid = valid ? valid[col_i] : 0;
+        direct.values[col_i] = (U8*)columns[col_i];
+        
+        U64 first_null = 0;
+        for (; src_valid && first_null < row_count && src_valid[first_null]; first_null++);
+        if (src_valid && first_null < row_count && column->type != GDB_ColumnType_String8)
+        {
+          U8* copy = push_array_no_zero(batch->arena, U8, row_count * column->size);
+          MemoryCopy(copy, columns[col_i], row_count * column->size);
+          for (U64 i = first_null; i < row_count; i++)
+          {
+            if (!src_valid[i])
+            {
+              MemoryZero(copy + i * column->size, column->size);
+            }
+          }
+          direct.values[col_i] = copy;
+        }
+      }
+      
+      result = gdb_table_insert_block(&direct);
+      appender->appended_row_count += result ? row_count : 0;
+      appender->failed |= !result;
+      arena_clear(batch->arena);
+    }
+    
+    ProfEnd();
+    return result;
+  }
+  
+  //- tec: smaller calls are gathered into the batch
+  for (U64 row = 0; row < row_count && result;)
+  {
+    U64 take = Min(row_count - row, GDB_APPENDER_BATCH_ROWS - batch->row_count);
+    for (U64 col_i = 0; col_i < appender->column_count; col_i++)
+    {
+      GDB_Column* column = table->columns[col_i];
+      B8* src_valid = valid ? valid[col_i] : 0;
+      B8* dst_valid = batch->valid[col_i] + batch->row_count;
+      U8* src = (U8*)columns[col_i] + row * column->size;
+      U8* dst = batch->values[col_i] + batch->row_count * column->size;
+      
+      if (src_valid)
+      {
+        MemoryCopy(dst_valid, src_valid + row, take);
+      }
+      else
+      {
+        MemorySet(dst_valid, 1, take);
+      }
+      
+      if (column->type == GDB_ColumnType_String8)
+      {
+        for (U64 i = 0; i < take; i++)
+        {
+          String8 copy = dst_valid[i] ? push_str8_copy(batch->arena, ((String8*)src)[i]) : str8_zero();
+          MemoryCopy(dst + i * sizeof(String8), &copy, sizeof(copy));
+        }
+      }
+      else
+      {
+        MemoryCopy(dst, src, take * column->size);
+        for (U64 i = 0; src_valid && i < take; i++)
+        {
+          if (!dst_valid[i])
+          {
+            MemoryZero(dst + i * column->size, column->size);
+          }
+        }
+      }
+    }
+    
+    batch->row_count += take;
+    row += take;
+    if (batch->row_count == GDB_APPENDER_BATCH_ROWS)
+    {
+      result = gdb_appender_flush(appender);
+    }
+  }
+  
+  ProfEnd();
+  return result;
+}
+
+// tec: rows is an array of row_count structs, row_size apart. field_offsets has the offset of each column's
+// field in the struct, see GDB_AppenderField. struct fields have no nulls
+internal B32
+gdb_appender_append_structs(GDB_Appender* appender, void* rows, U64 row_size, U64* field_offsets, U64 row_count)
+{
+  ProfBeginFunction();
+  
+  GDB_ImportBlock* batch = &appender->batch;
+  GDB_Table* table = appender->table;
+  B32 result = !appender->failed;
+  
+  for (U64 row = 0; row < row_count && result;)
+  {
+    U64 take = Min(row_count - row, GDB_APPENDER_BATCH_ROWS - batch->row_count);
+    
+    // tec: column by column, so each column of the batch is written front to back
+    for (U64 col_i = 0; col_i < appender->column_count; col_i++)
+    {
+      GDB_Column* column = table->columns[col_i];
+      U8* src = (U8*)rows + row * row_size + field_offsets[col_i];
+      U8* dst = batch->values[col_i] + batch->row_count * column->size;
+      MemorySet(batch->valid[col_i] + batch->row_count, 1, take);
+      
+      if (column->type == GDB_ColumnType_String8)
+      {
+        for (U64 i = 0; i < take; i++)
+        {
+          String8 copy = push_str8_copy(batch->arena, *(String8*)(src + i * row_size));
+          MemoryCopy(dst + i * sizeof(String8), &copy, sizeof(copy));
+        }
+      }
+      else
+      {
+        for (U64 i = 0; i < take; i++)
+        {
+          MemoryCopy(dst + i * column->size, src + i * row_size, column->size);
+        }
+      }
+    }
+    
+    batch->row_count += take;
+    row += take;
+    if (batch->row_count == GDB_APPENDER_BATCH_ROWS)
+    {
+      result = gdb_appender_flush(appender);
+    }
+  }
+  
+  ProfEnd();
+  return result;
+}
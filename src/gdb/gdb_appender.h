@@ -0,0 +1,52 @@
+/* date = October 19th 2026 10:05 pm */
+
+#ifndef GDB_APPENDER_H
+#define GDB_APPENDER_H
+
+// tec: rows an appender holds before they are published to the table
+#ifndef GDB_APPENDER_BATCH_ROWS
+#define GDB_APPENDER_BATCH_ROWS (1 << 16)
+#endif
+#ifndef GDB_APPENDER_ARENA_RESERVE_SIZE
+#define GDB_APPENDER_ARENA_RESERVE_SIZE GB(1)
+#endif
+#ifndef GDB_APPENDER_ARENA_COMMIT_SIZE
+#define GDB_APPENDER_ARENA_COMMIT_SIZE MB(1)
+#endif
+
+// tec: offset of a row struct's field, for gdb_appender_append_structs
+#define GDB_AppenderField(T, m) ((U64)OffsetOf(T, m))
+
+// tec: bulk inserts for programs that embed the database, typed values go straight into the columns without
+// being printed to SQL and parsed back. values are in the column's type, String8 for strings, one array per
+// column in table order. rows are batched and published together under the table's write mutex, so readers see
+// whole batches. one appender belongs to one thread, appenders on the same table take turns. the table has to
+// belong to a database, gdb_appender_open refuses one that does not.
+// each published batch is one write-ahead log record, like an INSERT of its rows. a call that publishes returns
+// once its batch is durable, rows still held in the batch are not until gdb_appender_flush or close.
+// a batch the log refuses is not added and the appender fails from then on
+typedef struct GDB_Appender GDB_Appender;
+struct GDB_Appender
+{
+  Arena* arena;
+  GDB_Table* table;
+  
+  // tec: the schema at open, a table altered while an appender is open refuses its batches
+  U64 column_count;
+  
+  // tec: strings are copied into the batch's arena, the caller's buffers can be reused once a call returns
+  GDB_ImportBlock batch;
+  U64 appended_row_count;
+  B32 failed;
+};
+
+internal GDB_Appender* gdb_appender_open(GDB_Table* table);
+internal B32 gdb_appender_close(GDB_Appender* appender);
+internal B32 gdb_appender_flush(GDB_Appender* appender);
+internal B32 gdb_appender_schema_matches(GDB_Appender* appender);
+internal void gdb_appender_put_value(GDB_Appender* appender, U64 col_i, U64 row, void* value);
+internal B32 gdb_appender_append_row(GDB_Appender* appender, void** row_data);
+internal B32 gdb_appender_append_columns(GDB_Appender* appender, void** columns, B8** valid, U64 row_count);
+internal B32 gdb_appender_append_structs(GDB_Appender* appender, void* rows, U64 row_size, U64* field_offsets, U64 row_count);
+
+#endif //GDB_APPENDER_H
@@ -0,0 +1,1110 @@
+//~ tec: flatbuffer reading
+internal U64
+gdb_arrow_fb_read(String8 data, U64 pos, U64 size)
+{
+  U64 result = 0;
+  if (pos <= data.size && size <= data.size - pos)
+  {
+    MemoryCopy(&result, data.str + pos, size);
+  }
+  return result;
+}
+
+internal GDB_ArrowFBTable
+gdb_arrow_fb_root(String8 data)
+{
+  GDB_ArrowFBTable result = { data, 0 };
+  U64 pos = gdb_arrow_fb_read(data, 0, sizeof(U32));
+  if (pos >= sizeof(U32) && pos < data.size)
+  {
+    result.pos = pos;
+  }
+  return result;
+}
+
+internal U64
+gdb_arrow_fb_field_pos(GDB_ArrowFBTable table, U64 field)
+{
+  if (table.pos == 0)
+  {
+    return 0;
+  }
+  
+  // tec: the table starts with a signed offset back to its vtable, [vtable size][table size][field offsets]
+  S64 vtable_offset = (S32)gdb_arrow_fb_read(table.data, table.pos, sizeof(S32));
+  S64 vtable_pos = (S64)table.pos - vtable_offset;
+  if (vtable_pos < 0 || (U64)vtable_pos >= table.data.size)
+  {
+    return 0;
+  }
+  
+  U64 vtable_size = gdb_arrow_fb_read(table.data, vtable_pos, sizeof(U16));
+  U64 entry_pos = 4 + field * sizeof(U16);
+  if (entry_pos + sizeof(U16) > vtable_size)
+  {
+    return 0;
+  }
+  
+  U64 field_offset = gdb_arrow_fb_read(table.data, vtable_pos + entry_pos, sizeof(U16));
+  U64 result = (field_offset != 0) ? table.pos + field_offset : 0;
+  return result;
+}
+
+internal U64
+gdb_arrow_fb_scalar(GDB_ArrowFBTable table, U64 field, U64 size, U64 default_value)
+{
+  U64 pos = gdb_arrow_fb_field_pos(table, field);
+  U64 result = (pos != 0) ? gdb_arrow_fb_read(table.data, pos, size) : default_value;
+  return result;
+}
+
+internal U64
+gdb_arrow_fb_follow(String8 data, U64 pos)
+{
+  U64 result = 0;
+  if (pos != 0)
+  {
+    U64 target = pos + gdb_arrow_fb_read(data, pos, sizeof(U32));
+    result = (target > pos && target < data.size) ? target : 0;
+  }
+  return result;
+}
+
+internal GDB_ArrowFBTable
+gdb_arrow_fb_table(GDB_ArrowFBTable table, U64 field)
+{
+  GDB_ArrowFBTable result = { table.data, 0 };
+  result.pos = gdb_arrow_fb_follow(table.data, gdb_arrow_fb_field_pos(table, field));
+  return result;
+}
+
+internal GDB_ArrowFBVector
+gdb_arrow_fb_vector(GDB_ArrowFBTable table, U64 field, U64 element_size)
+{
+  GDB_ArrowFBVector result = { table.data, 0, 0 };
+  U64 pos = gdb_arrow_fb_follow(table.data, gdb_arrow_fb_field_pos(table, field));
+  if (pos != 0)
+  {
+    U64 count = gdb_arrow_fb_read(table.data, pos, sizeof(U32));
+    U64 elements_pos = pos + sizeof(U32);
+    if (elements_pos <= table.data.size && count <= (table.data.size - elements_pos) / element_size)
+    {
+      result.pos = elements_pos;
+      result.count = count;
+    }
+  }
+  return result;
+}
+
+internal GDB_ArrowFBTable
+gdb_arrow_fb_vector_table(GDB_ArrowFBVector vector, U64 index)
+{
+  GDB_ArrowFBTable result = { vector.data, 0 };
+  if (index < vector.count)
+  {
+    result.pos = gdb_arrow_fb_follow(vector.data, vector.pos + index * sizeof(U32));
+  }
+  return result;
+}
+
+internal B32
+gdb_arrow_fb_vector_struct(GDB_ArrowFBVector vector, U64 index, void* out, U64 element_size)
+{
+  B32 result = (index < vector.count);
+  if (result)
+  {
+    MemoryCopy(out, vector.data.str + vector.pos + index * element_size, element_size);
+  }
+  return result;
+}
+
+internal String8
+gdb_arrow_fb_string(GDB_ArrowFBTable table, U64 field)
+{
+  String8 result = {0};
+  U64 pos = gdb_arrow_fb_follow(table.data, gdb_arrow_fb_field_pos(table, field));
+  if (pos != 0)
+  {
+    U64 size = gdb_arrow_fb_read(table.data, pos, sizeof(U32));
+    if (pos + sizeof(U32) <= table.data.size && size <= table.data.size - pos - sizeof(U32))
+    {
+      result = str8(table.data.str + pos + sizeof(U32), size);
+    }
+  }
+  return result;
+}
+
+//~ tec: flatbuffer writing
+internal U64
+gdb_arrow_fb_push(GDB_ArrowFBBuilder* builder, void* data, U64 size, U64 align)
+{
+  U64 pos = AlignPow2(builder->size, align);
+  if (pos + size > builder->capacity)
+  {
+    U64 new_capacity = Max(KB(4), Max(builder->capacity * 2, pos + size));
+    U8* new_data = push_array(builder->arena, U8, new_capacity);
+    if (builder->data)
+    {
+      MemoryCopy(new_data, builder->data, builder->size);
+    }
+    builder->data = new_data;
+    builder->capacity = new_capacity;
+  }
+  
+  MemoryZero(builder->data + builder->size, pos - builder->size);
+  if (data)
+  {
+    MemoryCopy(builder->data + pos, data, size);
+  }
+  else
+  {
+    MemoryZero(builder->data + pos, size);
+  }
+  builder->size = pos + size;
+  return pos;
+}
+
+internal U64
+gdb_arrow_fb_push_table(GDB_ArrowFBBuilder* builder, GDB_ArrowFBField* fields, U64 field_count)
+{
+  Temp scratch = scratch_begin(&builder->arena, 1);
+  
+  //- tec: widest fields first, the table starts 4 past an 8 byte boundary so 8 byte fields land aligned
+  U16* vtable = push_array(scratch.arena, U16, 2 + field_count);
+  U64* field_offsets = push_array(scratch.arena, U64, field_count);
+  U64 table_size = sizeof(S32);
+  for (U64 size = 8; size >= 1; size /= 2)
+  {
+    for (U64 i = 0; i < field_count; i++)
+    {
+      if (fields[i].size == size)
+      {
+        field_offsets[i] = table_size;
+        table_size += size;
+      }
+    }
+  }
+  
+  vtable[0] = (U16)((2 + field_count) * sizeof(U16));
+  vtable[1] = (U16)table_size;
+  for (U64 i = 0; i < field_count; i++)
+  {
+    vtable[2 + i] = (U16)((fields[i].size != 0) ? field_offsets[i] : 0);
+  }
+  U64 vtable_pos = gdb_arrow_fb_push(builder, vtable, vtable[0], sizeof(U16));
+  
+  if ((builder->size & 7) != 4)
+  {
+    gdb_arrow_fb_push(builder, 0, (4 - (builder->size & 7)) & 7, 1);
+  }
+  
+  U64 table_pos = builder->size;
+  S32 vtable_offset = (S32)(table_pos - vtable_pos);
+  gdb_arrow_fb_push(builder, &vtable_offset, sizeof(vtable_offset), 1);
+  for (U64 size = 8; size >= 1; size /= 2)
+  {
+    for (U64 i = 0; i < field_count; i++)
+    {
+      if (fields[i].size == size)
+      {
+        fields[i].pos = gdb_arrow_fb_push(builder, &fields[i].value, size, 1);
+      }
+    }
+  }
+  
+  scratch_end(scratch);
+  return table_pos;
+}
+
+internal U64
+gdb_arrow_fb_push_vector(GDB_ArrowFBBuilder* builder, void* elements, U64 count, U64 element_size)
+{
+  // tec: the length sits right before the elements, which start on an 8 byte boundary
+  if ((builder->size & 7) != 4)
+  {
+    gdb_arrow_fb_push(builder, 0, (4 - (builder->size & 7)) & 7, 1);
+  }
+  
+  U32 length = (U32)count;
+  U64 result = gdb_arrow_fb_push(builder, &length, sizeof(length), 1);
+  gdb_arrow_fb_push(builder, elements, count * element_size, 1);
+  return result;
+}
+
+internal U64
+gdb_arrow_fb_push_string(GDB_ArrowFBBuilder* builder, String8 string)
+{
+  U32 length = (U32)string.size;
+  U64 result = gdb_arrow_fb_push(builder, &length, sizeof(length), sizeof(U32));
+  gdb_arrow_fb_push(builder, string.str, string.size, 1);
+  gdb_arrow_fb_push(builder, 0, 1, 1);
+  return result;
+}
+
+internal void
+gdb_arrow_fb_patch(GDB_ArrowFBBuilder* builder, U64 at, U64 target)
+{
+  U32 offset = (U32)(target - at);
+  MemoryCopy(builder->data + at, &offset, sizeof(offset));
+}
+
+//~ tec: messages
+internal U64
+gdb_arrow_push_schema(GDB_ArrowFBBuilder* builder, GDB_Table* table)
+{
+  // tec: Schema { endianness, fields }
+  GDB_ArrowFBField schema_fields[] = { { sizeof(S16), 0 }, { sizeof(U32), 0 } };
+  U64 schema_pos = gdb_arrow_fb_push_table(builder, schema_fields, ArrayCount(schema_fields));
+  U64 fields_pos = gdb_arrow_fb_push_vector(builder, 0, table->column_count, sizeof(U32));
+  gdb_arrow_fb_patch(builder, schema_fields[1].pos, fields_pos);
+  
+  for (U64 i = 0; i < table->column_count; i++)
+  {
+    GDB_Column* column = table->columns[i];
+    
+    GDB_ArrowType type = GDB_ArrowType_LargeUtf8;
+    if (column->type == GDB_ColumnType_U32 || column->type == GDB_ColumnType_U64)
+    {
+      type = GDB_ArrowType_Int;
+    }
+    else if (column->type == GDB_ColumnType_F32 || column->type == GDB_ColumnType_F64)
+    {
+      type = GDB_ArrowType_FloatingPoint;
+    }
+    
+    // tec: Field { name, nullable, type_type, type, dictionary, children }, readers expect children even when empty
+    GDB_ArrowFBField field_fields[] =
+    {
+      { sizeof(U32), 0 },
+      { sizeof(U8), 1 },
+      { sizeof(U8), type },
+      { sizeof(U32), 0 },
+      { 0, 0 },
+      { sizeof(U32), 0 },
+    };
+    U64 field_pos = gdb_arrow_fb_push_table(builder, field_fields, ArrayCount(field_fields));
+    gdb_arrow_fb_patch(builder, fields_pos + sizeof(U32) + i * sizeof(U32), field_pos);
+    gdb_arrow_fb_patch(builder, field_fields[0].pos, gdb_arrow_fb_push_string(builder, column->name));
+    
+    // tec: Int { bitWidth, is_signed }, FloatingPoint { precision }, LargeUtf8 {}
+    U64 type_pos = 0;
+    if (type == GDB_ArrowType_Int)
+    {
+      GDB_ArrowFBField type_fields[] = { { sizeof(S32), column->size * 8 }, { sizeof(U8), 0 } };
+      type_pos = gdb_arrow_fb_push_table(builder, type_fields, ArrayCount(type_fields));
+    }
+    else if (type == GDB_ArrowType_FloatingPoint)
+    {
+      GDB_ArrowPrecision precision = (column->type == GDB_ColumnType_F32) ? GDB_ArrowPrecision_Single : GDB_ArrowPrecision_Double;
+      GDB_ArrowFBField type_fields[] = { { sizeof(S16), precision } };
+      type_pos = gdb_arrow_fb_push_table(builder, type_fields, ArrayCount(type_fields));
+    }
+    else
+    {
+      type_pos = gdb_arrow_fb_push_table(builder, 0, 0);
+    }
+    gdb_arrow_fb_patch(builder, field_fields[3].pos, type_pos);
+    gdb_arrow_fb_patch(builder, field_fields[5].pos, gdb_arrow_fb_push_vector(builder, 0, 0, sizeof(U32)));
+  }
+  
+  return schema_pos;
+}
+
+internal String8
+gdb_arrow_message(Arena* arena, GDB_Table* table, GDB_ArrowMessageHeader header_type, U64 row_count,
+                  GDB_ArrowFieldNode* nodes, U64 node_count, GDB_ArrowBuffer* buffers, U64 buffer_count, U64 body_size)
+{
+  GDB_ArrowFBBuilder builder = { arena };
+  U64 root_pos = gdb_arrow_fb_push(&builder, 0, sizeof(U32), sizeof(U32));
+  
+  // tec: Message { version, header_type, header, bodyLength }
+  GDB_ArrowFBField message_fields[] =
+  {
+    { sizeof(S16), GDB_ARROW_METADATA_VERSION_V5 },
+    { sizeof(U8), header_type },
+    { sizeof(U32), 0 },
+    { sizeof(S64), body_size },
+  };
+  U64 message_pos = gdb_arrow_fb_push_table(&builder, message_fields, ArrayCount(message_fields));
+  gdb_arrow_fb_patch(&builder, root_pos, message_pos);
+  
+  U64 header_pos = 0;
+  if (header_type == GDB_ArrowMessageHeader_Schema)
+  {
+    header_pos = gdb_arrow_push_schema(&builder, table);
+  }
+  else
+  {
+    // tec: RecordBatch { length, nodes, buffers }
+    GDB_ArrowFBField batch_fields[] = { { sizeof(S64), row_count }, { sizeof(U32), 0 }, { sizeof(U32), 0 } };
+    header_pos = gdb_arrow_fb_push_table(&builder, batch_fields, ArrayCount(batch_fields));
+    gdb_arrow_fb_patch(&builder, batch_fields[1].pos, gdb_arrow_fb_push_vector(&builder, nodes, node_count, sizeof(GDB_ArrowFieldNode)));
+    gdb_arrow_fb_patch(&builder, batch_fields[2].pos, gdb_arrow_fb_push_vector(&builder, buffers, buffer_count, sizeof(GDB_ArrowBuffer)));
+  }
+  gdb_arrow_fb_patch(&builder, message_fields[2].pos, header_pos);
+  
+  gdb_arrow_fb_push(&builder, 0, 0, 8);
+  String8 result = str8(builder.data, builder.size);
+  return result;
+}
+
+internal String8
+gdb_arrow_footer(Arena* arena, GDB_Table* table, GDB_ArrowBlock* batches, U64 batch_count)
+{
+  GDB_ArrowFBBuilder builder = { arena };
+  U64 root_pos = gdb_arrow_fb_push(&builder, 0, sizeof(U32), sizeof(U32));
+  
+  // tec: Footer { version, schema, dictionaries, recordBatches }
+  GDB_ArrowFBField footer_fields[] =
+  {
+    { sizeof(S16), GDB_ARROW_METADATA_VERSION_V5 },
+    { sizeof(U32), 0 },
+    { sizeof(U32), 0 },
+    { sizeof(U32), 0 },
+  };
+  U64 footer_pos = gdb_arrow_fb_push_table(&builder, footer_fields, ArrayCount(footer_fields));
+  gdb_arrow_fb_patch(&builder, root_pos, footer_pos);
+  gdb_arrow_fb_patch(&builder, footer_fields[1].pos, gdb_arrow_push_schema(&builder, table));
+  gdb_arrow_fb_patch(&builder, footer_fields[2].pos, gdb_arrow_fb_push_vector(&builder, 0, 0, sizeof(GDB_ArrowBlock)));
+  gdb_arrow_fb_patch(&builder, footer_fields[3].pos, gdb_arrow_fb_push_vector(&builder, batches, batch_count, sizeof(GDB_ArrowBlock)));
+  
+  gdb_arrow_fb_push(&builder, 0, 0, 8);
+  String8 result = str8(builder.data, builder.size);
+  return result;
+}
+
+// tec: [continuation][metadata size][flatbuffer], returns the bytes written which a footer block records
+internal U64
+gdb_arrow_write_message(OS_Handle file, U64 offset, String8 message)
+{
+  U32 prefix[2] = { GDB_ARROW_CONTINUATION, (U32)message.size };
+  U64 result = 0;
+  result += os_file_write(file, r1u64(offset, offset + sizeof(prefix)), prefix);
+  result += os_file_write(file, r1u64(offset + sizeof(prefix), offset + sizeof(prefix) + message.size), message.str);
+  return result;
+}
+
+//~ tec: export
+internal B32
+gdb_arrow_path_is_arrow(String8 path)
+{
+  String8 extension = str8_skip_last_dot(path);
+  B32 result = (str8_match(extension, str8_lit("arrow"), StringMatchFlag_CaseInsensitive) ||
+                str8_match(extension, str8_lit("feather"), StringMatchFlag_CaseInsensitive) ||
+                str8_match(extension, str8_lit("ipc"), StringMatchFlag_CaseInsensitive));
+  return result;
+}
+
+internal U64
+gdb_arrow_null_count(GDB_Column* column, U64 row_count)
+{
+  if (!gdb_column_has_nulls(column))
+  {
+    return 0;
+  }
+  
+  // tec: words past the bitmap are rows added before the first null, they all hold values
+  U64 result = 0;
+  U64 word_count = Min((row_count + 63) / 64, column->validity_capacity);
+  for (U64 i = 0; i < word_count; i++)
+  {
+    U64 nulls = ~column->validity[i];
+    if ((i + 1) * 64 > row_count)
+    {
+      nulls &= (1ull << (row_count & 63)) - 1;
+    }
+    result += count_bits_set64(nulls);
+  }
+  return result;
+}
+
+internal U64
+gdb_arrow_string_data_size(GDB_Column* column, U64 row_count)
+{
+  U64 result = 0;
+  if (row_count == 0)
+  {
+    return result;
+  }
+  
+  os_rw_mutex_take_r(column->rw_mutex);
+  if (!column->is_disk_backed)
+  {
+    result = column->offsets[row_count - 1];
+  }
+  else
+  {
+    OS_Handle file = column->file;
+    B32 temp_opened = 0;
+    if (os_handle_match(os_handle_zero(), file))
+    {
+      file = os_file_open(OS_AccessFlag_Read, column->disk_path);
+      temp_opened = 1;
+    }
+    
+    U64 var_reserved = 0;
+    os_file_read(file, r1u64(0, sizeof(U64)), &var_reserved);
+    U64 offset_pos = sizeof(U64) + var_reserved + (row_count - 1) * sizeof(U64);
+    os_file_read(file, r1u64(offset_pos, offset_pos + sizeof(U64)), &result);
+    
+    if (temp_opened)
+    {
+      os_file_close(file);
+    }
+  }
+  os_rw_mutex_drop_r(column->rw_mutex);
+  return result;
+}
+
+internal B32
+gdb_table_export_arrow(GDB_Table* table, String8 path)
+{
+  ProfBeginFunction();
+  
+  OS_Handle file = os_file_open(OS_AccessFlag_Write, path);
+  if (os_handle_match(os_handle_zero(), file))
+  {
+    log_error("failed to open Arrow file for writing: %.*s", str8_varg(path));
+    ProfEnd();
+    return 0;
+  }
+  
+  Temp scratch = scratch_begin(0, 0);
+  
+  // tec: rows inserted while exporting are left for the next export
+  U64 row_count = gdb_table_row_count(table);
+  U64 column_count = table->column_count;
+  
+  //- tec: body layout, one record batch holding every row. validity, then offsets for strings, then values
+  GDB_ArrowFieldNode* nodes = push_array(scratch.arena, GDB_ArrowFieldNode, column_count);
+  GDB_ArrowBuffer* buffers = push_array(scratch.arena, GDB_ArrowBuffer, column_count * 3);
+  U64* first_buffer = push_array(scratch.arena, U64, column_count);
+  U64 buffer_count = 0;
+  U64 body_size = 0;
+  for (U64 col = 0; col < column_count; col++)
+  {
+    GDB_Column* column = table->columns[col];
+    nodes[col].length = row_count;
+    nodes[col].null_count = gdb_arrow_null_count(column, row_count);
+    first_buffer[col] = buffer_count;
+    
+    U64 sizes[3] = { 0 };
+    U64 size_count = 0;
+    sizes[size_count++] = (nodes[col].null_count > 0) ? (row_count + 7) / 8 : 0;
+    if (column->type == GDB_ColumnType_String8)
+    {
+      sizes[size_count++] = (row_count + 1) * sizeof(S64);
+      sizes[size_count++] = gdb_arrow_string_data_size(column, row_count);
+    }
+    else
+    {
+      sizes[size_count++] = row_count * column->size;
+    }
+    
+    for (U64 i = 0; i < size_count; i++)
+    {
+      buffers[buffer_count].offset = body_size;
+      buffers[buffer_count].size = sizes[i];
+      buffer_count++;
+      body_size += AlignPow2(sizes[i], GDB_ARROW_BUFFER_ALIGNMENT);
+    }
+  }
+  
+  //- tec: magic, schema and the record batch metadata
+  U8 magic[8] = GDB_ARROW_MAGIC;
+  U64 file_off = os_file_write(file, r1u64(0, sizeof(magic)), magic);
+  
+  String8 schema_message = gdb_arrow_message(scratch.arena, table, GDB_ArrowMessageHeader_Schema, 0, 0, 0, 0, 0, 0);
+  file_off += gdb_arrow_write_message(file, file_off, schema_message);
+  
+  GDB_ArrowBlock block = { 0 };
+  String8 batch_message = gdb_arrow_message(scratch.arena, table, GDB_ArrowMessageHeader_RecordBatch, row_count,
+                                            nodes, column_count, buffers, buffer_count, body_size);
+  block.offset = file_off;
+  block.metadata_size = (S32)gdb_arrow_write_message(file, file_off, batch_message);
+  block.body_size = body_size;
+  file_off += block.metadata_size;
+  
+  //- tec: body, a block of rows at a time straight from the column storage
+  B32 result = 1;
+  U64 body_off = file_off;
+  for (U64 col = 0; col < column_count && result; col++)
+  {
+    GDB_Column* column = table->columns[col];
+    GDB_ArrowBuffer* validity = &buffers[first_buffer[col]];
+    GDB_ArrowBuffer* values = validity + 1;
+    
+    // tec: the null bitmap has the same bit order, rows past the stored words all hold values
+    if (validity->size > 0)
+    {
+      U8* bitmap = push_array_no_zero(scratch.arena, U8, validity->size);
+      U64 stored_size = Min(validity->size, column->validity_capacity * sizeof(U64));
+      MemoryCopy(bitmap, column->validity, stored_size);
+      MemorySet(bitmap + stored_size, 0xff, validity->size - stored_size);
+      os_file_write(file, r1u64(body_off + validity->offset, body_off + validity->offset + validity->size), bitmap);
+    }
+    
+    U64 string_data_off = 0;
+    S64 zero = 0;
+    if (column->type == GDB_ColumnType_String8)
+    {
+      os_file_write(file, r1u64(body_off + values->offset, body_off + values->offset + sizeof(S64)), &zero);
+    }
+    
+    for (U64 block_start = 0; block_start < row_count && result; block_start += GDB_EXPORT_BLOCK_ROWS)
+    {
+      Temp temp = temp_begin(scratch.arena);
+      Rng1U64 rows = r1u64(block_start, Min(row_count, block_start + GDB_EXPORT_BLOCK_ROWS));
+      U64 block_rows = dim_1u64(rows);
+      
+      if (column->type == GDB_ColumnType_String8)
+      {
+        // tec: gdb keeps end offsets, Arrow keeps start offsets with one extra at the end
+        GDB_ArrowBuffer* data = values + 1;
+        U64* bounds = 0;
+        U8* string_data = gdb_table_export_string_block(temp.arena, column, rows, &bounds);
+        if (string_data == 0)
+        {
+          result = 0;
+        }
+        else
+        {
+          for (U64 i = 1; i <= block_rows; i++)
+          {
+            bounds[i] += string_data_off;
+          }
+          U64 offsets_at = body_off + values->offset + (rows.min + 1) * sizeof(S64);
+          U64 data_at = body_off + data->offset + string_data_off;
+          U64 data_size = bounds[block_rows] - string_data_off;
+          os_file_write(file, r1u64(offsets_at, offsets_at + block_rows * sizeof(S64)), bounds + 1);
+          os_file_write(file, r1u64(data_at, data_at + data_size), string_data);
+          string_data_off += data_size;
+        }
+      }
+      else
+      {
+        U64 size = 0;
+        void* data = gdb_column_get_data_range(temp.arena, column, rows, &size);
+        U64 values_at = body_off + values->offset + rows.min * column->size;
+        if (data == 0 || size != block_rows * column->size ||
+            os_file_write(file, r1u64(values_at, values_at + size), data) != size)
+        {
+          result = 0;
+        }
+      }
+      temp_end(temp);
+    }
+    
+    if (column->type == GDB_ColumnType_String8 && result && string_data_off != (U64)values[1].size)
+    {
+      log_error("string data of column '%.*s' changed size while exporting", str8_varg(column->name));
+      result = 0;
+    }
+    if (!result)
+    {
+      log_error("failed to export column '%.*s' of table '%.*s'", str8_varg(column->name), str8_varg(table->name));
+    }
+  }
+  file_off = body_off + body_size;
+  
+  //- tec: footer, its size and the closing magic
+  if (result)
+  {
+    String8 footer = gdb_arrow_footer(scratch.arena, table, &block, 1);
+    S32 footer_size = (S32)footer.size;
+    file_off += os_file_write(file, r1u64(file_off, file_off + footer.size), footer.str);
+    file_off += os_file_write(file, r1u64(file_off, file_off + sizeof(footer_size)), &footer_size);
+    file_off += os_file_write(file, r1u64(file_off, file_off + GDB_ARROW_MAGIC_SIZE), magic);
+    log_info("exported %llu rows of table '%.*s' to %.*s", row_count, str8_varg(table->name), str8_varg(path));
+  }
+  
+  os_file_close(file);
+  scratch_end(scratch);
+  ProfEnd();
+  return result;
+}
+
+//~ tec: import
+
+// tec: more than one record batch means the columns are stitched together, every buffer is read into the column arena
+internal B32
+gdb_arrow_copy_column(GDB_Column* column, OS_Handle file, GDB_ArrowColumnBatch* batches, U64 batch_stride, U64 batch_count, B32 wide_offsets)
+{
+  ProfBeginFunction();
+  Temp scratch = scratch_begin(0, 0);
+  
+  U64 row_count = 0;
+  U64 null_count = 0;
+  for (U64 b = 0; b < batch_count; b++)
+  {
+    row_count += batches[b * batch_stride].row_count;
+    null_count += batches[b * batch_stride].null_count;
+  }
+  
+  B32 result = 1;
+  if (column->type == GDB_ColumnType_String8)
+  {
+    //- tec: offsets of every batch first, they give the size of the string data
+    U64 offset_size = wide_offsets ? sizeof(U64) : sizeof(U32);
+    U64** batch_offsets = push_array(scratch.arena, U64*, batch_count);
+    U64 data_size = 0;
+    for (U64 b = 0; b < batch_count && result; b++)
+    {
+      GDB_ArrowColumnBatch* batch = &batches[b * batch_stride];
+      U64 count = batch->row_count + 1;
+      U8* raw = push_array(scratch.arena, U8, count * offset_size);
+      batch_offsets[b] = push_array(scratch.arena, U64, count);
+      if (batch->row_count > 0)
+      {
+        result = (dim_1u64(batch->offsets) >= count * offset_size &&
+                  os_file_read(file, r1u64(batch->offsets.min, batch->offsets.min + count * offset_size), raw) == count * offset_size);
+      }
+      for (U64 i = 0; i < count && result; i++)
+      {
+        batch_offsets[b][i] = wide_offsets ? ((U64*)raw)[i] : ((U32*)raw)[i];
+        result = (i == 0 || batch_offsets[b][i] >= batch_offsets[b][i - 1]);
+      }
+      if (result && batch->row_count > 0)
+      {
+        result = (batch_offsets[b][batch->row_count] <= dim_1u64(batch->values));
+        data_size += batch_offsets[b][batch->row_count] - batch_offsets[b][0];
+      }
+    }
+    
+    //- tec: then the string bytes, end offsets are rebased onto the joined data
+    if (result)
+    {
+      column->offsets = push_array_no_zero(column->arena, U64, Max(1, row_count));
+      column->data = push_array_no_zero(column->arena, U8, Max(1, data_size));
+      column->variable_capacity = data_size;
+      U64 row_base = 0;
+      U64 data_base = 0;
+      for (U64 b = 0; b < batch_count && result; b++)
+      {
+        GDB_ArrowColumnBatch* batch = &batches[b * batch_stride];
+        if (batch->row_count == 0)
+        {
+          continue;
+        }
+        
+        U64* offsets = batch_offsets[b];
+        U64 size = offsets[batch->row_count] - offsets[0];
+        for (U64 i = 0; i < batch->row_count; i++)
+        {
+          column->offsets[row_base + i] = data_base + offsets[i + 1] - offsets[0];
+        }
+        U64 read_at = batch->values.min + offsets[0];
+        result = (os_file_read(file, r1u64(read_at, read_at + size), column->data + data_base) == size);
+        row_base += batch->row_count;
+        data_base += size;
+      }
+    }
+  }
+  else
+  {
+    column->data = push_array_no_zero(column->arena, U8, Max(1, row_count * column->size));
+    U64 row_base = 0;
+    for (U64 b = 0; b < batch_count && result; b++)
+    {
+      GDB_ArrowColumnBatch* batch = &batches[b * batch_stride];
+      U64 size = batch->row_count * column->size;
+      result = (size <= dim_1u64(batch->values) &&
+                os_file_read(file, r1u64(batch->values.min, batch->values.min + size), column->data + row_base * column->size) == size);
+      row_base += batch->row_count;
+    }
+  }
+  
+  //- tec: null bitmaps are shifted into place a row at a time, only batches holding nulls are read
+  if (result && null_count > 0)
+  {
+    U64 word_count = (row_count + 63) / 64;
+    column->validity = push_array_no_zero(column->arena, U64, word_count);
+    column->validity_capacity = word_count;
+    MemorySet(column->validity, 0xff, word_count * sizeof(U64));
+    
+    U64 row_base = 0;
+    for (U64 b = 0; b < batch_count && result; b++)
+    {
+      GDB_ArrowColumnBatch* batch = &batches[b * batch_stride];
+      U64 bitmap_size = (batch->row_count + 7) / 8;
+      if (batch->null_count > 0)
+      {
+        Temp temp = temp_begin(scratch.arena);
+        U8* bitmap = push_array(temp.arena, U8, bitmap_size);
+        result = (dim_1u64(batch->validity) >= bitmap_size &&
+                  os_file_read(file, r1u64(batch->validity.min, batch->validity.min + bitmap_size), bitmap) == bitmap_size);
+        for (U64 i = 0; i < batch->row_count && result; i++)
+        {
+          if ((bitmap[i >> 3] & (1 << (i & 7))) == 0)
+          {
+            U64 row = row_base + i;
+            column->validity[row >> 6] &= ~(1ull << (row & 63));
+          }
+        }
+        temp_end(temp);
+      }
+      row_base += batch->row_count;
+    }
+    column->null_count = null_count;
+  }
+  
+  column->row_count = row_count;
+  column->capacity = row_count;
+  
+  scratch_end(scratch);
+  ProfEnd();
+  return result;
+}
+
+// tec: a single record batch is adopted in place. the column's buffers are mapped copy on write, numeric
+// values and 64 bit string offsets are used as they are, 32 bit offsets are widened into the column arena
+internal B32
+gdb_arrow_adopt_column(GDB_Column* column, OS_Handle file, OS_Handle file_map, GDB_ArrowColumnBatch* batch, B32 wide_offsets)
+{
+  ProfBeginFunction();
+  
+  U64 row_count = batch->row_count;
+  if (row_count == 0)
+  {
+    ProfEnd();
+    return 1;
+  }
+  
+  Rng1U64 range = batch->values;
+  if (column->type == GDB_ColumnType_String8)
+  {
+    range = union_1u64(range, batch->offsets);
+  }
+  if (batch->null_count > 0)
+  {
+    range = union_1u64(range, batch->validity);
+  }
+  
+  U8* view = (U8*)os_file_map_view_open(file_map, OS_AccessFlag_Read|OS_AccessFlag_CopyOnWrite, range);
+  if (view == 0)
+  {
+    log_warn("failed to map column '%.*s', reading it instead", str8_varg(column->name));
+    B32 result = gdb_arrow_copy_column(column, file, batch, 1, 1, wide_offsets);
+    ProfEnd();
+    return result;
+  }
+  column->adopted_view = view;
+  column->adopted_range = range;
+  
+  B32 result = 1;
+  if (column->type == GDB_ColumnType_String8)
+  {
+    U64 offset_size = wide_offsets ? sizeof(U64) : sizeof(U32);
+    U8* raw_offsets = view + (batch->offsets.min - range.min);
+    result = (dim_1u64(batch->offsets) >= (row_count + 1) * offset_size);
+    if (result)
+    {
+      U64 first = wide_offsets ? ((U64*)raw_offsets)[0] : ((U32*)raw_offsets)[0];
+      U64 last = wide_offsets ? ((U64*)raw_offsets)[row_count] : ((U32*)raw_offsets)[row_count];
+      result = (first <= last && last <= dim_1u64(batch->values));
+      
+      if (result && wide_offsets && first == 0 && ((U64)raw_offsets & 7) == 0)
+      {
+        column->offsets = (U64*)raw_offsets + 1;
+      }
+      else if (result)
+      {
+        column->offsets = push_array_no_zero(column->arena, U64, row_count);
+        for (U64 i = 0; i < row_count; i++)
+        {
+          U64 end = wide_offsets ? ((U64*)raw_offsets)[i + 1] : ((U32*)raw_offsets)[i + 1];
+          column->offsets[i] = end - first;
+        }
+      }
+      column->data = view + (batch->values.min - range.min) + first;
+      column->variable_capacity = dim_1u64(batch->values) - first;
+    }
+  }
+  else
+  {
+    result = (dim_1u64(batch->values) >= row_count * column->size);
+    column->data = view + (batch->values.min - range.min);
+  }
+  
+  if (result && batch->null_count > 0)
+  {
+    U64 word_count = (row_count + 63) / 64;
+    U8* bitmap = view + (batch->validity.min - range.min);
+    if (dim_1u64(batch->validity) >= word_count * sizeof(U64) && ((U64)bitmap & 7) == 0)
+    {
+      column->validity = (U64*)bitmap;
+    }
+    else
+    {
+      U64 bitmap_size = Min(dim_1u64(batch->validity), word_count * sizeof(U64));
+      result = (bitmap_size >= (row_count + 7) / 8);
+      column->validity = push_array_no_zero(column->arena, U64, word_count);
+      MemorySet(column->validity, 0xff, word_count * sizeof(U64));
+      MemoryCopy(column->validity, bitmap, bitmap_size);
+    }
+    column->validity_capacity = word_count;
+    column->null_count = batch->null_count;
+  }
+  
+  // tec: capacity matches the rows so the first append moves the column into its own memory
+  column->row_count = row_count;
+  column->capacity = row_count;
+  
+  ProfEnd();
+  return result;
+}
+
+internal GDB_Table*
+gdb_table_import_arrow(GDB_Database* database, String8 table_name, String8 path)
+{
+  ProfBeginFunction();
+  
+  OS_Handle file = os_file_open(OS_AccessFlag_Read, path);
+  if (os_handle_match(file, os_handle_zero()))
+  {
+    log_error("failed to open Arrow file: %.*s", str8_varg(path));
+    ProfEnd();
+    return NULL;
+  }
+  
+  log_info("starting import arrow file %.*s", str8_varg(path));
+  
+  Temp scratch = scratch_begin(0, 0);
+  U64 file_size = os_properties_from_file(file).size;
+  B32 result = 1;
+  
+  //- tec: footer, [footer][S32 footer size][magic] at the end of the file
+  U8 head[8] = { 0 };
+  U8 tail[sizeof(S32) + GDB_ARROW_MAGIC_SIZE] = { 0 };
+  S32 footer_size = 0;
+  if (file_size >= sizeof(head) + sizeof(tail))
+  {
+    os_file_read(file, r1u64(0, sizeof(head)), head);
+    os_file_read(file, r1u64(file_size - sizeof(tail), file_size), tail);
+    MemoryCopy(&footer_size, tail, sizeof(footer_size));
+  }
+  if (!MemoryMatch(head, GDB_ARROW_MAGIC, GDB_ARROW_MAGIC_SIZE) || !MemoryMatch(tail + sizeof(S32), GDB_ARROW_MAGIC, GDB_ARROW_MAGIC_SIZE) ||
+      footer_size <= 0 || (U64)footer_size > file_size - sizeof(head) - sizeof(tail))
+  {
+    log_error("'%.*s' is not an Arrow IPC file", str8_varg(path));
+    result = 0;
+  }
+  
+  String8 footer_data = {0};
+  if (result)
+  {
+    U64 footer_at = file_size - sizeof(tail) - footer_size;
+    footer_data.str = push_array_no_zero(scratch.arena, U8, footer_size);
+    footer_data.size = os_file_read(file, r1u64(footer_at, footer_at + footer_size), footer_data.str);
+  }
+  
+  GDB_ArrowFBTable footer = gdb_arrow_fb_root(footer_data);
+  GDB_ArrowFBTable schema = gdb_arrow_fb_table(footer, 1);
+  GDB_ArrowFBVector fields = gdb_arrow_fb_vector(schema, 1, sizeof(U32));
+  GDB_ArrowFBVector batches = gdb_arrow_fb_vector(footer, 3, sizeof(GDB_ArrowBlock));
+  if (result && (schema.pos == 0 || gdb_arrow_fb_scalar(schema, 0, sizeof(S16), 0) != 0))
+  {
+    log_error("'%.*s' has no schema or is big endian", str8_varg(path));
+    result = 0;
+  }
+  
+  //- tec: schema, one column per field
+  U64 column_count = fields.count;
+  String8* names = push_array(scratch.arena, String8, column_count);
+  GDB_ColumnType* types = push_array(scratch.arena, GDB_ColumnType, column_count);
+  B32* wide_offsets = push_array(scratch.arena, B32, column_count);
+  for (U64 i = 0; i < column_count && result; i++)
+  {
+    GDB_ArrowFBTable field = gdb_arrow_fb_vector_table(fields, i);
+    GDB_ArrowFBTable type = gdb_arrow_fb_table(field, 3);
+    GDB_ArrowType type_tag = (GDB_ArrowType)gdb_arrow_fb_scalar(field, 2, sizeof(U8), GDB_ArrowType_None);
+    names[i] = gdb_arrow_fb_string(field, 0);
+    
+    if (gdb_arrow_fb_field_pos(field, 4) != 0)
+    {
+      log_error("column '%.*s' is dictionary encoded, which is not supported", str8_varg(names[i]));
+      result = 0;
+      break;
+    }
+    
+    switch (type_tag)
+    {
+      case GDB_ArrowType_Int:
+      {
+        U64 bit_width = gdb_arrow_fb_scalar(type, 0, sizeof(S32), 0);
+        if (bit_width == 32)      types[i] = GDB_ColumnType_U32;
+        else if (bit_width == 64) types[i] = GDB_ColumnType_U64;
+        if (gdb_arrow_fb_scalar(type, 1, sizeof(U8), 0))
+        {
+          log_warn("column '%.*s' is signed, its values are kept as unsigned", str8_varg(names[i]));
+        }
+      } break;
+      
+      case GDB_ArrowType_FloatingPoint:
+      {
+        U64 precision = gdb_arrow_fb_scalar(type, 0, sizeof(S16), GDB_ArrowPrecision_Half);
+        if (precision == GDB_ArrowPrecision_Single)      types[i] = GDB_ColumnType_F32;
+        else if (precision == GDB_ArrowPrecision_Double) types[i] = GDB_ColumnType_F64;
+      } break;
+      
+      case GDB_ArrowType_Binary:
+      case GDB_ArrowType_Utf8:
+      {
+        types[i] = GDB_ColumnType_String8;
+      } break;
+      
+      case GDB_ArrowType_LargeBinary:
+      case GDB_ArrowType_LargeUtf8:
+      {
+        types[i] = GDB_ColumnType_String8;
+        wide_offsets[i] = 1;
+      } break;
+      
+      default: break;
+    }
+    
+    if (types[i] == GDB_ColumnType_Invalid)
+    {
+      log_error("column '%.*s' has Arrow type %u, which has no matching column type", str8_varg(names[i]), type_tag);
+      result = 0;
+    }
+  }
+  
+  //- tec: record batches, where each column's buffers sit in the file
+  U64 batch_count = batches.count;
+  GDB_ArrowColumnBatch* column_batches = push_array(scratch.arena, GDB_ArrowColumnBatch, batch_count * column_count);
+  U64 row_count = 0;
+  for (U64 b = 0; b < batch_count && result; b++)
+  {
+    GDB_ArrowBlock block = { 0 };
+    gdb_arrow_fb_vector_struct(batches, b, &block, sizeof(block));
+    if (block.offset < 0 || block.metadata_size <= 0 || block.body_size < 0 ||
+        (U64)block.offset + block.metadata_size + block.body_size > file_size)
+    {
+      log_error("record batch %llu lies outside the file", b);
+      result = 0;
+      break;
+    }
+    
+    // tec: newer writers put a continuation marker before the size, older ones only the size
+    Temp temp = temp_begin(scratch.arena);
+    String8 metadata = str8(push_array_no_zero(temp.arena, U8, block.metadata_size), block.metadata_size);
+    os_file_read(file, r1u64(block.offset, block.offset + block.metadata_size), metadata.str);
+    U64 skip = (gdb_arrow_fb_read(metadata, 0, sizeof(U32)) == GDB_ARROW_CONTINUATION) ? 2 * sizeof(U32) : sizeof(U32);
+    GDB_ArrowFBTable message = gdb_arrow_fb_root(str8_skip(metadata, skip));
+    GDB_ArrowFBTable batch = gdb_arrow_fb_table(message, 2);
+    GDB_ArrowFBVector nodes = gdb_arrow_fb_vector(batch, 1, sizeof(GDB_ArrowFieldNode));
+    GDB_ArrowFBVector buffers = gdb_arrow_fb_vector(batch, 2, sizeof(GDB_ArrowBuffer));
+    
+    if (gdb_arrow_fb_scalar(message, 1, sizeof(U8), 0) != GDB_ArrowMessageHeader_RecordBatch || batch.pos == 0)
+    {
+      log_error("record batch %llu is not a record batch message", b);
+      result = 0;
+    }
+    else if (gdb_arrow_fb_field_pos(batch, 3) != 0)
+    {
+      log_error("record batch %llu is compressed, which is not supported", b);
+      result = 0;
+    }
+    else if (nodes.count != column_count)
+    {
+      log_error("record batch %llu has %llu columns, the schema has %llu", b, nodes.count, column_count);
+      result = 0;
+    }
+    
+    U64 body_at = block.offset + block.metadata_size;
+    U64 batch_rows = gdb_arrow_fb_scalar(batch, 0, sizeof(S64), 0);
+    U64 buffer_index = 0;
+    for (U64 c = 0; c < column_count && result; c++)
+    {
+      GDB_ArrowColumnBatch* column_batch = &column_batches[b * column_count + c];
+      GDB_ArrowFieldNode node = { 0 };
+      gdb_arrow_fb_vector_struct(nodes, c, &node, sizeof(node));
+      column_batch->row_count = node.length;
+      column_batch->null_count = node.null_count;
+      
+      Rng1U64* ranges[3] = { &column_batch->validity, &column_batch->offsets, &column_batch->values };
+      U64 range_count = (types[c] == GDB_ColumnType_String8) ? 3 : 2;
+      for (U64 r = 0; r < range_count && result; r++)
+      {
+        U64 slot = (range_count == 2 && r == 1) ? 2 : r;
+        GDB_ArrowBuffer buffer = { 0 };
+        result = gdb_arrow_fb_vector_struct(buffers, buffer_index++, &buffer, sizeof(buffer)) &&
+          buffer.offset >= 0 && buffer.size >= 0 && buffer.offset + buffer.size <= block.body_size;
+        *ranges[slot] = r1u64(body_at + buffer.offset, body_at + buffer.offset + buffer.size);
+      }
+      
+      if (!result || node.length != (S64)batch_rows)
+      {
+        log_error("record batch %llu has invalid buffers for column '%.*s'", b, str8_varg(names[c]));
+        result = 0;
+      }
+    }
+    row_count += batch_rows;
+    temp_end(temp);
+  }
+  
+  //- tec: columns, adopted in place when there is a single batch
+  GDB_Table* table = NULL;
+  if (result)
+  {
+    table = gdb_table_alloc(table_name);
+    table->name = push_str8_copy(table->arena, table_name);
+    table->parent_database = database;
+    for (U64 c = 0; c < column_count; c++)
+    {
+      gdb_table_add_column(table, gdb_column_schema_create(push_str8_copy(table->arena, names[c]), types[c]));
+    }
+    
+    OS_Handle file_map = os_handle_zero();
+    if (batch_count == 1 && row_count > 0)
+    {
+      file_map = os_file_map_open(OS_AccessFlag_Read, file);
+    }
+    
+    for (U64 c = 0; c < column_count && result; c++)
+    {
+      GDB_Column* column = table->columns[c];
+      if (!os_handle_match(file_map, os_handle_zero()))
+      {
+        result = gdb_arrow_adopt_column(column, file, file_map, &column_batches[c], wide_offsets[c]);
+      }
+      else
+      {
+        result = gdb_arrow_copy_column(column, file, &column_batches[c], column_count, batch_count, wide_offsets[c]);
+      }
+      gdb_column_mark_dirty(column);
+      
+      if (!result)
+      {
+        log_error("failed to read column '%.*s' from %.*s", str8_varg(column->name), str8_varg(path));
+      }
+    }
+    
+    // tec: views keep the file mapped after the mapping handle goes
+    if (!os_handle_match(file_map, os_handle_zero()))
+    {
+      os_file_map_close(file_map);
+    }
+    
+    table->row_count = row_count;
+    if (!result)
+    {
+      for (U64 c = 0; c < table->column_count; c++)
+      {
+        gdb_column_release(table->columns[c]);
+      }
+      gdb_table_release(table);
+      table = NULL;
+    }
+  }
+  
+  os_file_close(file);
+  scratch_end(scratch);
+  if (table)
+  {
+    log_info("ending import arrow file %.*s, %llu rows in %llu record batches", str8_varg(path), row_count, batch_count);
+  }
+  ProfEnd();
+  return table;
+}
@@ -0,0 +1,143 @@
+/* date = October 19th 2026 6:05 pm */
+
+#ifndef GDB_ARROW_H
+#define GDB_ARROW_H
+
+// tec: Arrow IPC files (Feather v2), [magic][schema message][record batch messages][footer][footer size][magic].
+// every message is a flatbuffer, read and written here without the flatbuffers library
+#define GDB_ARROW_MAGIC "ARROW1"
+#define GDB_ARROW_MAGIC_SIZE 6
+#define GDB_ARROW_CONTINUATION 0xFFFFFFFFu
+#define GDB_ARROW_METADATA_VERSION_V5 4
+
+// tec: body buffers start on this boundary, the format asks for 8 and recommends 64
+#ifndef GDB_ARROW_BUFFER_ALIGNMENT
+#define GDB_ARROW_BUFFER_ALIGNMENT 64
+#endif
+
+typedef U8 GDB_ArrowMessageHeader;
+enum
+{
+  GDB_ArrowMessageHeader_None            = 0,
+  GDB_ArrowMessageHeader_Schema          = 1,
+  GDB_ArrowMessageHeader_DictionaryBatch = 2,
+  GDB_ArrowMessageHeader_RecordBatch     = 3,
+};
+
+// tec: the Type union tags this reader knows, everything else is refused on import
+typedef U8 GDB_ArrowType;
+enum
+{
+  GDB_ArrowType_None          = 0,
+  GDB_ArrowType_Int           = 2,
+  GDB_ArrowType_FloatingPoint = 3,
+  GDB_ArrowType_Binary        = 4,
+  GDB_ArrowType_Utf8          = 5,
+  GDB_ArrowType_LargeBinary   = 19,
+  GDB_ArrowType_LargeUtf8     = 20,
+};
+
+typedef U16 GDB_ArrowPrecision;
+enum
+{
+  GDB_ArrowPrecision_Half   = 0,
+  GDB_ArrowPrecision_Single = 1,
+  GDB_ArrowPrecision_Double = 2,
+};
+
+// tec: structs stored inline in flatbuffer vectors, laid out the way the format has them
+typedef struct GDB_ArrowBlock GDB_ArrowBlock;
+struct GDB_ArrowBlock
+{
+  S64 offset;
+  S32 metadata_size;
+  S32 pad;
+  S64 body_size;
+};
+
+typedef struct GDB_ArrowFieldNode GDB_ArrowFieldNode;
+struct GDB_ArrowFieldNode
+{
+  S64 length;
+  S64 null_count;
+};
+
+typedef struct GDB_ArrowBuffer GDB_ArrowBuffer;
+struct GDB_ArrowBuffer
+{
+  S64 offset;
+  S64 size;
+};
+
+//~ tec: flatbuffer reading
+
+// tec: a table inside a flatbuffer, pos 0 is a missing table. every read is bounds checked against data
+typedef struct GDB_ArrowFBTable GDB_ArrowFBTable;
+struct GDB_ArrowFBTable
+{
+  String8 data;
+  U64 pos;
+};
+
+typedef struct GDB_ArrowFBVector GDB_ArrowFBVector;
+struct GDB_ArrowFBVector
+{
+  String8 data;
+  U64 pos;
+  U64 count;
+};
+
+//~ tec: flatbuffer writing
+
+// tec: built front to back, children always land after the table referring to them so offsets stay unsigned
+typedef struct GDB_ArrowFBBuilder GDB_ArrowFBBuilder;
+struct GDB_ArrowFBBuilder
+{
+  Arena* arena;
+  U8* data;
+  U64 size;
+  U64 capacity;
+};
+
+// tec: one table field, size 0 leaves it out. offsets to children are 4 byte fields patched once the child exists
+typedef struct GDB_ArrowFBField GDB_ArrowFBField;
+struct GDB_ArrowFBField
+{
+  U32 size;
+  U64 value;
+  U64 pos;
+};
+
+//~ tec: import
+
+// tec: where one column's buffers sit in the file for one record batch
+typedef struct GDB_ArrowColumnBatch GDB_ArrowColumnBatch;
+struct GDB_ArrowColumnBatch
+{
+  U64 row_count;
+  U64 null_count;
+  Rng1U64 validity;
+  Rng1U64 offsets;
+  Rng1U64 values;
+};
+
+internal GDB_ArrowFBTable gdb_arrow_fb_root(String8 data);
+internal U64 gdb_arrow_fb_field_pos(GDB_ArrowFBTable table, U64 field);
+internal U64 gdb_arrow_fb_scalar(GDB_ArrowFBTable table, U64 field, U64 size, U64 default_value);
+internal GDB_ArrowFBTable gdb_arrow_fb_table(GDB_ArrowFBTable table, U64 field);
+internal GDB_ArrowFBVector gdb_arrow_fb_vector(GDB_ArrowFBTable table, U64 field, U64 element_size);
+internal GDB_ArrowFBTable gdb_arrow_fb_vector_table(GDB_ArrowFBVector vector, U64 index);
+internal B32 gdb_arrow_fb_vector_struct(GDB_ArrowFBVector vector, U64 index, void* out, U64 element_size);
+internal String8 gdb_arrow_fb_string(GDB_ArrowFBTable table, U64 field);
+
+internal U64 gdb_arrow_fb_push(GDB_ArrowFBBuilder* builder, void* data, U64 size, U64 align);
+internal U64 gdb_arrow_fb_push_table(GDB_ArrowFBBuilder* builder, GDB_ArrowFBField* fields, U64 field_count);
+internal U64 gdb_arrow_fb_push_vector(GDB_ArrowFBBuilder* builder, void* elements, U64 count, U64 element_size);
+internal U64 gdb_arrow_fb_push_string(GDB_ArrowFBBuilder* builder, String8 string);
+internal void gdb_arrow_fb_patch(GDB_ArrowFBBuilder* builder, U64 at, U64 target);
+
+internal B32 gdb_arrow_path_is_arrow(String8 path);
+internal GDB_Table* gdb_table_import_arrow(GDB_Database* database, String8 table_name, String8 path);
+internal B32 gdb_table_export_arrow(GDB_Table* table, String8 path);
+
+#endif //GDB_ARROW_H
@@ -1 +1,6 @@
-#include "gdb.c"
\ No newline at end of file
+#include "gdb.c"
+#include "gdb_wal.c"
+#include "gdb_index.c"
+#include "gdb_arrow.c"
+#include "gdb_parquet.c"
+#include "gdb_appender.c"
\ No newline at end of file
@@ -4,5 +4,10 @@
 #define GDB_INC_H
 
 #include "gdb.h"
+#include "gdb_wal.h"
+#include "gdb_index.h"
+#include "gdb_arrow.h"
+#include "gdb_parquet.h"
+#include "gdb_appender.h"
 
 #endif //GDB_INC_H
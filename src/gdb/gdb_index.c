@@ -0,0 +1,759 @@
+
+typedef struct GDB_IndexEntry GDB_IndexEntry;
+struct GDB_IndexEntry
+{
+  U64 key;
+  U64 row;
+};
+
+internal int
+gdb_index_entry_compare(const GDB_IndexEntry* a, const GDB_IndexEntry* b)
+{
+  if (a->key != b->key) return (a->key < b->key) ? -1 : 1;
+  if (a->row != b->row) return (a->row < b->row) ? -1 : 1;
+  return 0;
+}
+
+//~ tec: keys
+internal U64
+gdb_index_key_from_f64(F64 value)
+{
+  // tec: -0 and +0 compare equal so they share a key
+  if (value == 0)
+  {
+    value = 0;
+  }
+  U64 bits = 0;
+  MemoryCopy(&bits, &value, sizeof(bits));
+  U64 result = (bits & (1ull << 63)) ? ~bits : (bits | (1ull << 63));
+  return result;
+}
+
+internal U64
+gdb_index_key_from_data(GDB_ColumnType type, void* data)
+{
+  U64 result = 0;
+  switch (type)
+  {
+    case GDB_ColumnType_U32:     { result = *(U32*)data; } break;
+    case GDB_ColumnType_U64:     { result = *(U64*)data; } break;
+    case GDB_ColumnType_F32:     { result = gdb_index_key_from_f64((F64)*(F32*)data); } break;
+    case GDB_ColumnType_F64:     { result = gdb_index_key_from_f64(*(F64*)data); } break;
+    case GDB_ColumnType_String8: { result = gdb_index_hash_string(*(String8*)data); } break;
+  }
+  return result;
+}
+
+internal B32
+gdb_index_key_from_string(GDB_ColumnType type, String8 value, U64* out_key)
+{
+  B32 result = 1;
+  switch (type)
+  {
+    case GDB_ColumnType_U32:
+    case GDB_ColumnType_U64:
+    {
+      // tec: a fractional literal against an integer column is left to the kernel
+      if (str8_contains(value, '.'))
+      {
+        result = 0;
+        break;
+      }
+      U64 key = u64_from_str8(value, 10);
+      if (type == GDB_ColumnType_U32 && key > max_U32)
+      {
+        result = 0;
+        break;
+      }
+      *out_key = key;
+    } break;
+    case GDB_ColumnType_F32: { *out_key = gdb_index_key_from_f64((F64)(F32)f64_from_str8(value)); } break;
+    case GDB_ColumnType_F64: { *out_key = gdb_index_key_from_f64(f64_from_str8(value)); } break;
+    case GDB_ColumnType_String8: { *out_key = gdb_index_hash_string(value); } break;
+    default: { result = 0; } break;
+  }
+  return result;
+}
+
+internal U64
+gdb_index_hash_key(U64 key)
+{
+  // tec: splitmix64 finalizer, sequential keys spread over the whole table
+  key ^= key >> 30;
+  key *= 0xbf58476d1ce4e5b9ull;
+  key ^= key >> 27;
+  key *= 0x94d049bb133111ebull;
+  key ^= key >> 31;
+  return key;
+}
+
+internal U64
+gdb_index_hash_string(String8 string)
+{
+  U64 hash = 14695981039346656037ULL;
+  for (U64 i = 0; i < string.size; i++)
+  {
+    hash ^= string.str[i];
+    hash *= 1099511628211ULL;
+  }
+  return hash;
+}
+
+//~ tec: building
+internal GDB_IndexEntry*
+gdb_index_gather_entries(Arena* arena, GDB_Index* index, Rng1U64 row_range, U64* out_count)
+{
+  ProfBeginFunction();
+  
+  GDB_Column* column = index->column;
+  U64 row_count = dim_1u64(row_range);
+  GDB_IndexEntry* entries = push_array_no_zero(arena, GDB_IndexEntry, row_count);
+  U64 count = 0;
+  
+  for (U64 batch_start = row_range.min; batch_start < row_range.max; batch_start += GDB_INDEX_BUILD_BATCH_ROWS)
+  {
+    Temp scratch = scratch_begin(&arena, 1);
+    Rng1U64 batch = r1u64(batch_start, Min(batch_start + GDB_INDEX_BUILD_BATCH_ROWS, row_range.max));
+    
+    if (column->type == GDB_ColumnType_String8)
+    {
+      for (U64 row = batch.min; row < batch.max; row++)
+      {
+        if (gdb_column_is_null(column, row)) continue;
+        String8 value = gdb_column_get_string(scratch.arena, column, row);
+        entries[count].key = gdb_index_hash_string(value);
+        entries[count].row = row;
+        count++;
+      }
+    }
+    else
+    {
+      U64 size = 0;
+      U8* data = gdb_column_get_data_range(scratch.arena, column, batch, &size);
+      U64 batch_rows = data ? Min(size / column->size, dim_1u64(batch)) : 0;
+      for (U64 i = 0; i < batch_rows; i++)
+      {
+        U64 row = batch.min + i;
+        if (gdb_column_is_null(column, row)) continue;
+        entries[count].key = gdb_index_key_from_data(column->type, data + i * column->size);
+        entries[count].row = row;
+        count++;
+      }
+    }
+    
+    scratch_end(scratch);
+  }
+  
+  *out_count = count;
+  ProfEnd();
+  return entries;
+}
+
+internal void
+gdb_index_hash_resize(GDB_Index* index, U64 slot_count)
+{
+  U64* old_keys = index->slot_keys;
+  U64* old_rows = index->slot_rows;
+  U64 old_slot_count = index->slot_count;
+  
+  index->slot_count = slot_count;
+  index->slot_keys = push_array_no_zero(index->arena, U64, slot_count);
+  index->slot_rows = push_array(index->arena, U64, slot_count);
+  
+  U64 mask = slot_count - 1;
+  for (U64 i = 0; i < old_slot_count; i++)
+  {
+    if (old_rows[i] == 0) continue;
+    U64 slot = gdb_index_hash_key(old_keys[i]) & mask;
+    while (index->slot_rows[slot] != 0)
+    {
+      slot = (slot + 1) & mask;
+    }
+    index->slot_keys[slot] = old_keys[i];
+    index->slot_rows[slot] = old_rows[i];
+  }
+}
+
+internal void
+gdb_index_hash_insert(GDB_Index* index, GDB_IndexEntry* entries, U64 count)
+{
+  ProfBeginFunction();
+  
+  U64 needed = ((index->entry_count + count) * 100) / GDB_INDEX_HASH_MAX_LOAD + 1;
+  if (needed > index->slot_count)
+  {
+    U64 slot_count = Max(index->slot_count, 64);
+    while (slot_count < needed)
+    {
+      slot_count *= 2;
+    }
+    gdb_index_hash_resize(index, slot_count);
+  }
+  
+  U64 mask = index->slot_count - 1;
+  for (U64 i = 0; i < count; i++)
+  {
+    U64 slot = gdb_index_hash_key(entries[i].key) & mask;
+    while (index->slot_rows[slot] != 0)
+    {
+      slot = (slot + 1) & mask;
+    }
+    index->slot_keys[slot] = entries[i].key;
+    index->slot_rows[slot] = entries[i].row + 1;
+  }
+  index->entry_count += count;
+  
+  ProfEnd();
+}
+
+internal void
+gdb_index_sorted_insert(GDB_Index* index, GDB_IndexEntry* entries, U64 count)
+{
+  ProfBeginFunction();
+  
+  quick_sort(entries, count, sizeof(GDB_IndexEntry), gdb_index_entry_compare);
+  
+  // tec: merge the new entries into the existing order
+  U64 total = index->sorted_count + count;
+  U64* rows = push_array_no_zero(index->arena, U64, total);
+  U64* keys = push_array_no_zero(index->arena, U64, total);
+  
+  U64 a = 0, b = 0, out = 0;
+  while (a < index->sorted_count || b < count)
+  {
+    B32 take_old = (b >= count) || (a < index->sorted_count && index->sorted_keys[a] <= entries[b].key);
+    if (take_old)
+    {
+      keys[out] = index->sorted_keys[a];
+      rows[out] = index->sorted_rows[a];
+      a++;
+    }
+    else
+    {
+      keys[out] = entries[b].key;
+      rows[out] = entries[b].row;
+      b++;
+    }
+    out++;
+  }
+  
+  index->sorted_rows = rows;
+  index->sorted_keys = keys;
+  index->sorted_count = total;
+  
+  ProfEnd();
+}
+
+internal void
+gdb_index_reset(GDB_Index* index)
+{
+  arena_clear(index->arena);
+  index->row_count = 0;
+  index->stale = 0;
+  index->slot_count = 0;
+  index->entry_count = 0;
+  index->slot_keys = 0;
+  index->slot_rows = 0;
+  index->sorted_count = 0;
+  index->sorted_rows = 0;
+  index->sorted_keys = 0;
+}
+
+internal void
+gdb_index_refresh(GDB_Index* index)
+{
+  ProfBeginFunction();
+  os_rw_mutex_take_w(index->rw_mutex);
+  
+  // tec: only rows published to readers are indexed, a row mid-insert is picked up next time
+  U64 table_row_count = gdb_table_row_count(index->table);
+  
+  // tec: removed rows shift every index after them, start over
+  if (index->stale || index->row_count > table_row_count)
+  {
+    gdb_index_reset(index);
+    index->version++;
+  }
+  
+  if (index->row_count < table_row_count)
+  {
+    Temp scratch = scratch_begin(&index->arena, 1);
+    
+    U64 entry_count = 0;
+    GDB_IndexEntry* entries = gdb_index_gather_entries(scratch.arena, index, r1u64(index->row_count, table_row_count), &entry_count);
+    if (index->kind == GDB_IndexKind_Hash)
+    {
+      gdb_index_hash_insert(index, entries, entry_count);
+    }
+    else
+    {
+      gdb_index_sorted_insert(index, entries, entry_count);
+    }
+    
+    index->row_count = table_row_count;
+    index->version++;
+    
+    scratch_end(scratch);
+  }
+  
+  os_rw_mutex_drop_w(index->rw_mutex);
+  ProfEnd();
+}
+
+internal GDB_Index*
+gdb_index_alloc(GDB_Table* table, String8 name, GDB_Column* column, GDB_IndexKind kind)
+{
+  GDB_Index* index = push_array(table->arena, GDB_Index, 1);
+  index->arena = arena_alloc(.reserve_size=GDB_INDEX_ARENA_RESERVE_SIZE, .commit_size=GDB_INDEX_ARENA_COMMIT_SIZE);
+  index->rw_mutex = os_rw_mutex_alloc();
+  index->name = push_str8_copy(table->arena, name);
+  index->kind = kind;
+  index->table = table;
+  index->column = column;
+  return index;
+}
+
+internal GDB_Index*
+gdb_index_create(GDB_Table* table, String8 name, String8 column_name, GDB_IndexKind kind)
+{
+  ProfBeginFunction();
+  
+  GDB_Column* column = gdb_table_find_column(table, column_name);
+  if (!column)
+  {
+    ProfEnd();
+    return NULL;
+  }
+  
+  if (kind == GDB_IndexKind_Sorted && column->type == GDB_ColumnType_String8)
+  {
+    log_error("sorted index '%.*s' needs a numeric column, use a hash index for '%.*s'", str8_varg(name), str8_varg(column_name));
+    ProfEnd();
+    return NULL;
+  }
+  
+  // tec: creating an index is a write to the table
+  os_mutex_take(table->write_mutex);
+  
+  for (U64 i = 0; i < table->index_count; i++)
+  {
+    if (str8_match(table->indexes[i]->name, name, 0))
+    {
+      log_error("index '%.*s' already exists on table '%.*s'", str8_varg(name), str8_varg(table->name));
+      os_mutex_drop(table->write_mutex);
+      ProfEnd();
+      return NULL;
+    }
+  }
+  
+  U64 start_time = os_now_microseconds();
+  
+  // tec: a new index has never been written
+  GDB_Index* index = gdb_index_alloc(table, name, column, kind);
+  index->version = 1;
+  gdb_index_refresh(index);
+  gdb_table_add_index(table, index);
+  gdb_table_mark_dirty(table);
+  
+  os_mutex_drop(table->write_mutex);
+  
+  log_info("created %.*s index '%.*s' on %.*s(%.*s) over %llu rows in %.4f ms",
+           str8_varg(string_from_gdb_index_kind(kind)), str8_varg(name), str8_varg(table->name), str8_varg(column_name),
+           index->row_count, (os_now_microseconds() - start_time) / 1000.0f);
+  
+  ProfEnd();
+  return index;
+}
+
+internal void
+gdb_index_release(GDB_Index* index)
+{
+  os_rw_mutex_release(index->rw_mutex);
+  arena_release(index->arena);
+}
+
+//~ tec: lookups
+typedef struct GDB_IndexRowList GDB_IndexRowList;
+struct GDB_IndexRowList
+{
+  U64* rows;
+  U64 count;
+  U64 cap;
+};
+
+internal void
+gdb_index_row_list_push(Arena* arena, GDB_IndexRowList* list, U64 row)
+{
+  if (list->count == list->cap)
+  {
+    U64 new_cap = Max(16, list->cap * 2);
+    U64* new_rows = push_array_no_zero(arena, U64, new_cap);
+    if (list->count)
+    {
+      MemoryCopy(new_rows, list->rows, list->count * sizeof(U64));
+    }
+    list->rows = new_rows;
+    list->cap = new_cap;
+  }
+  list->rows[list->count++] = row;
+}
+
+internal U64
+gdb_index_lower_bound(GDB_Index* index, U64 key)
+{
+  U64 lo = 0;
+  U64 hi = index->sorted_count;
+  while (lo < hi)
+  {
+    U64 mid = lo + (hi - lo) / 2;
+    if (index->sorted_keys[mid] < key) lo = mid + 1;
+    else hi = mid;
+  }
+  return lo;
+}
+
+internal U64
+gdb_index_upper_bound(GDB_Index* index, U64 key)
+{
+  U64 lo = 0;
+  U64 hi = index->sorted_count;
+  while (lo < hi)
+  {
+    U64 mid = lo + (hi - lo) / 2;
+    if (index->sorted_keys[mid] <= key) lo = mid + 1;
+    else hi = mid;
+  }
+  return lo;
+}
+
+internal Rng1U64
+gdb_index_sorted_range(GDB_Index* index, U64 min_key, B32 min_inclusive, U64 max_key, B32 max_inclusive)
+{
+  U64 start = min_inclusive ? gdb_index_lower_bound(index, min_key) : gdb_index_upper_bound(index, min_key);
+  U64 end = max_inclusive ? gdb_index_upper_bound(index, max_key) : gdb_index_lower_bound(index, max_key);
+  Rng1U64 result = r1u64(start, Max(start, end));
+  return result;
+}
+
+internal U64
+gdb_index_count_range(GDB_Index* index, U64 min_key, B32 min_inclusive, U64 max_key, B32 max_inclusive)
+{
+  U64 result = 0;
+  OS_MutexScopeR(index->rw_mutex)
+  {
+    if (index->kind != GDB_IndexKind_Sorted)
+    {
+      result = index->entry_count;
+    }
+    else
+    {
+      result = dim_1u64(gdb_index_sorted_range(index, min_key, min_inclusive, max_key, max_inclusive));
+    }
+  }
+  return result;
+}
+
+// tec: callers hold rw_mutex for reading
+internal GDB_IndexLookup
+gdb_index_copy_sorted_range(Arena* arena, GDB_Index* index, U64 min_key, B32 min_inclusive, U64 max_key, B32 max_inclusive)
+{
+  GDB_IndexLookup result = {0};
+  Rng1U64 range = gdb_index_sorted_range(index, min_key, min_inclusive, max_key, max_inclusive);
+  result.count = dim_1u64(range);
+  result.rows = push_array_no_zero(arena, U64, result.count);
+  MemoryCopy(result.rows, index->sorted_rows + range.min, result.count * sizeof(U64));
+  return result;
+}
+
+internal GDB_IndexLookup
+gdb_index_lookup_range(Arena* arena, GDB_Index* index, U64 min_key, B32 min_inclusive, U64 max_key, B32 max_inclusive)
+{
+  ProfBeginFunction();
+  
+  GDB_IndexLookup result = {0};
+  if (index->kind != GDB_IndexKind_Sorted)
+  {
+    log_error("range lookup on hash index '%.*s'", str8_varg(index->name));
+    ProfEnd();
+    return result;
+  }
+  
+  OS_MutexScopeR(index->rw_mutex)
+  {
+    result = gdb_index_copy_sorted_range(arena, index, min_key, min_inclusive, max_key, max_inclusive);
+  }
+  
+  ProfEnd();
+  return result;
+}
+
+internal GDB_IndexLookup
+gdb_index_lookup_equal(Arena* arena, GDB_Index* index, U64 key, String8 string_key)
+{
+  ProfBeginFunction();
+  
+  GDB_IndexLookup result = {0};
+  os_rw_mutex_take_r(index->rw_mutex);
+  if (index->kind == GDB_IndexKind_Sorted)
+  {
+    result = gdb_index_copy_sorted_range(arena, index, key, 1, key, 1);
+  }
+  else if (index->slot_count > 0)
+  {
+    GDB_IndexRowList list = {0};
+    U64 mask = index->slot_count - 1;
+    U64 slot = gdb_index_hash_key(key) & mask;
+    
+    Temp scratch = scratch_begin(&arena, 1);
+    while (index->slot_rows[slot] != 0)
+    {
+      if (index->slot_keys[slot] == key)
+      {
+        U64 row = index->slot_rows[slot] - 1;
+        B32 match = 1;
+        
+        // tec: string keys are hashes, confirm against the column
+        if (index->column->type == GDB_ColumnType_String8)
+        {
+          String8 value = gdb_column_get_string(scratch.arena, index->column, row);
+          match = str8_match(value, string_key, 0);
+        }
+        
+        if (match)
+        {
+          gdb_index_row_list_push(arena, &list, row);
+        }
+      }
+      slot = (slot + 1) & mask;
+    }
+    scratch_end(scratch);
+    
+    result.rows = list.rows;
+    result.count = list.count;
+  }
+  os_rw_mutex_drop_r(index->rw_mutex);
+  
+  ProfEnd();
+  return result;
+}
+
+//~ tec: persistence
+internal B32
+gdb_index_save(GDB_Index* index, String8 table_dir)
+{
+  ProfBeginFunction();
+  
+  Temp scratch = scratch_begin(0, 0);
+  String8 index_path = push_str8f(scratch.arena, "%.*s/%.*s" GDB_INDEX_FILE_EXTENSION, str8_varg(table_dir), str8_varg(index->name));
+  os_rw_mutex_take_r(index->rw_mutex);
+  
+  GDB_IndexHeader* header = push_array(scratch.arena, GDB_IndexHeader, 1);
+  header->magic = GDB_INDEX_MAGIC;
+  header->version = GDB_INDEX_VERSION;
+  header->kind = index->kind;
+  header->column_name_size = (U32)index->column->name.size;
+  header->row_count = index->row_count;
+  header->count = (index->kind == GDB_IndexKind_Hash) ? index->slot_count : index->sorted_count;
+  
+  String8List data = {0};
+  str8_list_push(scratch.arena, &data, str8((U8*)header, sizeof(*header)));
+  str8_list_push(scratch.arena, &data, index->column->name);
+  if (index->kind == GDB_IndexKind_Hash)
+  {
+    str8_list_push(scratch.arena, &data, str8((U8*)index->slot_keys, index->slot_count * sizeof(U64)));
+    str8_list_push(scratch.arena, &data, str8((U8*)index->slot_rows, index->slot_count * sizeof(U64)));
+  }
+  else
+  {
+    str8_list_push(scratch.arena, &data, str8((U8*)index->sorted_rows, index->sorted_count * sizeof(U64)));
+    str8_list_push(scratch.arena, &data, str8((U8*)index->sorted_keys, index->sorted_count * sizeof(U64)));
+  }
+  
+  B32 result = gdb_write_file_atomic(index_path, data);
+  os_rw_mutex_drop_r(index->rw_mutex);
+  if (!result)
+  {
+    log_error("failed to write index file: %.*s", str8_varg(index_path));
+  }
+  
+  scratch_end(scratch);
+  ProfEnd();
+  return result;
+}
+
+internal GDB_Index*
+gdb_index_load(GDB_Table* table, String8 path)
+{
+  ProfBeginFunction();
+  
+  Temp scratch = scratch_begin(0, 0);
+  String8 data = os_data_from_file_path(scratch.arena, path);
+  GDB_IndexHeader* header = (GDB_IndexHeader*)data.str;
+  
+  if (data.size < sizeof(GDB_IndexHeader) || header->magic != GDB_INDEX_MAGIC || header->version != GDB_INDEX_VERSION ||
+      header->kind >= GDB_IndexKind_COUNT)
+  {
+    log_error("invalid index file: %.*s", str8_varg(path));
+    scratch_end(scratch);
+    ProfEnd();
+    return NULL;
+  }
+  
+  U64 expected_size = sizeof(GDB_IndexHeader) + header->column_name_size + header->count * sizeof(U64) * 2;
+  if (data.size < expected_size)
+  {
+    log_error("index file is truncated: %.*s", str8_varg(path));
+    scratch_end(scratch);
+    ProfEnd();
+    return NULL;
+  }
+  
+  U8* read_ptr = data.str + sizeof(GDB_IndexHeader);
+  String8 column_name = str8(read_ptr, header->column_name_size);
+  read_ptr += header->column_name_size;
+  
+  GDB_Column* column = gdb_table_find_column(table, column_name);
+  if (!column)
+  {
+    scratch_end(scratch);
+    ProfEnd();
+    return NULL;
+  }
+  
+  String8 name = str8_chop_last_dot(str8_skip_last_slash(path));
+  GDB_Index* index = gdb_index_alloc(table, name, column, header->kind);
+  index->row_count = header->row_count;
+  
+  U64* first = push_array_no_zero(index->arena, U64, header->count);
+  U64* second = push_array_no_zero(index->arena, U64, header->count);
+  MemoryCopy(first, read_ptr, header->count * sizeof(U64));
+  read_ptr += header->count * sizeof(U64);
+  MemoryCopy(second, read_ptr, header->count * sizeof(U64));
+  
+  if (header->kind == GDB_IndexKind_Hash)
+  {
+    index->slot_count = header->count;
+    index->slot_keys = first;
+    index->slot_rows = second;
+    for (U64 i = 0; i < index->slot_count; i++)
+    {
+      index->entry_count += (index->slot_rows[i] != 0);
+    }
+  }
+  else
+  {
+    index->sorted_count = header->count;
+    index->sorted_rows = first;
+    index->sorted_keys = second;
+  }
+  
+  // tec: an index that covers rows the column no longer has is rebuilt on first use
+  index->stale = (index->row_count > column->row_count);
+  index->flushed_version = index->version;
+  
+  scratch_end(scratch);
+  ProfEnd();
+  return index;
+}
+
+//~ tec: tables
+internal void
+gdb_table_add_index(GDB_Table* table, GDB_Index* index)
+{
+  if (table->index_count == 0)
+  {
+    table->indexes = push_array(table->arena, GDB_Index*, 2);
+    table->index_capacity = 2;
+  }
+  else if (table->index_count >= table->index_capacity)
+  {
+    U64 new_capacity = table->index_capacity * 2;
+    GDB_Index** new_indexes = push_array(table->arena, GDB_Index*, new_capacity);
+    MemoryCopy(new_indexes, table->indexes, sizeof(GDB_Index*) * table->index_count);
+    table->indexes = new_indexes;
+    table->index_capacity = new_capacity;
+  }
+  
+  // tec: readers walk indexes without a lock, the slot is filled before the count grows
+  table->indexes[table->index_count] = index;
+  ins_atomic_u64_inc_eval(&table->index_count);
+}
+
+internal GDB_Index*
+gdb_table_find_index(GDB_Table* table, String8 column_name, GDB_IndexKind kind)
+{
+  for (U64 i = 0; i < table->index_count; i++)
+  {
+    GDB_Index* index = table->indexes[i];
+    if (index->kind == kind && str8_match(index->column->name, column_name, 0))
+    {
+      return index;
+    }
+  }
+  return NULL;
+}
+
+internal void
+gdb_table_invalidate_indexes(GDB_Table* table)
+{
+  for (U64 i = 0; i < table->index_count; i++)
+  {
+    table->indexes[i]->stale = 1;
+  }
+}
+
+internal void
+gdb_table_load_indexes(GDB_Table* table, String8 table_dir)
+{
+  ProfBeginFunction();
+  
+  Temp scratch = scratch_begin(0, 0);
+  OS_FileIter* it = os_file_iter_begin(scratch.arena, table_dir, OS_FileIterFlag_SkipFolders);
+  for (OS_FileInfo info = {0}; os_file_iter_next(scratch.arena, it, &info);)
+  {
+    if (!str8_ends_with(info.name, str8_lit(GDB_INDEX_FILE_EXTENSION), 0))
+    {
+      continue;
+    }
+    
+    String8 index_path = push_str8f(scratch.arena, "%.*s/%.*s", str8_varg(table_dir), str8_varg(info.name));
+    GDB_Index* index = gdb_index_load(table, index_path);
+    if (index)
+    {
+      gdb_table_add_index(table, index);
+    }
+  }
+  os_file_iter_end(it);
+  
+  scratch_end(scratch);
+  ProfEnd();
+}
+
+internal GDB_IndexKind
+gdb_index_kind_from_string(String8 str)
+{
+  if (str8_match(str, str8_lit("hash"), StringMatchFlag_CaseInsensitive))
+  {
+    return GDB_IndexKind_Hash;
+  }
+  else if (str8_match(str, str8_lit("sorted"), StringMatchFlag_CaseInsensitive) ||
+           str8_match(str, str8_lit("btree"), StringMatchFlag_CaseInsensitive))
+  {
+    return GDB_IndexKind_Sorted;
+  }
+  
+  log_error("unknown index kind '%.*s', using sorted", str8_varg(str));
+  return GDB_IndexKind_Sorted;
+}
+
+internal String8
+string_from_gdb_index_kind(GDB_IndexKind kind)
+{
+  String8 result = str8_lit("");
+  switch (kind)
+  {
+    case GDB_IndexKind_Hash:   { result = str8_lit("hash"); } break;
+    case GDB_IndexKind_Sorted: { result = str8_lit("sorted"); } break;
+  }
+  return result;
+}
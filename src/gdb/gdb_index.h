@@ -0,0 +1,115 @@
+/* date = October 19th 2026 2:40 pm */
+
+#ifndef GDB_INDEX_H
+#define GDB_INDEX_H
+
+#define GDB_INDEX_MAGIC   0x58444947 // tec: 'GIDX'
+#define GDB_INDEX_VERSION 1
+
+#ifndef GDB_INDEX_FILE_EXTENSION
+#define GDB_INDEX_FILE_EXTENSION ".idx"
+#endif
+#ifndef GDB_INDEX_ARENA_RESERVE_SIZE
+#define GDB_INDEX_ARENA_RESERVE_SIZE GB(4)
+#endif
+#ifndef GDB_INDEX_ARENA_COMMIT_SIZE
+#define GDB_INDEX_ARENA_COMMIT_SIZE MB(1)
+#endif
+#ifndef GDB_INDEX_BUILD_BATCH_ROWS
+#define GDB_INDEX_BUILD_BATCH_ROWS 65536
+#endif
+// tec: hash slots are kept at most this full (percent)
+#ifndef GDB_INDEX_HASH_MAX_LOAD
+#define GDB_INDEX_HASH_MAX_LOAD 50
+#endif
+
+typedef U32 GDB_IndexKind;
+enum
+{
+  GDB_IndexKind_Hash,
+  GDB_IndexKind_Sorted,
+  GDB_IndexKind_COUNT
+};
+
+// tec: every value is reduced to a U64 key. integers are used as is, floats have their bits
+// flipped so unsigned order matches float order, strings store a hash and are checked against the column.
+// rows holding null are not indexed, a comparison against null is never true
+typedef struct GDB_Index GDB_Index;
+struct GDB_Index
+{
+  Arena* arena;
+  
+  String8 name;
+  GDB_IndexKind kind;
+  GDB_Table* table;
+  GDB_Column* column;
+  
+  // tec: refresh takes this for writing, lookups and saves for reading
+  OS_Handle rw_mutex;
+  
+  // tec: rows [0, row_count) of the table are indexed, later inserts are folded in on the next lookup.
+  // concurrent readers may have folded in rows past another reader's snapshot, lookups filter by snapshot
+  U64 row_count;
+  B32 stale;
+  
+  // tec: hash, open addressing with linear probing. slot_rows holds row + 1, 0 is an empty slot
+  U64 slot_count;
+  U64 entry_count;
+  U64* slot_keys;
+  U64* slot_rows;
+  
+  // tec: sorted, row indices ordered by key with the keys alongside for binary search
+  U64 sorted_count;
+  U64* sorted_rows;
+  U64* sorted_keys;
+  
+  U64 version;
+  U64 flushed_version;
+};
+
+// tec: on disk [GDB_IndexHeader][column name][hash: slot_keys, slot_rows | sorted: sorted_rows, sorted_keys]
+typedef struct GDB_IndexHeader GDB_IndexHeader;
+struct GDB_IndexHeader
+{
+  U32 magic;
+  U32 version;
+  GDB_IndexKind kind;
+  U32 column_name_size;
+  U64 row_count;
+  U64 count;
+};
+
+// tec: the rows a lookup found, in key order for range lookups
+typedef struct GDB_IndexLookup GDB_IndexLookup;
+struct GDB_IndexLookup
+{
+  U64* rows;
+  U64 count;
+};
+
+internal GDB_Index*      gdb_index_create(GDB_Table* table, String8 name, String8 column_name, GDB_IndexKind kind);
+internal void            gdb_index_release(GDB_Index* index);
+internal void            gdb_index_refresh(GDB_Index* index);
+internal B32             gdb_index_save(GDB_Index* index, String8 table_dir);
+internal GDB_Index*      gdb_index_load(GDB_Table* table, String8 path);
+
+internal GDB_IndexLookup gdb_index_lookup_equal(Arena* arena, GDB_Index* index, U64 key, String8 string_key);
+internal GDB_IndexLookup gdb_index_lookup_range(Arena* arena, GDB_Index* index, U64 min_key, B32 min_inclusive, U64 max_key, B32 max_inclusive);
+internal U64             gdb_index_count_range(GDB_Index* index, U64 min_key, B32 min_inclusive, U64 max_key, B32 max_inclusive);
+
+//~ tec: keys
+internal U64             gdb_index_key_from_data(GDB_ColumnType type, void* data);
+internal B32             gdb_index_key_from_string(GDB_ColumnType type, String8 value, U64* out_key);
+internal U64             gdb_index_hash_key(U64 key);
+internal U64             gdb_index_hash_string(String8 string);
+
+//~ tec: tables
+internal void            gdb_table_add_index(GDB_Table* table, GDB_Index* index);
+internal GDB_Index*      gdb_table_find_index(GDB_Table* table, String8 column_name, GDB_IndexKind kind);
+internal void            gdb_table_invalidate_indexes(GDB_Table* table);
+internal void            gdb_table_load_indexes(GDB_Table* table, String8 table_dir);
+
+internal GDB_IndexKind   gdb_index_kind_from_string(String8 str);
+internal String8         string_from_gdb_index_kind(GDB_IndexKind kind);
+
+#endif //GDB_INDEX_H
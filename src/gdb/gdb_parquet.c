@@ -0,0 +1,1547 @@
+//~ tec: thrift compact protocol
+internal U8
+gdb_thrift_read_byte(GDB_ThriftReader* reader)
+{
+  U8 result = 0;
+  if (!reader->failed && reader->at < reader->end)
+  {
+    result = *reader->at++;
+  }
+  else
+  {
+    reader->failed = 1;
+  }
+  return result;
+}
+
+internal U64
+gdb_thrift_read_varint(GDB_ThriftReader* reader)
+{
+  U64 result = 0;
+  for (U32 shift = 0; shift < 64; shift += 7)
+  {
+    U8 byte = gdb_thrift_read_byte(reader);
+    result |= (U64)(byte & 0x7f) << shift;
+    if (!(byte & 0x80))
+    {
+      break;
+    }
+  }
+  return result;
+}
+
+internal S64
+gdb_thrift_read_zigzag(GDB_ThriftReader* reader)
+{
+  U64 value = gdb_thrift_read_varint(reader);
+  S64 result = (S64)(value >> 1) ^ -(S64)(value & 1);
+  return result;
+}
+
+internal String8
+gdb_thrift_read_binary(GDB_ThriftReader* reader)
+{
+  String8 result = {0};
+  U64 size = gdb_thrift_read_varint(reader);
+  if (!reader->failed && size <= (U64)(reader->end - reader->at))
+  {
+    result = str8(reader->at, size);
+    reader->at += size;
+  }
+  else
+  {
+    reader->failed = 1;
+  }
+  return result;
+}
+
+// tec: [size << 4 | element type], a size of 15 means the real size follows as a varint
+internal U64
+gdb_thrift_read_list(GDB_ThriftReader* reader, GDB_ThriftType* out_element_type)
+{
+  U8 header = gdb_thrift_read_byte(reader);
+  U64 result = header >> 4;
+  if (result == 15)
+  {
+    result = gdb_thrift_read_varint(reader);
+  }
+  *out_element_type = header & 0x0f;
+  return result;
+}
+
+// tec: [delta << 4 | type], a delta of 0 means the field id follows. returns 0 at the end of the struct.
+// booleans carry their value in the type and have no payload
+internal B32
+gdb_thrift_next_field(GDB_ThriftReader* reader, S16* field_id, GDB_ThriftType* out_type)
+{
+  U8 header = gdb_thrift_read_byte(reader);
+  if (header == GDB_ThriftType_Stop || reader->failed)
+  {
+    return 0;
+  }
+  
+  U8 delta = header >> 4;
+  if (delta == 0)
+  {
+    *field_id = (S16)gdb_thrift_read_zigzag(reader);
+  }
+  else
+  {
+    *field_id += delta;
+  }
+  *out_type = header & 0x0f;
+  return !reader->failed;
+}
+
+internal void
+gdb_thrift_skip_element(GDB_ThriftReader* reader, GDB_ThriftType type)
+{
+  // tec: inside lists and maps a boolean is a whole byte
+  if (type == GDB_ThriftType_True || type == GDB_ThriftType_False)
+  {
+    gdb_thrift_read_byte(reader);
+  }
+  else
+  {
+    gdb_thrift_skip(reader, type);
+  }
+}
+
+internal void
+gdb_thrift_skip(GDB_ThriftReader* reader, GDB_ThriftType type)
+{
+  switch (type)
+  {
+    case GDB_ThriftType_True:
+    case GDB_ThriftType_False: break;
+    case GDB_ThriftType_Byte: { gdb_thrift_read_byte(reader); } break;
+    
+    case GDB_ThriftType_I16:
+    case GDB_ThriftType_I32:
+    case GDB_ThriftType_I64: { gdb_thrift_read_varint(reader); } break;
+    
+    case GDB_ThriftType_Double:
+    {
+      for (U64 i = 0; i < sizeof(F64); i++)
+      {
+        gdb_thrift_read_byte(reader);
+      }
+    } break;
+    
+    case GDB_ThriftType_Binary: { gdb_thrift_read_binary(reader); } break;
+    
+    case GDB_ThriftType_List:
+    case GDB_ThriftType_Set:
+    {
+      GDB_ThriftType element_type = 0;
+      U64 count = gdb_thrift_read_list(reader, &element_type);
+      for (U64 i = 0; i < count && !reader->failed; i++)
+      {
+        gdb_thrift_skip_element(reader, element_type);
+      }
+    } break;
+    
+    case GDB_ThriftType_Map:
+    {
+      U64 count = gdb_thrift_read_varint(reader);
+      U8 types = (count > 0) ? gdb_thrift_read_byte(reader) : 0;
+      for (U64 i = 0; i < count && !reader->failed; i++)
+      {
+        gdb_thrift_skip_element(reader, types >> 4);
+        gdb_thrift_skip_element(reader, types & 0x0f);
+      }
+    } break;
+    
+    case GDB_ThriftType_Struct:
+    {
+      S16 field_id = 0;
+      GDB_ThriftType field_type = 0;
+      while (gdb_thrift_next_field(reader, &field_id, &field_type))
+      {
+        gdb_thrift_skip(reader, field_type);
+      }
+    } break;
+    
+    default: { reader->failed = 1; } break;
+  }
+}
+
+//~ tec: decompression
+// tec: raw snappy, a varint of the uncompressed size then literals and back references
+internal B32
+gdb_parquet_snappy_decompress(String8 src, U8* dst, U64 dst_size)
+{
+  GDB_ThriftReader reader = { src.str, src.str + src.size, 0 };
+  if (gdb_thrift_read_varint(&reader) != dst_size || reader.failed)
+  {
+    return 0;
+  }
+  
+  U8* at = reader.at;
+  U8* end = reader.end;
+  U64 out = 0;
+  while (at < end)
+  {
+    U8 tag = *at++;
+    U64 length = 0;
+    U64 offset = 0;
+    switch (tag & 3)
+    {
+      case 0:
+      {
+        // tec: literal, lengths past 60 are stored in the next 1 to 4 bytes
+        length = tag >> 2;
+        if (length >= 60)
+        {
+          U64 extra = length - 59;
+          if (extra > (U64)(end - at))
+          {
+            return 0;
+          }
+          length = 0;
+          for (U64 i = 0; i < extra; i++)
+          {
+            length |= (U64)at[i] << (8 * i);
+          }
+          at += extra;
+        }
+        length += 1;
+        
+        if (length > (U64)(end - at) || length > dst_size - out)
+        {
+          return 0;
+        }
+        MemoryCopy(dst + out, at, length);
+        at += length;
+        out += length;
+        continue;
+      }
+      
+      case 1:
+      {
+        if (at >= end)
+        {
+          return 0;
+        }
+        length = ((tag >> 2) & 7) + 4;
+        offset = ((U64)(tag >> 5) << 8) | at[0];
+        at += 1;
+      } break;
+      
+      case 2:
+      {
+        if ((U64)(end - at) < 2)
+        {
+          return 0;
+        }
+        length = (tag >> 2) + 1;
+        offset = (U64)at[0] | ((U64)at[1] << 8);
+        at += 2;
+      } break;
+      
+      case 3:
+      {
+        if ((U64)(end - at) < 4)
+        {
+          return 0;
+        }
+        length = (tag >> 2) + 1;
+        offset = (U64)at[0] | ((U64)at[1] << 8) | ((U64)at[2] << 16) | ((U64)at[3] << 24);
+        at += 4;
+      } break;
+    }
+    
+    if (offset == 0 || offset > out || length > dst_size - out)
+    {
+      return 0;
+    }
+    
+    // tec: a reference may overlap what it writes, byte by byte repeats the pattern the way the format means
+    for (U64 i = 0; i < length; i++)
+    {
+      dst[out + i] = dst[out - offset + i];
+    }
+    out += length;
+  }
+  
+  return out == dst_size;
+}
+
+internal B32
+gdb_parquet_lz4_read_length(U8** at, U8* end, U64* length)
+{
+  U8 byte = 255;
+  while (byte == 255)
+  {
+    if (*at >= end)
+    {
+      return 0;
+    }
+    byte = *(*at)++;
+    *length += byte;
+  }
+  return 1;
+}
+
+// tec: a raw lz4 block, sequences of [token][literals][U16 offset][match] with the last one only literals
+internal B32
+gdb_parquet_lz4_decompress(String8 src, U8* dst, U64 dst_size)
+{
+  U8* at = src.str;
+  U8* end = src.str + src.size;
+  U64 out = 0;
+  while (at < end)
+  {
+    U8 token = *at++;
+    U64 literal_length = token >> 4;
+    if (literal_length == 15 && !gdb_parquet_lz4_read_length(&at, end, &literal_length))
+    {
+      return 0;
+    }
+    if (literal_length > (U64)(end - at) || literal_length > dst_size - out)
+    {
+      return 0;
+    }
+    MemoryCopy(dst + out, at, literal_length);
+    at += literal_length;
+    out += literal_length;
+    
+    if (at >= end)
+    {
+      break;
+    }
+    
+    if ((U64)(end - at) < 2)
+    {
+      return 0;
+    }
+    U64 offset = (U64)at[0] | ((U64)at[1] << 8);
+    at += 2;
+    
+    U64 match_length = token & 15;
+    if (match_length == 15 && !gdb_parquet_lz4_read_length(&at, end, &match_length))
+    {
+      return 0;
+    }
+    match_length += 4;
+    
+    if (offset == 0 || offset > out || match_length > dst_size - out)
+    {
+      return 0;
+    }
+    for (U64 i = 0; i < match_length; i++)
+    {
+      dst[out + i] = dst[out - offset + i];
+    }
+    out += match_length;
+  }
+  
+  return out == dst_size;
+}
+
+internal B32
+gdb_parquet_decompress(Arena* arena, GDB_ParquetCodec codec, String8 src, U64 size, String8* out)
+{
+  B32 result = 0;
+  switch (codec)
+  {
+    case GDB_ParquetCodec_Uncompressed:
+    {
+      *out = src;
+      result = 1;
+    } break;
+    
+    case GDB_ParquetCodec_Snappy:
+    case GDB_ParquetCodec_LZ4Raw:
+    {
+      U8* data = push_array_no_zero(arena, U8, Max(1, size));
+      result = (codec == GDB_ParquetCodec_Snappy) ? gdb_parquet_snappy_decompress(src, data, size) : gdb_parquet_lz4_decompress(src, data, size);
+      *out = str8(data, size);
+    } break;
+    
+    default: break;
+  }
+  return result;
+}
+
+//~ tec: encodings
+// tec: the rle / bit packed hybrid used for levels and dictionary indices, runs are headed by a varint
+// whose low bit picks between a repeated value and groups of 8 bit packed values
+internal B32
+gdb_parquet_decode_hybrid(String8 src, U32 bit_width, U32* out, U64 count)
+{
+  if (bit_width > 32)
+  {
+    return 0;
+  }
+  
+  GDB_ThriftReader reader = { src.str, src.str + src.size, 0 };
+  U64 byte_width = (bit_width + 7) / 8;
+  U64 mask = ((U64)1 << bit_width) - 1;
+  U64 done = 0;
+  while (done < count)
+  {
+    U64 header = gdb_thrift_read_varint(&reader);
+    U64 available = (U64)(reader.end - reader.at);
+    if (reader.failed)
+    {
+      return 0;
+    }
+    
+    if (header & 1)
+    {
+      //- tec: bit packed, least significant bit first. writers may cut the final group short
+      U64 value_count = Min((header >> 1) * 8, count - done);
+      U64 byte_count = Min((header >> 1) * bit_width, available);
+      if (value_count == 0 || (value_count * bit_width + 7) / 8 > byte_count)
+      {
+        return 0;
+      }
+      for (U64 i = 0; i < value_count; i++)
+      {
+        U64 bit = i * bit_width;
+        U64 word = 0;
+        MemoryCopy(&word, reader.at + bit / 8, Min(sizeof(word), byte_count - bit / 8));
+        out[done + i] = (U32)((word >> (bit & 7)) & mask);
+      }
+      reader.at += byte_count;
+      done += value_count;
+    }
+    else
+    {
+      //- tec: one value repeated, stored in as few whole bytes as its width needs
+      U64 run_length = Min(header >> 1, count - done);
+      if (run_length == 0 || byte_width > available)
+      {
+        return 0;
+      }
+      U32 value = 0;
+      MemoryCopy(&value, reader.at, byte_width);
+      reader.at += byte_width;
+      for (U64 i = 0; i < run_length; i++)
+      {
+        out[done + i] = value;
+      }
+      done += run_length;
+    }
+  }
+  return 1;
+}
+
+// tec: next plain encoded value. booleans are single bits, so the position is counted in bits
+internal B32
+gdb_parquet_plain_next(GDB_ParquetColumnDesc* desc, String8 data, U64* bit_pos, void* out, String8* out_string)
+{
+  U64 at = *bit_pos / 8;
+  U64 left = (at <= data.size) ? data.size - at : 0;
+  B32 result = 0;
+  switch (desc->physical_type)
+  {
+    case GDB_ParquetPhysicalType_Boolean:
+    {
+      result = (left >= 1);
+      if (result)
+      {
+        *(U32*)out = (data.str[at] >> (*bit_pos & 7)) & 1;
+        *bit_pos += 1;
+      }
+    } break;
+    
+    case GDB_ParquetPhysicalType_Int32:
+    case GDB_ParquetPhysicalType_Float:
+    case GDB_ParquetPhysicalType_Int64:
+    case GDB_ParquetPhysicalType_Double:
+    {
+      U64 size = g_gdb_column_type_size[desc->column_type];
+      result = (left >= size);
+      if (result)
+      {
+        MemoryCopy(out, data.str + at, size);
+        *bit_pos += size * 8;
+      }
+    } break;
+    
+    case GDB_ParquetPhysicalType_ByteArray:
+    {
+      U32 size = 0;
+      result = (left >= sizeof(U32));
+      if (result)
+      {
+        MemoryCopy(&size, data.str + at, sizeof(U32));
+        result = (size <= left - sizeof(U32));
+      }
+      if (result)
+      {
+        *out_string = str8(data.str + at + sizeof(U32), size);
+        *bit_pos += (sizeof(U32) + size) * 8;
+      }
+    } break;
+    
+    default: break;
+  }
+  return result;
+}
+
+//~ tec: footer
+internal B32
+gdb_parquet_read_statistics(GDB_ThriftReader* reader, GDB_ParquetChunkMeta* meta)
+{
+  String8 legacy_min = {0};
+  String8 legacy_max = {0};
+  S16 field_id = 0;
+  GDB_ThriftType type = 0;
+  while (gdb_thrift_next_field(reader, &field_id, &type))
+  {
+    switch (field_id)
+    {
+      case 1:  { legacy_max = gdb_thrift_read_binary(reader); } break;
+      case 2:  { legacy_min = gdb_thrift_read_binary(reader); } break;
+      case 3:  { meta->null_count = gdb_thrift_read_zigzag(reader); meta->has_null_count = 1; } break;
+      case 5:  { meta->max = gdb_thrift_read_binary(reader); } break;
+      case 6:  { meta->min = gdb_thrift_read_binary(reader); } break;
+      default: { gdb_thrift_skip(reader, type); } break;
+    }
+  }
+  
+  if (meta->min.size == 0 && meta->max.size == 0)
+  {
+    meta->min = legacy_min;
+    meta->max = legacy_max;
+    meta->legacy_stats = 1;
+  }
+  return !reader->failed;
+}
+
+internal B32
+gdb_parquet_read_column_chunk(GDB_ThriftReader* reader, GDB_ParquetChunkMeta* meta)
+{
+  B32 result = 1;
+  S16 field_id = 0;
+  GDB_ThriftType type = 0;
+  while (gdb_thrift_next_field(reader, &field_id, &type))
+  {
+    if (field_id == 1)
+    {
+      // tec: the chunk lives in another file, this reader only follows the one it was given
+      gdb_thrift_read_binary(reader);
+      result = 0;
+    }
+    else if (field_id == 3)
+    {
+      //- tec: ColumnMetaData
+      S16 meta_field_id = 0;
+      GDB_ThriftType meta_type = 0;
+      while (gdb_thrift_next_field(reader, &meta_field_id, &meta_type))
+      {
+        switch (meta_field_id)
+        {
+          case 4:  { meta->codec = (GDB_ParquetCodec)gdb_thrift_read_zigzag(reader); } break;
+          case 5:  { meta->value_count = gdb_thrift_read_zigzag(reader); } break;
+          case 7:  { meta->compressed_size = gdb_thrift_read_zigzag(reader); } break;
+          case 9:  { meta->data_page_offset = gdb_thrift_read_zigzag(reader); } break;
+          case 11: { meta->dictionary_page_offset = gdb_thrift_read_zigzag(reader); } break;
+          case 12: { gdb_parquet_read_statistics(reader, meta); } break;
+          default: { gdb_thrift_skip(reader, meta_type); } break;
+        }
+      }
+    }
+    else
+    {
+      gdb_thrift_skip(reader, type);
+    }
+  }
+  return result && !reader->failed;
+}
+
+internal void
+gdb_parquet_read_schema_element(GDB_ThriftReader* reader, GDB_ParquetSchemaElement* element)
+{
+  S16 field_id = 0;
+  GDB_ThriftType type = 0;
+  while (gdb_thrift_next_field(reader, &field_id, &type))
+  {
+    switch (field_id)
+    {
+      case 1: { element->physical_type = (GDB_ParquetPhysicalType)gdb_thrift_read_zigzag(reader); element->has_type = 1; } break;
+      case 3: { element->repetition = (GDB_ParquetRepetition)gdb_thrift_read_zigzag(reader); } break;
+      case 4: { element->name = gdb_thrift_read_binary(reader); } break;
+      case 5: { element->child_count = gdb_thrift_read_zigzag(reader); } break;
+      case 6: { element->converted_type = (U32)gdb_thrift_read_zigzag(reader); } break;
+      
+      case 10:
+      {
+        //- tec: LogicalType union, only INTEGER says anything about how values compare
+        S16 logical_field_id = 0;
+        GDB_ThriftType logical_type = 0;
+        while (gdb_thrift_next_field(reader, &logical_field_id, &logical_type))
+        {
+          if (logical_field_id != 10)
+          {
+            gdb_thrift_skip(reader, logical_type);
+            continue;
+          }
+          
+          S16 int_field_id = 0;
+          GDB_ThriftType int_type = 0;
+          while (gdb_thrift_next_field(reader, &int_field_id, &int_type))
+          {
+            if (int_field_id == 2)
+            {
+              element->is_unsigned = (int_type == GDB_ThriftType_False);
+            }
+            else
+            {
+              gdb_thrift_skip(reader, int_type);
+            }
+          }
+        }
+      } break;
+      
+      default: { gdb_thrift_skip(reader, type); } break;
+    }
+  }
+}
+
+internal B32
+gdb_parquet_read_footer(Arena* arena, GDB_ParquetFile* file, String8 path)
+{
+  //- tec: [footer][U32 footer size][magic] at the end of the file
+  U8 head[GDB_PARQUET_MAGIC_SIZE] = { 0 };
+  U8 tail[sizeof(U32) + GDB_PARQUET_MAGIC_SIZE] = { 0 };
+  U32 footer_size = 0;
+  if (file->size >= sizeof(head) + sizeof(tail))
+  {
+    os_file_read(file->handle, r1u64(0, sizeof(head)), head);
+    os_file_read(file->handle, r1u64(file->size - sizeof(tail), file->size), tail);
+    MemoryCopy(&footer_size, tail, sizeof(footer_size));
+  }
+  if (!MemoryMatch(head, GDB_PARQUET_MAGIC, GDB_PARQUET_MAGIC_SIZE) || !MemoryMatch(tail + sizeof(U32), GDB_PARQUET_MAGIC, GDB_PARQUET_MAGIC_SIZE) ||
+      footer_size == 0 || footer_size > file->size - sizeof(head) - sizeof(tail))
+  {
+    log_error("'%.*s' is not a Parquet file", str8_varg(path));
+    return 0;
+  }
+  
+  U64 footer_at = file->size - sizeof(tail) - footer_size;
+  U8* footer = push_array_no_zero(arena, U8, footer_size);
+  if (os_file_read(file->handle, r1u64(footer_at, footer_at + footer_size), footer) != footer_size)
+  {
+    log_error("failed to read the footer of %.*s", str8_varg(path));
+    return 0;
+  }
+  
+  //- tec: FileMetaData, the schema is a tree flattened depth first with the root first
+  GDB_ThriftReader reader = { footer, footer + footer_size, 0 };
+  GDB_ParquetSchemaElement* elements = 0;
+  U64 element_count = 0;
+  B32 result = 1;
+  S16 field_id = 0;
+  GDB_ThriftType type = 0;
+  while (result && gdb_thrift_next_field(&reader, &field_id, &type))
+  {
+    if (field_id == 2)
+    {
+      GDB_ThriftType element_type = 0;
+      element_count = gdb_thrift_read_list(&reader, &element_type);
+      result = (element_count <= footer_size);
+      elements = push_array(arena, GDB_ParquetSchemaElement, result ? element_count : 0);
+      for (U64 i = 0; i < element_count && result && !reader.failed; i++)
+      {
+        gdb_parquet_read_schema_element(&reader, &elements[i]);
+      }
+    }
+    else if (field_id == 4)
+    {
+      GDB_ThriftType group_type = 0;
+      file->row_group_count = gdb_thrift_read_list(&reader, &group_type);
+      result = (file->row_group_count <= footer_size);
+      file->row_groups = push_array(arena, GDB_ParquetRowGroup, result ? file->row_group_count : 0);
+      for (U64 g = 0; g < file->row_group_count && result && !reader.failed; g++)
+      {
+        GDB_ParquetRowGroup* group = &file->row_groups[g];
+        U64 chunk_count = 0;
+        S16 group_field_id = 0;
+        GDB_ThriftType group_field_type = 0;
+        while (result && gdb_thrift_next_field(&reader, &group_field_id, &group_field_type))
+        {
+          if (group_field_id == 1)
+          {
+            GDB_ThriftType chunk_type = 0;
+            chunk_count = gdb_thrift_read_list(&reader, &chunk_type);
+            result = (chunk_count <= footer_size && (file->column_count == 0 || chunk_count == file->column_count));
+            file->column_count = chunk_count;
+            group->chunks = push_array(arena, GDB_ParquetChunkMeta, result ? chunk_count : 0);
+            for (U64 c = 0; c < chunk_count && result; c++)
+            {
+              result = gdb_parquet_read_column_chunk(&reader, &group->chunks[c]);
+            }
+          }
+          else if (group_field_id == 3)
+          {
+            group->row_count = gdb_thrift_read_zigzag(&reader);
+          }
+          else
+          {
+            gdb_thrift_skip(&reader, group_field_type);
+          }
+        }
+        result = result && (group->chunks != 0 || file->column_count == 0);
+      }
+    }
+    else
+    {
+      gdb_thrift_skip(&reader, type);
+    }
+  }
+  
+  if (!result || reader.failed || element_count == 0)
+  {
+    log_error("the footer of %.*s is damaged or uses column chunks in other files", str8_varg(path));
+    return 0;
+  }
+  
+  //- tec: leaves in schema order are the column chunks in every row group
+  U64 leaf_count = 0;
+  for (U64 i = 1; i < element_count; i++)
+  {
+    leaf_count += (elements[i].child_count == 0);
+  }
+  if (file->row_group_count > 0 && leaf_count != file->column_count)
+  {
+    log_error("%.*s has %llu schema leaves but %llu column chunks per row group", str8_varg(path), leaf_count, file->column_count);
+    return 0;
+  }
+  
+  file->column_count = leaf_count;
+  file->columns = push_array(arena, GDB_ParquetColumnDesc, leaf_count);
+  U64 remaining[GDB_PARQUET_MAX_SCHEMA_DEPTH] = { 0 };
+  U64 depth = 0;
+  U64 leaf = 0;
+  for (U64 i = 1; i < element_count; i++)
+  {
+    GDB_ParquetSchemaElement* element = &elements[i];
+    if (element->child_count > 0)
+    {
+      if (depth >= GDB_PARQUET_MAX_SCHEMA_DEPTH)
+      {
+        log_error("the schema of %.*s is nested too deeply", str8_varg(path));
+        return 0;
+      }
+      remaining[depth++] = element->child_count;
+      continue;
+    }
+    
+    GDB_ParquetColumnDesc* desc = &file->columns[leaf++];
+    desc->name = element->name;
+    desc->physical_type = element->physical_type;
+    desc->optional = (element->repetition == GDB_ParquetRepetition_Optional);
+    desc->nested = (depth > 0 || element->repetition == GDB_ParquetRepetition_Repeated || !element->has_type);
+    desc->is_unsigned = (element->is_unsigned ||
+                         (element->converted_type >= GDB_PARQUET_CONVERTED_UINT_FIRST && element->converted_type <= GDB_PARQUET_CONVERTED_UINT_LAST));
+    switch (element->physical_type)
+    {
+      case GDB_ParquetPhysicalType_Boolean:
+      case GDB_ParquetPhysicalType_Int32:     desc->column_type = GDB_ColumnType_U32; break;
+      case GDB_ParquetPhysicalType_Int64:     desc->column_type = GDB_ColumnType_U64; break;
+      case GDB_ParquetPhysicalType_Float:     desc->column_type = GDB_ColumnType_F32; break;
+      case GDB_ParquetPhysicalType_Double:    desc->column_type = GDB_ColumnType_F64; break;
+      case GDB_ParquetPhysicalType_ByteArray: desc->column_type = GDB_ColumnType_String8; break;
+      default: break;
+    }
+    
+    // tec: a finished group takes up one child slot of its parent
+    while (depth > 0)
+    {
+      remaining[depth - 1]--;
+      if (remaining[depth - 1] > 0)
+      {
+        break;
+      }
+      depth--;
+    }
+  }
+  
+  return 1;
+}
+
+//~ tec: filters
+// tec: a decoded value, 4 bytes for booleans, INT32 and FLOAT and 8 for the rest, against the filter's number
+internal S32
+gdb_parquet_compare(GDB_ParquetColumnDesc* desc, void* value, GDB_ParquetFilter* filter)
+{
+  B32 is_float = 0;
+  B32 negative = 0;
+  U64 u = 0;
+  F64 f = 0;
+  switch (desc->physical_type)
+  {
+    case GDB_ParquetPhysicalType_Boolean:
+    case GDB_ParquetPhysicalType_Int32:
+    {
+      U32 raw = *(U32*)value;
+      S64 s = (desc->is_unsigned || desc->physical_type == GDB_ParquetPhysicalType_Boolean) ? (S64)raw : (S64)(S32)raw;
+      negative = (s < 0);
+      u = (U64)s;
+      f = (F64)s;
+    } break;
+    
+    case GDB_ParquetPhysicalType_Int64:
+    {
+      u = *(U64*)value;
+      negative = (!desc->is_unsigned && (S64)u < 0);
+      f = desc->is_unsigned ? (F64)u : (F64)(S64)u;
+    } break;
+    
+    case GDB_ParquetPhysicalType_Float:  { is_float = 1; f = *(F32*)value; } break;
+    case GDB_ParquetPhysicalType_Double: { is_float = 1; f = *(F64*)value; } break;
+  }
+  
+  S32 result = 0;
+  if (!is_float && filter->is_integer)
+  {
+    result = negative ? -1 : (u < filter->u64) ? -1 : (u > filter->u64) ? 1 : 0;
+  }
+  else
+  {
+    result = (f < filter->f64) ? -1 : (f > filter->f64) ? 1 : 0;
+  }
+  return result;
+}
+
+internal B32
+gdb_parquet_filter_match(GDB_ParquetCompare compare, S32 cmp)
+{
+  B32 result = 0;
+  switch (compare)
+  {
+    case GDB_ParquetCompare_Equal:        result = (cmp == 0); break;
+    case GDB_ParquetCompare_NotEqual:     result = (cmp != 0); break;
+    case GDB_ParquetCompare_Less:         result = (cmp < 0); break;
+    case GDB_ParquetCompare_LessEqual:    result = (cmp <= 0); break;
+    case GDB_ParquetCompare_Greater:      result = (cmp > 0); break;
+    case GDB_ParquetCompare_GreaterEqual: result = (cmp >= 0); break;
+  }
+  return result;
+}
+
+// tec: statistics are plain encoded, booleans in a whole byte
+internal B32
+gdb_parquet_stat_value(GDB_ParquetColumnDesc* desc, String8 stat, U64* out)
+{
+  *out = 0;
+  U64 size = (desc->physical_type == GDB_ParquetPhysicalType_Boolean) ? 1 : g_gdb_column_type_size[desc->column_type];
+  B32 result = (stat.size == size && size > 0);
+  if (result)
+  {
+    MemoryCopy(out, stat.str, size);
+  }
+  return result;
+}
+
+// tec: 0 when the statistics of a filter column rule out every row of the group
+internal B32
+gdb_parquet_row_group_may_match(GDB_ParquetFile* file, U64 row_group, GDB_ParquetFilter* filters)
+{
+  GDB_ParquetRowGroup* group = &file->row_groups[row_group];
+  for (GDB_ParquetFilter* filter = filters; filter != 0; filter = filter->next)
+  {
+    GDB_ParquetColumnDesc* desc = &file->columns[filter->leaf];
+    GDB_ParquetChunkMeta* meta = &group->chunks[filter->leaf];
+    
+    // tec: comparisons are never true for nulls, so a chunk of nothing but nulls matches nothing
+    if (meta->has_null_count && group->row_count > 0 && meta->null_count >= group->row_count)
+    {
+      return 0;
+    }
+    
+    U64 min = 0;
+    U64 max = 0;
+    if ((meta->legacy_stats && desc->is_unsigned) ||
+        !gdb_parquet_stat_value(desc, meta->min, &min) || !gdb_parquet_stat_value(desc, meta->max, &max))
+    {
+      continue;
+    }
+    
+    S32 cmp_min = gdb_parquet_compare(desc, &min, filter);
+    S32 cmp_max = gdb_parquet_compare(desc, &max, filter);
+    B32 may_match = 1;
+    switch (filter->compare)
+    {
+      case GDB_ParquetCompare_Equal:        may_match = (cmp_min <= 0 && cmp_max >= 0); break;
+      case GDB_ParquetCompare_NotEqual:     may_match = !(cmp_min == 0 && cmp_max == 0); break;
+      case GDB_ParquetCompare_Less:         may_match = (cmp_min < 0); break;
+      case GDB_ParquetCompare_LessEqual:    may_match = (cmp_min <= 0); break;
+      case GDB_ParquetCompare_Greater:      may_match = (cmp_max > 0); break;
+      case GDB_ParquetCompare_GreaterEqual: may_match = (cmp_max >= 0); break;
+    }
+    if (!may_match)
+    {
+      return 0;
+    }
+  }
+  return 1;
+}
+
+//~ tec: pages
+internal B32
+gdb_parquet_read_page_header(GDB_ThriftReader* reader, GDB_ParquetPageHeader* header)
+{
+  MemoryZeroStruct(header);
+  header->is_compressed = 1;
+  
+  S16 field_id = 0;
+  GDB_ThriftType type = 0;
+  while (gdb_thrift_next_field(reader, &field_id, &type))
+  {
+    switch (field_id)
+    {
+      case 1: { header->type = (GDB_ParquetPageType)gdb_thrift_read_zigzag(reader); } break;
+      case 2: { header->uncompressed_size = (U32)gdb_thrift_read_zigzag(reader); } break;
+      case 3: { header->compressed_size = (U32)gdb_thrift_read_zigzag(reader); } break;
+      
+      case 5:
+      case 7:
+      case 8:
+      {
+        //- tec: DataPageHeader, DictionaryPageHeader and DataPageHeaderV2 all start with the value count
+        S16 page_field_id = 0;
+        GDB_ThriftType page_type = 0;
+        while (gdb_thrift_next_field(reader, &page_field_id, &page_type))
+        {
+          if (page_field_id == 1)
+          {
+            header->value_count = (U32)gdb_thrift_read_zigzag(reader);
+          }
+          else if ((field_id != 8 && page_field_id == 2) || (field_id == 8 && page_field_id == 4))
+          {
+            header->encoding = (GDB_ParquetEncoding)gdb_thrift_read_zigzag(reader);
+          }
+          else if (field_id == 8 && page_field_id == 5)
+          {
+            header->definition_size = (U32)gdb_thrift_read_zigzag(reader);
+          }
+          else if (field_id == 8 && page_field_id == 6)
+          {
+            header->repetition_size = (U32)gdb_thrift_read_zigzag(reader);
+          }
+          else if (field_id == 8 && page_field_id == 7)
+          {
+            header->is_compressed = (page_type == GDB_ThriftType_True);
+          }
+          else
+          {
+            gdb_thrift_skip(reader, page_type);
+          }
+        }
+      } break;
+      
+      default: { gdb_thrift_skip(reader, type); } break;
+    }
+  }
+  return !reader->failed;
+}
+
+internal B32
+gdb_parquet_push_string(Arena* arena, GDB_ParquetChunkTask* task, U64 row, String8 string)
+{
+  if (string.size > task->string_capacity - task->string_size)
+  {
+    U64 new_capacity = Max(task->string_capacity * 2, task->string_size + string.size);
+    U8* new_data = push_array_no_zero(arena, U8, new_capacity);
+    MemoryCopy(new_data, task->string_data, task->string_size);
+    task->string_data = new_data;
+    task->string_capacity = new_capacity;
+  }
+  MemoryCopy(task->string_data + task->string_size, string.str, string.size);
+  task->string_size += string.size;
+  task->offsets[row] = task->string_size;
+  return 1;
+}
+
+internal B32
+gdb_parquet_read_dictionary(Arena* arena, GDB_ParquetColumnDesc* desc, GDB_ParquetCodec codec, GDB_ParquetPageHeader* header,
+                            String8 page, GDB_ParquetDictionary* dictionary)
+{
+  String8 data = {0};
+  if (!gdb_parquet_decompress(arena, codec, page, header->uncompressed_size, &data))
+  {
+    return 0;
+  }
+  
+  // tec: a plain value needs at least a bit, which bounds the count before anything is pushed
+  U64 count = header->value_count;
+  if (count > data.size * 8)
+  {
+    return 0;
+  }
+  
+  U64 value_size = g_gdb_column_type_size[desc->column_type];
+  dictionary->count = count;
+  if (desc->column_type == GDB_ColumnType_String8)
+  {
+    dictionary->strings = push_array(arena, String8, Max(1, count));
+  }
+  else
+  {
+    dictionary->values = push_array(arena, U8, Max(1, count * value_size));
+  }
+  
+  U64 bit_pos = 0;
+  for (U64 i = 0; i < count; i++)
+  {
+    String8 string = {0};
+    void* out = dictionary->values ? dictionary->values + i * value_size : 0;
+    if (!gdb_parquet_plain_next(desc, data, &bit_pos, out, &string))
+    {
+      return 0;
+    }
+    if (dictionary->strings)
+    {
+      dictionary->strings[i] = string;
+    }
+  }
+  return 1;
+}
+
+internal B32
+gdb_parquet_read_data_page(Arena* arena, GDB_ParquetChunkTask* task, GDB_ParquetColumnDesc* desc, GDB_ParquetCodec codec,
+                           GDB_ParquetPageHeader* header, String8 page, GDB_ParquetDictionary* dictionary, U64* row)
+{
+  U64 count = header->value_count;
+  if (count > task->row_count - *row)
+  {
+    return 0;
+  }
+  
+  //- tec: v1 compresses the levels along with the values, v2 keeps them uncompressed in front
+  String8 levels = {0};
+  String8 values = {0};
+  if (header->type == GDB_ParquetPageType_DataV2)
+  {
+    U64 level_size = header->definition_size + header->repetition_size;
+    if (header->repetition_size != 0 || level_size > page.size || level_size > header->uncompressed_size)
+    {
+      return 0;
+    }
+    levels = str8_prefix(page, header->definition_size);
+    String8 body = str8_skip(page, level_size);
+    if (!header->is_compressed)
+    {
+      values = body;
+    }
+    else if (!gdb_parquet_decompress(arena, codec, body, header->uncompressed_size - level_size, &values))
+    {
+      return 0;
+    }
+  }
+  else
+  {
+    String8 body = {0};
+    if (!gdb_parquet_decompress(arena, codec, page, header->uncompressed_size, &body))
+    {
+      return 0;
+    }
+    
+    values = body;
+    if (desc->optional)
+    {
+      U32 level_size = 0;
+      if (body.size < sizeof(U32))
+      {
+        return 0;
+      }
+      MemoryCopy(&level_size, body.str, sizeof(U32));
+      if (level_size > body.size - sizeof(U32))
+      {
+        return 0;
+      }
+      levels = str8_substr(body, r1u64(sizeof(U32), sizeof(U32) + level_size));
+      values = str8_skip(body, sizeof(U32) + level_size);
+    }
+  }
+  
+  //- tec: a flat optional column has one definition level bit, set where the row holds a value
+  B8* defined = task->defined ? task->defined + *row : 0;
+  U64 value_count = count;
+  if (defined)
+  {
+    U32* level_values = push_array_no_zero(arena, U32, Max(1, count));
+    if (!gdb_parquet_decode_hybrid(levels, 1, level_values, count))
+    {
+      return 0;
+    }
+    value_count = 0;
+    for (U64 i = 0; i < count; i++)
+    {
+      defined[i] = (level_values[i] != 0);
+      value_count += defined[i];
+    }
+  }
+  
+  //- tec: dictionary indices are a bit width byte and then hybrid runs, v2 booleans are hybrid runs behind a length
+  U32* indices = 0;
+  B32 boolean_runs = 0;
+  if (header->encoding == GDB_ParquetEncoding_PlainDictionary || header->encoding == GDB_ParquetEncoding_RLEDictionary)
+  {
+    if (values.size < 1 || (value_count > 0 && dictionary->count == 0))
+    {
+      return 0;
+    }
+    indices = push_array_no_zero(arena, U32, Max(1, value_count));
+    if (!gdb_parquet_decode_hybrid(str8_skip(values, 1), values.str[0], indices, value_count))
+    {
+      return 0;
+    }
+  }
+  else if (header->encoding == GDB_ParquetEncoding_RLE && desc->physical_type == GDB_ParquetPhysicalType_Boolean)
+  {
+    U32 run_size = 0;
+    if (values.size < sizeof(U32))
+    {
+      return 0;
+    }
+    MemoryCopy(&run_size, values.str, sizeof(U32));
+    indices = push_array_no_zero(arena, U32, Max(1, value_count));
+    boolean_runs = 1;
+    if (!gdb_parquet_decode_hybrid(str8_substr(values, r1u64(sizeof(U32), sizeof(U32) + run_size)), 1, indices, value_count))
+    {
+      return 0;
+    }
+  }
+  else if (header->encoding != GDB_ParquetEncoding_Plain)
+  {
+    return 0;
+  }
+  
+  //- tec: values land in the rows that hold one, null rows keep zeroed values and empty strings
+  B32 is_string = (desc->column_type == GDB_ColumnType_String8);
+  U64 value_size = g_gdb_column_type_size[desc->column_type];
+  U64 bit_pos = 0;
+  U64 next_value = 0;
+  for (U64 i = 0; i < count; i++)
+  {
+    U64 r = *row + i;
+    if (defined && !defined[i])
+    {
+      if (is_string)
+      {
+        task->offsets[r] = task->string_size;
+      }
+      continue;
+    }
+    
+    if (boolean_runs)
+    {
+      *(U32*)(task->values + r * value_size) = indices[next_value++] & 1;
+    }
+    else if (indices)
+    {
+      U32 index = indices[next_value++];
+      if (index >= dictionary->count)
+      {
+        return 0;
+      }
+      if (is_string)
+      {
+        gdb_parquet_push_string(arena, task, r, dictionary->strings[index]);
+      }
+      else
+      {
+        MemoryCopy(task->values + r * value_size, dictionary->values + index * value_size, value_size);
+      }
+    }
+    else
+    {
+      String8 string = {0};
+      if (!gdb_parquet_plain_next(desc, values, &bit_pos, is_string ? 0 : task->values + r * value_size, &string))
+      {
+        return 0;
+      }
+      if (is_string)
+      {
+        gdb_parquet_push_string(arena, task, r, string);
+      }
+    }
+  }
+  
+  *row += count;
+  return 1;
+}
+
+THREAD_POOL_TASK_FUNC(gdb_parquet_chunk_task)
+{
+  ProfBeginFunction();
+  
+  GDB_ParquetChunkTaskArray* tasks = (GDB_ParquetChunkTaskArray*)raw_task;
+  GDB_ParquetChunkTask* task = &tasks->v[task_id];
+  GDB_ParquetFile* file = task->file;
+  GDB_ParquetColumnDesc* desc = &file->columns[task->leaf];
+  GDB_ParquetChunkMeta* meta = &file->row_groups[task->row_group].chunks[task->leaf];
+  U64 row_count = file->row_groups[task->row_group].row_count;
+  
+  task->row_count = row_count;
+  if (desc->column_type == GDB_ColumnType_String8)
+  {
+    task->offsets = push_array(arena, U64, Max(1, row_count));
+  }
+  else
+  {
+    task->values = push_array(arena, U8, Max(1, row_count * g_gdb_column_type_size[desc->column_type]));
+  }
+  if (desc->optional)
+  {
+    task->defined = push_array(arena, B8, Max(1, row_count));
+  }
+  
+  //- tec: the whole chunk in one read, its dictionary page comes first when it has one
+  U64 chunk_at = meta->data_page_offset;
+  if (meta->dictionary_page_offset > 0 && meta->dictionary_page_offset < chunk_at)
+  {
+    chunk_at = meta->dictionary_page_offset;
+  }
+  B32 result = (chunk_at < file->size && meta->compressed_size <= file->size - chunk_at);
+  U8* chunk = 0;
+  if (result)
+  {
+    chunk = push_array_no_zero(arena, U8, Max(1, meta->compressed_size));
+    result = (os_file_read(file->handle, r1u64(chunk_at, chunk_at + meta->compressed_size), chunk) == meta->compressed_size);
+  }
+  
+  GDB_ParquetDictionary dictionary = {0};
+  GDB_ThriftReader reader = { chunk, chunk + meta->compressed_size, 0 };
+  U64 row = 0;
+  while (result && row < row_count && reader.at < reader.end)
+  {
+    GDB_ParquetPageHeader header = {0};
+    result = (gdb_parquet_read_page_header(&reader, &header) && header.compressed_size <= (U64)(reader.end - reader.at));
+    if (!result)
+    {
+      break;
+    }
+    
+    String8 page = str8(reader.at, header.compressed_size);
+    reader.at += header.compressed_size;
+    switch (header.type)
+    {
+      case GDB_ParquetPageType_Dictionary:
+      {
+        result = gdb_parquet_read_dictionary(arena, desc, meta->codec, &header, page, &dictionary);
+      } break;
+      
+      case GDB_ParquetPageType_Data:
+      case GDB_ParquetPageType_DataV2:
+      {
+        result = gdb_parquet_read_data_page(arena, task, desc, meta->codec, &header, page, &dictionary, &row);
+      } break;
+      
+      // tec: index pages hold nothing this reader needs
+      default: break;
+    }
+  }
+  
+  task->success = (result && row == row_count);
+  ProfEnd();
+}
+
+//~ tec: import
+internal B32
+gdb_parquet_path_is_parquet(String8 path)
+{
+  String8 extension = str8_skip_last_dot(path);
+  B32 result = (str8_match(extension, str8_lit("parquet"), StringMatchFlag_CaseInsensitive) ||
+                str8_match(extension, str8_lit("parq"), StringMatchFlag_CaseInsensitive));
+  return result;
+}
+
+internal U64
+gdb_parquet_find_leaf(GDB_ParquetFile* file, String8 name)
+{
+  U64 result = file->column_count;
+  for (U64 i = 0; i < file->column_count; i++)
+  {
+    if (str8_match(file->columns[i].name, name, StringMatchFlag_CaseInsensitive))
+    {
+      result = i;
+      break;
+    }
+  }
+  return result;
+}
+
+internal B32
+gdb_parquet_leaf_is_supported(GDB_ParquetColumnDesc* desc)
+{
+  return !desc->nested && desc->column_type != GDB_ColumnType_Invalid;
+}
+
+internal void
+gdb_parquet_append_rows(GDB_Column* column, GDB_ParquetChunkTask* task, B8* keep)
+{
+  U64 value_size = column->size;
+  for (U64 r = 0; r < task->row_count; r++)
+  {
+    if (keep && !keep[r])
+    {
+      continue;
+    }
+    
+    if (task->defined && !task->defined[r])
+    {
+      gdb_column_add_data(column, NULL);
+    }
+    else if (column->type == GDB_ColumnType_String8)
+    {
+      U64 start = (r > 0) ? task->offsets[r - 1] : 0;
+      String8 string = str8(task->string_data + start, task->offsets[r] - start);
+      gdb_column_add_data(column, &string);
+    }
+    else
+    {
+      gdb_column_add_data(column, task->values + r * value_size);
+    }
+  }
+}
+
+internal GDB_Table*
+gdb_table_import_parquet(GDB_Database* database, String8 table_name, String8 path, String8List columns, GDB_ParquetFilter* filters)
+{
+  ProfBeginFunction();
+  
+  OS_Handle handle = os_file_open(OS_AccessFlag_Read, path);
+  if (os_handle_match(handle, os_handle_zero()))
+  {
+    log_error("failed to open Parquet file: %.*s", str8_varg(path));
+    ProfEnd();
+    return NULL;
+  }
+  
+  log_info("starting import parquet file %.*s", str8_varg(path));
+  
+  Temp scratch = scratch_begin(0, 0);
+  GDB_ParquetFile file = { 0 };
+  file.handle = handle;
+  file.size = os_properties_from_file(handle).size;
+  B32 result = gdb_parquet_read_footer(scratch.arena, &file, path);
+  
+  //- tec: projection, every column with a matching type when none are named
+  U64* projected = push_array(scratch.arena, U64, Max(file.column_count, columns.node_count) + 1);
+  U64 projected_count = 0;
+  if (result && columns.node_count == 0)
+  {
+    for (U64 leaf = 0; leaf < file.column_count; leaf++)
+    {
+      if (gdb_parquet_leaf_is_supported(&file.columns[leaf]))
+      {
+        projected[projected_count++] = leaf;
+      }
+      else
+      {
+        log_warn("column '%.*s' is skipped, it is nested or has no matching column type", str8_varg(file.columns[leaf].name));
+      }
+    }
+  }
+  for (String8Node* node = columns.first; node != 0 && result; node = node->next)
+  {
+    U64 leaf = gdb_parquet_find_leaf(&file, node->string);
+    if (leaf >= file.column_count)
+    {
+      log_error("%.*s has no column '%.*s'", str8_varg(path), str8_varg(node->string));
+      result = 0;
+    }
+    else if (!gdb_parquet_leaf_is_supported(&file.columns[leaf]))
+    {
+      log_error("column '%.*s' is nested or has no matching column type", str8_varg(node->string));
+      result = 0;
+    }
+    else
+    {
+      projected[projected_count++] = leaf;
+    }
+  }
+  
+  //- tec: filter columns are decoded whether they are projected or not
+  B8* decoded = push_array(scratch.arena, B8, file.column_count + 1);
+  for (U64 p = 0; p < projected_count; p++)
+  {
+    decoded[projected[p]] = 1;
+  }
+  for (GDB_ParquetFilter* filter = filters; filter != 0 && result; filter = filter->next)
+  {
+    filter->leaf = gdb_parquet_find_leaf(&file, filter->column);
+    if (filter->leaf >= file.column_count || !gdb_parquet_leaf_is_supported(&file.columns[filter->leaf]) ||
+        file.columns[filter->leaf].column_type == GDB_ColumnType_String8)
+    {
+      log_error("filter column '%.*s' is not a numeric column of %.*s", str8_varg(filter->column), str8_varg(path));
+      result = 0;
+      break;
+    }
+    decoded[filter->leaf] = 1;
+  }
+  
+  U64* decode = push_array(scratch.arena, U64, file.column_count + 1);
+  U64* slot_of_leaf = push_array(scratch.arena, U64, file.column_count + 1);
+  U64 decode_count = 0;
+  for (U64 leaf = 0; leaf < file.column_count && result; leaf++)
+  {
+    if (decoded[leaf])
+    {
+      slot_of_leaf[leaf] = decode_count;
+      decode[decode_count++] = leaf;
+    }
+  }
+  
+  //- tec: row groups whose statistics rule out a filter are never read
+  U64* kept = push_array(scratch.arena, U64, file.row_group_count + 1);
+  U64 kept_count = 0;
+  for (U64 g = 0; g < file.row_group_count && result; g++)
+  {
+    if (!gdb_parquet_row_group_may_match(&file, g, filters))
+    {
+      continue;
+    }
+    kept[kept_count++] = g;
+    
+    for (U64 d = 0; d < decode_count && result; d++)
+    {
+      GDB_ParquetCodec codec = file.row_groups[g].chunks[decode[d]].codec;
+      if (codec != GDB_ParquetCodec_Uncompressed && codec != GDB_ParquetCodec_Snappy && codec != GDB_ParquetCodec_LZ4Raw)
+      {
+        log_error("column '%.*s' uses compression codec %u, only uncompressed, snappy and lz4_raw are supported",
+                  str8_varg(file.columns[decode[d]].name), codec);
+        result = 0;
+      }
+    }
+  }
+  if (result)
+  {
+    log_info("reading %llu of %llu row groups and %llu of %llu columns", kept_count, file.row_group_count, decode_count, file.column_count);
+  }
+  
+  GDB_Table* table = NULL;
+  if (result)
+  {
+    table = gdb_table_alloc(table_name);
+    table->name = push_str8_copy(table->arena, table_name);
+    table->parent_database = database;
+    for (U64 p = 0; p < projected_count; p++)
+    {
+      GDB_ParquetColumnDesc* desc = &file.columns[projected[p]];
+      gdb_table_add_column(table, gdb_column_schema_create(push_str8_copy(table->arena, desc->name), desc->column_type));
+    }
+  }
+  
+  //- tec: decoded in waves of whole row groups with a task per column chunk, appended in file order
+  if (result && kept_count > 0 && decode_count > 0)
+  {
+    // tec: imports share the thread pool with flushes and take their turn the same way
+    os_mutex_take(g_gdb_state->flush_mutex);
+    
+    U64 wave_groups = Max(1, 2 * (U64)g_gdb_state->thread_pool->worker_count / decode_count);
+    GDB_ParquetChunkTaskArray tasks = {0};
+    tasks.v = push_array(scratch.arena, GDB_ParquetChunkTask, wave_groups * decode_count);
+    
+    for (U64 first_group = 0; first_group < kept_count && result; first_group += wave_groups)
+    {
+      U64 group_count = Min(wave_groups, kept_count - first_group);
+      tasks.count = group_count * decode_count;
+      MemoryZero(tasks.v, sizeof(GDB_ParquetChunkTask) * tasks.count);
+      for (U64 g = 0; g < group_count; g++)
+      {
+        for (U64 d = 0; d < decode_count; d++)
+        {
+          GDB_ParquetChunkTask* task = &tasks.v[g * decode_count + d];
+          task->file = &file;
+          task->row_group = kept[first_group + g];
+          task->leaf = decode[d];
+        }
+      }
+      
+      TP_Temp tp_temp = tp_temp_begin(g_gdb_state->thread_pool_arena);
+      tp_for_parallel(g_gdb_state->thread_pool, g_gdb_state->thread_pool_arena, tasks.count, gdb_parquet_chunk_task, &tasks);
+      
+      for (U64 g = 0; g < group_count && result; g++)
+      {
+        GDB_ParquetChunkTask* group_tasks = &tasks.v[g * decode_count];
+        for (U64 d = 0; d < decode_count && result; d++)
+        {
+          if (!group_tasks[d].success)
+          {
+            log_error("failed to decode column '%.*s' of row group %llu in %.*s",
+                      str8_varg(file.columns[decode[d]].name), group_tasks[d].row_group, str8_varg(path));
+            result = 0;
+          }
+        }
+        if (!result)
+        {
+          break;
+        }
+        
+        //- tec: rows of the group that every filter keeps
+        Temp temp = temp_begin(scratch.arena);
+        U64 row_count = group_tasks[0].row_count;
+        U64 kept_rows = row_count;
+        B8* keep = 0;
+        if (filters)
+        {
+          keep = push_array_no_zero(temp.arena, B8, Max(1, row_count));
+          MemorySet(keep, 1, row_count);
+          for (GDB_ParquetFilter* filter = filters; filter != 0; filter = filter->next)
+          {
+            GDB_ParquetColumnDesc* desc = &file.columns[filter->leaf];
+            GDB_ParquetChunkTask* task = &group_tasks[slot_of_leaf[filter->leaf]];
+            U64 value_size = g_gdb_column_type_size[desc->column_type];
+            for (U64 r = 0; r < row_count; r++)
+            {
+              if (keep[r] && ((task->defined && !task->defined[r]) ||
+                              !gdb_parquet_filter_match(filter->compare, gdb_parquet_compare(desc, task->values + r * value_size, filter))))
+              {
+                keep[r] = 0;
+              }
+            }
+          }
+          kept_rows = 0;
+          for (U64 r = 0; r < row_count; r++)
+          {
+            kept_rows += keep[r];
+          }
+        }
+        
+        for (U64 p = 0; p < projected_count; p++)
+        {
+          gdb_parquet_append_rows(table->columns[p], &group_tasks[slot_of_leaf[projected[p]]], keep);
+        }
+        table->row_count += kept_rows;
+        temp_end(temp);
+      }
+      tp_temp_end(tp_temp);
+    }
+    
+    os_mutex_drop(g_gdb_state->flush_mutex);
+  }
+  
+  if (table)
+  {
+    for (U64 c = 0; c < table->column_count; c++)
+    {
+      gdb_column_mark_dirty(table->columns[c]);
+    }
+    if (!result)
+    {
+      for (U64 c = 0; c < table->column_count; c++)
+      {
+        gdb_column_release(table->columns[c]);
+      }
+      gdb_table_release(table);
+      table = NULL;
+    }
+  }
+  
+  os_file_close(handle);
+  scratch_end(scratch);
+  if (table)
+  {
+    log_info("ending import parquet file %.*s, %llu rows", str8_varg(path), table->row_count);
+  }
+  ProfEnd();
+  return table;
+}
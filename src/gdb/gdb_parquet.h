@@ -0,0 +1,257 @@
+/* date = October 19th 2026 7:40 pm */
+
+#ifndef GDB_PARQUET_H
+#define GDB_PARQUET_H
+
+// tec: Parquet files, [magic][column chunks per row group][footer][U32 footer size][magic].
+// the footer and every page header are thrift compact protocol structs, read here without the thrift library
+#define GDB_PARQUET_MAGIC "PAR1"
+#define GDB_PARQUET_MAGIC_SIZE 4
+
+// tec: nested structs deeper than this are refused, flat schemas only ever use one level
+#define GDB_PARQUET_MAX_SCHEMA_DEPTH 64
+
+typedef U8 GDB_ThriftType;
+enum
+{
+  GDB_ThriftType_Stop      = 0,
+  GDB_ThriftType_True      = 1,
+  GDB_ThriftType_False     = 2,
+  GDB_ThriftType_Byte      = 3,
+  GDB_ThriftType_I16       = 4,
+  GDB_ThriftType_I32       = 5,
+  GDB_ThriftType_I64       = 6,
+  GDB_ThriftType_Double    = 7,
+  GDB_ThriftType_Binary    = 8,
+  GDB_ThriftType_List      = 9,
+  GDB_ThriftType_Set       = 10,
+  GDB_ThriftType_Map       = 11,
+  GDB_ThriftType_Struct    = 12,
+};
+
+typedef U32 GDB_ParquetPhysicalType;
+enum
+{
+  GDB_ParquetPhysicalType_Boolean           = 0,
+  GDB_ParquetPhysicalType_Int32             = 1,
+  GDB_ParquetPhysicalType_Int64             = 2,
+  GDB_ParquetPhysicalType_Int96             = 3,
+  GDB_ParquetPhysicalType_Float             = 4,
+  GDB_ParquetPhysicalType_Double            = 5,
+  GDB_ParquetPhysicalType_ByteArray         = 6,
+  GDB_ParquetPhysicalType_FixedLenByteArray = 7,
+};
+
+typedef U32 GDB_ParquetRepetition;
+enum
+{
+  GDB_ParquetRepetition_Required = 0,
+  GDB_ParquetRepetition_Optional = 1,
+  GDB_ParquetRepetition_Repeated = 2,
+};
+
+typedef U32 GDB_ParquetEncoding;
+enum
+{
+  GDB_ParquetEncoding_Plain           = 0,
+  GDB_ParquetEncoding_PlainDictionary = 2,
+  GDB_ParquetEncoding_RLE             = 3,
+  GDB_ParquetEncoding_BitPacked       = 4,
+  GDB_ParquetEncoding_RLEDictionary   = 8,
+};
+
+typedef U32 GDB_ParquetCodec;
+enum
+{
+  GDB_ParquetCodec_Uncompressed = 0,
+  GDB_ParquetCodec_Snappy       = 1,
+  GDB_ParquetCodec_LZ4Raw       = 7,
+};
+
+typedef U32 GDB_ParquetPageType;
+enum
+{
+  GDB_ParquetPageType_Data       = 0,
+  GDB_ParquetPageType_Index      = 1,
+  GDB_ParquetPageType_Dictionary = 2,
+  GDB_ParquetPageType_DataV2     = 3,
+};
+
+// tec: converted types that mark an integer column as unsigned, UINT_8 through UINT_64
+#define GDB_PARQUET_CONVERTED_UINT_FIRST 11
+#define GDB_PARQUET_CONVERTED_UINT_LAST  14
+
+//~ tec: thrift compact protocol
+
+// tec: every read is bounds checked, running past the end sets failed and reads zeroes from then on
+typedef struct GDB_ThriftReader GDB_ThriftReader;
+struct GDB_ThriftReader
+{
+  U8* at;
+  U8* end;
+  B32 failed;
+};
+
+//~ tec: footer
+
+typedef struct GDB_ParquetSchemaElement GDB_ParquetSchemaElement;
+struct GDB_ParquetSchemaElement
+{
+  String8 name;
+  B32 has_type;
+  GDB_ParquetPhysicalType physical_type;
+  GDB_ParquetRepetition repetition;
+  U64 child_count;
+  U32 converted_type;
+  B32 is_unsigned;
+};
+
+// tec: one leaf of the schema, which is one column chunk in every row group
+typedef struct GDB_ParquetColumnDesc GDB_ParquetColumnDesc;
+struct GDB_ParquetColumnDesc
+{
+  String8 name;
+  GDB_ParquetPhysicalType physical_type;
+  GDB_ColumnType column_type;
+  B32 optional;
+  B32 is_unsigned;
+  
+  // tec: nested and repeated leaves carry repetition levels this reader does not decode
+  B32 nested;
+};
+
+typedef struct GDB_ParquetChunkMeta GDB_ParquetChunkMeta;
+struct GDB_ParquetChunkMeta
+{
+  GDB_ParquetCodec codec;
+  U64 value_count;
+  U64 data_page_offset;
+  U64 dictionary_page_offset;
+  U64 compressed_size;
+  
+  // tec: min and max in the column's plain encoding, empty when the writer left them out.
+  // legacy statistics were ordered as signed whatever the column's type
+  String8 min;
+  String8 max;
+  B32 legacy_stats;
+  B32 has_null_count;
+  U64 null_count;
+};
+
+typedef struct GDB_ParquetRowGroup GDB_ParquetRowGroup;
+struct GDB_ParquetRowGroup
+{
+  U64 row_count;
+  GDB_ParquetChunkMeta* chunks;
+};
+
+typedef struct GDB_ParquetFile GDB_ParquetFile;
+struct GDB_ParquetFile
+{
+  OS_Handle handle;
+  U64 size;
+  
+  U64 column_count;
+  GDB_ParquetColumnDesc* columns;
+  
+  U64 row_group_count;
+  GDB_ParquetRowGroup* row_groups;
+};
+
+//~ tec: pages
+
+typedef struct GDB_ParquetPageHeader GDB_ParquetPageHeader;
+struct GDB_ParquetPageHeader
+{
+  GDB_ParquetPageType type;
+  U64 uncompressed_size;
+  U64 compressed_size;
+  U64 value_count;
+  GDB_ParquetEncoding encoding;
+  
+  // tec: v2 data pages only, the levels sit uncompressed in front of the values
+  U64 definition_size;
+  U64 repetition_size;
+  B32 is_compressed;
+};
+
+typedef struct GDB_ParquetDictionary GDB_ParquetDictionary;
+struct GDB_ParquetDictionary
+{
+  U64 count;
+  U8* values;
+  String8* strings;
+};
+
+//~ tec: import
+
+typedef U32 GDB_ParquetCompare;
+enum
+{
+  GDB_ParquetCompare_Equal,
+  GDB_ParquetCompare_NotEqual,
+  GDB_ParquetCompare_Less,
+  GDB_ParquetCompare_LessEqual,
+  GDB_ParquetCompare_Greater,
+  GDB_ParquetCompare_GreaterEqual,
+};
+
+// tec: 'column op number', filters in a list are and-ed. they prune row groups by their statistics
+// and then drop the rows of the remaining groups that do not match
+typedef struct GDB_ParquetFilter GDB_ParquetFilter;
+struct GDB_ParquetFilter
+{
+  GDB_ParquetFilter* next;
+  String8 column;
+  GDB_ParquetCompare compare;
+  B32 is_integer;
+  U64 u64;
+  F64 f64;
+  
+  // tec: resolved on import
+  U64 leaf;
+};
+
+// tec: one column chunk of one row group decoded into the worker's arena, nulls are zeroed values
+typedef struct GDB_ParquetChunkTask GDB_ParquetChunkTask;
+struct GDB_ParquetChunkTask
+{
+  GDB_ParquetFile* file;
+  U64 row_group;
+  U64 leaf;
+  
+  U64 row_count;
+  U8* values;
+  U64* offsets;
+  U8* string_data;
+  U64 string_size;
+  U64 string_capacity;
+  B8* defined;
+  B32 success;
+};
+
+typedef struct GDB_ParquetChunkTaskArray GDB_ParquetChunkTaskArray;
+struct GDB_ParquetChunkTaskArray
+{
+  GDB_ParquetChunkTask* v;
+  U64 count;
+};
+
+internal U64 gdb_thrift_read_varint(GDB_ThriftReader* reader);
+internal S64 gdb_thrift_read_zigzag(GDB_ThriftReader* reader);
+internal String8 gdb_thrift_read_binary(GDB_ThriftReader* reader);
+internal U64 gdb_thrift_read_list(GDB_ThriftReader* reader, GDB_ThriftType* out_element_type);
+internal B32 gdb_thrift_next_field(GDB_ThriftReader* reader, S16* field_id, GDB_ThriftType* out_type);
+internal void gdb_thrift_skip(GDB_ThriftReader* reader, GDB_ThriftType type);
+
+internal B32 gdb_parquet_snappy_decompress(String8 src, U8* dst, U64 dst_size);
+internal B32 gdb_parquet_lz4_decompress(String8 src, U8* dst, U64 dst_size);
+internal B32 gdb_parquet_decode_hybrid(String8 src, U32 bit_width, U32* out, U64 count);
+
+internal B32 gdb_parquet_read_page_header(GDB_ThriftReader* reader, GDB_ParquetPageHeader* header);
+internal B32 gdb_parquet_read_footer(Arena* arena, GDB_ParquetFile* file, String8 path);
+internal B32 gdb_parquet_row_group_may_match(GDB_ParquetFile* file, U64 row_group, GDB_ParquetFilter* filters);
+internal B32 gdb_parquet_path_is_parquet(String8 path);
+internal GDB_Table* gdb_table_import_parquet(GDB_Database* database, String8 table_name, String8 path, String8List columns, GDB_ParquetFilter* filters);
+
+#endif //GDB_PARQUET_H
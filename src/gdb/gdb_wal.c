@@ -0,0 +1,695 @@
+global U32 g_gdb_wal_crc_table[256];
+global B32 g_gdb_wal_crc_table_initialized = 0;
+
+internal U32
+gdb_wal_crc32(U32 crc, void* data, U64 size)
+{
+  if (!g_gdb_wal_crc_table_initialized)
+  {
+    for (U32 i = 0; i < 256; i++)
+    {
+      U32 value = i;
+      for (U32 bit = 0; bit < 8; bit++)
+      {
+        value = (value & 1) ? (0xEDB88320u ^ (value >> 1)) : (value >> 1);
+      }
+      g_gdb_wal_crc_table[i] = value;
+    }
+    g_gdb_wal_crc_table_initialized = 1;
+  }
+
+  U8* bytes = (U8*)data;
+  crc = ~crc;
+  for (U64 i = 0; i < size; i++)
+  {
+    crc = g_gdb_wal_crc_table[(crc ^ bytes[i]) & 0xFF] ^ (crc >> 8);
+  }
+  return ~crc;
+}
+
+internal U32
+gdb_wal_record_crc(GDB_WalRecordHeader* header, void* payload)
+{
+  U32 crc = gdb_wal_crc32(0, &header->lsn, sizeof(header->lsn) + sizeof(header->payload_size));
+  crc = gdb_wal_crc32(crc, payload, header->payload_size);
+  return crc;
+}
+
+internal String8
+gdb_wal_path_from_directory(Arena* arena, String8 directory)
+{
+  U8 last_char = directory.size > 0 ? directory.str[directory.size - 1] : 0;
+  B32 has_slash = (last_char == '/' || last_char == '\\');
+  String8 result = push_str8f(arena, "%.*s%s" GDB_WAL_FILE_NAME, str8_varg(directory), has_slash ? "" : "/");
+  return result;
+}
+
+internal B32
+gdb_wal_write_header(GDB_Wal* wal)
+{
+  GDB_WalHeader header = { GDB_WAL_MAGIC, GDB_WAL_VERSION, wal->base_lsn };
+  B32 result = (os_file_write(wal->file, r1u64(0, sizeof(header)), &header) == sizeof(header));
+  return result;
+}
+
+internal GDB_Wal*
+gdb_wal_open(GDB_Database* database, String8 directory)
+{
+  ProfBeginFunction();
+
+  if (!os_file_path_exists(directory))
+  {
+    os_make_directory(directory);
+  }
+
+  GDB_Wal* wal = push_array(database->arena, GDB_Wal, 1);
+  wal->path = gdb_wal_path_from_directory(database->arena, directory);
+  wal->file = os_file_open(OS_AccessFlag_Read | OS_AccessFlag_Write | OS_AccessFlag_Append, wal->path);
+  if (os_handle_match(os_handle_zero(), wal->file))
+  {
+    log_error("failed to open write-ahead log: %.*s", str8_varg(wal->path));
+    ProfEnd();
+    return NULL;
+  }
+
+  wal->mutex = os_mutex_alloc();
+  wal->flushed_cv = os_condition_variable_alloc();
+  wal->pending_arena = arena_alloc(.reserve_size=GDB_WAL_ARENA_RESERVE_SIZE, .commit_size=GDB_WAL_ARENA_COMMIT_SIZE);
+  wal->flushing_arena = arena_alloc(.reserve_size=GDB_WAL_ARENA_RESERVE_SIZE, .commit_size=GDB_WAL_ARENA_COMMIT_SIZE);
+  wal->last_checkpoint_us = os_now_microseconds();
+
+  // tec: lsns must keep increasing past anything a table has already folded in
+  U64 table_lsn = 0;
+  for (U64 i = 0; i < database->table_count; i++)
+  {
+    table_lsn = Max(table_lsn, database->tables[i]->wal_lsn);
+  }
+
+  GDB_WalHeader header = {0};
+  U64 file_size = os_properties_from_file(wal->file).size;
+  if (file_size >= sizeof(header))
+  {
+    os_file_read(wal->file, r1u64(0, sizeof(header)), &header);
+  }
+
+  // tec: a valid log keeps its base, replay starts from its first record and leaves out what each table
+  // already folded in. records below the tables' lsns can still belong to other tables
+  if (header.magic == GDB_WAL_MAGIC && header.version == GDB_WAL_VERSION)
+  {
+    wal->base_lsn = header.base_lsn;
+    wal->file_size = file_size;
+  }
+  else
+  {
+    if (file_size != 0)
+    {
+      log_warn("write-ahead log has an invalid header, starting a new log: %.*s", str8_varg(wal->path));
+    }
+    wal->base_lsn = table_lsn + 1;
+    wal->file_size = sizeof(header);
+    gdb_wal_write_header(wal);
+    os_file_resize(wal->file, wal->file_size);
+    os_file_flush(wal->file);
+  }
+
+  wal->next_lsn = Max(wal->base_lsn, table_lsn + 1);
+  wal->flushed_lsn = wal->next_lsn - 1;
+
+  ProfEnd();
+  return wal;
+}
+
+internal void
+gdb_wal_close(GDB_Wal* wal)
+{
+  if (wal)
+  {
+    os_file_close(wal->file);
+    os_mutex_release(wal->mutex);
+    os_condition_variable_release(wal->flushed_cv);
+    arena_release(wal->pending_arena);
+    arena_release(wal->flushing_arena);
+  }
+}
+
+//- tec: record encoding
+
+internal U64
+gdb_wal_value_size(GDB_Column* column, void* value)
+{
+  U64 size = sizeof(U8);
+  if (value != NULL)
+  {
+    size += (column->type == GDB_ColumnType_String8) ? sizeof(U64) + ((String8*)value)->size : column->size;
+  }
+  return size;
+}
+
+internal U8*
+gdb_wal_write_value(U8* write_ptr, GDB_Column* column, void* value)
+{
+  *write_ptr = (value == NULL); write_ptr += sizeof(U8);
+  if (value == NULL)
+  {
+    return write_ptr;
+  }
+
+  if (column->type == GDB_ColumnType_String8)
+  {
+    String8* str = (String8*)value;
+    MemoryCopy(write_ptr, &str->size, sizeof(U64)); write_ptr += sizeof(U64);
+    MemoryCopy(write_ptr, str->str, str->size); write_ptr += str->size;
+  }
+  else
+  {
+    MemoryCopy(write_ptr, value, column->size); write_ptr += column->size;
+  }
+  return write_ptr;
+}
+
+internal U8*
+gdb_wal_write_payload_header(U8* write_ptr, GDB_Table* table, U64 row_count)
+{
+  *(U64*)write_ptr = table->name.size; write_ptr += sizeof(U64);
+  MemoryCopy(write_ptr, table->name.str, table->name.size); write_ptr += table->name.size;
+  *(U64*)write_ptr = table->column_count; write_ptr += sizeof(U64);
+  *(U64*)write_ptr = row_count; write_ptr += sizeof(U64);
+  return write_ptr;
+}
+
+internal String8
+gdb_wal_encode_rows(Arena* arena, GDB_Table* table, void*** rows, U64 row_count)
+{
+  U64 size = sizeof(U64) + table->name.size + sizeof(U64) * 2;
+  for (U64 r = 0; r < row_count; r++)
+  {
+    for (U64 c = 0; c < table->column_count; c++)
+    {
+      size += gdb_wal_value_size(table->columns[c], rows[r][c]);
+    }
+  }
+
+  U8* buffer = push_array_no_zero(arena, U8, size);
+  U8* write_ptr = gdb_wal_write_payload_header(buffer, table, row_count);
+  for (U64 r = 0; r < row_count; r++)
+  {
+    for (U64 c = 0; c < table->column_count; c++)
+    {
+      write_ptr = gdb_wal_write_value(write_ptr, table->columns[c], rows[r][c]);
+    }
+  }
+
+  return str8(buffer, size);
+}
+
+// tec: the same record as gdb_wal_encode_rows, read straight from the block's columns.
+// the sizes are summed a column at a time, only the interleaving into rows walks across them
+internal String8
+gdb_wal_encode_block(Arena* arena, GDB_ImportBlock* block)
+{
+  GDB_Table* table = block->table;
+
+  U64 size = sizeof(U64) + table->name.size + sizeof(U64) * 2;
+  for (U64 c = 0; c < table->column_count; c++)
+  {
+    GDB_Column* column = table->columns[c];
+    B8* valid = block->valid ? block->valid[c] : 0;
+    if (column->type != GDB_ColumnType_String8 && !valid)
+    {
+      size += (sizeof(U8) + column->size) * block->row_count;
+      continue;
+    }
+    for (U64 r = 0; r < block->row_count; r++)
+    {
+      void* value = (!valid || valid[r]) ? block->values[c] + r * column->size : NULL;
+      size += gdb_wal_value_size(column, value);
+    }
+  }
+
+  U8* buffer = push_array_no_zero(arena, U8, size);
+  U8* write_ptr = gdb_wal_write_payload_header(buffer, table, block->row_count);
+  for (U64 r = 0; r < block->row_count; r++)
+  {
+    for (U64 c = 0; c < table->column_count; c++)
+    {
+      GDB_Column* column = table->columns[c];
+      B8* valid = block->valid ? block->valid[c] : 0;
+      void* value = (!valid || valid[r]) ? block->values[c] + r * column->size : NULL;
+      write_ptr = gdb_wal_write_value(write_ptr, column, value);
+    }
+  }
+
+  return str8(buffer, size);
+}
+
+//- tec: appending
+
+internal U64
+gdb_wal_append_payload(GDB_Wal* wal, String8 payload)
+{
+  U64 lsn = 0;
+  OS_MutexScope(wal->mutex)
+  {
+    lsn = wal->next_lsn++;
+
+    GDB_WalRecordHeader header = { GDB_WAL_RECORD_MAGIC, 0, lsn, payload.size };
+    header.crc = gdb_wal_record_crc(&header, payload.str);
+
+    U64 record_size = sizeof(header) + payload.size;
+    U8* record = push_array_no_zero(wal->pending_arena, U8, record_size);
+    MemoryCopy(record, &header, sizeof(header));
+    MemoryCopy(record + sizeof(header), payload.str, payload.size);
+
+    str8_list_push(wal->pending_arena, &wal->pending, str8(record, record_size));
+    wal->pending_last_lsn = lsn;
+  }
+
+  if (!gdb_wal_wait_durable(wal, lsn))
+  {
+    lsn = 0;
+  }
+  return lsn;
+}
+
+internal U64
+gdb_wal_append_rows(GDB_Wal* wal, GDB_Table* table, void*** rows, U64 row_count)
+{
+  ProfBeginFunction();
+
+  Temp scratch = scratch_begin(0, 0);
+  String8 payload = gdb_wal_encode_rows(scratch.arena, table, rows, row_count);
+  U64 lsn = gdb_wal_append_payload(wal, payload);
+  scratch_end(scratch);
+
+  ProfEnd();
+  return lsn;
+}
+
+internal U64
+gdb_wal_append_block(GDB_Wal* wal, GDB_ImportBlock* block)
+{
+  ProfBeginFunction();
+
+  Temp scratch = scratch_begin(0, 0);
+  String8 payload = gdb_wal_encode_block(scratch.arena, block);
+  U64 lsn = gdb_wal_append_payload(wal, payload);
+  scratch_end(scratch);
+
+  ProfEnd();
+  return lsn;
+}
+
+internal B32
+gdb_wal_wait_durable(GDB_Wal* wal, U64 lsn)
+{
+  ProfBeginFunction();
+
+  os_mutex_take(wal->mutex);
+  while (wal->flushed_lsn < lsn && !wal->write_failed)
+  {
+    if (wal->flush_in_progress)
+    {
+      os_condition_variable_wait(wal->flushed_cv, wal->mutex, max_U64);
+      continue;
+    }
+
+    // tec: become the group leader, every record queued so far goes out with one write and one flush
+    wal->flush_in_progress = 1;
+    String8List group = wal->pending;
+    U64 group_last_lsn = wal->pending_last_lsn;
+    Arena* group_arena = wal->pending_arena;
+    wal->pending_arena = wal->flushing_arena;
+    wal->flushing_arena = group_arena;
+    MemoryZeroStruct(&wal->pending);
+    U64 offset = wal->file_size;
+    os_mutex_drop(wal->mutex);
+
+    B32 success = 1;
+    U64 written = 0;
+    for (String8Node* node = group.first; node != NULL && success; node = node->next)
+    {
+      U64 write_size = os_file_write(wal->file, r1u64(offset + written, offset + written + node->string.size), node->string.str);
+      success = (write_size == node->string.size);
+      written += write_size;
+    }
+    success = success && os_file_flush(wal->file);
+
+    os_mutex_take(wal->mutex);
+    if (success)
+    {
+      wal->file_size = offset + written;
+      wal->flushed_lsn = group_last_lsn;
+    }
+    else
+    {
+      log_error("failed to write to write-ahead log: %.*s", str8_varg(wal->path));
+      wal->write_failed = 1;
+    }
+    arena_clear(group_arena);
+    wal->flush_in_progress = 0;
+    os_condition_variable_broadcast(wal->flushed_cv);
+  }
+  B32 result = !wal->write_failed;
+  os_mutex_drop(wal->mutex);
+
+  ProfEnd();
+  return result;
+}
+
+internal B32
+gdb_wal_replay(GDB_Database* database)
+{
+  ProfBeginFunction();
+
+  GDB_Wal* wal = database->wal;
+  if (!wal)
+  {
+    ProfEnd();
+    return 0;
+  }
+
+  Temp scratch = scratch_begin(0, 0);
+  String8 log_data = {0};
+  log_data.size = wal->file_size;
+  log_data.str = push_array_no_zero(scratch.arena, U8, log_data.size);
+  log_data.size = os_file_read(wal->file, r1u64(0, log_data.size), log_data.str);
+
+  U64 at = sizeof(GDB_WalHeader);
+  U64 replayed_record_count = 0;
+  U64 last_lsn = wal->base_lsn - 1;
+
+  while (at + sizeof(GDB_WalRecordHeader) <= log_data.size)
+  {
+    GDB_WalRecordHeader header = {0};
+    MemoryCopy(&header, log_data.str + at, sizeof(header));
+
+    // tec: a torn or corrupt record ends the log, nothing after it was acknowledged
+    if (header.magic != GDB_WAL_RECORD_MAGIC ||
+        header.payload_size > log_data.size - at - sizeof(header))
+    {
+      break;
+    }
+    U8* payload = log_data.str + at + sizeof(header);
+    if (gdb_wal_record_crc(&header, payload) != header.crc)
+    {
+      log_warn("write-ahead log crc mismatch at lsn %llu, ignoring the rest of the log", header.lsn);
+      break;
+    }
+
+    // tec: a whole record out of order is skipped, never cut off, the records after it were acknowledged
+    if (header.lsn <= last_lsn)
+    {
+      log_warn("write-ahead log lsn %llu is out of order after %llu, skipping", header.lsn, last_lsn);
+      at += sizeof(header) + header.payload_size;
+      continue;
+    }
+
+    //- tec: decode the row batch
+    U8* read_ptr = payload;
+    U8* read_end = payload + header.payload_size;
+    B32 valid = 1;
+
+    String8 table_name = {0};
+    table_name.size = *(U64*)read_ptr; read_ptr += sizeof(U64);
+    table_name.str = read_ptr; read_ptr += table_name.size;
+    U64 column_count = *(U64*)read_ptr; read_ptr += sizeof(U64);
+    U64 row_count = *(U64*)read_ptr; read_ptr += sizeof(U64);
+
+    GDB_Table* table = NULL;
+    for (U64 i = 0; i < database->table_count; i++)
+    {
+      if (str8_match(database->tables[i]->name, table_name, 0))
+      {
+        table = database->tables[i];
+        break;
+      }
+    }
+
+    if (table == NULL || table->column_count != column_count)
+    {
+      log_warn("write-ahead log lsn %llu references unknown table '%.*s', skipping", header.lsn, str8_varg(table_name));
+    }
+    else if (header.lsn > table->wal_lsn)
+    {
+      Temp temp = temp_begin(scratch.arena);
+      void*** rows = push_array(temp.arena, void**, row_count);
+      for (U64 r = 0; r < row_count && valid; r++)
+      {
+        rows[r] = push_array(temp.arena, void*, column_count);
+        for (U64 c = 0; c < column_count && valid; c++)
+        {
+          GDB_Column* column = table->columns[c];
+          B32 is_null = *read_ptr; read_ptr += sizeof(U8);
+          if (is_null)
+          {
+            rows[r][c] = NULL;
+          }
+          else if (column->type == GDB_ColumnType_String8)
+          {
+            String8* str = push_array(temp.arena, String8, 1);
+            MemoryCopy(&str->size, read_ptr, sizeof(U64)); read_ptr += sizeof(U64);
+            str->str = read_ptr; read_ptr += str->size;
+            rows[r][c] = str;
+          }
+          else
+          {
+            rows[r][c] = read_ptr; read_ptr += column->size;
+          }
+          valid = (read_ptr <= read_end);
+        }
+      }
+
+      if (valid)
+      {
+        gdb_table_apply_logged_rows(table, rows, row_count, header.lsn);
+        replayed_record_count++;
+      }
+      else
+      {
+        log_error("write-ahead log lsn %llu does not match the schema of '%.*s'", header.lsn, str8_varg(table_name));
+      }
+      temp_end(temp);
+    }
+
+    last_lsn = header.lsn;
+    at += sizeof(header) + header.payload_size;
+  }
+
+  //- tec: drop a torn tail so new records are not appended after garbage
+  if (at != wal->file_size)
+  {
+    log_warn("truncating write-ahead log from %llu to %llu bytes", wal->file_size, at);
+    os_file_resize(wal->file, at);
+    os_file_flush(wal->file);
+    wal->file_size = at;
+  }
+
+  wal->next_lsn = Max(wal->next_lsn, last_lsn + 1);
+  wal->flushed_lsn = wal->next_lsn - 1;
+
+  if (replayed_record_count > 0)
+  {
+    log_info("replayed %llu write-ahead log records into '%.*s'", replayed_record_count, str8_varg(database->name));
+  }
+
+  scratch_end(scratch);
+  ProfEnd();
+  return 1;
+}
+
+internal B32
+gdb_wal_checkpoint(GDB_Database* database, String8 directory)
+{
+  ProfBeginFunction();
+
+  GDB_Wal* wal = database->wal;
+
+  // tec: records logged after this point may have missed the flush, those keep the log alive
+  U64 checkpoint_lsn = 0;
+  if (wal)
+  {
+    OS_MutexScope(wal->mutex)
+    {
+      checkpoint_lsn = wal->next_lsn;
+    }
+  }
+
+  // tec: fold the logged rows into the column files, each meta file records the last lsn it contains
+  B32 result = gdb_database_flush(database, directory, 1);
+
+  if (result && wal)
+  {
+    OS_MutexScope(wal->mutex)
+    {
+      // tec: queued records belong to inserts that are not applied yet, those keep the log alive
+      if (!wal->flush_in_progress && wal->pending.node_count == 0 && wal->next_lsn == checkpoint_lsn)
+      {
+        wal->base_lsn = wal->next_lsn;
+        wal->file_size = sizeof(GDB_WalHeader);
+        result = gdb_wal_write_header(wal);
+        os_file_resize(wal->file, wal->file_size);
+        result = result && os_file_flush(wal->file);
+      }
+    }
+    wal->last_checkpoint_us = os_now_microseconds();
+    log_info("checkpointed write-ahead log for '%.*s'", str8_varg(database->name));
+  }
+
+  ProfEnd();
+  return result;
+}
+
+internal B32
+gdb_wal_checkpoint_if_needed(GDB_Database* database, String8 directory)
+{
+  GDB_Wal* wal = database->wal;
+  if (!wal)
+  {
+    return 1;
+  }
+
+  B32 has_records = (wal->file_size > sizeof(GDB_WalHeader));
+  B32 too_large = (wal->file_size >= GDB_WAL_CHECKPOINT_SIZE);
+  B32 too_old = (os_now_microseconds() - wal->last_checkpoint_us >= GDB_WAL_CHECKPOINT_INTERVAL_US);
+
+  B32 result = 1;
+  if (has_records && (too_large || too_old))
+  {
+    result = gdb_wal_checkpoint(database, directory);
+  }
+  return result;
+}
+
+//~ tec: logged inserts
+
+// tec: a column whose only pending changes live in the log stays out of the next save. taken before a logged
+// change is applied, gdb_table_mark_logged moves what was covered up to the change afterwards
+internal B32*
+gdb_table_logged_coverage(Arena* arena, GDB_Table* table, B32* out_table_covered)
+{
+  B32* column_covered = push_array(arena, B32, table->column_count);
+  for (U64 c = 0; c < table->column_count; c++)
+  {
+    column_covered[c] = !gdb_column_has_unlogged_changes(table->columns[c]);
+  }
+  *out_table_covered = (table->version == Max(table->flushed_version, table->logged_version));
+  return column_covered;
+}
+
+internal void
+gdb_table_mark_logged(GDB_Table* table, B32* column_covered, B32 table_covered, U64 lsn)
+{
+  for (U64 c = 0; c < table->column_count; c++)
+  {
+    if (column_covered[c])
+    {
+      table->columns[c]->logged_version = table->columns[c]->version;
+    }
+  }
+  if (table_covered)
+  {
+    table->logged_version = table->version;
+  }
+  table->wal_lsn = lsn;
+}
+
+internal void
+gdb_table_apply_logged_rows(GDB_Table* table, void*** rows, U64 row_count, U64 lsn)
+{
+  ProfBeginFunction();
+
+  Temp scratch = scratch_begin(0, 0);
+  B32 table_covered = 0;
+  B32* column_covered = gdb_table_logged_coverage(scratch.arena, table, &table_covered);
+
+  for (U64 r = 0; r < row_count; r++)
+  {
+    gdb_table_add_row(table, rows[r]);
+  }
+
+  gdb_table_mark_logged(table, column_covered, table_covered, lsn);
+
+  scratch_end(scratch);
+  ProfEnd();
+}
+
+internal void
+gdb_table_insert_rows(GDB_Table* table, void*** rows, U64 row_count)
+{
+  ProfBeginFunction();
+
+  GDB_Database* database = table->parent_database;
+  GDB_Wal* wal = database ? database->wal : NULL;
+
+  // tec: held across logging and applying so records land in the table in lsn order,
+  // other tables keep sharing the group commit
+  os_mutex_take(table->write_mutex);
+
+  if (wal)
+  {
+    U64 lsn = gdb_wal_append_rows(wal, table, rows, row_count);
+    if (lsn == 0)
+    {
+      log_error("failed to log insert into '%.*s', rows were not added", str8_varg(table->name));
+    }
+    else
+    {
+      gdb_table_apply_logged_rows(table, rows, row_count, lsn);
+    }
+  }
+  else
+  {
+    for (U64 r = 0; r < row_count; r++)
+    {
+      gdb_table_add_row(table, rows[r]);
+    }
+  }
+
+  os_mutex_drop(table->write_mutex);
+  ProfEnd();
+}
+
+// tec: a columnar block, logged as one insert record so it replays like gdb_table_insert_rows does and then
+// appended column by column. the rows are not added when the record could not be made durable.
+// indexes are left as they are, appended rows do not move the old ones and the next lookup folds them in
+internal B32
+gdb_table_insert_block(GDB_ImportBlock* block)
+{
+  ProfBeginFunction();
+
+  GDB_Table* table = block->table;
+  GDB_Database* database = table->parent_database;
+  GDB_Wal* wal = database ? database->wal : NULL;
+  B32 result = 1;
+
+  os_mutex_take(table->write_mutex);
+
+  if (wal)
+  {
+    Temp scratch = scratch_begin(0, 0);
+    B32 table_covered = 0;
+    B32* column_covered = gdb_table_logged_coverage(scratch.arena, table, &table_covered);
+    U64 lsn = gdb_wal_append_block(wal, block);
+    if (lsn == 0)
+    {
+      log_error("failed to log %llu appended rows for '%.*s', they were not added", block->row_count, str8_varg(table->name));
+      result = 0;
+    }
+    else
+    {
+      gdb_import_block_append(block);
+      gdb_table_mark_dirty(table);
+      gdb_table_mark_logged(table, column_covered, table_covered, lsn);
+    }
+    scratch_end(scratch);
+  }
+  else
+  {
+    gdb_import_block_append(block);
+    gdb_table_mark_dirty(table);
+  }
+
+  os_mutex_drop(table->write_mutex);
+  ProfEnd();
+  return result;
+}
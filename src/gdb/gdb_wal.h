@@ -0,0 +1,89 @@
+/* date = October 19th 2026 9:12 am */
+
+#ifndef GDB_WAL_H
+#define GDB_WAL_H
+
+#define GDB_WAL_MAGIC        0x4c415747 // tec: 'GWAL'
+#define GDB_WAL_RECORD_MAGIC 0x43455247 // tec: 'GREC'
+#define GDB_WAL_VERSION      1
+
+#ifndef GDB_WAL_FILE_NAME
+#define GDB_WAL_FILE_NAME "wal.log"
+#endif
+#ifndef GDB_WAL_ARENA_RESERVE_SIZE
+#define GDB_WAL_ARENA_RESERVE_SIZE GB(1)
+#endif
+#ifndef GDB_WAL_ARENA_COMMIT_SIZE
+#define GDB_WAL_ARENA_COMMIT_SIZE MB(1)
+#endif
+#ifndef GDB_WAL_CHECKPOINT_SIZE
+#define GDB_WAL_CHECKPOINT_SIZE MB(64)
+#endif
+#ifndef GDB_WAL_CHECKPOINT_INTERVAL_US
+#define GDB_WAL_CHECKPOINT_INTERVAL_US (60ull * 1000000ull)
+#endif
+
+// tec: on disk the log is a GDB_WalHeader followed by records, each record is a
+// GDB_WalRecordHeader followed by payload_size bytes. the crc covers lsn, payload_size and the payload.
+// payload: [U64 table_name_size][table name][U64 column_count][U64 row_count][rows]
+// each row holds every column value, fixed size types raw, strings as [U64 size][bytes]
+typedef struct GDB_WalHeader GDB_WalHeader;
+struct GDB_WalHeader
+{
+  U32 magic;
+  U32 version;
+  U64 base_lsn;
+};
+
+typedef struct GDB_WalRecordHeader GDB_WalRecordHeader;
+struct GDB_WalRecordHeader
+{
+  U32 magic;
+  U32 crc;
+  U64 lsn;
+  U64 payload_size;
+};
+
+typedef struct GDB_Wal GDB_Wal;
+struct GDB_Wal
+{
+  String8 path;
+  OS_Handle file;
+
+  // tec: guards everything below
+  OS_Handle mutex;
+  OS_Handle flushed_cv;
+
+  U64 file_size;
+  U64 base_lsn;
+  U64 next_lsn;
+  U64 flushed_lsn;
+  U64 last_checkpoint_us;
+
+  // tec: group commit, records queue up in pending while the leader writes the previous group
+  B32 flush_in_progress;
+  B32 write_failed;
+  Arena* pending_arena;
+  Arena* flushing_arena;
+  String8List pending;
+  U64 pending_last_lsn;
+};
+
+internal GDB_Wal* gdb_wal_open(GDB_Database* database, String8 directory);
+internal void     gdb_wal_close(GDB_Wal* wal);
+internal U64      gdb_wal_append_rows(GDB_Wal* wal, GDB_Table* table, void*** rows, U64 row_count);
+internal U64      gdb_wal_append_block(GDB_Wal* wal, GDB_ImportBlock* block);
+internal B32      gdb_wal_wait_durable(GDB_Wal* wal, U64 lsn);
+internal B32      gdb_wal_replay(GDB_Database* database);
+internal B32      gdb_wal_checkpoint(GDB_Database* database, String8 directory);
+internal B32      gdb_wal_checkpoint_if_needed(GDB_Database* database, String8 directory);
+internal U32      gdb_wal_crc32(U32 crc, void* data, U64 size);
+
+//~ tec: logged inserts
+internal B32* gdb_table_logged_coverage(Arena* arena, GDB_Table* table, B32* out_table_covered);
+internal void gdb_table_mark_logged(GDB_Table* table, B32* column_covered, B32 table_covered, U64 lsn);
+internal void gdb_table_apply_logged_rows(GDB_Table* table, void*** rows, U64 row_count, U64 lsn);
+internal void gdb_table_insert_rows(GDB_Table* table, void*** rows, U64 row_count);
+internal B32  gdb_table_insert_block(GDB_ImportBlock* block);
+
+#endif //GDB_WAL_H
@@ -0,0 +1,50 @@
+//~ tec: devices
+internal void
+gpu_select_device(U32 device_index)
+{
+  U32 device_count = gpu_device_count();
+  g_gpu_thread_device = device_index < device_count ? device_index : 0;
+}
+
+internal U32
+gpu_selected_device(void)
+{
+  return g_gpu_thread_device;
+}
+
+//~ tec: kernel params
+internal GPU_KernelParam*
+gpu_kernel_param_list_push(Arena* arena, GPU_KernelParamList* list, GPU_KernelParamKind kind)
+{
+  GPU_KernelParam* param = push_array(arena, GPU_KernelParam, 1);
+  param->kind = kind;
+  SLLQueuePush(list->first, list->last, param);
+  list->count++;
+  return param;
+}
+
+internal GPU_KernelParam*
+gpu_kernel_param_from_numeric(Arena* arena, GPU_KernelParamList* list, String8 value)
+{
+  // tec: integers keep integer compares, anything with a fraction or exponent compares as double
+  B32 is_float = (str8_contains(value, '.') || str8_contains(value, 'e') || str8_contains(value, 'E'));
+  B32 is_negative = (value.size > 0 && value.str[0] == '-');
+  
+  GPU_KernelParam* param = 0;
+  if (is_float)
+  {
+    param = gpu_kernel_param_list_push(arena, list, GPU_KernelParamKind_F64);
+    param->f64 = f64_from_str8(value);
+  }
+  else if (is_negative)
+  {
+    param = gpu_kernel_param_list_push(arena, list, GPU_KernelParamKind_S64);
+    param->s64 = -(S64)u64_from_str8(str8_skip(value, 1), 10);
+  }
+  else
+  {
+    param = gpu_kernel_param_list_push(arena, list, GPU_KernelParamKind_U64);
+    param->u64 = u64_from_str8(value, 10);
+  }
+  return param;
+}
@@ -9,6 +9,23 @@
 //#define GPU_MAX_BUFFER_SIZE MB(512)
 //#define GPU_MAX_BUFFER_SIZE GB(1)
 
+#if !defined(GPU_KERNEL_CACHE_BUCKET_COUNT)
+#define GPU_KERNEL_CACHE_BUCKET_COUNT 64
+#endif
+
+#if !defined(GPU_MAX_DEVICE_COUNT)
+#define GPU_MAX_DEVICE_COUNT 8
+#endif
+
+// tec: staging buffers are sized to the chunk read into them, rounded up to this so chunks of about the
+// same size reuse each other's buffers. each device keeps at most GPU_STAGING_POOL_MAX_SIZE of idle ones
+#if !defined(GPU_STAGING_GRANULARITY)
+#define GPU_STAGING_GRANULARITY MB(2)
+#endif
+#if !defined(GPU_STAGING_POOL_MAX_SIZE)
+#define GPU_STAGING_POOL_MAX_SIZE MB(256)
+#endif
+
 typedef enum GPU_BufferFlags
 {
   GPU_BufferFlag_Read  = (1 << 0),
@@ -27,6 +44,56 @@ typedef struct GPU_State GPU_State;
 typedef struct GPU_Buffer GPU_Buffer;
 typedef struct GPU_Kernel GPU_Kernel;
 
+typedef enum GPU_KernelParamKind
+{
+  GPU_KernelParamKind_U64,
+  GPU_KernelParamKind_S64,
+  GPU_KernelParamKind_F32,
+  GPU_KernelParamKind_F64,
+  GPU_KernelParamKind_String,
+  GPU_KernelParamKind_COUNT,
+} GPU_KernelParamKind;
+
+// tec: a literal hoisted out of a generated kernel so the source only depends on the query shape.
+// params follow row_count in the kernel signature, strings take two arguments (data buffer, size)
+typedef struct GPU_KernelParam GPU_KernelParam;
+struct GPU_KernelParam
+{
+  GPU_KernelParam* next;
+  GPU_KernelParamKind kind;
+  U64 u64;
+  S64 s64;
+  F64 f64;
+  String8 string;
+};
+
+typedef struct GPU_KernelParamList GPU_KernelParamList;
+struct GPU_KernelParamList
+{
+  GPU_KernelParam* first;
+  GPU_KernelParam* last;
+  U64 count;
+};
+
+// tec: work the calling thread sent to the device. EXPLAIN ANALYZE takes the difference around each operator
+typedef struct GPU_Stats GPU_Stats;
+struct GPU_Stats
+{
+  U64 bytes_uploaded;
+  U64 bytes_downloaded;
+  U64 upload_time_us;
+  U64 download_time_us;
+  U64 kernel_time_us;
+  U64 kernel_compile_time_us;
+  U64 kernel_cache_hits;
+  U64 kernel_cache_misses;
+};
+
+thread_static GPU_Stats g_gpu_stats = { 0 };
+
+// tec: the device buffers and kernels allocated on this thread belong to, see gpu_select_device
+thread_static U32 g_gpu_thread_device = 0;
+
 internal void gpu_init(void);
 internal void gpu_release(void);
 internal void gpu_wait(void);
@@ -35,6 +102,16 @@ internal void gpu_wait(void);
 internal U64 gpu_device_total_memory(void);
 internal U64 gpu_device_free_memory(void);
 
+//- tec: devices. every gpu found at init gets its own context and queue, a thread picks one with
+// gpu_select_device and everything it allocates afterwards lives on that device
+internal U32 gpu_device_count(void);
+internal void gpu_select_device(U32 device_index);
+internal U32 gpu_selected_device(void);
+internal String8 gpu_device_name(U32 device_index);
+// tec: rows per microsecond the device sustained on recent scan chunks, 0 until it ran one
+internal F64 gpu_device_throughput(U32 device_index);
+internal void gpu_device_record_throughput(U32 device_index, U64 rows, U64 time_us);
+
 internal U64 gpu_hash_from_string(String8 str);
 internal String8 gpu_get_device_id_string(Arena* arena);
 internal String8 gpu_get_kernel_cache_path(Arena* arena, String8 source, String8 kernel_name);
@@ -43,13 +120,29 @@ internal GPU_Buffer* gpu_buffer_alloc(U64 size, GPU_BufferFlags flags, void* dat
 internal void gpu_buffer_release(GPU_Buffer* buffer);
 internal void gpu_buffer_write(GPU_Buffer* buffer, void* data, U64 size);
 internal void gpu_buffer_read(GPU_Buffer* buffer, void* data, U64 size);
+internal void gpu_buffer_read_range(GPU_Buffer* buffer, U64 offset, void* data, U64 size);
 
+//- tec: staging buffers, pinned host memory that stays mapped for its lifetime and that the device
+// copies from without the driver bouncing it through its own. a released buffer goes back to the
+// selected device's pool and is handed out again to the next alloc it is big enough for
+internal GPU_Buffer* gpu_staging_alloc(U64 size);
+internal void gpu_staging_release(GPU_Buffer* staging);
+internal void* gpu_staging_ptr(GPU_Buffer* staging);
+internal void gpu_buffer_write_from_staging(GPU_Buffer* buffer, GPU_Buffer* staging, U64 staging_offset, U64 size);
+
+// tec: kernels are cached by name and source for the lifetime of the process, the cache owns them.
+// alloc hands a kernel to one caller until it is released back to the cache
 internal GPU_Kernel* gpu_kernel_alloc(String8 name, String8 src);
 internal void gpu_kernel_release(GPU_Kernel *kernel);
 internal void gpu_kernel_execute(GPU_Kernel* kernel, U32 global_work_size, U32 local_work_size);
 internal void gpu_kernel_set_arg_buffer(GPU_Kernel* kernel, U32 index, GPU_Buffer* buffer);
 internal void gpu_kernel_set_arg_u64(GPU_Kernel* kernel, U32 index, U64 value);
+internal void gpu_kernel_set_arg_bytes(GPU_Kernel* kernel, U32 index, void* data, U64 size);
+
+internal GPU_KernelParam* gpu_kernel_param_list_push(Arena* arena, GPU_KernelParamList* list, GPU_KernelParamKind kind);
+internal GPU_KernelParam* gpu_kernel_param_from_numeric(Arena* arena, GPU_KernelParamList* list, String8 value);
 
-internal String8 gpu_generate_kernel_from_ir(Arena* arena, String8 kernel_name, GDB_Database* database, IR_Node* ir_node, String8List* active_columns);
+// tec: one kernel evaluates the where clause of every query in ir_nodes, all of them over the same table
+internal String8 gpu_generate_kernel_from_ir(Arena* arena, String8 kernel_name, GDB_Database* database, IR_Node** ir_nodes, U64 query_count, String8List* active_columns, String8List* nullable_columns, GPU_KernelParamList* out_params);
 
 #endif //GPU_H
@@ -1,3 +1,5 @@
+#include "gpu.c"
+
 #if GPU == GPU_OPENCL
 #include "opencl/gpu_opencl.c"
 #elif GPU == GPU_VULKAN
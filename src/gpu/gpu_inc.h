@@ -7,7 +7,10 @@
 #define GPU_OPENCL 1
 #define GPU_VULKAN 2
 
+// tec: the backend can be picked at build time, e.g. /DGPU=2 for vulkan
+#if !defined(GPU)
 #define GPU GPU_OPENCL
+#endif
 
 #include "gpu.h"
 
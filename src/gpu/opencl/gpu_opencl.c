@@ -22,43 +22,73 @@ gpu_init(void)
   Arena* arena = arena_alloc();
   g_opencl_state = push_array(arena, GPU_State, 1);
   g_opencl_state->arena = arena;
+  g_opencl_state->mutex = os_mutex_alloc();
   
   //- tec: OpenCL setup
   cl_int ret;
   
-  //- tec: get platform and device
-  ret = clGetPlatformIDs(1, &g_opencl_state->platform, NULL);
-  if (ret != CL_SUCCESS)
+  //- tec: get platforms
+  cl_platform_id platforms[GPU_MAX_DEVICE_COUNT];
+  cl_uint platform_count = 0;
+  ret = clGetPlatformIDs(GPU_MAX_DEVICE_COUNT, platforms, &platform_count);
+  if (ret != CL_SUCCESS || platform_count == 0)
   {
     log_error("Failed to get OpenCL platform.");
   }
+  platform_count = Min(platform_count, GPU_MAX_DEVICE_COUNT);
   
-  ret = clGetDeviceIDs(g_opencl_state->platform, CL_DEVICE_TYPE_GPU, 1, &g_opencl_state->device, NULL);
-  if (ret != CL_SUCCESS) 
-  {
-    log_error("Failed to get OpenCL device.");
-  }
-  
-  
-  //- tec: create context
-  g_opencl_state->context = clCreateContext(NULL, 1, &g_opencl_state->device, NULL, NULL, &ret);
-  if (ret != CL_SUCCESS) 
+  //- tec: every gpu of every platform gets its own context and command queue
+  for (cl_uint platform_index = 0; platform_index < platform_count; platform_index++)
   {
-    log_error("Failed to create OpenCL context.");
+    cl_device_id devices[GPU_MAX_DEVICE_COUNT];
+    cl_uint device_count = 0;
+    ret = clGetDeviceIDs(platforms[platform_index], CL_DEVICE_TYPE_GPU, GPU_MAX_DEVICE_COUNT, devices, &device_count);
+    if (ret != CL_SUCCESS)
+    {
+      continue;
+    }
+    device_count = Min(device_count, GPU_MAX_DEVICE_COUNT);
+    
+    for (cl_uint i = 0; i < device_count && g_opencl_state->device_count < GPU_MAX_DEVICE_COUNT; i++)
+    {
+      GPU_Device* device = &g_opencl_state->devices[g_opencl_state->device_count];
+      device->platform = platforms[platform_index];
+      device->device = devices[i];
+      
+      //- tec: create context
+      device->context = clCreateContext(NULL, 1, &device->device, NULL, NULL, &ret);
+      if (ret != CL_SUCCESS) 
+      {
+        log_error("Failed to create OpenCL context.");
+        continue;
+      }
+      
+      //- tec: create command queue
+      cl_queue_properties props[] =
+      {
+        CL_QUEUE_PROPERTIES, CL_QUEUE_PROFILING_ENABLE,
+        0
+      };
+      
+      device->command_queue = clCreateCommandQueueWithProperties(device->context, device->device, props, &ret);
+      if (ret != CL_SUCCESS) 
+      {
+        log_error("Failed to create OpenCL command queue.");
+        clReleaseContext(device->context);
+        continue;
+      }
+      
+      char name[256] = { 0 };
+      clGetDeviceInfo(device->device, CL_DEVICE_NAME, sizeof(name) - 1, name, NULL);
+      device->name = push_str8_copy(arena, str8_cstring(name));
+      log_info("gpu %u: %.*s", g_opencl_state->device_count, str8_varg(device->name));
+      g_opencl_state->device_count++;
+    }
   }
   
-  //- tec: create command queue
-  //g_opencl_state->command_queue = clCreateCommandQueue(g_opencl_state->context, g_opencl_state->device, 0, &ret);
-  cl_queue_properties props[] =
-  {
-    CL_QUEUE_PROPERTIES, CL_QUEUE_PROFILING_ENABLE,
-    0
-  };
-  
-  g_opencl_state->command_queue = clCreateCommandQueueWithProperties(g_opencl_state->context, g_opencl_state->device, props, &ret);
-  if (ret != CL_SUCCESS) 
+  if (g_opencl_state->device_count == 0)
   {
-    log_error("Failed to create OpenCL command queue.");
+    log_error("Failed to get OpenCL device.");
   }
   
   ProfEnd();
@@ -67,9 +97,33 @@ gpu_init(void)
 internal void
 gpu_release(void)
 {
-  clReleaseCommandQueue(g_opencl_state->command_queue);
-  clReleaseContext(g_opencl_state->context);
+  for (U64 bucket = 0; bucket < GPU_KERNEL_CACHE_BUCKET_COUNT; bucket++)
+  {
+    for (GPU_Kernel* kernel = g_opencl_state->kernel_cache[bucket]; kernel != NULL; kernel = kernel->hash_next)
+    {
+      clReleaseKernel(kernel->kernel);
+      clReleaseProgram(kernel->program);
+    }
+    g_opencl_state->kernel_cache[bucket] = 0;
+  }
+  log_info("kernel cache: %llu hits, %llu misses", g_opencl_state->kernel_cache_hits, g_opencl_state->kernel_cache_misses);
+  
+  for (U32 i = 0; i < g_opencl_state->device_count; i++)
+  {
+    while (g_opencl_state->devices[i].free_staging)
+    {
+      GPU_Buffer* staging = g_opencl_state->devices[i].free_staging;
+      SLLStackPop(g_opencl_state->devices[i].free_staging);
+      gpu_opencl_staging_destroy(&g_opencl_state->devices[i], staging);
+    }
+    clFinish(g_opencl_state->devices[i].command_queue);
+    g_opencl_state->devices[i].free_staging_size = 0;
+    
+    clReleaseCommandQueue(g_opencl_state->devices[i].command_queue);
+    clReleaseContext(g_opencl_state->devices[i].context);
+  }
   
+  os_mutex_release(g_opencl_state->mutex);
   arena_release(g_opencl_state->arena);
 }
 
@@ -78,7 +132,7 @@ gpu_wait(void)
 {
   ProfBeginFunction();
   
-  clFinish(g_opencl_state->command_queue);
+  clFinish(gpu_opencl_selected_device()->command_queue);
   
   ProfEnd();
 }
@@ -91,7 +145,7 @@ gpu_device_total_memory(void)
   cl_int err;
   cl_ulong total_memory = 0;
   
-  err = clGetDeviceInfo(g_opencl_state->device, CL_DEVICE_GLOBAL_MEM_SIZE, sizeof(cl_ulong), &total_memory, NULL);
+  err = clGetDeviceInfo(gpu_opencl_selected_device()->device, CL_DEVICE_GLOBAL_MEM_SIZE, sizeof(cl_ulong), &total_memory, NULL);
   if (err != CL_SUCCESS)
   {
     log_error("failed to get CL_DEVICE_GLOBAL_MEM_SIZE (err %d)\n", err);
@@ -107,6 +161,47 @@ gpu_device_free_memory(void)
   return 0;
 }
 
+//~ tec: devices
+internal GPU_Device*
+gpu_opencl_selected_device(void)
+{
+  return &g_opencl_state->devices[g_gpu_thread_device];
+}
+
+internal U32
+gpu_device_count(void)
+{
+  return Max(g_opencl_state->device_count, 1);
+}
+
+internal String8
+gpu_device_name(U32 device_index)
+{
+  return device_index < g_opencl_state->device_count ? g_opencl_state->devices[device_index].name : str8_zero();
+}
+
+internal F64
+gpu_device_throughput(U32 device_index)
+{
+  F64 result = 0;
+  OS_MutexScope(g_opencl_state->mutex)
+  {
+    result = g_opencl_state->devices[device_index].throughput;
+  }
+  return result;
+}
+
+internal void
+gpu_device_record_throughput(U32 device_index, U64 rows, U64 time_us)
+{
+  F64 sample = (F64)rows / (F64)Max(time_us, 1);
+  OS_MutexScope(g_opencl_state->mutex)
+  {
+    GPU_Device* device = &g_opencl_state->devices[device_index];
+    device->throughput = device->throughput > 0 ? device->throughput * 0.75 + sample * 0.25 : sample;
+  }
+}
+
 //~ tec: kernel caching
 internal U64 
 gpu_hash_from_string(String8 str)
@@ -123,13 +218,15 @@ gpu_hash_from_string(String8 str)
 internal String8
 gpu_get_device_id_string(Arena* arena)
 {
+  // tec: binaries differ between models of the same vendor, the name keeps their cache entries apart
+  GPU_Device* device = gpu_opencl_selected_device();
   char vendor[128], version[128];
-  clGetDeviceInfo(g_opencl_state->device, CL_DEVICE_VENDOR, sizeof(vendor), vendor, NULL);
-  clGetDeviceInfo(g_opencl_state->device, CL_DRIVER_VERSION, sizeof(version), version, NULL);
+  clGetDeviceInfo(device->device, CL_DEVICE_VENDOR, sizeof(vendor), vendor, NULL);
+  clGetDeviceInfo(device->device, CL_DRIVER_VERSION, sizeof(version), version, NULL);
   
   String8 vendor_str = str8_cstring(vendor);
   String8 version_str = str8_cstring(version);
-  return push_str8f(arena, "%.*s_%.*s", str8_varg(vendor_str), str8_varg(version_str));
+  return push_str8f(arena, "%.*s_%.*s_%.*s", str8_varg(vendor_str), str8_varg(device->name), str8_varg(version_str));
 }
 
 internal String8 
@@ -149,22 +246,45 @@ gpu_buffer_alloc(U64 size, GPU_BufferFlags flags, void* data)
 {
   ProfBeginFunction();
   
-  GPU_Buffer* buffer = push_array(g_opencl_state->arena, GPU_Buffer, 1);
+  GPU_Buffer* buffer = 0;
+  OS_MutexScope(g_opencl_state->mutex)
+  {
+    buffer = g_opencl_state->free_buffers;
+    if (buffer)
+    {
+      SLLStackPop(g_opencl_state->free_buffers);
+    }
+    else
+    {
+      buffer = push_array_no_zero(g_opencl_state->arena, GPU_Buffer, 1);
+    }
+  }
+  MemoryZeroStruct(buffer);
   
   cl_int result = 0;
   
   cl_mem_flags cl_flags = gpu_flags_to_opencl_flags(flags);
   
   buffer->size = size;
-  buffer->buffer = clCreateBuffer(g_opencl_state->context, cl_flags, size, data ? data : NULL, &result);
+  buffer->device_index = g_gpu_thread_device;
+  buffer->buffer = clCreateBuffer(gpu_opencl_selected_device()->context, cl_flags, size, data ? data : NULL, &result);
   
   if (result != CL_SUCCESS) 
   {
     log_error("failed to create buffer, error: %i", result);
+    OS_MutexScope(g_opencl_state->mutex)
+    {
+      SLLStackPush(g_opencl_state->free_buffers, buffer);
+    }
     ProfEnd();
     return NULL;
   }
   
+  if (data && (flags & GPU_BufferFlag_CopyHostPointer))
+  {
+    g_gpu_stats.bytes_uploaded += size;
+  }
+  
   ProfEnd();
   return buffer;
 }
@@ -173,7 +293,10 @@ internal void
 gpu_buffer_release(GPU_Buffer* buffer)
 {
   clReleaseMemObject(buffer->buffer);
-  // tec: TODO add to free list
+  OS_MutexScope(g_opencl_state->mutex)
+  {
+    SLLStackPush(g_opencl_state->free_buffers, buffer);
+  }
 }
 
 internal void
@@ -182,7 +305,7 @@ gpu_buffer_write(GPU_Buffer* buffer, void* data, U64 size)
   ProfBeginFunction();
   
   cl_event write_event;
-  clEnqueueWriteBuffer(g_opencl_state->command_queue, buffer->buffer, CL_FALSE, 0, size, data, 0, NULL, &write_event);
+  clEnqueueWriteBuffer(g_opencl_state->devices[buffer->device_index].command_queue, buffer->buffer, CL_FALSE, 0, size, data, 0, NULL, &write_event);
   clWaitForEvents(1, &write_event);
   
   cl_ulong start_time = 0;
@@ -192,23 +315,32 @@ gpu_buffer_write(GPU_Buffer* buffer, void* data, U64 size)
   
   log_debug("buffer write time %llu microseconds", (end_time - start_time) / 1000);
   clReleaseEvent(write_event);
+  g_gpu_stats.bytes_uploaded += size;
+  g_gpu_stats.upload_time_us += (end_time - start_time) / 1000;
   
   ProfEnd();
 }
 
 internal void
 gpu_buffer_read(GPU_Buffer* buffer, void* data, U64 size)
+{
+  gpu_buffer_read_range(buffer, 0, data, size);
+}
+
+internal void
+gpu_buffer_read_range(GPU_Buffer* buffer, U64 offset, void* data, U64 size)
 {
   ProfBeginFunction();
   
   if (size == 0)
   {
     log_info("can not request read gpu buffer with size 0");
+    ProfEnd();
     return;
   }
   
   cl_event read_event;
-  clEnqueueReadBuffer(g_opencl_state->command_queue, buffer->buffer, CL_FALSE, 0, size, data, 0, NULL, &read_event);
+  clEnqueueReadBuffer(g_opencl_state->devices[buffer->device_index].command_queue, buffer->buffer, CL_FALSE, offset, size, data, 0, NULL, &read_event);
   clWaitForEvents(1, &read_event);
   
   cl_ulong start_time = 0;
@@ -218,10 +350,116 @@ gpu_buffer_read(GPU_Buffer* buffer, void* data, U64 size)
   
   log_debug("buffer read time %llu microseconds", (end_time - start_time) / 1000);
   clReleaseEvent(read_event);
+  g_gpu_stats.bytes_downloaded += size;
+  g_gpu_stats.download_time_us += (end_time - start_time) / 1000;
   
   ProfEnd();
 }
 
+//~ tec: staging buffers
+// tec: CL_MEM_ALLOC_HOST_PTR is where drivers hand out page locked memory, mapping it once gives the host
+// a pointer that clEnqueueWriteBuffer can dma from directly
+internal GPU_Buffer*
+gpu_staging_alloc(U64 size)
+{
+  ProfBeginFunction();
+  
+  GPU_Device* device = gpu_opencl_selected_device();
+  U64 staging_size = AlignPow2(Max(size, 1), GPU_STAGING_GRANULARITY);
+  GPU_Buffer* staging = 0;
+  OS_MutexScope(g_opencl_state->mutex)
+  {
+    // tec: the smallest idle buffer that fits, so a small chunk does not take the buffer a big one needs
+    GPU_Buffer* best_prev = 0;
+    GPU_Buffer* prev = 0;
+    for (GPU_Buffer* it = device->free_staging; it != NULL; prev = it, it = it->next)
+    {
+      if (it->size >= staging_size && (staging == 0 || it->size < staging->size))
+      {
+        staging = it;
+        best_prev = prev;
+      }
+    }
+    if (staging)
+    {
+      if (best_prev) best_prev->next = staging->next;
+      else device->free_staging = staging->next;
+      device->free_staging_size -= staging->size;
+    }
+  }
+  
+  if (staging == 0)
+  {
+    staging = gpu_buffer_alloc(staging_size, GPU_BufferFlag_Read | GPU_BufferFlag_HostVisible, NULL);
+    if (staging)
+    {
+      cl_int result = 0;
+      staging->mapped_ptr = clEnqueueMapBuffer(device->command_queue, staging->buffer, CL_TRUE, CL_MAP_WRITE, 0, staging_size, 0, NULL, NULL, &result);
+      if (result != CL_SUCCESS)
+      {
+        log_error("failed to map staging buffer, error: %i", result);
+        gpu_buffer_release(staging);
+        staging = 0;
+      }
+    }
+  }
+  
+  if (staging)
+  {
+    staging->next = 0;
+  }
+  
+  ProfEnd();
+  return staging;
+}
+
+// tec: a buffer that would take the device's idle pool past GPU_STAGING_POOL_MAX_SIZE is freed instead
+internal void
+gpu_staging_release(GPU_Buffer* staging)
+{
+  GPU_Device* device = &g_opencl_state->devices[staging->device_index];
+  B32 pooled = 0;
+  OS_MutexScope(g_opencl_state->mutex)
+  {
+    if (device->free_staging_size + staging->size <= GPU_STAGING_POOL_MAX_SIZE)
+    {
+      SLLStackPush(device->free_staging, staging);
+      device->free_staging_size += staging->size;
+      pooled = 1;
+    }
+  }
+  
+  if (!pooled)
+  {
+    gpu_opencl_staging_destroy(device, staging);
+  }
+}
+
+internal void
+gpu_opencl_staging_destroy(GPU_Device* device, GPU_Buffer* staging)
+{
+  clEnqueueUnmapMemObject(device->command_queue, staging->buffer, staging->mapped_ptr, 0, NULL, NULL);
+  staging->mapped_ptr = 0;
+  gpu_buffer_release(staging);
+}
+
+internal void*
+gpu_staging_ptr(GPU_Buffer* staging)
+{
+  return staging->mapped_ptr;
+}
+
+internal void
+gpu_buffer_write_from_staging(GPU_Buffer* buffer, GPU_Buffer* staging, U64 staging_offset, U64 size)
+{
+  if (staging_offset + size > staging->size)
+  {
+    log_error("gpu_buffer_write_from_staging: write range exceeds staging size.");
+    return;
+  }
+  gpu_buffer_write(buffer, (U8*)staging->mapped_ptr + staging_offset, size);
+}
+
 //~ tec: kernel
 internal cl_program
 gpu_opencl_load_or_build_program(String8 source, String8 kernel_name)
@@ -231,8 +469,8 @@ gpu_opencl_load_or_build_program(String8 source, String8 kernel_name)
   
   cl_program program = 0;
   cl_int ret = 0;
-  cl_device_id device = g_opencl_state->device;
-  cl_context context = g_opencl_state->context;
+  cl_device_id device = gpu_opencl_selected_device()->device;
+  cl_context context = gpu_opencl_selected_device()->context;
   
   String8 cache_path = gpu_get_kernel_cache_path(scratch.arena, source, kernel_name);
 #if !FORCE_KERNEL_COMPILATION
@@ -317,31 +555,102 @@ gpu_kernel_alloc(String8 name, String8 src)
 {
   ProfBeginFunction();
   
-  GPU_Kernel* kernel = push_array(g_opencl_state->arena, GPU_Kernel, 1);
+  //- tec: queries of the same shape generate the same source, reuse the compiled kernel
+  U32 device_index = g_gpu_thread_device;
+  U64 hash = gpu_hash_from_string(src) ^ (gpu_hash_from_string(name) * 1099511628211ULL) ^ device_index;
+  U64 bucket = hash % GPU_KERNEL_CACHE_BUCKET_COUNT;
+  GPU_Kernel* result = 0;
+  GPU_Kernel* busy_match = 0;
+  OS_MutexScope(g_opencl_state->mutex)
+  {
+    for (GPU_Kernel* cached = g_opencl_state->kernel_cache[bucket]; cached != NULL; cached = cached->hash_next)
+    {
+      if (cached->hash == hash && cached->device_index == device_index && str8_match(cached->name, name, 0) && str8_match(cached->source, src, 0))
+      {
+        if (!cached->in_use)
+        {
+          cached->in_use = 1;
+          result = cached;
+          break;
+        }
+        busy_match = cached;
+      }
+    }
+    if (result || busy_match) g_opencl_state->kernel_cache_hits++;
+    else                      g_opencl_state->kernel_cache_misses++;
+  }
+  if (result || busy_match) g_gpu_stats.kernel_cache_hits++;
+  else                      g_gpu_stats.kernel_cache_misses++;
+  if (result)
+  {
+    log_debug("reusing cached kernel '%.*s' (%016llx)", str8_varg(name), hash);
+    ProfEnd();
+    return result;
+  }
   
+  U64 compile_start_time = os_now_microseconds();
   cl_int ret = 0;
+  Temp scratch = scratch_begin(0, 0);
   
-  cl_program program = gpu_opencl_load_or_build_program(src, name);
-  kernel->name = name;
-  kernel->program = program;
-  kernel->kernel = clCreateKernel(program, name.str, &ret);
+  // tec: another query holds the cached kernel, a second one is made from its program without rebuilding
+  cl_program program = 0;
+  if (busy_match)
+  {
+    program = busy_match->program;
+    clRetainProgram(program);
+  }
+  else
+  {
+    program = gpu_opencl_load_or_build_program(src, name);
+  }
+  if (!program)
+  {
+    log_error("failed to build program for kernel \'%.*s\'", str8_varg(name));
+    scratch_end(scratch);
+    ProfEnd();
+    return NULL;
+  }
   
+  // tec: the name is passed to OpenCL as a c string
+  String8 name_cstr = push_str8_copy(scratch.arena, name);
+  cl_kernel cl_kernel_handle = clCreateKernel(program, (char*)name_cstr.str, &ret);
+  scratch_end(scratch);
   if (ret != CL_SUCCESS) 
   {
-    log_error("failed to create kernel \'%.*s\'", str8_varg(kernel->name));
+    log_error("failed to create kernel \'%.*s\'", str8_varg(name));
+    clReleaseProgram(program);
     ProfEnd();
     return NULL;
   }
   
+  OS_MutexScope(g_opencl_state->mutex)
+  {
+    GPU_Kernel* kernel = push_array(g_opencl_state->arena, GPU_Kernel, 1);
+    kernel->name = push_str8_copy(g_opencl_state->arena, name);
+    kernel->program = program;
+    kernel->kernel = cl_kernel_handle;
+    kernel->hash = hash;
+    kernel->source = push_str8_copy(g_opencl_state->arena, src);
+    kernel->in_use = 1;
+    kernel->device_index = device_index;
+    kernel->hash_next = g_opencl_state->kernel_cache[bucket];
+    g_opencl_state->kernel_cache[bucket] = kernel;
+    result = kernel;
+  }
+  g_gpu_stats.kernel_compile_time_us += os_now_microseconds() - compile_start_time;
+  
   ProfEnd();
-  return kernel;
+  return result;
 }
 
 internal void
 gpu_kernel_release(GPU_Kernel *kernel)
 {
-  clReleaseKernel(kernel->kernel);
-  // tec: TODO add to free list
+  // tec: back to the cache for the next query of the same shape, gpu_release frees it
+  OS_MutexScope(g_opencl_state->mutex)
+  {
+    kernel->in_use = 0;
+  }
 }
 
 internal void
@@ -354,7 +663,7 @@ gpu_kernel_execute(GPU_Kernel* kernel, U32 global_work_size, U32 local_work_size
   size_t local_size[]  = { local_work_size };
   
   cl_event kernel_event;
-  err = clEnqueueNDRangeKernel(g_opencl_state->command_queue, kernel->kernel, 1, NULL, global_size, local_size, 0, NULL, &kernel_event);
+  err = clEnqueueNDRangeKernel(g_opencl_state->devices[kernel->device_index].command_queue, kernel->kernel, 1, NULL, global_size, local_size, 0, NULL, &kernel_event);
   
   if (err != CL_SUCCESS)
   {
@@ -370,7 +679,8 @@ gpu_kernel_execute(GPU_Kernel* kernel, U32 global_work_size, U32 local_work_size
   clGetEventProfilingInfo(kernel_event, CL_PROFILING_COMMAND_START, sizeof(cl_ulong), &start_time, NULL);
   clGetEventProfilingInfo(kernel_event, CL_PROFILING_COMMAND_END,   sizeof(cl_ulong), &end_time,   NULL);
   
-  g_opencl_state->executed_kernel_time = (end_time - start_time) / 1000;
+  g_opencl_executed_kernel_time = (end_time - start_time) / 1000;
+  g_gpu_stats.kernel_time_us += g_opencl_executed_kernel_time;
   //log_debug("kernel execution time %llu microseconds", (end_time - start_time) / 1000);
   clReleaseEvent(kernel_event);
   
@@ -380,7 +690,7 @@ gpu_kernel_execute(GPU_Kernel* kernel, U32 global_work_size, U32 local_work_size
 internal U64
 gpu_get_executed_kernel_time_microseconds()
 {
-  return g_opencl_state->executed_kernel_time;
+  return g_opencl_executed_kernel_time;
 }
 
 internal void
@@ -402,7 +712,19 @@ gpu_kernel_set_arg_u64(GPU_Kernel* kernel, U32 index, U64 value)
   cl_int err = clSetKernelArg(kernel->kernel, index, sizeof(cl_ulong), &value);
   if (err != CL_SUCCESS)
   {
-    log_error("failed to set argument %llu for kernel (code: %d)", index, err);
+    log_error("failed to set argument %u for kernel (code: %d)", index, err);
+  }
+  ProfEnd();
+}
+
+internal void
+gpu_kernel_set_arg_bytes(GPU_Kernel* kernel, U32 index, void* data, U64 size)
+{
+  ProfBeginFunction();
+  cl_int err = clSetKernelArg(kernel->kernel, index, size, data);
+  if (err != CL_SUCCESS)
+  {
+    log_error("failed to set argument %u for kernel (code: %d)", index, err);
   }
   ProfEnd();
 }
@@ -412,12 +734,12 @@ global String8 g_gpu_opencl_str_match_code =
 str8_lit_comp(
               "int gpu_str_match(\n"
               "  __global const char* data, __global const ulong* offsets, ulong row_index, \n"
-              "  __constant const char* compare_str, int compare_size) {\n"
+              "  __global const char* compare_str, ulong compare_size) {\n"
               "\n"
               "    ulong start = offsets[row_index];\n"
               "    ulong end = offsets[row_index+1];\n"
               "    ulong str_size = end - start;\n"
-              "    if (str_size != (ulong)compare_size) return 0;\n"
+              "    if (str_size != compare_size) return 0;\n"
               "\n"
               "    for (ulong i = 0; i < str_size; i++) {\n"
               "        if ((char)data[start + i] != (char)compare_str[i]) {\n"
@@ -433,17 +755,17 @@ global String8 g_gpu_opencl_str_contains_code =
 str8_lit_comp(
               "int gpu_str_contains(\n"
               "  __global const char* data, __global const ulong* offsets, ulong row_index,\n"
-              "  __constant const char* compare_str, int compare_size) {\n"
+              "  __global const char* compare_str, ulong compare_size) {\n"
               "    \n"
               "    ulong start = offsets[row_index];\n"
               "    ulong end   = offsets[row_index+1];\n"
               "    ulong str_size = end - start;\n"
               "    \n"
-              "    if (str_size != (ulong)compare_size) return 0;\n"
+              "    if (str_size < compare_size) return 0;\n"
               "    \n"
               "    for (ulong i = 0; i <= str_size - compare_size; i++) {\n"
               "        int match = 1;\n"
-              "        for (int j = 0; j < compare_size; j++) {\n"
+              "        for (ulong j = 0; j < compare_size; j++) {\n"
               "            if ((char)data[start + i + j] != (char)compare_str[j]) {\n"
               "                match = 0;\n"
               "                break;\n"
@@ -456,7 +778,12 @@ str8_lit_comp(
               "}\n"
               );
 
-
+global String8 g_gpu_opencl_is_valid_code =
+str8_lit_comp(
+              "int gpu_is_valid(__global const ulong* valid, ulong row_index) {\n"
+              "    return (int)((valid[row_index >> 6] >> (row_index & 63)) & 1);\n"
+              "}\n"
+              );
 
 internal String8
 gpu_opencl_type_from_column_type(GDB_ColumnType type)
@@ -474,8 +801,40 @@ gpu_opencl_type_from_column_type(GDB_ColumnType type)
   return str8_lit("invalid");
 }
 
+// tec: sql '=' compares, in the kernel it would assign
+internal String8
+gpu_opencl_operator_from_ir(String8 op)
+{
+  if (str8_match(op, str8_lit("="), 0)) return str8_lit("==");
+  if (str8_match(op, str8_lit("<>"), 0)) return str8_lit("!=");
+  return op;
+}
+
 internal void
-gpu_opencl_generate_where(Arena* arena, String8List* builder, IR_Node* condition)
+gpu_opencl_generate_operand(Arena* arena, String8List* builder, GPU_KernelParamList* params, IR_Node* operand, GDB_ColumnType compared_type)
+{
+  if (operand->type == IR_NodeType_Column)
+  {
+    str8_list_pushf(arena, builder, "%.*s[i]", str8_varg(operand->value));
+  }
+  else if (operand->type == IR_NodeType_Numeric)
+  {
+    // tec: fractions compared against a float column stay float, devices without fp64 can still run the kernel
+    GPU_KernelParam* param = gpu_kernel_param_from_numeric(arena, params, operand->value);
+    if (param->kind == GPU_KernelParamKind_F64 && compared_type == GDB_ColumnType_F32)
+    {
+      param->kind = GPU_KernelParamKind_F32;
+    }
+    str8_list_pushf(arena, builder, "p%llu", params->count - 1);
+  }
+  else
+  {
+    str8_list_pushf(arena, builder, "%.*s", str8_varg(operand->value));
+  }
+}
+
+internal void
+gpu_opencl_generate_where(Arena* arena, String8List* builder, GDB_Database* database, IR_Node* root_node, IR_Node* condition, String8List* nullable_columns, GPU_KernelParamList* params)
 {
   if (!condition) return;
   
@@ -487,71 +846,88 @@ gpu_opencl_generate_where(Arena* arena, String8List* builder, IR_Node* condition
     if (str8_match(condition->value, str8_lit("and"), StringMatchFlag_CaseInsensitive))
     {
       str8_list_push(arena, builder, str8_lit("("));
-      gpu_opencl_generate_where(arena, builder, left);
+      gpu_opencl_generate_where(arena, builder, database, root_node, left, nullable_columns, params);
       str8_list_push(arena, builder, str8_lit(" && "));
-      gpu_opencl_generate_where(arena, builder, right);
+      gpu_opencl_generate_where(arena, builder, database, root_node, right, nullable_columns, params);
       str8_list_push(arena, builder, str8_lit(")"));
     }
     else if (str8_match(condition->value, str8_lit("or"), StringMatchFlag_CaseInsensitive))
     {
       str8_list_push(arena, builder, str8_lit("("));
-      gpu_opencl_generate_where(arena, builder, left);
+      gpu_opencl_generate_where(arena, builder, database, root_node, left, nullable_columns, params);
       str8_list_push(arena, builder, str8_lit(" || "));
-      gpu_opencl_generate_where(arena, builder, right);
+      gpu_opencl_generate_where(arena, builder, database, root_node, right, nullable_columns, params);
       str8_list_push(arena, builder, str8_lit(")"));
     }
+    else if (str8_match(condition->value, str8_lit("is null"), StringMatchFlag_CaseInsensitive) ||
+             str8_match(condition->value, str8_lit("is not null"), StringMatchFlag_CaseInsensitive))
+    {
+      // tec: columns without nulls get no bitmap, the test folds to a constant
+      B32 is_not = str8_match(condition->value, str8_lit("is not null"), StringMatchFlag_CaseInsensitive);
+      if (left->type == IR_NodeType_Column && ir_column_list_contains(nullable_columns, left->value))
+      {
+        str8_list_pushf(arena, builder, "%sgpu_is_valid(%.*s_valid, i)", is_not ? "" : "!", str8_varg(left->value));
+      }
+      else
+      {
+        str8_list_push(arena, builder, is_not ? str8_lit("1") : str8_lit("0"));
+      }
+    }
     else
     {
-      if (right->type == IR_NodeType_Literal)
+      // tec: a comparison against a null row is never true
+      B32 guarded = 0;
+      for (IR_Node* operand = condition->first; operand != NULL; operand = operand->next)
       {
-        if (str8_match(condition->value, str8_lit("=="), 0))
+        if (operand->type == IR_NodeType_Column && ir_column_list_contains(nullable_columns, operand->value))
         {
-          str8_list_pushf(arena, builder, "gpu_str_match(%.*s_data, %.*s_offsets, i, \"%.*s\", %llu)",
-                          str8_varg(left->value),
-                          str8_varg(left->value),
-                          str8_varg(right->value),
-                          right->value.size);
+          if (!guarded)
+          {
+            str8_list_push(arena, builder, str8_lit("("));
+            guarded = 1;
+          }
+          str8_list_pushf(arena, builder, "gpu_is_valid(%.*s_valid, i) && ", str8_varg(operand->value));
         }
-        else if (str8_match(condition->value, str8_lit("contains"), StringMatchFlag_CaseInsensitive))
+      }
+      
+      String8 op = gpu_opencl_operator_from_ir(condition->value);
+      if (right->type == IR_NodeType_Literal)
+      {
+        // tec: the literal is passed as a buffer and size, see GPU_KernelParam
+        B32 is_match = str8_match(op, str8_lit("=="), 0) || str8_match(op, str8_lit("!="), 0);
+        B32 is_contains = str8_match(op, str8_lit("contains"), StringMatchFlag_CaseInsensitive);
+        if (is_match || is_contains)
         {
-          str8_list_pushf(arena, builder, "gpu_str_contains(%.*s_data, %.*s_offsets, i, \"%.*s\", %llu)",
+          GPU_KernelParam* param = gpu_kernel_param_list_push(arena, params, GPU_KernelParamKind_String);
+          param->string = right->value;
+          
+          str8_list_pushf(arena, builder, "%s%s(%.*s_data, %.*s_offsets, i, p%llu, p%llu_size)",
+                          str8_match(op, str8_lit("!="), 0) ? "!" : "",
+                          is_contains ? "gpu_str_contains" : "gpu_str_match",
                           str8_varg(left->value),
                           str8_varg(left->value),
-                          str8_varg(right->value),
-                          right->value.size);
+                          params->count - 1,
+                          params->count - 1);
         }
         else
         {
           str8_list_pushf(arena, builder, "%.*s[i] ", str8_varg(left->value));
-          str8_list_pushf(arena, builder, "%.*s", str8_varg(condition->value));
+          str8_list_pushf(arena, builder, "%.*s", str8_varg(op));
           str8_list_pushf(arena, builder, " \"%.*s\"", str8_varg(right->value));
         }
       }
       else
       {
-        
-        if (left->type == IR_NodeType_Column)
-        {
-          str8_list_pushf(arena, builder, "%.*s[i] %.*s %.*s", 
-                          str8_varg(left->value),
-                          str8_varg(condition->value),
-                          str8_varg(right->value));
-        }
-        else
-        {
-          
-          str8_list_pushf(arena, builder, "%.*s %.*s %.*s[i]", 
-                          str8_varg(left->value),
-                          str8_varg(condition->value),
-                          str8_varg(right->value));
-        }
-        
-        /*
-        str8_list_pushf(arena, builder, "%.*s[i] %.*s %.*s", 
-                        str8_varg(left->value),
-                        str8_varg(condition->value),
-                        str8_varg(right->value));
-      */
+        GDB_ColumnType left_type = (left->type == IR_NodeType_Column) ? ir_find_column_type(database, root_node, left->value) : GDB_ColumnType_Invalid;
+        GDB_ColumnType right_type = (right->type == IR_NodeType_Column) ? ir_find_column_type(database, root_node, right->value) : GDB_ColumnType_Invalid;
+        gpu_opencl_generate_operand(arena, builder, params, left, right_type);
+        str8_list_pushf(arena, builder, " %.*s ", str8_varg(op));
+        gpu_opencl_generate_operand(arena, builder, params, right, left_type);
+      }
+      
+      if (guarded)
+      {
+        str8_list_push(arena, builder, str8_lit(")"));
       }
     }
   }
@@ -569,13 +945,15 @@ gpu_opencl_generate_where(Arena* arena, String8List* builder, IR_Node* condition
 #define GPU_USE_64_BIT_COUNTERS 1
 
 internal String8
-gpu_generate_kernel_from_ir(Arena* arena, String8 kernel_name, GDB_Database* database, IR_Node* ir_node, String8List* active_columns)
+gpu_generate_kernel_from_ir(Arena* arena, String8 kernel_name, GDB_Database* database, IR_Node** ir_nodes, U64 query_count, String8List* active_columns, String8List* nullable_columns, GPU_KernelParamList* out_params)
 {
   ProfBeginFunction();
   
   String8List builder = { 0 };
+  String8List body = { 0 };
   
-  // tec: find from table node
+  // tec: every query in a batch scans the same table, the first one stands in for column lookups
+  IR_Node* ir_node = ir_nodes[0];
   IR_Node* table_node = ir_node_find_child(ir_node, IR_NodeType_Table);
   if (!table_node)
   {
@@ -583,8 +961,9 @@ gpu_generate_kernel_from_ir(Arena* arena, String8 kernel_name, GDB_Database* dat
     return str8_lit("");
   }
   
-  // tec: check if any string columns are used
+  // tec: check if any string or nullable columns are used
   B32 contains_string_column = 0;
+  B32 contains_nullable_column = 0;
   for (String8Node* node = active_columns->first; node != NULL; node = node->next)
   {
     String8 str = node->string;
@@ -593,6 +972,10 @@ gpu_generate_kernel_from_ir(Arena* arena, String8 kernel_name, GDB_Database* dat
     {
       contains_string_column = 1;
     }
+    if (ir_column_list_contains(nullable_columns, str))
+    {
+      contains_nullable_column = 1;
+    }
   }
   if (contains_string_column)
   {
@@ -600,6 +983,11 @@ gpu_generate_kernel_from_ir(Arena* arena, String8 kernel_name, GDB_Database* dat
     str8_list_push(arena, &builder, g_gpu_opencl_str_contains_code);
     str8_list_push(arena, &builder, str8_lit("\n"));
   }
+  if (contains_nullable_column)
+  {
+    str8_list_push(arena, &builder, g_gpu_opencl_is_valid_code);
+    str8_list_push(arena, &builder, str8_lit("\n"));
+  }
   
   // tec: kernel signature
 #if (GPU_OPTIMIZE_GROUP_COMPACTION == 1)
@@ -636,83 +1024,122 @@ gpu_generate_kernel_from_ir(Arena* arena, String8 kernel_name, GDB_Database* dat
                       str8_varg(type_string),
                       str8_varg(str));
     }
+    
+    // tec: the null bitmap follows the column's data, only when the column holds nulls
+    if (ir_column_list_contains(nullable_columns, str))
+    {
+      str8_list_pushf(arena, &builder, 
+                      "__global const ulong* %.*s_valid,\n",
+                      str8_varg(str));
+    }
   }
   
-  // tec: output buffers and row count
+  // tec: output buffers and row count. query q writes its matches to
+  // output_indices[q * output_stride...] and its count to output_counts[q]
   str8_list_push(arena, &builder, str8_lit("__global ulong* output_indices,\n"));
-  str8_list_push(arena, &builder, str8_lit("volatile __global ulong* output_count,\n"));
-  str8_list_push(arena, &builder, str8_lit("ulong row_count) {\n"));
+  str8_list_push(arena, &builder, str8_lit("volatile __global ulong* output_counts,\n"));
+  str8_list_push(arena, &builder, str8_lit("ulong row_count,\n"));
+  str8_list_push(arena, &builder, str8_lit("ulong output_stride"));
+  
+  // tec: the body is generated first, it decides which literals become params
+  String8List signature = builder;
+  builder = body;
   
   // tec; thread/work group bookkeeping
   str8_list_push(arena, &builder, str8_lit("  ulong i = get_global_id(0);\n"));
   str8_list_push(arena, &builder, str8_lit("  if (i >= row_count) return;\n"));
   
-  // tec: find where clause
-  IR_Node* where_clause = ir_node_find_child(ir_node, IR_NodeType_Where);
+#if (GPU_OPTIMIZE_GROUP_COMPACTION == 1)
+  // tec: work group local declarations, shared by every query's compaction
+  str8_list_push(arena, &builder, str8_lit("  int  lid   = get_local_id(0);\n"));
+  str8_list_push(arena, &builder, str8_lit("  int  lsize = get_local_size(0);\n"));
+  str8_list_push(arena, &builder, str8_lit("  __local ulong local_indices[LOCAL_SIZE];\n"));
+  str8_list_push(arena, &builder, str8_lit("  __local ulong prefix[LOCAL_SIZE];\n"));
+  str8_list_push(arena, &builder, str8_lit("  __local ulong shared_offset;\n\n"));
+#endif
   
-  if (where_clause)
+  // tec: the columns are loaded once and every query's predicate is checked against the row
+  for (U64 query_index = 0; query_index < query_count; query_index++)
   {
-#if (GPU_OPTIMIZE_GROUP_COMPACTION == 1)
-    // tec: work group local declarations
-    str8_list_push(arena, &builder, str8_lit("  int  lid   = get_local_id(0);\n"));
-    str8_list_push(arena, &builder, str8_lit("  int  lsize = get_local_size(0);\n"));
-    str8_list_push(arena, &builder, str8_lit("  __local ulong local_indices[LOCAL_SIZE];\n"));
-    str8_list_push(arena, &builder, str8_lit("  __local ulong prefix[LOCAL_SIZE];\n"));
-    str8_list_push(arena, &builder, str8_lit("  __local ulong shared_offset;\n\n"));
-    
-    // tec: evaluate predicate
-    str8_list_push(arena, &builder, str8_lit("  int match = ("));
-    gpu_opencl_generate_where(arena, &builder, where_clause->first);
-    str8_list_push(arena, &builder, str8_lit(") ? 1 : 0;\n"));
-    
-    // tec: store match + exclusive scan into prefix[]
-    str8_list_push(arena, &builder, str8_lit("  local_indices[lid] = match ? i : 0;\n"));
-    str8_list_push(arena, &builder, str8_lit("  prefix[lid] = match;\n"));
-    str8_list_push(arena, &builder, str8_lit("  barrier(CLK_LOCAL_MEM_FENCE);\n"));
-    
-    // tec: inclusive scan (naïve, O(log n) synchronizations)
-    str8_list_push(arena, &builder, str8_lit("  for (int off = 1; off < lsize; off <<= 1) {\n"));
-    str8_list_push(arena, &builder, str8_lit("    ulong v = prefix[lid];\n"));
-    str8_list_push(arena, &builder, str8_lit("    barrier(CLK_LOCAL_MEM_FENCE);\n"));
-    str8_list_push(arena, &builder, str8_lit("    if (lid >= off) v += prefix[lid - off];\n"));
-    str8_list_push(arena, &builder, str8_lit("    barrier(CLK_LOCAL_MEM_FENCE);\n"));
-    str8_list_push(arena, &builder, str8_lit("    prefix[lid] = v;\n"));
-    str8_list_push(arena, &builder, str8_lit("  }\n\n"));
-    
-    // tec: One global atomic per group (thread 0)
-    str8_list_push(arena, &builder, str8_lit("  ulong group_total = prefix[lsize - 1];\n"));
-    str8_list_push(arena, &builder, str8_lit("  ulong global_offset = 0;\n"));
-    str8_list_push(arena, &builder, str8_lit("  if (lid == 0 && group_total)\n"));
-    //str8_list_push(arena, &builder, str8_lit("    global_offset = atomic_add(output_count, group_total);\n"));
-    str8_list_push(arena, &builder, str8_lit("    global_offset = atom_add(output_count, group_total);\n"));
-    str8_list_push(arena, &builder, str8_lit("  if (lid == 0) shared_offset = global_offset;\n"));
-    str8_list_push(arena, &builder, str8_lit("  barrier(CLK_LOCAL_MEM_FENCE);\n"));
-    str8_list_push(arena, &builder, str8_lit("  global_offset = shared_offset;\n\n"));
+    IR_Node* query_node = ir_nodes[query_index];
+    IR_Node* where_clause = ir_node_find_child(query_node, IR_NodeType_Where);
     
-    // tec: Write results (only matching threads reach here)
-    str8_list_push(arena, &builder, str8_lit("  if (match) {\n"));
-    str8_list_push(arena, &builder, str8_lit("    ulong pos = global_offset + prefix[lid] - 1;\n"));
-    str8_list_push(arena, &builder, str8_lit("    output_indices[pos] = i;\n"));
-    str8_list_push(arena, &builder, str8_lit("  }\n"));
+    if (where_clause)
+    {
+#if (GPU_OPTIMIZE_GROUP_COMPACTION == 1)
+      // tec: evaluate predicate
+      str8_list_push(arena, &builder, str8_lit("  {\n"));
+      str8_list_push(arena, &builder, str8_lit("  int match = ("));
+      gpu_opencl_generate_where(arena, &builder, database, query_node, where_clause->first, nullable_columns, out_params);
+      str8_list_push(arena, &builder, str8_lit(") ? 1 : 0;\n"));
+      
+      // tec: store match + exclusive scan into prefix[]
+      str8_list_push(arena, &builder, str8_lit("  local_indices[lid] = match ? i : 0;\n"));
+      str8_list_push(arena, &builder, str8_lit("  prefix[lid] = match;\n"));
+      str8_list_push(arena, &builder, str8_lit("  barrier(CLK_LOCAL_MEM_FENCE);\n"));
+      
+      // tec: inclusive scan (naïve, O(log n) synchronizations)
+      str8_list_push(arena, &builder, str8_lit("  for (int off = 1; off < lsize; off <<= 1) {\n"));
+      str8_list_push(arena, &builder, str8_lit("    ulong v = prefix[lid];\n"));
+      str8_list_push(arena, &builder, str8_lit("    barrier(CLK_LOCAL_MEM_FENCE);\n"));
+      str8_list_push(arena, &builder, str8_lit("    if (lid >= off) v += prefix[lid - off];\n"));
+      str8_list_push(arena, &builder, str8_lit("    barrier(CLK_LOCAL_MEM_FENCE);\n"));
+      str8_list_push(arena, &builder, str8_lit("    prefix[lid] = v;\n"));
+      str8_list_push(arena, &builder, str8_lit("  }\n\n"));
+      
+      // tec: One global atomic per group (thread 0)
+      str8_list_push(arena, &builder, str8_lit("  ulong group_total = prefix[lsize - 1];\n"));
+      str8_list_push(arena, &builder, str8_lit("  ulong global_offset = 0;\n"));
+      str8_list_push(arena, &builder, str8_lit("  if (lid == 0 && group_total)\n"));
+      str8_list_pushf(arena, &builder, "    global_offset = atom_add(&output_counts[%llu], group_total);\n", query_index);
+      str8_list_push(arena, &builder, str8_lit("  if (lid == 0) shared_offset = global_offset;\n"));
+      str8_list_push(arena, &builder, str8_lit("  barrier(CLK_LOCAL_MEM_FENCE);\n"));
+      str8_list_push(arena, &builder, str8_lit("  global_offset = shared_offset;\n\n"));
+      
+      // tec: Write results (only matching threads reach here)
+      str8_list_push(arena, &builder, str8_lit("  if (match) {\n"));
+      str8_list_push(arena, &builder, str8_lit("    ulong pos = global_offset + prefix[lid] - 1;\n"));
+      str8_list_pushf(arena, &builder, "    output_indices[%llu * output_stride + pos] = i;\n", query_index);
+      str8_list_push(arena, &builder, str8_lit("  }\n"));
+      str8_list_push(arena, &builder, str8_lit("  barrier(CLK_LOCAL_MEM_FENCE);\n"));
+      str8_list_push(arena, &builder, str8_lit("  }\n"));
 #else
-    str8_list_push(arena, &builder, str8_lit("  if ("));
-    gpu_opencl_generate_where(arena, &builder, where_clause->first);
-    str8_list_push(arena, &builder, str8_lit(") {\n"));
-    str8_list_push(arena, &builder, str8_lit("    ulong index = atomic_add(output_count, 1);\n"));
-    str8_list_push(arena, &builder, str8_lit("    output_indices[index] = i;\n"));
-    
-    str8_list_push(arena, &builder, str8_lit("  }\n"));
+      str8_list_push(arena, &builder, str8_lit("  if ("));
+      gpu_opencl_generate_where(arena, &builder, database, query_node, where_clause->first, nullable_columns, out_params);
+      str8_list_push(arena, &builder, str8_lit(") {\n"));
+      str8_list_pushf(arena, &builder, "    ulong index = atomic_add(&output_counts[%llu], 1);\n", query_index);
+      str8_list_pushf(arena, &builder, "    output_indices[%llu * output_stride + index] = i;\n", query_index);
+      
+      str8_list_push(arena, &builder, str8_lit("  }\n"));
 #endif
-  }
-  else
-  {
-    //str8_list_push(arena, &builder, str8_lit("  output_indices[i] = 1;\n"));
-    str8_list_push(arena, &builder, str8_lit("  output_indices[i] = i;\n"));
-    str8_list_push(arena, &builder, str8_lit("  if (i == 0) *output_count = row_count;\n"));
+    }
+    else
+    {
+      str8_list_pushf(arena, &builder, "  output_indices[%llu * output_stride + i] = i;\n", query_index);
+      str8_list_pushf(arena, &builder, "  if (i == 0) output_counts[%llu] = row_count;\n", query_index);
+    }
   }
   
   str8_list_push(arena, &builder, str8_lit("}"));
   
+  //- tec: hoisted literals, in the order they were pushed
+  body = builder;
+  builder = signature;
+  U64 param_index = 0;
+  for (GPU_KernelParam* param = out_params->first; param != NULL; param = param->next, param_index++)
+  {
+    switch (param->kind)
+    {
+      case GPU_KernelParamKind_U64:    str8_list_pushf(arena, &builder, ",\nulong p%llu", param_index); break;
+      case GPU_KernelParamKind_S64:    str8_list_pushf(arena, &builder, ",\nlong p%llu", param_index); break;
+      case GPU_KernelParamKind_F32:    str8_list_pushf(arena, &builder, ",\nfloat p%llu", param_index); break;
+      case GPU_KernelParamKind_F64:    str8_list_pushf(arena, &builder, ",\ndouble p%llu", param_index); break;
+      case GPU_KernelParamKind_String: str8_list_pushf(arena, &builder, ",\n__global const char* p%llu,\nulong p%llu_size", param_index, param_index); break;
+    }
+  }
+  str8_list_push(arena, &builder, str8_lit(") {\n"));
+  str8_list_concat_in_place(&builder, &body);
+  
   String8 result = str8_list_join(arena, &builder, NULL);
   
   ProfEnd();
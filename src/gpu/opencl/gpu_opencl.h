@@ -13,8 +13,13 @@ StaticAssert(sizeof(F64) == sizeof(cl_double), InvalidSize);
 
 struct GPU_Buffer
 {
+  GPU_Buffer* next;
   cl_mem buffer;
   U64 size;
+  U32 device_index;
+  
+  // tec: staging buffers only, where the buffer is mapped into the host's address space
+  void* mapped_ptr;
 };
 
 struct GPU_Kernel
@@ -22,23 +27,60 @@ struct GPU_Kernel
   String8 name;
   cl_kernel kernel;
   cl_program program;
+  
+  // tec: kernel cache chain. a kernel's arguments belong to one query at a time, concurrent
+  // queries of the same shape get their own cl_kernel from the same program
+  GPU_Kernel* hash_next;
+  U64 hash;
+  String8 source;
+  B32 in_use;
+  
+  // tec: programs and kernels belong to one context, each device compiles its own
+  U32 device_index;
 };
 
-struct GPU_State
+typedef struct GPU_Device GPU_Device;
+struct GPU_Device
 {
-  Arena* arena;
-  
   cl_platform_id platform;
   cl_device_id device;
   cl_context context;
   cl_command_queue command_queue;
+  String8 name;
   
-  U64 executed_kernel_time;
+  // tec: rows per microsecond, a moving average over the scan chunks the device ran
+  F64 throughput;
+  
+  // tec: staging buffers nobody holds and their total size, guarded by the state mutex
+  GPU_Buffer* free_staging;
+  U64 free_staging_size;
+};
+
+struct GPU_State
+{
+  Arena* arena;
+  
+  GPU_Device devices[GPU_MAX_DEVICE_COUNT];
+  U32 device_count;
+  
+  // tec: guards the arena, the kernel cache and the buffer free list, queries may run on several threads
+  OS_Handle mutex;
+  GPU_Buffer* free_buffers;
+  
+  // tec: compiled kernels keyed by name and source, reused by queries of the same shape
+  GPU_Kernel* kernel_cache[GPU_KERNEL_CACHE_BUCKET_COUNT];
+  U64 kernel_cache_hits;
+  U64 kernel_cache_misses;
 };
 
 global GPU_State* g_opencl_state = 0;
 
+// tec: per thread so concurrent queries time their own kernels
+thread_static U64 g_opencl_executed_kernel_time = 0;
+
 internal cl_mem_flags gpu_flags_to_opencl_flags(GPU_BufferFlags flags);
+internal GPU_Device* gpu_opencl_selected_device(void);
+internal void gpu_opencl_staging_destroy(GPU_Device* device, GPU_Buffer* staging);
 
 internal cl_program gpu_opencl_load_or_build_program(String8 source, String8 kernel_name);
 
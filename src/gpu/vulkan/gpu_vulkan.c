@@ -12,7 +12,6 @@ gpu_vulkan_find_memory_type(U32 type_bits, VkMemoryPropertyFlags props)
     }
   }
   
-  log_error("failed to find suitable Vulkan memory type.");
   return max_U32;
 }
 
@@ -24,6 +23,7 @@ gpu_init(void)
   Arena* arena = arena_alloc();
   g_vulkan_state = push_array(arena, GPU_State, 1);
   g_vulkan_state->arena = arena;
+  g_vulkan_state->mutex = os_mutex_alloc();
   
   VkResult res;
   
@@ -48,10 +48,11 @@ gpu_init(void)
   if (res != VK_SUCCESS)
   {
     log_error("failed to create Vulkan instance");
+    ProfEnd();
     return;
   }
   
-  //- tec: physical device
+  //- tec: physical device, discrete gpus first. software devices such as lavapipe are taken when nothing else is there
   U32 dev_count = 0;
   vkEnumeratePhysicalDevices(g_vulkan_state->instance, &dev_count, 0);
   VkPhysicalDevice *devices = push_array(arena, VkPhysicalDevice, dev_count);
@@ -59,223 +60,483 @@ gpu_init(void)
   
   VkPhysicalDevice selected = 0;
   U32 compute_queue_family_index = ~0u;
+  U32 transfer_queue_family_index = ~0u;
+  S32 selected_score = -1;
   for (U32 i = 0; i < dev_count; i++)
   {
+    VkPhysicalDeviceProperties props;
+    vkGetPhysicalDeviceProperties(devices[i], &props);
+    S32 score = (props.deviceType == VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU)   ? 3 :
+    (props.deviceType == VK_PHYSICAL_DEVICE_TYPE_INTEGRATED_GPU) ? 2 :
+    (props.deviceType == VK_PHYSICAL_DEVICE_TYPE_VIRTUAL_GPU)    ? 1 : 0;
+    
     U32 queue_count = 0;
     vkGetPhysicalDeviceQueueFamilyProperties(devices[i], &queue_count, 0);
-    VkQueueFamilyProperties *props = push_array(arena, VkQueueFamilyProperties, queue_count);
-    vkGetPhysicalDeviceQueueFamilyProperties(devices[i], &queue_count, props);
+    VkQueueFamilyProperties *queue_props = push_array(arena, VkQueueFamilyProperties, queue_count);
+    vkGetPhysicalDeviceQueueFamilyProperties(devices[i], &queue_count, queue_props);
     
+    U32 compute_family = ~0u;
+    U32 transfer_family = ~0u;
     for (U32 j = 0; j < queue_count; j++)
     {
-      if (props[j].queueFlags & VK_QUEUE_COMPUTE_BIT) 
+      if (compute_family == ~0u && (queue_props[j].queueFlags & VK_QUEUE_COMPUTE_BIT))
+      {
+        compute_family = j;
+      }
+      // tec: a family that only copies is usually a dma engine that runs alongside compute
+      if (transfer_family == ~0u && (queue_props[j].queueFlags & VK_QUEUE_TRANSFER_BIT) &&
+          !(queue_props[j].queueFlags & (VK_QUEUE_COMPUTE_BIT | VK_QUEUE_GRAPHICS_BIT)))
       {
-        selected = devices[i];
-        compute_queue_family_index = j;
-        break;
+        transfer_family = j;
       }
     }
-    if (selected) break;
+    
+    if (compute_family != ~0u && score > selected_score)
+    {
+      selected = devices[i];
+      selected_score = score;
+      compute_queue_family_index = compute_family;
+      transfer_queue_family_index = transfer_family != ~0u ? transfer_family : compute_family;
+    }
   }
   
   if (!selected)
   {
     log_error("no suitable Vulkan GPU found");
+    ProfEnd();
     return;
   }
   
   g_vulkan_state->physical_device = selected;
   g_vulkan_state->compute_queue_family_index = compute_queue_family_index;
+  g_vulkan_state->transfer_queue_family_index = transfer_queue_family_index;
+  
+  VkPhysicalDeviceProperties device_props;
+  vkGetPhysicalDeviceProperties(selected, &device_props);
+  g_vulkan_state->device_name = push_str8_copy(arena, str8_cstring(device_props.deviceName));
+  g_vulkan_state->max_push_constant_size = device_props.limits.maxPushConstantsSize;
+  g_vulkan_state->max_group_count_x = device_props.limits.maxComputeWorkGroupCount[0];
+  g_vulkan_state->timestamp_period = device_props.limits.timestampPeriod;
+  log_info("vulkan device: %.*s", str8_varg(g_vulkan_state->device_name));
+  
+  //- tec: features the generated shaders rely on, 64 bit row ids and counters, bytes for strings
+  VkPhysicalDeviceVulkan12Features supported12 = { .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES };
+  VkPhysicalDeviceFeatures2 supported = { .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2, .pNext = &supported12 };
+  vkGetPhysicalDeviceFeatures2(selected, &supported);
+  
+  if (!supported.features.shaderInt64 || !supported12.shaderBufferInt64Atomics)
+  {
+    log_error("vulkan device lacks 64 bit integers or atomics, kernels will not run");
+  }
+  if (!supported12.shaderInt8 || !supported12.storageBuffer8BitAccess)
+  {
+    log_error("vulkan device lacks 8 bit storage, string predicates will not run");
+  }
+  if (!supported.features.shaderFloat64)
+  {
+    log_info("vulkan device lacks fp64, F64 columns can not be filtered");
+  }
+  
+  VkPhysicalDeviceVulkan12Features enabled12 =
+  {
+    .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES,
+    .shaderBufferInt64Atomics = supported12.shaderBufferInt64Atomics,
+    .shaderInt8 = supported12.shaderInt8,
+    .storageBuffer8BitAccess = supported12.storageBuffer8BitAccess,
+  };
+  VkPhysicalDeviceFeatures2 enabled =
+  {
+    .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2,
+    .pNext = &enabled12,
+    .features =
+    {
+      .shaderInt64 = supported.features.shaderInt64,
+      .shaderFloat64 = supported.features.shaderFloat64,
+    },
+  };
   
   //- tec: logical device
   F32 priority = 1.0f;
-  VkDeviceQueueCreateInfo queue_info = 
+  VkDeviceQueueCreateInfo queue_infos[2] =
   {
-    .sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO,
-    .queueFamilyIndex = compute_queue_family_index,
-    .queueCount = 1,
-    .pQueuePriorities = &priority,
+    {
+      .sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO,
+      .queueFamilyIndex = compute_queue_family_index,
+      .queueCount = 1,
+      .pQueuePriorities = &priority,
+    },
+    {
+      .sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO,
+      .queueFamilyIndex = transfer_queue_family_index,
+      .queueCount = 1,
+      .pQueuePriorities = &priority,
+    },
   };
   
-  VkDeviceCreateInfo dev_info = 
+  VkDeviceCreateInfo dev_info =
   {
     .sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO,
-    .queueCreateInfoCount = 1,
-    .pQueueCreateInfos = &queue_info,
+    .pNext = &enabled,
+    .queueCreateInfoCount = (transfer_queue_family_index != compute_queue_family_index) ? 2 : 1,
+    .pQueueCreateInfos = queue_infos,
   };
   
   res = vkCreateDevice(selected, &dev_info, 0, &g_vulkan_state->device);
-  if (res != VK_SUCCESS) 
+  if (res != VK_SUCCESS)
   {
     log_error("failed to create Vulkan logical device");
+    ProfEnd();
     return;
   }
   
   vkGetDeviceQueue(g_vulkan_state->device, compute_queue_family_index, 0, &g_vulkan_state->compute_queue);
+  vkGetDeviceQueue(g_vulkan_state->device, transfer_queue_family_index, 0, &g_vulkan_state->transfer_queue);
   
-  //- tec: command pool
-  VkCommandPoolCreateInfo pool_info =
-  {
-    .sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
-    .queueFamilyIndex = compute_queue_family_index,
-    .flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT,
-  };
-  
-  res = vkCreateCommandPool(g_vulkan_state->device, &pool_info, 0, &g_vulkan_state->command_pool);
-  if (res != VK_SUCCESS)
+  //- tec: command pools, one command buffer each
+  U32 families[2] = { compute_queue_family_index, transfer_queue_family_index };
+  VkCommandPool* pools[2] = { &g_vulkan_state->command_pool, &g_vulkan_state->transfer_command_pool };
+  VkCommandBuffer* command_buffers[2] = { &g_vulkan_state->command_buffer, &g_vulkan_state->transfer_command_buffer };
+  for (U32 i = 0; i < 2; i++)
   {
-    log_error("failed to create Vulkan command pool");
-    return;
+    VkCommandPoolCreateInfo pool_info =
+    {
+      .sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+      .queueFamilyIndex = families[i],
+      .flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT,
+    };
+    
+    res = vkCreateCommandPool(g_vulkan_state->device, &pool_info, 0, pools[i]);
+    if (res != VK_SUCCESS)
+    {
+      log_error("failed to create Vulkan command pool");
+      ProfEnd();
+      return;
+    }
+    
+    VkCommandBufferAllocateInfo alloc_info =
+    {
+      .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+      .commandPool = *pools[i],
+      .level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+      .commandBufferCount = 1,
+    };
+    
+    res = vkAllocateCommandBuffers(g_vulkan_state->device, &alloc_info, command_buffers[i]);
+    if (res != VK_SUCCESS)
+    {
+      log_error("failed to allocate Vulkan command buffer");
+      ProfEnd();
+      return;
+    }
   }
   
-  //- tec: command buffer
-  VkCommandBufferAllocateInfo alloc_info = 
-  {
-    .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
-    .commandPool = g_vulkan_state->command_pool,
-    .level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
-    .commandBufferCount = 1,
-  };
+  VkFenceCreateInfo fence_info = { .sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO };
+  vkCreateFence(g_vulkan_state->device, &fence_info, 0, &g_vulkan_state->fence);
   
-  res = vkAllocateCommandBuffers(g_vulkan_state->device, &alloc_info, &g_vulkan_state->command_buffer);
-  if (res != VK_SUCCESS) 
+  //- tec: descriptor pool, every cached kernel keeps one set
+  VkDescriptorPoolSize pool_sizes[] =
   {
-    log_error("failed to allocate Vulkan command buffer");
-    return;
-  }
-  
-  // tec: descriptor pool
-  VkDescriptorPoolSize pool_sizes[] = 
-  {
-    { VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 32 },
+    { VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, GPU_VULKAN_DESCRIPTOR_SET_COUNT * 16 },
   };
   
-  VkDescriptorPoolCreateInfo desc_pool_info = 
+  VkDescriptorPoolCreateInfo desc_pool_info =
   {
     .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
+    .flags = VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT,
     .poolSizeCount = 1,
     .pPoolSizes = pool_sizes,
-    .maxSets = 32,
+    .maxSets = GPU_VULKAN_DESCRIPTOR_SET_COUNT,
   };
   
   res = vkCreateDescriptorPool(g_vulkan_state->device, &desc_pool_info, 0, &g_vulkan_state->descriptor_pool);
-  if (res != VK_SUCCESS) 
+  if (res != VK_SUCCESS)
   {
     log_error("failed to create Vulkan descriptor pool");
+    ProfEnd();
     return;
   }
   
+  //- tec: timestamp queries, only when the compute queue writes them
+  U32 queue_count = 0;
+  vkGetPhysicalDeviceQueueFamilyProperties(selected, &queue_count, 0);
+  VkQueueFamilyProperties *queue_props = push_array(arena, VkQueueFamilyProperties, queue_count);
+  vkGetPhysicalDeviceQueueFamilyProperties(selected, &queue_count, queue_props);
+  g_vulkan_state->timestamps_supported = (queue_props[compute_queue_family_index].timestampValidBits > 0 &&
+                                          device_props.limits.timestampComputeAndGraphics);
+  if (g_vulkan_state->timestamps_supported)
+  {
+    VkQueryPoolCreateInfo query_info =
+    {
+      .sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO,
+      .queryType = VK_QUERY_TYPE_TIMESTAMP,
+      .queryCount = 2,
+    };
+    vkCreateQueryPool(g_vulkan_state->device, &query_info, 0, &g_vulkan_state->query_pool);
+  }
+  
+  //- tec: staging for device local buffers
+  g_vulkan_state->staging = gpu_vulkan_buffer_create(GPU_VULKAN_STAGING_SIZE, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+  if (!g_vulkan_state->staging)
+  {
+    log_error("failed to create Vulkan staging buffer");
+  }
+  
   ProfEnd();
 }
 
-internal void 
+internal void
 gpu_release(void)
 {
+  VkDevice device = g_vulkan_state->device;
+  vkDeviceWaitIdle(device);
+  
+  for (U64 bucket = 0; bucket < GPU_KERNEL_CACHE_BUCKET_COUNT; bucket++)
+  {
+    for (GPU_Kernel* kernel = g_vulkan_state->kernel_cache[bucket]; kernel != NULL; kernel = kernel->hash_next)
+    {
+      vkDestroyPipeline(device, kernel->pipeline, 0);
+      vkDestroyPipelineLayout(device, kernel->pipeline_layout, 0);
+      vkDestroyDescriptorSetLayout(device, kernel->descriptor_set_layout, 0);
+      vkDestroyShaderModule(device, kernel->shader, 0);
+    }
+    g_vulkan_state->kernel_cache[bucket] = 0;
+  }
+  log_info("kernel cache: %llu hits, %llu misses", g_vulkan_state->kernel_cache_hits, g_vulkan_state->kernel_cache_misses);
+  
+  if (g_vulkan_state->staging)
+  {
+    gpu_buffer_release(g_vulkan_state->staging);
+  }
+  while (g_vulkan_state->free_staging)
+  {
+    GPU_Buffer* staging = g_vulkan_state->free_staging;
+    SLLStackPop(g_vulkan_state->free_staging);
+    gpu_buffer_release(staging);
+  }
+  g_vulkan_state->free_staging_size = 0;
+  if (g_vulkan_state->query_pool)
+  {
+    vkDestroyQueryPool(device, g_vulkan_state->query_pool, 0);
+  }
+  vkDestroyDescriptorPool(device, g_vulkan_state->descriptor_pool, 0);
+  vkDestroyFence(device, g_vulkan_state->fence, 0);
+  vkDestroyCommandPool(device, g_vulkan_state->transfer_command_pool, 0);
+  vkDestroyCommandPool(device, g_vulkan_state->command_pool, 0);
+  vkDestroyDevice(device, 0);
+  vkDestroyInstance(g_vulkan_state->instance, 0);
+  
+  os_mutex_release(g_vulkan_state->mutex);
   arena_release(g_vulkan_state->arena);
 }
 
-internal U64 gpu_device_total_memory(void)
+internal void
+gpu_wait(void)
 {
-  return 0;
+  ProfBeginFunction();
+  
+  // tec: submissions already wait on their fence, this only covers work queued elsewhere
+  OS_MutexScope(g_vulkan_state->mutex)
+  {
+    vkQueueWaitIdle(g_vulkan_state->compute_queue);
+  }
+  
+  ProfEnd();
 }
-internal U64 gpu_device_free_memory(void)
+
+internal U64
+gpu_device_total_memory(void)
+{
+  VkPhysicalDeviceMemoryProperties mem_props;
+  vkGetPhysicalDeviceMemoryProperties(g_vulkan_state->physical_device, &mem_props);
+  
+  U64 total = 0;
+  for (U32 i = 0; i < mem_props.memoryHeapCount; i++)
+  {
+    if (mem_props.memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT)
+    {
+      total += mem_props.memoryHeaps[i].size;
+    }
+  }
+  return total;
+}
+
+internal U64
+gpu_device_free_memory(void)
 {
   return 0;
 }
 
-internal U64 gpu_hash_from_string(String8 str)
+//~ tec: devices
+// tec: the vulkan backend drives a single physical device
+internal U32 gpu_device_count(void)
+{
+  return 1;
+}
+
+internal String8 gpu_device_name(U32 device_index)
+{
+  return g_vulkan_state->device_name;
+}
+
+internal F64 gpu_device_throughput(U32 device_index)
 {
   return 0;
 }
-internal String8 gpu_get_device_id_string(Arena* arena)
+
+internal void gpu_device_record_throughput(U32 device_index, U64 rows, U64 time_us)
 {
-  
 }
-internal String8 gpu_get_kernel_cache_path(Arena* arena, String8 source, String8 kernel_name)
+
+//~ tec: kernel caching
+internal U64
+gpu_hash_from_string(String8 str)
+{
+  U64 hash = 14695981039346656037ULL;
+  for (U64 i = 0; i < str.size; i++)
+  {
+    hash ^= str.str[i];
+    hash *= 1099511628211ULL;
+  }
+  return hash;
+}
+
+internal String8
+gpu_get_device_id_string(Arena* arena)
 {
+  VkPhysicalDeviceProperties props;
+  vkGetPhysicalDeviceProperties(g_vulkan_state->physical_device, &props);
+  return push_str8f(arena, "%x_%s_%u", props.vendorID, props.deviceName, props.driverVersion);
+}
+
+internal String8
+gpu_get_kernel_cache_path(Arena* arena, String8 source, String8 kernel_name)
+{
+  String8 device_id = gpu_get_device_id_string(arena);
+  U64 source_hash = gpu_hash_from_string(source);
+  U64 kernel_hash = gpu_hash_from_string(kernel_name);
+  U64 device_hash = gpu_hash_from_string(device_id);
   
+  return push_str8f(arena, "kernel_cache/%016llx_%016llx_%016llx.spv", device_hash, source_hash, kernel_hash);
 }
 
+//~ tec: buffer
 internal GPU_Buffer*
-gpu_buffer_alloc(U64 size, GPU_BufferFlags flags, void* data)
+gpu_vulkan_buffer_create(U64 size, VkMemoryPropertyFlags props)
 {
-  GPU_Buffer* result = push_array(g_vulkan_state->arena, GPU_Buffer, 1);
-  result->size = size;
-  result->mapped_ptr = 0;
-  
-  VkBufferUsageFlags usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
+  VkDevice device = g_vulkan_state->device;
   
-  VkBufferCreateInfo buf_info = 
+  // tec: buffers are shared by the compute and transfer queues without ownership transfers
+  U32 families[2] = { g_vulkan_state->compute_queue_family_index, g_vulkan_state->transfer_queue_family_index };
+  B32 concurrent = (families[0] != families[1]);
+  VkBufferCreateInfo buf_info =
   {
     .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
-    .size = size,
-    .usage = usage,
-    .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+    .size = Max(size, 1),
+    .usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+    .sharingMode = concurrent ? VK_SHARING_MODE_CONCURRENT : VK_SHARING_MODE_EXCLUSIVE,
+    .queueFamilyIndexCount = concurrent ? 2 : 0,
+    .pQueueFamilyIndices = concurrent ? families : 0,
   };
   
-  VkResult res = vkCreateBuffer(g_vulkan_state->device, &buf_info, 0, &result->buffer);
-  if (res != VK_SUCCESS)
+  VkBuffer vk_buffer = 0;
+  if (vkCreateBuffer(device, &buf_info, 0, &vk_buffer) != VK_SUCCESS)
   {
-    log_error("failed to create Vulkan buffer");
     return 0;
   }
   
   VkMemoryRequirements mem_req;
-  vkGetBufferMemoryRequirements(g_vulkan_state->device, result->buffer, &mem_req);
-  
-  VkMemoryPropertyFlags mem_props = 0;
-  B32 host_visible = (flags & GPU_BufferFlag_HostVisible) != 0;
-  B32 device_local = (flags & GPU_BufferFlag_DeviceLocal) != 0;
-  
-  if (host_visible)
+  vkGetBufferMemoryRequirements(device, vk_buffer, &mem_req);
+  U32 mem_type = gpu_vulkan_find_memory_type(mem_req.memoryTypeBits, props);
+  if (mem_type == max_U32)
   {
-    mem_props |= VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
-  }
-  
-  if (device_local)
-  {
-    mem_props |= VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
-  }
-  
-  U32 mem_type = gpu_vulkan_find_memory_type(mem_req.memoryTypeBits, mem_props);
-  if (mem_type == UINT32_MAX)
-  {
-    log_error("No matching memory type for Vulkan buffer.");
+    vkDestroyBuffer(device, vk_buffer, 0);
     return 0;
   }
   
-  VkMemoryAllocateInfo alloc_info = 
+  VkMemoryAllocateInfo alloc_info =
   {
     .sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
     .allocationSize = mem_req.size,
     .memoryTypeIndex = mem_type,
   };
   
-  res = vkAllocateMemory(g_vulkan_state->device, &alloc_info, 0, &result->memory);
-  if (res != VK_SUCCESS)
+  VkDeviceMemory memory = 0;
+  if (vkAllocateMemory(device, &alloc_info, 0, &memory) != VK_SUCCESS)
   {
-    log_error("Failed to allocate Vulkan buffer memory.");
+    vkDestroyBuffer(device, vk_buffer, 0);
     return 0;
   }
+  vkBindBufferMemory(device, vk_buffer, memory, 0);
   
-  vkBindBufferMemory(g_vulkan_state->device, result->buffer, result->memory, 0);
-  
-  if (host_visible)
+  GPU_Buffer* result = 0;
+  OS_MutexScope(g_vulkan_state->mutex)
   {
-    vkMapMemory(g_vulkan_state->device, result->memory, 0, size, 0, &result->mapped_ptr);
-    if (data) 
+    result = g_vulkan_state->free_buffers;
+    if (result)
     {
-      MemoryCopy(result->mapped_ptr, data, size);
+      SLLStackPop(g_vulkan_state->free_buffers);
+    }
+    else
+    {
+      result = push_array_no_zero(g_vulkan_state->arena, GPU_Buffer, 1);
     }
   }
-  else if (data)
+  MemoryZeroStruct(result);
+  result->buffer = vk_buffer;
+  result->memory = memory;
+  result->size = size;
+  
+  if (props & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT)
   {
-    log_error("Can't upload data to non-host-visible Vulkan buffer yet.");
+    vkMapMemory(device, memory, 0, VK_WHOLE_SIZE, 0, &result->mapped_ptr);
   }
   
   return result;
 }
 
+internal GPU_Buffer*
+gpu_buffer_alloc(U64 size, GPU_BufferFlags flags, void* data)
+{
+  ProfBeginFunction();
+  
+  //- tec: device local memory the host can map needs no staging (integrated gpus, resizable bar,
+  // software devices), otherwise device local and staged, otherwise whatever the host can see
+  VkMemoryPropertyFlags host_props = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+  VkMemoryPropertyFlags candidates[3] = { 0 };
+  U32 candidate_count = 0;
+  if (flags & GPU_BufferFlag_HostVisible)
+  {
+    candidates[candidate_count++] = host_props;
+  }
+  else
+  {
+    candidates[candidate_count++] = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | host_props;
+    candidates[candidate_count++] = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+    candidates[candidate_count++] = host_props;
+  }
+  
+  GPU_Buffer* buffer = 0;
+  for (U32 i = 0; i < candidate_count && buffer == 0; i++)
+  {
+    buffer = gpu_vulkan_buffer_create(size, candidates[i]);
+  }
+  
+  if (buffer == 0)
+  {
+    log_error("failed to create Vulkan buffer of %llu bytes", size);
+    ProfEnd();
+    return 0;
+  }
+  
+  if (data && size)
+  {
+    gpu_buffer_write(buffer, data, size);
+  }
+  
+  ProfEnd();
+  return buffer;
+}
+
 internal void
 gpu_buffer_release(GPU_Buffer* buffer)
 {
@@ -286,49 +547,264 @@ gpu_buffer_release(GPU_Buffer* buffer)
   
   vkDestroyBuffer(g_vulkan_state->device, buffer->buffer, 0);
   vkFreeMemory(g_vulkan_state->device, buffer->memory, 0);
+  OS_MutexScope(g_vulkan_state->mutex)
+  {
+    SLLStackPush(g_vulkan_state->free_buffers, buffer);
+  }
 }
 
+// tec: the caller holds the state mutex, the queue and the fence are shared
 internal void
-gpu_buffer_write(GPU_Buffer* buffer, void* data, U64 size)
+gpu_vulkan_submit_and_wait(VkQueue queue, VkCommandBuffer command_buffer)
 {
-  if (!buffer->mapped_ptr)
+  VkSubmitInfo submit_info =
   {
-    log_error("gpu_buffer_write: buffer is not host-visible.");
+    .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+    .commandBufferCount = 1,
+    .pCommandBuffers = &command_buffer,
+  };
+  
+  if (vkQueueSubmit(queue, 1, &submit_info, g_vulkan_state->fence) != VK_SUCCESS)
+  {
+    log_error("failed to submit Vulkan command buffer");
     return;
   }
+  vkWaitForFences(g_vulkan_state->device, 1, &g_vulkan_state->fence, VK_TRUE, max_U64);
+  vkResetFences(g_vulkan_state->device, 1, &g_vulkan_state->fence);
+}
+
+// tec: one copy on the transfer queue, the caller holds the state mutex
+internal void
+gpu_vulkan_copy(VkBuffer src, U64 src_offset, VkBuffer dst, U64 dst_offset, U64 size)
+{
+  VkCommandBuffer cmd = g_vulkan_state->transfer_command_buffer;
+  vkResetCommandBuffer(cmd, 0);
+  
+  VkCommandBufferBeginInfo begin_info =
+  {
+    .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+    .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
+  };
+  vkBeginCommandBuffer(cmd, &begin_info);
+  
+  VkBufferCopy region = { .srcOffset = src_offset, .dstOffset = dst_offset, .size = size };
+  vkCmdCopyBuffer(cmd, src, dst, 1, &region);
+  
+  // tec: the copy is visible to the host and to the next dispatch once the fence signals
+  VkMemoryBarrier barrier =
+  {
+    .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+    .srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+    .dstAccessMask = VK_ACCESS_HOST_READ_BIT | VK_ACCESS_SHADER_READ_BIT,
+  };
+  vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT | VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+                       0, 1, &barrier, 0, 0, 0, 0);
+  
+  vkEndCommandBuffer(cmd);
+  gpu_vulkan_submit_and_wait(g_vulkan_state->transfer_queue, cmd);
+}
+
+internal void
+gpu_buffer_write(GPU_Buffer* buffer, void* data, U64 size)
+{
+  ProfBeginFunction();
   
   if (size > buffer->size)
   {
     log_error("gpu_buffer_write: write size exceeds buffer size.");
+    ProfEnd();
     return;
   }
   
-  MemoryCopy(buffer->mapped_ptr, data, size);
+  U64 start_time = os_now_microseconds();
+  if (buffer->mapped_ptr)
+  {
+    MemoryCopy(buffer->mapped_ptr, data, size);
+  }
+  else
+  {
+    //- tec: device local, through the staging buffer one piece at a time
+    OS_MutexScope(g_vulkan_state->mutex)
+    {
+      GPU_Buffer* staging = g_vulkan_state->staging;
+      for (U64 offset = 0; offset < size; offset += staging->size)
+      {
+        U64 piece = Min(staging->size, size - offset);
+        MemoryCopy(staging->mapped_ptr, (U8*)data + offset, piece);
+        gpu_vulkan_copy(staging->buffer, 0, buffer->buffer, offset, piece);
+      }
+    }
+  }
+  g_gpu_stats.bytes_uploaded += size;
+  g_gpu_stats.upload_time_us += os_now_microseconds() - start_time;
+  
+  ProfEnd();
 }
 
 internal void
 gpu_buffer_read(GPU_Buffer* buffer, void* data, U64 size)
 {
-  f (!buffer->mapped_ptr)
+  gpu_buffer_read_range(buffer, 0, data, size);
+}
+
+internal void
+gpu_buffer_read_range(GPU_Buffer* buffer, U64 offset, void* data, U64 size)
+{
+  ProfBeginFunction();
+  
+  if (size == 0)
   {
-    log_error("gpu_buffer_read: buffer is not host-visible.");
+    log_info("can not request read gpu buffer with size 0");
+    ProfEnd();
     return;
   }
   
-  if (size > buffer->size)
+  if (offset + size > buffer->size)
+  {
+    log_error("gpu_buffer_read_range: read range exceeds buffer size.");
+    ProfEnd();
+    return;
+  }
+  
+  U64 start_time = os_now_microseconds();
+  if (buffer->mapped_ptr)
+  {
+    MemoryCopy(data, (U8*)buffer->mapped_ptr + offset, size);
+  }
+  else
+  {
+    OS_MutexScope(g_vulkan_state->mutex)
+    {
+      GPU_Buffer* staging = g_vulkan_state->staging;
+      for (U64 done = 0; done < size; done += staging->size)
+      {
+        U64 piece = Min(staging->size, size - done);
+        gpu_vulkan_copy(buffer->buffer, offset + done, staging->buffer, 0, piece);
+        MemoryCopy((U8*)data + done, staging->mapped_ptr, piece);
+      }
+    }
+  }
+  g_gpu_stats.bytes_downloaded += size;
+  g_gpu_stats.download_time_us += os_now_microseconds() - start_time;
+  
+  ProfEnd();
+}
+
+//~ tec: staging buffers
+// tec: host visible and coherent memory stays mapped for the buffer's lifetime, uploads from it are a
+// single copy on the transfer queue instead of going through the shared staging buffer piece by piece
+internal GPU_Buffer*
+gpu_staging_alloc(U64 size)
+{
+  ProfBeginFunction();
+  
+  U64 staging_size = AlignPow2(Max(size, 1), GPU_STAGING_GRANULARITY);
+  GPU_Buffer* staging = 0;
+  OS_MutexScope(g_vulkan_state->mutex)
+  {
+    // tec: the smallest idle buffer that fits, so a small chunk does not take the buffer a big one needs
+    GPU_Buffer* best_prev = 0;
+    GPU_Buffer* prev = 0;
+    for (GPU_Buffer* it = g_vulkan_state->free_staging; it != NULL; prev = it, it = it->next)
+    {
+      if (it->size >= staging_size && (staging == 0 || it->size < staging->size))
+      {
+        staging = it;
+        best_prev = prev;
+      }
+    }
+    if (staging)
+    {
+      if (best_prev) best_prev->next = staging->next;
+      else g_vulkan_state->free_staging = staging->next;
+      g_vulkan_state->free_staging_size -= staging->size;
+    }
+  }
+  
+  if (staging == 0)
+  {
+    VkMemoryPropertyFlags host_props = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+    staging = gpu_vulkan_buffer_create(staging_size, host_props);
+    if (staging == 0 || staging->mapped_ptr == 0)
+    {
+      log_error("failed to create Vulkan staging buffer of %llu bytes", size);
+      if (staging) gpu_buffer_release(staging);
+      staging = 0;
+    }
+  }
+  
+  if (staging)
+  {
+    staging->next = 0;
+  }
+  
+  ProfEnd();
+  return staging;
+}
+
+// tec: a buffer that would take the idle pool past GPU_STAGING_POOL_MAX_SIZE is freed instead
+internal void
+gpu_staging_release(GPU_Buffer* staging)
+{
+  B32 pooled = 0;
+  OS_MutexScope(g_vulkan_state->mutex)
+  {
+    if (g_vulkan_state->free_staging_size + staging->size <= GPU_STAGING_POOL_MAX_SIZE)
+    {
+      SLLStackPush(g_vulkan_state->free_staging, staging);
+      g_vulkan_state->free_staging_size += staging->size;
+      pooled = 1;
+    }
+  }
+  
+  if (!pooled)
+  {
+    gpu_buffer_release(staging);
+  }
+}
+
+internal void*
+gpu_staging_ptr(GPU_Buffer* staging)
+{
+  return staging->mapped_ptr;
+}
+
+internal void
+gpu_buffer_write_from_staging(GPU_Buffer* buffer, GPU_Buffer* staging, U64 staging_offset, U64 size)
+{
+  ProfBeginFunction();
+  
+  if (size > buffer->size || staging_offset + size > staging->size)
   {
-    log_error("gpu_buffer_read: read size exceeds buffer size.");
+    log_error("gpu_buffer_write_from_staging: write size exceeds buffer size.");
+    ProfEnd();
     return;
   }
   
-  MemoryCopy(data, buffer->mapped_ptr, size);
+  U64 start_time = os_now_microseconds();
+  if (buffer->mapped_ptr)
+  {
+    MemoryCopy(buffer->mapped_ptr, (U8*)staging->mapped_ptr + staging_offset, size);
+  }
+  else if (size > 0)
+  {
+    OS_MutexScope(g_vulkan_state->mutex)
+    {
+      gpu_vulkan_copy(staging->buffer, staging_offset, buffer->buffer, 0, size);
+    }
+  }
+  g_gpu_stats.bytes_uploaded += size;
+  g_gpu_stats.upload_time_us += os_now_microseconds() - start_time;
+  
+  ProfEnd();
 }
 
+//~ tec: kernel
 internal String8
-gpu_vulkan_load_or_build_spirv(String8 source_glsl, String8 kernel_name)
+gpu_vulkan_load_or_build_spirv(Arena* arena, String8 source_glsl, String8 kernel_name)
 {
   ProfBeginFunction();
-  Temp scratch = scratch_begin(0, 0);
+  Temp scratch = scratch_begin(&arena, 1);
   
   String8 cache_path = gpu_get_kernel_cache_path(scratch.arena, source_glsl, kernel_name);
   String8 result = {0};
@@ -336,14 +812,7 @@ gpu_vulkan_load_or_build_spirv(String8 source_glsl, String8 kernel_name)
 #if !FORCE_KERNEL_COMPILATION
   if (os_file_path_exists(cache_path))
   {
-    OS_Handle file = os_file_open(OS_AccessFlag_Read, cache_path);
-    U64 file_size = os_properties_from_file(file).size;
-    if (file_size > 0)
-    {
-      result = os_string_from_file_range(g_vulkan_state->arena, file, r1u64(0, file_size));
-    }
-    os_file_close(file);
-    
+    result = os_data_from_file_path(arena, cache_path);
     if (result.size > 0)
     {
       log_info("loaded cached SPIR-V binary for kernel '%.*s'", str8_varg(kernel_name));
@@ -354,32 +823,228 @@ gpu_vulkan_load_or_build_spirv(String8 source_glsl, String8 kernel_name)
   }
 #endif
   
-  // tec: TODO compile GLSL to SPIR-V
-  String8 spirv_bin = {0};
+  //- tec: compile next to the cache entry, the source is kept when the compiler rejects it
+  String8 glsl_path = push_str8f(scratch.arena, "%.*s.comp", str8_varg(str8_chop_last_dot(cache_path)));
+  os_write_data_to_file_path(glsl_path, source_glsl);
+  
+  OS_ProcessLaunchParams params = { 0 };
+  params.path = os_get_current_path(scratch.arena);
+  params.inherit_env = 1;
+  params.consoleless = 1;
+  str8_list_push(scratch.arena, &params.cmd_line, str8_lit(GPU_VULKAN_GLSL_COMPILER));
+  str8_list_push(scratch.arena, &params.cmd_line, str8_lit("-V"));
+  str8_list_push(scratch.arena, &params.cmd_line, str8_lit("--target-env"));
+  str8_list_push(scratch.arena, &params.cmd_line, str8_lit("vulkan1.2"));
+  str8_list_push(scratch.arena, &params.cmd_line, str8_lit("-S"));
+  str8_list_push(scratch.arena, &params.cmd_line, str8_lit("comp"));
+  str8_list_push(scratch.arena, &params.cmd_line, str8_lit("-o"));
+  str8_list_push(scratch.arena, &params.cmd_line, cache_path);
+  str8_list_push(scratch.arena, &params.cmd_line, glsl_path);
   
-  if (spirv_bin.size > 0)
+  os_delete_file_at_path(cache_path);
+  OS_Handle process = os_process_launch(&params);
+  if (os_handle_match(process, os_handle_zero()))
   {
-    OS_Handle out_file = os_file_open(OS_AccessFlag_Write, cache_path);
-    if (!os_handle_match(os_handle_zero(), out_file))
-    {
-      os_file_write(out_file, r1u64(0, spirv_bin.size), spirv_bin.str);
-      os_file_close(out_file);
-    }
+    log_error("failed to launch %s, is the Vulkan SDK on the path?", GPU_VULKAN_GLSL_COMPILER);
+    scratch_end(scratch);
+    ProfEnd();
+    return result;
+  }
+  os_process_join(process, max_U64);
+  os_process_detach(process);
+  
+  result = os_data_from_file_path(arena, cache_path);
+  if (result.size == 0)
+  {
+    log_error("failed to compile kernel '%.*s', run %s on %.*s for the errors",
+              str8_varg(kernel_name), GPU_VULKAN_GLSL_COMPILER, str8_varg(glsl_path));
+  }
+  else
+  {
+    os_delete_file_at_path(glsl_path);
   }
   
   scratch_end(scratch);
   ProfEnd();
-  return spirv_bin;
+  return result;
 }
 
-internal GPU_Kernel* 
+internal GPU_Kernel*
+gpu_vulkan_kernel_create(String8 name, String8 src, String8 spirv)
+{
+  VkDevice device = g_vulkan_state->device;
+  GPU_Kernel kernel = { 0 };
+  
+  //- tec: argument layout, from the first line of the generated source
+  String8 layout_prefix = str8_lit(GPU_VULKAN_ARG_LAYOUT_PREFIX);
+  if (!str8_match(str8_prefix(src, layout_prefix.size), layout_prefix, 0))
+  {
+    log_error("kernel '%.*s' has no argument layout", str8_varg(name));
+    return 0;
+  }
+  U32 scalar_count = 0;
+  for (U64 i = layout_prefix.size; i < src.size && src.str[i] != '\n' && kernel.arg_count < GPU_VULKAN_MAX_ARGS; i++)
+  {
+    U32 arg = kernel.arg_count++;
+    kernel.arg_is_buffer[arg] = (src.str[i] == 'b');
+    if (!kernel.arg_is_buffer[arg])
+    {
+      kernel.push_offsets[arg] = scalar_count++ * sizeof(U64);
+    }
+  }
+  kernel.push_constant_size = scalar_count * sizeof(U64);
+  if (kernel.push_constant_size > Min(g_vulkan_state->max_push_constant_size, GPU_VULKAN_MAX_PUSH_CONSTANT_SIZE))
+  {
+    log_error("kernel '%.*s' needs %u bytes of push constants, the device has %u",
+              str8_varg(name), kernel.push_constant_size, g_vulkan_state->max_push_constant_size);
+    return 0;
+  }
+  
+  //- tec: shader module and descriptor layout, one storage buffer binding per buffer argument
+  VkShaderModuleCreateInfo module_info =
+  {
+    .sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO,
+    .codeSize = spirv.size,
+    .pCode = (U32*)spirv.str,
+  };
+  if (vkCreateShaderModule(device, &module_info, 0, &kernel.shader) != VK_SUCCESS)
+  {
+    log_error("failed to create shader module for kernel '%.*s'", str8_varg(name));
+    return 0;
+  }
+  
+  VkDescriptorSetLayoutBinding bindings[GPU_VULKAN_MAX_ARGS] = { 0 };
+  U32 binding_count = 0;
+  for (U32 i = 0; i < kernel.arg_count; i++)
+  {
+    if (kernel.arg_is_buffer[i])
+    {
+      VkDescriptorSetLayoutBinding* binding = &bindings[binding_count++];
+      binding->binding = i;
+      binding->descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+      binding->descriptorCount = 1;
+      binding->stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    }
+  }
+  
+  VkDescriptorSetLayoutCreateInfo set_layout_info =
+  {
+    .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
+    .bindingCount = binding_count,
+    .pBindings = bindings,
+  };
+  vkCreateDescriptorSetLayout(device, &set_layout_info, 0, &kernel.descriptor_set_layout);
+  
+  VkPushConstantRange push_range =
+  {
+    .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+    .offset = 0,
+    .size = kernel.push_constant_size,
+  };
+  VkPipelineLayoutCreateInfo pipeline_layout_info =
+  {
+    .sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
+    .setLayoutCount = 1,
+    .pSetLayouts = &kernel.descriptor_set_layout,
+    .pushConstantRangeCount = kernel.push_constant_size ? 1 : 0,
+    .pPushConstantRanges = &push_range,
+  };
+  vkCreatePipelineLayout(device, &pipeline_layout_info, 0, &kernel.pipeline_layout);
+  
+  //- tec: glsl entry points are always main
+  VkComputePipelineCreateInfo pipeline_info =
+  {
+    .sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO,
+    .stage =
+    {
+      .sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+      .stage = VK_SHADER_STAGE_COMPUTE_BIT,
+      .module = kernel.shader,
+      .pName = "main",
+    },
+    .layout = kernel.pipeline_layout,
+  };
+  if (vkCreateComputePipelines(device, VK_NULL_HANDLE, 1, &pipeline_info, 0, &kernel.pipeline) != VK_SUCCESS)
+  {
+    log_error("failed to create compute pipeline for kernel '%.*s'", str8_varg(name));
+    vkDestroyPipelineLayout(device, kernel.pipeline_layout, 0);
+    vkDestroyDescriptorSetLayout(device, kernel.descriptor_set_layout, 0);
+    vkDestroyShaderModule(device, kernel.shader, 0);
+    return 0;
+  }
+  
+  GPU_Kernel* result = 0;
+  OS_MutexScope(g_vulkan_state->mutex)
+  {
+    VkDescriptorSetAllocateInfo set_info =
+    {
+      .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+      .descriptorPool = g_vulkan_state->descriptor_pool,
+      .descriptorSetCount = 1,
+      .pSetLayouts = &kernel.descriptor_set_layout,
+    };
+    if (vkAllocateDescriptorSets(device, &set_info, &kernel.descriptor_set) == VK_SUCCESS)
+    {
+      result = push_array(g_vulkan_state->arena, GPU_Kernel, 1);
+      *result = kernel;
+      result->name = push_str8_copy(g_vulkan_state->arena, name);
+      result->source = push_str8_copy(g_vulkan_state->arena, src);
+    }
+  }
+  
+  if (!result)
+  {
+    log_error("out of Vulkan descriptor sets for kernel '%.*s'", str8_varg(name));
+    vkDestroyPipeline(device, kernel.pipeline, 0);
+    vkDestroyPipelineLayout(device, kernel.pipeline_layout, 0);
+    vkDestroyDescriptorSetLayout(device, kernel.descriptor_set_layout, 0);
+    vkDestroyShaderModule(device, kernel.shader, 0);
+  }
+  return result;
+}
+
+internal GPU_Kernel*
 gpu_kernel_alloc(String8 name, String8 src)
 {
   ProfBeginFunction();
-  Temp scratch = scratch_begin(0, 0);
   
-  String8 spirv_bin = gpu_vulkan_load_or_build_spirv(glsl_src, name);
-  if (spirv_bin.size == 0)
+  //- tec: queries of the same shape generate the same source, reuse the pipeline
+  U64 hash = gpu_hash_from_string(src) ^ (gpu_hash_from_string(name) * 1099511628211ULL);
+  U64 bucket = hash % GPU_KERNEL_CACHE_BUCKET_COUNT;
+  GPU_Kernel* result = 0;
+  B32 busy_match = 0;
+  OS_MutexScope(g_vulkan_state->mutex)
+  {
+    for (GPU_Kernel* cached = g_vulkan_state->kernel_cache[bucket]; cached != NULL; cached = cached->hash_next)
+    {
+      if (cached->hash == hash && str8_match(cached->name, name, 0) && str8_match(cached->source, src, 0))
+      {
+        if (!cached->in_use)
+        {
+          cached->in_use = 1;
+          result = cached;
+          break;
+        }
+        busy_match = 1;
+      }
+    }
+    if (result || busy_match) g_vulkan_state->kernel_cache_hits++;
+    else                      g_vulkan_state->kernel_cache_misses++;
+  }
+  if (result || busy_match) g_gpu_stats.kernel_cache_hits++;
+  else                      g_gpu_stats.kernel_cache_misses++;
+  if (result)
+  {
+    log_debug("reusing cached kernel '%.*s' (%016llx)", str8_varg(name), hash);
+    ProfEnd();
+    return result;
+  }
+  
+  //- tec: another query holds the cached kernel, a second pipeline comes from the spir-v on disk
+  U64 compile_start_time = os_now_microseconds();
+  Temp scratch = scratch_begin(0, 0);
+  String8 spirv = gpu_vulkan_load_or_build_spirv(scratch.arena, src, name);
+  if (spirv.size == 0)
   {
     log_error("failed to load or build SPIR-V for kernel '%.*s'", str8_varg(name));
     scratch_end(scratch);
@@ -387,37 +1052,496 @@ gpu_kernel_alloc(String8 name, String8 src)
     return 0;
   }
   
-  //GPU_Kernel* kernel = gpu_kernel_create(name, spirv_bin);
+  result = gpu_vulkan_kernel_create(name, src, spirv);
   scratch_end(scratch);
+  if (result)
+  {
+    OS_MutexScope(g_vulkan_state->mutex)
+    {
+      result->hash = hash;
+      result->in_use = 1;
+      result->hash_next = g_vulkan_state->kernel_cache[bucket];
+      g_vulkan_state->kernel_cache[bucket] = result;
+    }
+  }
+  g_gpu_stats.kernel_compile_time_us += os_now_microseconds() - compile_start_time;
+  
   ProfEnd();
-  return kernel;
+  return result;
 }
 
 internal void
 gpu_kernel_release(GPU_Kernel *kernel)
 {
-  
+  // tec: back to the cache for the next query of the same shape, gpu_release frees it
+  OS_MutexScope(g_vulkan_state->mutex)
+  {
+    kernel->in_use = 0;
+  }
 }
 
 internal void
 gpu_kernel_set_arg_buffer(GPU_Kernel* kernel, U32 index, GPU_Buffer* buffer)
 {
+  if (index >= kernel->arg_count || !kernel->arg_is_buffer[index])
+  {
+    log_error("argument %u of kernel '%.*s' is not a buffer", index, str8_varg(kernel->name));
+    return;
+  }
+  kernel->bound_buffers[index] = buffer;
 }
 
 internal void
 gpu_kernel_set_arg_u64(GPU_Kernel* kernel, U32 index, U64 value)
 {
-  
+  gpu_kernel_set_arg_bytes(kernel, index, &value, sizeof(U64));
+}
+
+internal void
+gpu_kernel_set_arg_bytes(GPU_Kernel* kernel, U32 index, void* data, U64 size)
+{
+  if (index >= kernel->arg_count || kernel->arg_is_buffer[index] || size > sizeof(U64))
+  {
+    log_error("argument %u of kernel '%.*s' is not a scalar of %llu bytes", index, str8_varg(kernel->name), size);
+    return;
+  }
+  MemoryCopy(kernel->push_constants + kernel->push_offsets[index], data, size);
 }
 
 internal void
 gpu_kernel_execute(GPU_Kernel* kernel, U32 global_work_size, U32 local_work_size)
 {
+  ProfBeginFunction();
   
+  // tec: the shader fixes its own work group size, the dispatch wraps into y past the x limit
+  U64 group_count = (global_work_size + GPU_VULKAN_LOCAL_SIZE - 1) / GPU_VULKAN_LOCAL_SIZE;
+  if (group_count == 0)
+  {
+    ProfEnd();
+    return;
+  }
+  U32 groups_x = (U32)Min(group_count, g_vulkan_state->max_group_count_x);
+  U32 groups_y = (U32)((group_count + groups_x - 1) / groups_x);
+  
+  VkDevice device = g_vulkan_state->device;
+  U64 kernel_time_us = 0;
+  OS_MutexScope(g_vulkan_state->mutex)
+  {
+    //- tec: bind the buffers of this dispatch
+    VkDescriptorBufferInfo buffer_infos[GPU_VULKAN_MAX_ARGS];
+    VkWriteDescriptorSet writes[GPU_VULKAN_MAX_ARGS];
+    U32 write_count = 0;
+    for (U32 i = 0; i < kernel->arg_count; i++)
+    {
+      if (kernel->arg_is_buffer[i] && kernel->bound_buffers[i])
+      {
+        buffer_infos[write_count] = (VkDescriptorBufferInfo){ kernel->bound_buffers[i]->buffer, 0, VK_WHOLE_SIZE };
+        writes[write_count] = (VkWriteDescriptorSet)
+        {
+          .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+          .dstSet = kernel->descriptor_set,
+          .dstBinding = i,
+          .descriptorCount = 1,
+          .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+          .pBufferInfo = &buffer_infos[write_count],
+        };
+        write_count++;
+      }
+    }
+    vkUpdateDescriptorSets(device, write_count, writes, 0, 0);
+    
+    //- tec: record
+    VkCommandBuffer cmd = g_vulkan_state->command_buffer;
+    vkResetCommandBuffer(cmd, 0);
+    VkCommandBufferBeginInfo begin_info =
+    {
+      .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+      .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
+    };
+    vkBeginCommandBuffer(cmd, &begin_info);
+    
+    if (g_vulkan_state->timestamps_supported)
+    {
+      vkCmdResetQueryPool(cmd, g_vulkan_state->query_pool, 0, 2);
+      vkCmdWriteTimestamp(cmd, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, g_vulkan_state->query_pool, 0);
+    }
+    
+    vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, kernel->pipeline);
+    vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, kernel->pipeline_layout, 0, 1, &kernel->descriptor_set, 0, 0);
+    if (kernel->push_constant_size)
+    {
+      vkCmdPushConstants(cmd, kernel->pipeline_layout, VK_SHADER_STAGE_COMPUTE_BIT, 0, kernel->push_constant_size, kernel->push_constants);
+    }
+    vkCmdDispatch(cmd, groups_x, groups_y, 1);
+    
+    if (g_vulkan_state->timestamps_supported)
+    {
+      vkCmdWriteTimestamp(cmd, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, g_vulkan_state->query_pool, 1);
+    }
+    
+    // tec: results are read by the host or copied out on the transfer queue
+    VkMemoryBarrier barrier =
+    {
+      .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+      .srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT,
+      .dstAccessMask = VK_ACCESS_HOST_READ_BIT | VK_ACCESS_TRANSFER_READ_BIT,
+    };
+    vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_HOST_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         0, 1, &barrier, 0, 0, 0, 0);
+    vkEndCommandBuffer(cmd);
+    
+    U64 submit_time = os_now_microseconds();
+    gpu_vulkan_submit_and_wait(g_vulkan_state->compute_queue, cmd);
+    kernel_time_us = os_now_microseconds() - submit_time;
+    
+    if (g_vulkan_state->timestamps_supported)
+    {
+      U64 timestamps[2] = { 0 };
+      if (vkGetQueryPoolResults(device, g_vulkan_state->query_pool, 0, 2, sizeof(timestamps), timestamps, sizeof(U64),
+                                VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WAIT_BIT) == VK_SUCCESS)
+      {
+        kernel_time_us = (U64)((F64)(timestamps[1] - timestamps[0]) * g_vulkan_state->timestamp_period / 1000.0);
+      }
+    }
+  }
+  
+  g_gpu_stats.kernel_time_us += kernel_time_us;
+  
+  ProfEnd();
+}
+
+//~ tec: kernel generation
+internal String8
+gpu_vulkan_type_from_column_type(GDB_ColumnType type)
+{
+  switch (type)
+  {
+    case GDB_ColumnType_U32: return str8_lit("uint"); break;
+    case GDB_ColumnType_U64: return str8_lit("uint64_t"); break;
+    case GDB_ColumnType_F32: return str8_lit("float"); break;
+    case GDB_ColumnType_F64: return str8_lit("double"); break;
+    case GDB_ColumnType_String8: return str8_lit("uint8_t"); break;
+  }
+  
+  log_error("invalid GDB_ColumnType");
+  return str8_lit("invalid");
 }
 
 internal String8
-gpu_generate_kernel_from_ir(Arena* arena, String8 kernel_name, GDB_Database* database, IR_Node* ir_node, String8List* active_columns)
+gpu_vulkan_type_from_param_kind(GPU_KernelParamKind kind)
 {
+  switch (kind)
+  {
+    case GPU_KernelParamKind_U64: return str8_lit("uint64_t"); break;
+    case GPU_KernelParamKind_S64: return str8_lit("int64_t"); break;
+    case GPU_KernelParamKind_F32: return str8_lit("float"); break;
+    case GPU_KernelParamKind_F64: return str8_lit("double"); break;
+  }
   return str8_zero();
-}
\ No newline at end of file
+}
+
+// tec: sql '=' compares, in the shader it would assign
+internal String8
+gpu_vulkan_operator_from_ir(String8 op)
+{
+  if (str8_match(op, str8_lit("="), 0)) return str8_lit("==");
+  if (str8_match(op, str8_lit("<>"), 0)) return str8_lit("!=");
+  return op;
+}
+
+// tec: columns are prefixed so names that are glsl keywords still compile
+internal String8
+gpu_vulkan_generate_operand(Arena* arena, GDB_Database* database, IR_Node* root_node, GPU_KernelParamList* params, IR_Node* operand, GDB_ColumnType compared_type, String8* out_type)
+{
+  String8 result = str8_zero();
+  *out_type = str8_zero();
+  if (operand->type == IR_NodeType_Column)
+  {
+    result = push_str8f(arena, "c_%.*s[i]", str8_varg(operand->value));
+    *out_type = gpu_vulkan_type_from_column_type(ir_find_column_type(database, root_node, operand->value));
+  }
+  else if (operand->type == IR_NodeType_Numeric)
+  {
+    GPU_KernelParam* param = gpu_kernel_param_from_numeric(arena, params, operand->value);
+    if (param->kind == GPU_KernelParamKind_F64 && compared_type == GDB_ColumnType_F32)
+    {
+      param->kind = GPU_KernelParamKind_F32;
+    }
+    result = push_str8f(arena, "args.p%llu", params->count - 1);
+    *out_type = gpu_vulkan_type_from_param_kind(param->kind);
+  }
+  else
+  {
+    result = operand->value;
+  }
+  return result;
+}
+
+internal void
+gpu_vulkan_generate_where(Arena* arena, String8List* builder, String8List* helpers, GDB_Database* database, IR_Node* root_node, IR_Node* condition, String8List* nullable_columns, GPU_KernelParamList* params)
+{
+  if (!condition) return;
+  
+  if (condition->type == IR_NodeType_Operator)
+  {
+    IR_Node* left = condition->first;
+    IR_Node* right = left ? left->next : 0;
+    
+    if (str8_match(condition->value, str8_lit("and"), StringMatchFlag_CaseInsensitive) ||
+        str8_match(condition->value, str8_lit("or"), StringMatchFlag_CaseInsensitive))
+    {
+      B32 is_and = str8_match(condition->value, str8_lit("and"), StringMatchFlag_CaseInsensitive);
+      str8_list_push(arena, builder, str8_lit("("));
+      gpu_vulkan_generate_where(arena, builder, helpers, database, root_node, left, nullable_columns, params);
+      str8_list_push(arena, builder, is_and ? str8_lit(" && ") : str8_lit(" || "));
+      gpu_vulkan_generate_where(arena, builder, helpers, database, root_node, right, nullable_columns, params);
+      str8_list_push(arena, builder, str8_lit(")"));
+    }
+    else if (str8_match(condition->value, str8_lit("is null"), StringMatchFlag_CaseInsensitive) ||
+             str8_match(condition->value, str8_lit("is not null"), StringMatchFlag_CaseInsensitive))
+    {
+      B32 is_not = str8_match(condition->value, str8_lit("is not null"), StringMatchFlag_CaseInsensitive);
+      if (left->type == IR_NodeType_Column && ir_column_list_contains(nullable_columns, left->value))
+      {
+        str8_list_pushf(arena, builder, "(((c_%.*s_valid[i >> 6] >> (i & 63)) & 1ul) %s 0ul)", str8_varg(left->value), is_not ? "!=" : "==");
+      }
+      else
+      {
+        str8_list_push(arena, builder, is_not ? str8_lit("true") : str8_lit("false"));
+      }
+    }
+    else
+    {
+      // tec: a comparison against a null row is never true
+      B32 guarded = 0;
+      for (IR_Node* operand = condition->first; operand != NULL; operand = operand->next)
+      {
+        if (operand->type == IR_NodeType_Column && ir_column_list_contains(nullable_columns, operand->value))
+        {
+          if (!guarded)
+          {
+            str8_list_push(arena, builder, str8_lit("("));
+            guarded = 1;
+          }
+          str8_list_pushf(arena, builder, "((c_%.*s_valid[i >> 6] >> (i & 63)) & 1ul) != 0ul && ", str8_varg(operand->value));
+        }
+      }
+      
+      String8 op = gpu_vulkan_operator_from_ir(condition->value);
+      if (right->type == IR_NodeType_Literal)
+      {
+        // tec: glsl functions can not take buffers, each string test gets a helper bound to its column and literal
+        B32 is_match = str8_match(op, str8_lit("=="), 0) || str8_match(op, str8_lit("!="), 0);
+        B32 is_contains = str8_match(op, str8_lit("contains"), StringMatchFlag_CaseInsensitive);
+        if ((is_match || is_contains) && left->type == IR_NodeType_Column)
+        {
+          GPU_KernelParam* param = gpu_kernel_param_list_push(arena, params, GPU_KernelParamKind_String);
+          param->string = right->value;
+          U64 p = params->count - 1;
+          String8 column = left->value;
+          
+          str8_list_pushf(arena, helpers, "bool gpu_str_%s_p%llu(uint i) {\n", is_contains ? "contains" : "match", p);
+          str8_list_pushf(arena, helpers, "  uint start = uint(c_%.*s_offsets[i]);\n", str8_varg(column));
+          str8_list_pushf(arena, helpers, "  uint str_size = uint(c_%.*s_offsets[i + 1]) - start;\n", str8_varg(column));
+          str8_list_pushf(arena, helpers, "  uint compare_size = uint(args.p%llu_size);\n", p);
+          if (is_contains)
+          {
+            str8_list_push(arena, helpers, str8_lit("  if (str_size < compare_size) return false;\n"));
+            str8_list_push(arena, helpers, str8_lit("  for (uint s = 0; s <= str_size - compare_size; s++) {\n"));
+            str8_list_push(arena, helpers, str8_lit("    bool match = true;\n"));
+            str8_list_push(arena, helpers, str8_lit("    for (uint j = 0; j < compare_size; j++) {\n"));
+            str8_list_pushf(arena, helpers, "      if (c_%.*s_data[start + s + j] != p%llu[j]) { match = false; break; }\n", str8_varg(column), p);
+            str8_list_push(arena, helpers, str8_lit("    }\n"));
+            str8_list_push(arena, helpers, str8_lit("    if (match) return true;\n"));
+            str8_list_push(arena, helpers, str8_lit("  }\n"));
+            str8_list_push(arena, helpers, str8_lit("  return false;\n"));
+          }
+          else
+          {
+            str8_list_push(arena, helpers, str8_lit("  if (str_size != compare_size) return false;\n"));
+            str8_list_push(arena, helpers, str8_lit("  for (uint j = 0; j < compare_size; j++) {\n"));
+            str8_list_pushf(arena, helpers, "    if (c_%.*s_data[start + j] != p%llu[j]) return false;\n", str8_varg(column), p);
+            str8_list_push(arena, helpers, str8_lit("  }\n"));
+            str8_list_push(arena, helpers, str8_lit("  return true;\n"));
+          }
+          str8_list_push(arena, helpers, str8_lit("}\n\n"));
+          
+          str8_list_pushf(arena, builder, "%sgpu_str_%s_p%llu(i)",
+                          str8_match(op, str8_lit("!="), 0) ? "!" : "",
+                          is_contains ? "contains" : "match", p);
+        }
+        else
+        {
+          log_error("unsupported string comparison '%.*s' in vulkan kernel", str8_varg(op));
+          str8_list_push(arena, builder, str8_lit("false"));
+        }
+      }
+      else
+      {
+        // tec: glsl does not mix 64 bit integers and floats, mismatched operands compare as double
+        GDB_ColumnType left_type = (left->type == IR_NodeType_Column) ? ir_find_column_type(database, root_node, left->value) : GDB_ColumnType_Invalid;
+        GDB_ColumnType right_type = (right->type == IR_NodeType_Column) ? ir_find_column_type(database, root_node, right->value) : GDB_ColumnType_Invalid;
+        String8 left_glsl_type = { 0 };
+        String8 right_glsl_type = { 0 };
+        String8 left_expr = gpu_vulkan_generate_operand(arena, database, root_node, params, left, right_type, &left_glsl_type);
+        String8 right_expr = gpu_vulkan_generate_operand(arena, database, root_node, params, right, left_type, &right_glsl_type);
+        if (left_glsl_type.size && right_glsl_type.size && !str8_match(left_glsl_type, right_glsl_type, 0))
+        {
+          str8_list_pushf(arena, builder, "double(%.*s) %.*s double(%.*s)", str8_varg(left_expr), str8_varg(op), str8_varg(right_expr));
+        }
+        else
+        {
+          str8_list_pushf(arena, builder, "%.*s %.*s %.*s", str8_varg(left_expr), str8_varg(op), str8_varg(right_expr));
+        }
+      }
+      
+      if (guarded)
+      {
+        str8_list_push(arena, builder, str8_lit(")"));
+      }
+    }
+  }
+  else if (condition->type == IR_NodeType_Column)
+  {
+    str8_list_pushf(arena, builder, "(c_%.*s[i] != 0)", str8_varg(condition->value));
+  }
+  else if (condition->type == IR_NodeType_Literal)
+  {
+    str8_list_push(arena, builder, str8_lit("false"));
+  }
+}
+
+// tec: same arguments in the same order as the OpenCL kernel, buffers become storage buffer bindings
+// and scalars push constants. the first line records which is which, see GPU_VULKAN_ARG_LAYOUT_PREFIX
+internal String8
+gpu_generate_kernel_from_ir(Arena* arena, String8 kernel_name, GDB_Database* database, IR_Node** ir_nodes, U64 query_count, String8List* active_columns, String8List* nullable_columns, GPU_KernelParamList* out_params)
+{
+  ProfBeginFunction();
+  
+  IR_Node* ir_node = ir_nodes[0];
+  IR_Node* table_node = ir_node_find_child(ir_node, IR_NodeType_Table);
+  if (!table_node)
+  {
+    log_error("kernel is missing a table");
+    ProfEnd();
+    return str8_lit("");
+  }
+  
+  //- tec: the body is generated first, it decides which literals become params
+  String8List body = { 0 };
+  String8List helpers = { 0 };
+  str8_list_pushf(arena, &body, "  uint i = gl_GlobalInvocationID.y * (gl_NumWorkGroups.x * %u) + gl_GlobalInvocationID.x;\n", GPU_VULKAN_LOCAL_SIZE);
+  str8_list_push(arena, &body, str8_lit("  if (uint64_t(i) >= args.row_count) return;\n"));
+  
+  for (U64 query_index = 0; query_index < query_count; query_index++)
+  {
+    IR_Node* query_node = ir_nodes[query_index];
+    IR_Node* where_clause = ir_node_find_child(query_node, IR_NodeType_Where);
+    
+    if (where_clause)
+    {
+      str8_list_push(arena, &body, str8_lit("  if ("));
+      gpu_vulkan_generate_where(arena, &body, &helpers, database, query_node, where_clause->first, nullable_columns, out_params);
+      str8_list_push(arena, &body, str8_lit(") {\n"));
+      str8_list_pushf(arena, &body, "    uint64_t index = atomicAdd(output_counts[%llu], 1ul);\n", query_index);
+      str8_list_pushf(arena, &body, "    output_indices[uint(%lluul * args.output_stride + index)] = uint64_t(i);\n", query_index);
+      str8_list_push(arena, &body, str8_lit("  }\n"));
+    }
+    else
+    {
+      str8_list_pushf(arena, &body, "  output_indices[uint(%lluul * args.output_stride) + i] = uint64_t(i);\n", query_index);
+      str8_list_pushf(arena, &body, "  if (i == 0) output_counts[%llu] = args.row_count;\n", query_index);
+    }
+  }
+  str8_list_push(arena, &body, str8_lit("}\n"));
+  
+  //- tec: declarations, in argument order
+  String8List layout = { 0 };
+  String8List decls = { 0 };
+  U32 binding = 0;
+  B32 uses_bytes = 0;
+  for (String8Node* node = active_columns->first; node != NULL; node = node->next)
+  {
+    String8 str = node->string;
+    GDB_ColumnType column_type = ir_find_column_type(database, ir_node, str);
+    String8 type_string = gpu_vulkan_type_from_column_type(column_type);
+    if (column_type == GDB_ColumnType_String8)
+    {
+      uses_bytes = 1;
+      str8_list_pushf(arena, &decls, "layout(std430, binding = %u) readonly buffer A%u { uint8_t c_%.*s_data[]; };\n", binding, binding, str8_varg(str));
+      binding++;
+      str8_list_pushf(arena, &decls, "layout(std430, binding = %u) readonly buffer A%u { uint64_t c_%.*s_offsets[]; };\n", binding, binding, str8_varg(str));
+      binding++;
+      str8_list_push(arena, &layout, str8_lit("bb"));
+    }
+    else
+    {
+      str8_list_pushf(arena, &decls, "layout(std430, binding = %u) readonly buffer A%u { %.*s c_%.*s[]; };\n", binding, binding, str8_varg(type_string), str8_varg(str));
+      binding++;
+      str8_list_push(arena, &layout, str8_lit("b"));
+    }
+    
+    if (ir_column_list_contains(nullable_columns, str))
+    {
+      str8_list_pushf(arena, &decls, "layout(std430, binding = %u) readonly buffer A%u { uint64_t c_%.*s_valid[]; };\n", binding, binding, str8_varg(str));
+      binding++;
+      str8_list_push(arena, &layout, str8_lit("b"));
+    }
+  }
+  
+  str8_list_pushf(arena, &decls, "layout(std430, binding = %u) writeonly buffer A%u { uint64_t output_indices[]; };\n", binding, binding);
+  binding++;
+  str8_list_pushf(arena, &decls, "layout(std430, binding = %u) buffer A%u { uint64_t output_counts[]; };\n", binding, binding);
+  binding++;
+  str8_list_push(arena, &layout, str8_lit("bbss"));
+  
+  //- tec: hoisted literals, scalars go to push constants and string literals to a buffer plus a size
+  String8List push_constants = { 0 };
+  str8_list_push(arena, &push_constants, str8_lit("  uint64_t row_count;\n"));
+  str8_list_push(arena, &push_constants, str8_lit("  uint64_t output_stride;\n"));
+  U64 param_index = 0;
+  for (GPU_KernelParam* param = out_params->first; param != NULL; param = param->next, param_index++)
+  {
+    switch (param->kind)
+    {
+      case GPU_KernelParamKind_U64: { str8_list_pushf(arena, &push_constants, "  uint64_t p%llu;\n", param_index); str8_list_push(arena, &layout, str8_lit("s")); } break;
+      case GPU_KernelParamKind_S64: { str8_list_pushf(arena, &push_constants, "  int64_t p%llu;\n", param_index); str8_list_push(arena, &layout, str8_lit("s")); } break;
+      case GPU_KernelParamKind_F32: { str8_list_pushf(arena, &push_constants, "  float p%llu;\n  uint p%llu_pad;\n", param_index, param_index); str8_list_push(arena, &layout, str8_lit("s")); } break;
+      case GPU_KernelParamKind_F64: { str8_list_pushf(arena, &push_constants, "  double p%llu;\n", param_index); str8_list_push(arena, &layout, str8_lit("s")); } break;
+      case GPU_KernelParamKind_String:
+      {
+        uses_bytes = 1;
+        str8_list_pushf(arena, &decls, "layout(std430, binding = %u) readonly buffer A%u { uint8_t p%llu[]; };\n", binding, binding, param_index);
+        binding++;
+        str8_list_pushf(arena, &push_constants, "  uint64_t p%llu_size;\n", param_index);
+        str8_list_push(arena, &layout, str8_lit("bs"));
+      } break;
+    }
+  }
+  
+  //- tec: assemble
+  String8List builder = { 0 };
+  str8_list_push(arena, &builder, str8_lit(GPU_VULKAN_ARG_LAYOUT_PREFIX));
+  str8_list_concat_in_place(&builder, &layout);
+  str8_list_push(arena, &builder, str8_lit("\n#version 450\n"));
+  str8_list_push(arena, &builder, str8_lit("#extension GL_EXT_shader_explicit_arithmetic_types_int64 : require\n"));
+  str8_list_push(arena, &builder, str8_lit("#extension GL_EXT_shader_atomic_int64 : require\n"));
+  if (uses_bytes)
+  {
+    str8_list_push(arena, &builder, str8_lit("#extension GL_EXT_shader_explicit_arithmetic_types_int8 : require\n"));
+    str8_list_push(arena, &builder, str8_lit("#extension GL_EXT_shader_8bit_storage : require\n"));
+  }
+  str8_list_pushf(arena, &builder, "\nlayout(local_size_x = %u) in;\n\n", GPU_VULKAN_LOCAL_SIZE);
+  str8_list_concat_in_place(&builder, &decls);
+  str8_list_push(arena, &builder, str8_lit("\nlayout(push_constant) uniform Args {\n"));
+  str8_list_concat_in_place(&builder, &push_constants);
+  str8_list_push(arena, &builder, str8_lit("} args;\n\n"));
+  str8_list_concat_in_place(&builder, &helpers);
+  str8_list_push(arena, &builder, str8_lit("void main() {\n"));
+  str8_list_concat_in_place(&builder, &body);
+  
+  String8 result = str8_list_join(arena, &builder, NULL);
+  
+  ProfEnd();
+  return result;
+}
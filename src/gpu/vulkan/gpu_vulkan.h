@@ -5,11 +5,44 @@
 
 #include "third_party/vulkan/vulkan/vulkan.h"
 
+// tec: work group width the generated shaders declare, dispatches are rounded up to it
+#if !defined(GPU_VULKAN_LOCAL_SIZE)
+#define GPU_VULKAN_LOCAL_SIZE 64
+#endif
+
+// tec: kernel arguments, buffers and scalars together. scalars take 8 bytes of push constants each
+#if !defined(GPU_VULKAN_MAX_ARGS)
+#define GPU_VULKAN_MAX_ARGS 64
+#endif
+#if !defined(GPU_VULKAN_MAX_PUSH_CONSTANT_SIZE)
+#define GPU_VULKAN_MAX_PUSH_CONSTANT_SIZE 256
+#endif
+
+// tec: uploads and downloads to device local memory go through this much host visible memory at a time
+#if !defined(GPU_VULKAN_STAGING_SIZE)
+#define GPU_VULKAN_STAGING_SIZE MB(64)
+#endif
+
+#if !defined(GPU_VULKAN_DESCRIPTOR_SET_COUNT)
+#define GPU_VULKAN_DESCRIPTOR_SET_COUNT 256
+#endif
+
+// tec: GLSL is compiled to SPIR-V by the compiler that ships with the Vulkan SDK, the result is cached
+#if !defined(GPU_VULKAN_GLSL_COMPILER)
+#define GPU_VULKAN_GLSL_COMPILER "glslangValidator"
+#endif
+
+// tec: generated sources start with this line, one character per argument, 'b' a buffer and 's' a scalar
+#define GPU_VULKAN_ARG_LAYOUT_PREFIX "// gdb_args: "
+
 struct GPU_Buffer
 {
+  GPU_Buffer* next;
   VkBuffer buffer;
   VkDeviceMemory memory;
   U64 size;
+  
+  // tec: set when the memory is host visible, otherwise data moves through the staging buffer
   void* mapped_ptr;
 };
 
@@ -24,8 +57,19 @@ struct GPU_Kernel
   VkDescriptorSetLayout descriptor_set_layout;
   VkDescriptorSet descriptor_set;
   
-  GPU_Buffer* bound_buffers[16];
-  U32 bound_buffer_count;
+  // tec: argument i is descriptor binding i when it is a buffer, otherwise it lives at push_offsets[i]
+  U32 arg_count;
+  B8 arg_is_buffer[GPU_VULKAN_MAX_ARGS];
+  U32 push_offsets[GPU_VULKAN_MAX_ARGS];
+  GPU_Buffer* bound_buffers[GPU_VULKAN_MAX_ARGS];
+  U8 push_constants[GPU_VULKAN_MAX_PUSH_CONSTANT_SIZE];
+  U32 push_constant_size;
+  
+  // tec: kernel cache chain, same rules as the OpenCL backend
+  GPU_Kernel* hash_next;
+  U64 hash;
+  String8 source;
+  B32 in_use;
 };
 
 struct GPU_State
@@ -35,16 +79,53 @@ struct GPU_State
   VkInstance instance;
   VkPhysicalDevice physical_device;
   VkDevice device;
+  String8 device_name;
   
   VkQueue compute_queue;
   U32 compute_queue_family_index;
   
+  // tec: a dedicated transfer family when the device has one, else the compute queue again
+  VkQueue transfer_queue;
+  U32 transfer_queue_family_index;
+  
   VkCommandPool command_pool;
   VkCommandBuffer command_buffer;
+  VkCommandPool transfer_command_pool;
+  VkCommandBuffer transfer_command_buffer;
+  VkFence fence;
   
   VkDescriptorPool descriptor_pool;
+  
+  // tec: two timestamps around every dispatch, ticks are timestamp_period nanoseconds
+  VkQueryPool query_pool;
+  F32 timestamp_period;
+  B32 timestamps_supported;
+  
+  U32 max_push_constant_size;
+  U32 max_group_count_x;
+  
+  GPU_Buffer* staging;
+  
+  // tec: staging buffers handed out by gpu_staging_alloc that nobody holds and their total size, guarded by the mutex
+  GPU_Buffer* free_staging;
+  U64 free_staging_size;
+  
+  // tec: guards the arena, the kernel cache, the buffer free list and every queue submission
+  OS_Handle mutex;
+  GPU_Buffer* free_buffers;
+  
+  GPU_Kernel* kernel_cache[GPU_KERNEL_CACHE_BUCKET_COUNT];
+  U64 kernel_cache_hits;
+  U64 kernel_cache_misses;
 };
 
 global GPU_State* g_vulkan_state = 0;
 
+internal U32 gpu_vulkan_find_memory_type(U32 type_bits, VkMemoryPropertyFlags props);
+internal GPU_Buffer* gpu_vulkan_buffer_create(U64 size, VkMemoryPropertyFlags props);
+internal void gpu_vulkan_submit_and_wait(VkQueue queue, VkCommandBuffer command_buffer);
+internal void gpu_vulkan_copy(VkBuffer src, U64 src_offset, VkBuffer dst, U64 dst_offset, U64 size);
+internal String8 gpu_vulkan_load_or_build_spirv(Arena* arena, String8 source_glsl, String8 kernel_name);
+internal GPU_Kernel* gpu_vulkan_kernel_create(String8 name, String8 src, String8 spirv);
+
 #endif //GPU_VULKAN_H
@@ -79,11 +79,13 @@ ir_type_from_sql_node_type(SQL_NodeType sql_type)
     case SQL_NodeType_Operator:      return IR_NodeType_Operator;
     case SQL_NodeType_Literal:       return IR_NodeType_Literal;
     case SQL_NodeType_Numeric:       return IR_NodeType_Numeric;
+    case SQL_NodeType_Null:          return IR_NodeType_Null;
     case SQL_NodeType_OrderBy:       return IR_NodeType_OrderBy;
     case SQL_NodeType_Ascending:     return IR_NodeType_Ascending;
     case SQL_NodeType_Descending:    return IR_NodeType_Descending;
     case SQL_NodeType_Insert:        return IR_NodeType_Insert;
     case SQL_NodeType_Import:        return IR_NodeType_Import;
+    case SQL_NodeType_Export:        return IR_NodeType_Export;
     case SQL_NodeType_Value:         return IR_NodeType_Value;
     case SQL_NodeType_ValueGroup:    return IR_NodeType_ValueGroup;
     case SQL_NodeType_ColumnList:    return IR_NodeType_ColumnList; 
@@ -94,6 +96,11 @@ ir_type_from_sql_node_type(SQL_NodeType sql_type)
     case SQL_NodeType_Alter_DropColumn: return IR_NodeType_DropColumn;
     case SQL_NodeType_Alter_Rename:  return IR_NodeType_Rename;
     case SQL_NodeType_Database:      return IR_NodeType_Database;
+    case SQL_NodeType_Index:         return IR_NodeType_Index;
+    case SQL_NodeType_Explain:       return IR_NodeType_Explain;
+    case SQL_NodeType_Parameter:     return IR_NodeType_Parameter;
+    case SQL_NodeType_Prepare:       return IR_NodeType_Prepare;
+    case SQL_NodeType_Execute:       return IR_NodeType_Execute;
     
     // Special cases
     case SQL_NodeType_Row:           return IR_NodeType_ValueGroup;
@@ -120,17 +127,20 @@ ir_node_type_to_string(IR_NodeType type)
     case IR_NodeType_Column: result = str8_lit("IR_NodeType_Column"); break;
     case IR_NodeType_Table: result = str8_lit("IR_NodeType_Table"); break;
     case IR_NodeType_Database: result = str8_lit("IR_NodeType_Database"); break;
+    case IR_NodeType_Index: result = str8_lit("IR_NodeType_Index"); break;
     case IR_NodeType_Where: result = str8_lit("IR_NodeType_Where"); break;
     case IR_NodeType_Create: result = str8_lit("IR_NodeType_Create"); break;
     case IR_NodeType_Condition: result = str8_lit("IR_NodeType_Condition"); break;
     case IR_NodeType_Operator: result = str8_lit("IR_NodeType_Operator"); break;
     case IR_NodeType_Numeric: result = str8_lit("IR_NodeType_Numeric"); break;
     case IR_NodeType_Literal: result = str8_lit("IR_NodeType_Literal"); break;
+    case IR_NodeType_Null: result = str8_lit("IR_NodeType_Null"); break;
     case IR_NodeType_OrderBy: result = str8_lit("IR_NodeType_OrderBy"); break;
     case IR_NodeType_Ascending: result = str8_lit("IR_NodeType_Ascending"); break;
     case IR_NodeType_Descending: result = str8_lit("IR_NodeType_Descending"); break;
     case IR_NodeType_Insert: result = str8_lit("IR_NodeType_Insert"); break;
     case IR_NodeType_Import: result = str8_lit("IR_NodeType_Import"); break;
+    case IR_NodeType_Export: result = str8_lit("IR_NodeType_Export"); break;
     case IR_NodeType_Value: result = str8_lit("IR_NodeType_Value"); break;
     case IR_NodeType_ValueGroup: result = str8_lit("IR_NodeType_ValueGroup"); break;
     case IR_NodeType_ColumnList: result = str8_lit("IR_NodeType_ColumnList"); break;
@@ -138,6 +148,10 @@ ir_node_type_to_string(IR_NodeType type)
     case IR_NodeType_Alter: result = str8_lit("IR_NodeType_Alter"); break;
     case IR_NodeType_AddColumn: result = str8_lit("IR_NodeType_AddColumn"); break;
     case IR_NodeType_Type: result = str8_lit("IR_NodeType_Type"); break;
+    case IR_NodeType_Explain: result = str8_lit("IR_NodeType_Explain"); break;
+    case IR_NodeType_Parameter: result = str8_lit("IR_NodeType_Parameter"); break;
+    case IR_NodeType_Prepare: result = str8_lit("IR_NodeType_Prepare"); break;
+    case IR_NodeType_Execute: result = str8_lit("IR_NodeType_Execute"); break;
   }
   
   return result;
@@ -159,6 +173,53 @@ ir_node_find_child(IR_Node* parent, IR_NodeType type)
   return NULL;
 }
 
+// tec: deep copies node and its children, strings included. parameter $k is replaced by a copy of
+// params[k - 1] when one is given. links match ir_generate_recursive, first and next only
+internal IR_Node*
+ir_node_copy(Arena* arena, IR_Node* node, IR_Node** params, U64 param_count)
+{
+  if (!node) return NULL;
+  
+  IR_Node* source = node;
+  if (node->type == IR_NodeType_Parameter)
+  {
+    U64 param_index = u64_from_str8(node->value, 10);
+    if (param_index >= 1 && param_index <= param_count)
+    {
+      source = params[param_index - 1];
+    }
+  }
+  
+  IR_Node* copy = ir_node_make(arena, source->type, push_str8_copy(arena, source->value));
+  
+  IR_Node** copy_child_next = &copy->first;
+  for (IR_Node* child = source->first; child != NULL; child = child->next)
+  {
+    *copy_child_next = ir_node_copy(arena, child, params, param_count);
+    (*copy_child_next)->parent = copy;
+    copy_child_next = &((*copy_child_next)->next);
+  }
+  
+  return copy;
+}
+
+// tec: the highest $k under node, parameters are numbered from 1 and may repeat
+internal U64
+ir_node_param_count(IR_Node* node)
+{
+  U64 result = 0;
+  if (node->type == IR_NodeType_Parameter)
+  {
+    result = u64_from_str8(node->value, 10);
+  }
+  for (IR_Node* child = node->first; child != NULL; child = child->next)
+  {
+    U64 child_count = ir_node_param_count(child);
+    result = Max(result, child_count);
+  }
+  return result;
+}
+
 internal GDB_ColumnType
 ir_find_column_type(GDB_Database* database, IR_Node* select_ir_node, String8 column_name)
 {
@@ -174,6 +235,19 @@ ir_find_column_type(GDB_Database* database, IR_Node* select_ir_node, String8 col
   return column->type;
 }
 
+internal B32
+ir_column_list_contains(String8List* columns, String8 column_name)
+{
+  for (String8Node* node = columns->first; node != NULL; node = node->next)
+  {
+    if (str8_match(node->string, column_name, 0))
+    {
+      return 1;
+    }
+  }
+  return 0;
+}
+
 internal void
 ir_create_active_column_list(Arena* arena, IR_Node* parent_node, String8List* used_columns)
 {
@@ -236,6 +310,21 @@ ir_print_node(IR_Node *node, U64 depth)
   }
 }
 
+// tec: one line per node, same layout as ir_print_node without the type prefix
+internal void
+ir_node_to_string_list(Arena* arena, IR_Node* node, U64 depth, String8List* out)
+{
+  for (; node != NULL; node = node->next)
+  {
+    String8 type = str8_skip(ir_node_type_to_string(node->type), str8_lit("IR_NodeType_").size);
+    String8 indent = str8(push_array(arena, U8, depth * 2), depth * 2);
+    MemorySet(indent.str, ' ', indent.size);
+    str8_list_pushf(arena, out, "%.*s- [%.*s] %.*s", str8_varg(indent), str8_varg(type), str8_varg(node->value));
+    
+    ir_node_to_string_list(arena, node->first, depth + 1, out);
+  }
+}
+
 internal void
 ir_print_query(IR_Query *query)
 {
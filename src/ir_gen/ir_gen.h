@@ -9,17 +9,20 @@ typedef enum IR_NodeType
   IR_NodeType_Column,
   IR_NodeType_Table,
   IR_NodeType_Database,
+  IR_NodeType_Index,
   IR_NodeType_Where,
   IR_NodeType_Create,
   IR_NodeType_Condition,
   IR_NodeType_Operator,
   IR_NodeType_Numeric,
   IR_NodeType_Literal,
+  IR_NodeType_Null,
   IR_NodeType_OrderBy,
   IR_NodeType_Ascending,
   IR_NodeType_Descending,
   IR_NodeType_Insert,
   IR_NodeType_Import,
+  IR_NodeType_Export,
   IR_NodeType_Value,
   IR_NodeType_ValueGroup,
   IR_NodeType_ColumnList,
@@ -30,6 +33,10 @@ typedef enum IR_NodeType
   IR_NodeType_Rename,
   IR_NodeType_Type,
   IR_NodeType_Use,
+  IR_NodeType_Explain,
+  IR_NodeType_Parameter,
+  IR_NodeType_Prepare,
+  IR_NodeType_Execute,
 } IR_NodeType;
 
 typedef struct IR_Node IR_Node;
@@ -71,8 +78,12 @@ internal void ir_node_add_child(IR_Node* parent, IR_Node* child);
 internal IR_NodeType ir_type_from_sql_node_type(SQL_NodeType sql_type);
 internal String8 ir_node_type_to_string(IR_NodeType type);
 internal IR_Node* ir_node_find_child(IR_Node* parent, IR_NodeType type);
+internal IR_Node* ir_node_copy(Arena* arena, IR_Node* node, IR_Node** params, U64 param_count);
+internal U64 ir_node_param_count(IR_Node* node);
 internal GDB_ColumnType ir_find_column_type(GDB_Database* database, IR_Node* select_ir_node, String8 column_name);
+internal B32 ir_column_list_contains(String8List* columns, String8 column_name);
 internal void ir_print_node(IR_Node *node, U64 depth);
+internal void ir_node_to_string_list(Arena* arena, IR_Node* node, U64 depth, String8List* out);
 internal void ir_print_query(IR_Query *query);
 
 #endif //IR_GEN_H
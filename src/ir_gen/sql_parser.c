@@ -123,6 +123,21 @@ sql_tokenize_from_text(Arena* arena, String8 text)
         .range = r1u64(start, pos),
       };
     }
+    // tec: $1, $2, ... placeholders of a prepared statement, the value is the number
+    else if (text.str[pos] == '$' && pos + 1 < text.size && char_is_digit(text.str[pos + 1], 10))
+    {
+      pos++;
+      while (pos < text.size && char_is_digit(text.str[pos], 10))
+      {
+        pos++;
+      }
+      tokens[token_count++] = (SQL_Token)
+      {
+        .type = SQL_TokenType_Parameter,
+        .value = str8_substr(text, r1u64(start + 1, pos)),
+        .range = r1u64(start, pos)
+      };
+    }
     // Symbols
     else if (sql_is_string_symbol(str8_substr(text, r1u64(pos, pos+1))))
     {
@@ -180,6 +195,7 @@ sql_tokens_print(SQL_TokenizeResult tokens)
       case SQL_TokenType_Symbol: token_type = str8_lit("SQL_TokenType_Symbol"); break;
       case SQL_TokenType_Number: token_type = str8_lit("SQL_TokenType_Number"); break;
       case SQL_TokenType_String: token_type = str8_lit("SQL_TokenType_String"); break;
+      case SQL_TokenType_Parameter: token_type = str8_lit("SQL_TokenType_Parameter"); break;
     }
     
     printf("\'%.*s\' : index=%llu : type=%.*s\n", (int)token->value.size, token->value.str,
@@ -187,6 +203,114 @@ sql_tokens_print(SQL_TokenizeResult tokens)
   }
 }
 
+// tec: the text with whitespace collapsed and every number and string literal replaced by $1, $2, ...
+// in order. the literals are returned as tokens. queries that only differ in their values normalize
+// to the same text. returns an empty string when the text already has placeholders, has an
+// unterminated string or more than max_literal_count literals
+internal String8
+sql_normalize_text(Arena* arena, String8 text, SQL_Token* out_literals, U64 max_literal_count, U64* out_literal_count)
+{
+  U8* out = push_array_no_zero(arena, U8, text.size + max_literal_count * 4 + 1);
+  U64 out_size = 0;
+  U64 literal_count = 0;
+  B32 valid = 1;
+  
+  U64 pos = 0;
+  while (valid && pos < text.size)
+  {
+    U8 c = text.str[pos];
+    
+    if (char_is_space(c))
+    {
+      while (pos < text.size && char_is_space(text.str[pos]))
+      {
+        pos++;
+      }
+      if (out_size > 0 && pos < text.size)
+      {
+        out[out_size++] = ' ';
+      }
+      continue;
+    }
+    
+    SQL_Token literal = { 0 };
+    B32 is_literal = 0;
+    U64 start = pos;
+    
+    if (c == '$')
+    {
+      valid = 0;
+    }
+    else if (c == '\'')
+    {
+      pos++;
+      while (pos < text.size && text.str[pos] != '\'')
+      {
+        pos++;
+      }
+      if (pos >= text.size)
+      {
+        valid = 0;
+        break;
+      }
+      literal.type = SQL_TokenType_String;
+      literal.value = str8_substr(text, r1u64(start + 1, pos));
+      literal.range = r1u64(start, pos + 1);
+      is_literal = 1;
+      pos++;
+    }
+    else if (char_is_digit(c, 10))
+    {
+      // tec: same rules as the tokenizer
+      B32 has_dot = 0;
+      while (pos < text.size && (char_is_digit(text.str[pos], 10) || (!has_dot && text.str[pos] == '.')))
+      {
+        if (text.str[pos] == '.')
+        {
+          has_dot = 1;
+          if (pos + 1 >= text.size || !char_is_digit(text.str[pos + 1], 10))
+          {
+            break;
+          }
+        }
+        pos++;
+      }
+      literal.type = SQL_TokenType_Number;
+      literal.value = str8_substr(text, r1u64(start, pos));
+      literal.range = r1u64(start, pos);
+      is_literal = 1;
+    }
+    else if (char_is_alpha(c))
+    {
+      while (pos < text.size && (char_is_digit(text.str[pos], 10) || char_is_alpha(text.str[pos]) || text.str[pos] == '_'))
+      {
+        out[out_size++] = text.str[pos++];
+      }
+    }
+    else
+    {
+      out[out_size++] = c;
+      pos++;
+    }
+    
+    if (is_literal)
+    {
+      if (literal_count >= max_literal_count)
+      {
+        valid = 0;
+        break;
+      }
+      out_literals[literal_count++] = literal;
+      String8 placeholder = push_str8f(arena, "$%llu", literal_count);
+      MemoryCopy(out + out_size, placeholder.str, placeholder.size);
+      out_size += placeholder.size;
+    }
+  }
+  
+  *out_literal_count = valid ? literal_count : 0;
+  return valid ? str8(out, out_size) : str8_zero();
+}
+
 //~ tec: ast
 internal SQL_Node*
 sql_parse(Arena* arena, SQL_Token* tokens, U64 token_count)
@@ -197,6 +321,8 @@ sql_parse(Arena* arena, SQL_Token* tokens, U64 token_count)
   SQL_Node *root = NULL;
   SQL_Node *current_node = NULL;
   SQL_Node *last_select_node = NULL;
+  SQL_Node *explain_node = NULL;
+  SQL_Node *prepare_node = NULL;
   
   while (token_index < token_count)
   {
@@ -251,6 +377,10 @@ sql_parse(Arena* arena, SQL_Token* tokens, U64 token_count)
       {
         new_node = sql_parse_import_clause(arena, &tokens, &token_index, token_count);
       }
+      else if (str8_match(token->value, str8_lit("export"), StringMatchFlag_CaseInsensitive))
+      {
+        new_node = sql_parse_export_clause(arena, &tokens, &token_index, token_count);
+      }
       else if (str8_match(token->value, str8_lit("create"), StringMatchFlag_CaseInsensitive))
       {
         new_node = sql_parse_create_clause(arena, &tokens, &token_index, token_count);
@@ -264,6 +394,32 @@ sql_parse(Arena* arena, SQL_Token* tokens, U64 token_count)
         new_node = sql_parse_delete_clause(arena, &tokens, &token_index, token_count);
         last_select_node = new_node;
       }
+      else if (str8_match(token->value, str8_lit("explain"), StringMatchFlag_CaseInsensitive))
+      {
+        // tec: wraps the statement that follows
+        explain_node = sql_parse_explain_clause(arena, &tokens, &token_index, token_count);
+        continue;
+      }
+      else if (str8_match(token->value, str8_lit("prepare"), StringMatchFlag_CaseInsensitive))
+      {
+        // tec: wraps the statement that follows, like explain
+        prepare_node = sql_parse_prepare_clause(arena, &tokens, &token_index, token_count);
+        if (!prepare_node)
+        {
+          ProfEnd();
+          return NULL;
+        }
+        continue;
+      }
+      else if (str8_match(token->value, str8_lit("execute"), StringMatchFlag_CaseInsensitive))
+      {
+        new_node = sql_parse_execute_clause(arena, &tokens, &token_index, token_count);
+        if (!new_node)
+        {
+          ProfEnd();
+          return NULL;
+        }
+      }
       else if (str8_match(token->value, str8_lit("order"), StringMatchFlag_CaseInsensitive))
       {
         new_node = sql_parse_order_by_clause(arena, &tokens, &token_index, token_count);
@@ -286,6 +442,22 @@ sql_parse(Arena* arena, SQL_Token* tokens, U64 token_count)
       {
         if (! attach_to_select)
         {
+          if (explain_node)
+          {
+            new_node->parent = explain_node;
+            DLLPushBack(explain_node->first, explain_node->last, new_node);
+            new_node = explain_node;
+            explain_node = NULL;
+          }
+          
+          if (prepare_node)
+          {
+            new_node->parent = prepare_node;
+            DLLPushBack(prepare_node->first, prepare_node->last, new_node);
+            new_node = prepare_node;
+            prepare_node = NULL;
+          }
+          
           if (!root)
           {
             root = new_node;
@@ -313,6 +485,111 @@ sql_parse(Arena* arena, SQL_Token* tokens, U64 token_count)
   return root;
 }
 
+internal SQL_Node*
+sql_parse_explain_clause(Arena* arena, SQL_Token **tokens, U64 *token_index, U64 token_count)
+{
+  (*token_index)++; // tec: move past 'explain'
+  
+  SQL_Node* explain_node = push_array(arena, SQL_Node, 1);
+  explain_node->type = SQL_NodeType_Explain;
+  
+  if (*token_index < token_count && (*tokens)[*token_index].type == SQL_TokenType_Keyword &&
+      str8_match((*tokens)[*token_index].value, str8_lit("analyze"), StringMatchFlag_CaseInsensitive))
+  {
+    explain_node->value = str8_lit("analyze");
+    (*token_index)++;
+  }
+  
+  return explain_node;
+}
+
+// tec: prepare <name> as <statement>, the statement may use $1, $2, ... for values
+internal SQL_Node*
+sql_parse_prepare_clause(Arena* arena, SQL_Token **tokens, U64 *token_index, U64 token_count)
+{
+  (*token_index)++; // tec: move past 'prepare'
+  
+  if (*token_index >= token_count || (*tokens)[*token_index].type != SQL_TokenType_Identifier)
+  {
+    log_error("expected statement name after 'prepare'");
+    return NULL;
+  }
+  
+  SQL_Node* prepare_node = push_array(arena, SQL_Node, 1);
+  prepare_node->type = SQL_NodeType_Prepare;
+  prepare_node->value = (*tokens)[*token_index].value;
+  (*token_index)++;
+  
+  if (*token_index >= token_count || (*tokens)[*token_index].type != SQL_TokenType_Keyword ||
+      !str8_match((*tokens)[*token_index].value, str8_lit("as"), StringMatchFlag_CaseInsensitive))
+  {
+    log_error("expected 'as' after the name in 'prepare'");
+    return NULL;
+  }
+  (*token_index)++; // tec: move past 'as'
+  
+  return prepare_node;
+}
+
+// tec: execute <name> [(value, ...)], the values bind to $1, $2, ... in order
+internal SQL_Node*
+sql_parse_execute_clause(Arena* arena, SQL_Token **tokens, U64 *token_index, U64 token_count)
+{
+  (*token_index)++; // tec: move past 'execute'
+  
+  if (*token_index >= token_count || (*tokens)[*token_index].type != SQL_TokenType_Identifier)
+  {
+    log_error("expected statement name after 'execute'");
+    return NULL;
+  }
+  
+  SQL_Node* execute_node = push_array(arena, SQL_Node, 1);
+  execute_node->type = SQL_NodeType_Execute;
+  execute_node->value = (*tokens)[*token_index].value;
+  (*token_index)++;
+  
+  if (*token_index >= token_count || (*tokens)[*token_index].type != SQL_TokenType_Symbol ||
+      !str8_match((*tokens)[*token_index].value, str8_lit("("), 0))
+  {
+    return execute_node;
+  }
+  (*token_index)++; // tec: move past '('
+  
+  while (*token_index < token_count)
+  {
+    SQL_Token* token = &(*tokens)[*token_index];
+    if (token->type == SQL_TokenType_Symbol && str8_match(token->value, str8_lit(")"), 0))
+    {
+      (*token_index)++;
+      return execute_node;
+    }
+    
+    B32 is_null = (token->type == SQL_TokenType_Keyword &&
+                   str8_match(token->value, str8_lit("null"), StringMatchFlag_CaseInsensitive));
+    if (token->type != SQL_TokenType_Number && token->type != SQL_TokenType_String && !is_null)
+    {
+      log_error("expected a literal value in 'execute', but found '%.*s'", str8_varg(token->value));
+      return NULL;
+    }
+    
+    SQL_Node* value_node = push_array(arena, SQL_Node, 1);
+    value_node->type = is_null ? SQL_NodeType_Null : (token->type == SQL_TokenType_Number ? SQL_NodeType_Numeric : SQL_NodeType_Literal);
+    value_node->value = token->value;
+    value_node->parent = execute_node;
+    DLLPushBack(execute_node->first, execute_node->last, value_node);
+    (*token_index)++;
+    
+    if (*token_index < token_count && (*tokens)[*token_index].type == SQL_TokenType_Symbol &&
+        str8_match((*tokens)[*token_index].value, str8_lit(","), 0))
+    {
+      (*token_index)++;
+    }
+  }
+  
+  log_error("expected ')' after the values in 'execute'");
+  return NULL;
+}
+
 internal SQL_Node*
 sql_parse_use_clause(Arena* arena, SQL_Token **tokens, U64 *token_index, U64 token_count)
 {
@@ -502,6 +779,41 @@ sql_parse_comparison_expression(Arena* arena, SQL_Token **tokens, U64 *token_ind
     return NULL;
   }
   
+  // tec: 'is [not] null' tests the validity of the left hand side only
+  if (*token_index < token_count &&
+      (*tokens)[*token_index].type == SQL_TokenType_Keyword &&
+      str8_match((*tokens)[*token_index].value, str8_lit("is"), StringMatchFlag_CaseInsensitive))
+  {
+    (*token_index)++; // tec: move past 'is'
+    
+    B32 is_not = 0;
+    if (*token_index < token_count &&
+        (*tokens)[*token_index].type == SQL_TokenType_Keyword &&
+        str8_match((*tokens)[*token_index].value, str8_lit("not"), StringMatchFlag_CaseInsensitive))
+    {
+      is_not = 1;
+      (*token_index)++; // tec: move past 'not'
+    }
+    
+    if (*token_index >= token_count ||
+        (*tokens)[*token_index].type != SQL_TokenType_Keyword ||
+        !str8_match((*tokens)[*token_index].value, str8_lit("null"), StringMatchFlag_CaseInsensitive))
+    {
+      log_error("expected 'null' after 'is'");
+      return NULL;
+    }
+    (*token_index)++; // tec: move past 'null'
+    
+    SQL_Node *operator_node = push_array(arena, SQL_Node, 1);
+    operator_node->type = SQL_NodeType_Operator;
+    operator_node->value = is_not ? str8_lit("is not null") : str8_lit("is null");
+    operator_node->first = left;
+    operator_node->last = left;
+    left->parent = operator_node;
+    
+    return operator_node;
+  }
+  
   // Expect comparison operator
   if (*token_index >= token_count || !((*tokens)[*token_index].type == SQL_TokenType_Operator ||
                                        (*tokens)[*token_index].type == SQL_TokenType_Keyword))
@@ -754,8 +1066,68 @@ sql_parse_import_clause(Arena* arena, SQL_Token **tokens, U64 *token_index, U64
   (*token_index)++;
   
   import_node->first = table_node;
+  import_node->last = table_node;
   table_node->parent = import_node;
   
+  // tec: optional column list, the columns read from files that store them separately
+  if (*token_index < token_count && (*tokens)[*token_index].type == SQL_TokenType_Symbol &&
+      str8_match((*tokens)[*token_index].value, str8_lit("("), 0))
+  {
+    (*token_index)++; // tec: move past '('
+    
+    SQL_Node* column_list_node = push_array(arena, SQL_Node, 1);
+    column_list_node->type = SQL_NodeType_ColumnList;
+    column_list_node->parent = import_node;
+    
+    while (*token_index < token_count && 
+           (*tokens)[*token_index].type != SQL_TokenType_Symbol &&
+           !str8_match((*tokens)[*token_index].value, str8_lit(")"), 0))
+    {
+      if ((*tokens)[*token_index].type != SQL_TokenType_Identifier)
+      {
+        log_error("expected column name in 'import' statement");
+        return NULL;
+      }
+      
+      SQL_Node* column_node = push_array(arena, SQL_Node, 1);
+      column_node->type = SQL_NodeType_Column;
+      column_node->value = (*tokens)[*token_index].value;
+      column_node->parent = column_list_node;
+      (*token_index)++;
+      
+      if (!column_list_node->first)
+      {
+        column_list_node->first = column_node;
+      }
+      else
+      {
+        column_list_node->last->next = column_node;
+        column_node->prev = column_list_node->last;
+      }
+      column_list_node->last = column_node;
+      
+      // tec: skip comma
+      if (*token_index < token_count && (*tokens)[*token_index].type == SQL_TokenType_Symbol &&
+          str8_match((*tokens)[*token_index].value, str8_lit(","), 0))
+      {
+        (*token_index)++;
+      }
+    }
+    
+    // tec: expect closing ')'
+    if (*token_index >= token_count || (*tokens)[*token_index].type != SQL_TokenType_Symbol ||
+        !str8_match((*tokens)[*token_index].value, str8_lit(")"), 0))
+    {
+      log_error("Expected closing ')' in column list.");
+      return NULL;
+    }
+    (*token_index)++; // tec: move past ')'
+    
+    table_node->next = column_list_node;
+    column_list_node->prev = table_node;
+    import_node->last = column_list_node;
+  }
+  
   // tec: expect 'FROM'
   if (*token_index >= token_count || 
       (*tokens)[*token_index].type != SQL_TokenType_Keyword || 
@@ -778,14 +1150,83 @@ sql_parse_import_clause(Arena* arena, SQL_Token **tokens, U64 *token_index, U64
   path_node->value = (*tokens)[*token_index].value;
   (*token_index)++;
   
-  table_node->next = path_node;
-  path_node->prev = table_node;
+  import_node->last->next = path_node;
+  path_node->prev = import_node->last;
   path_node->parent = import_node;
   import_node->last = path_node;
   
+  // tec: optional 'WHERE', rows the file reader can leave out while it reads
+  if (*token_index < token_count && (*tokens)[*token_index].type == SQL_TokenType_Keyword &&
+      str8_match((*tokens)[*token_index].value, str8_lit("where"), StringMatchFlag_CaseInsensitive))
+  {
+    SQL_Node* where_node = sql_parse_where_clause(arena, tokens, token_index, token_count);
+    if (!where_node || !where_node->first)
+    {
+      return NULL;
+    }
+    
+    path_node->next = where_node;
+    where_node->prev = path_node;
+    where_node->parent = import_node;
+    import_node->last = where_node;
+  }
+  
   return import_node;
 }
 
+internal SQL_Node*
+sql_parse_export_clause(Arena* arena, SQL_Token **tokens, U64 *token_index, U64 token_count)
+{
+  SQL_Node* export_node = push_array(arena, SQL_Node, 1);
+  export_node->type = SQL_NodeType_Export;
+  
+  (*token_index)++; // tec: move past 'EXPORT'
+  
+  // tec: expect table name
+  if (*token_index >= token_count || (*tokens)[*token_index].type != SQL_TokenType_Identifier)
+  {
+    log_error("Expected table name after 'EXPORT'");
+    return NULL;
+  }
+  
+  SQL_Node* table_node = push_array(arena, SQL_Node, 1);
+  table_node->type = SQL_NodeType_Table;
+  table_node->value = (*tokens)[*token_index].value;
+  (*token_index)++;
+  
+  export_node->first = table_node;
+  table_node->parent = export_node;
+  
+  // tec: expect 'TO'
+  if (*token_index >= token_count || 
+      (*tokens)[*token_index].type != SQL_TokenType_Keyword || 
+      !str8_match((*tokens)[*token_index].value, str8_lit("to"), StringMatchFlag_CaseInsensitive))
+  {
+    log_error("Expected 'TO' keyword in 'EXPORT' statement");
+    return NULL;
+  }
+  (*token_index)++; // tec: move past 'TO'
+  
+  // tec: expect file path as string literal, the extension picks the format
+  if (*token_index >= token_count || (*tokens)[*token_index].type != SQL_TokenType_String)
+  {
+    log_error("Expected file path after 'TO' in 'EXPORT' statement");
+    return NULL;
+  }
+  
+  SQL_Node* path_node = push_array(arena, SQL_Node, 1);
+  path_node->type = SQL_NodeType_Literal;
+  path_node->value = (*tokens)[*token_index].value;
+  (*token_index)++;
+  
+  table_node->next = path_node;
+  path_node->prev = table_node;
+  path_node->parent = export_node;
+  export_node->last = path_node;
+  
+  return export_node;
+}
+
 internal SQL_Node*
 sql_parse_create_clause(Arena* arena, SQL_Token **tokens, U64 *token_index, U64 token_count)
 {
@@ -798,7 +1239,7 @@ sql_parse_create_clause(Arena* arena, SQL_Token **tokens, U64 *token_index, U64
   if (*token_index >= token_count || 
       (*tokens)[*token_index].type != SQL_TokenType_Keyword)
   {
-    log_error("expected 'table' or 'database' keyword in 'create' statement");
+    log_error("expected 'table', 'database' or 'index' keyword in 'create' statement");
     return NULL;
   }
   String8 keyword = (*tokens)[*token_index].value;
@@ -915,9 +1356,86 @@ sql_parse_create_clause(Arena* arena, SQL_Token **tokens, U64 *token_index, U64
     (*token_index)++; // tec: move past ')'
     
   }
+  else if (str8_match(keyword, str8_lit("index"), StringMatchFlag_CaseInsensitive))
+  {
+    // tec: create index <name> on <table> (<column>) [using hash|sorted]
+    if (*token_index >= token_count || (*tokens)[*token_index].type != SQL_TokenType_Identifier)
+    {
+      log_error("expected index name in 'create index' statement");
+      return NULL;
+    }
+    
+    SQL_Node* index_node = push_array(arena, SQL_Node, 1);
+    index_node->type = SQL_NodeType_Index;
+    index_node->value = (*tokens)[*token_index].value;
+    index_node->parent = create_node;
+    (*token_index)++;
+    
+    create_node->first = index_node;
+    create_node->last = index_node;
+    
+    if (*token_index >= token_count || (*tokens)[*token_index].type != SQL_TokenType_Keyword ||
+        !str8_match((*tokens)[*token_index].value, str8_lit("on"), StringMatchFlag_CaseInsensitive))
+    {
+      log_error("expected 'on' in 'create index' statement");
+      return NULL;
+    }
+    (*token_index)++; // tec: move past 'on'
+    
+    if (*token_index >= token_count || (*tokens)[*token_index].type != SQL_TokenType_Identifier)
+    {
+      log_error("expected table name in 'create index' statement");
+      return NULL;
+    }
+    
+    SQL_Node* table_node = push_array(arena, SQL_Node, 1);
+    table_node->type = SQL_NodeType_Table;
+    table_node->value = (*tokens)[*token_index].value;
+    (*token_index)++;
+    DLLPushBack(index_node->first, index_node->last, table_node);
+    table_node->parent = index_node;
+    
+    if (*token_index + 2 >= token_count ||
+        (*tokens)[*token_index].type != SQL_TokenType_Symbol ||
+        !str8_match((*tokens)[*token_index].value, str8_lit("("), 0) ||
+        (*tokens)[*token_index + 1].type != SQL_TokenType_Identifier ||
+        (*tokens)[*token_index + 2].type != SQL_TokenType_Symbol ||
+        !str8_match((*tokens)[*token_index + 2].value, str8_lit(")"), 0))
+    {
+      log_error("expected '(<column>)' in 'create index' statement");
+      return NULL;
+    }
+    
+    SQL_Node* column_node = push_array(arena, SQL_Node, 1);
+    column_node->type = SQL_NodeType_Column;
+    column_node->value = (*tokens)[*token_index + 1].value;
+    (*token_index) += 3; // tec: move past '(<column>)'
+    DLLPushBack(index_node->first, index_node->last, column_node);
+    column_node->parent = index_node;
+    
+    // tec: optional index kind
+    if (*token_index < token_count && (*tokens)[*token_index].type == SQL_TokenType_Keyword &&
+        str8_match((*tokens)[*token_index].value, str8_lit("using"), StringMatchFlag_CaseInsensitive))
+    {
+      (*token_index)++; // tec: move past 'using'
+      if (*token_index >= token_count ||
+          ((*tokens)[*token_index].type != SQL_TokenType_Identifier && (*tokens)[*token_index].type != SQL_TokenType_Keyword))
+      {
+        log_error("expected index kind after 'using'");
+        return NULL;
+      }
+      
+      SQL_Node* type_node = push_array(arena, SQL_Node, 1);
+      type_node->type = SQL_NodeType_Type;
+      type_node->value = (*tokens)[*token_index].value;
+      (*token_index)++;
+      DLLPushBack(index_node->first, index_node->last, type_node);
+      type_node->parent = index_node;
+    }
+  }
   else
   {
-    log_error("unexpected keyword in 'create' statemnet, exepected 'table' or 'database'");
+    log_error("unexpected keyword in 'create' statemnet, exepected 'table', 'database' or 'index'");
   }
   
   return create_node;
@@ -1089,8 +1607,13 @@ sql_parse_values_clause(Arena* arena, SQL_Token **tokens, U64 *token_index, U64
            (*tokens)[*token_index].type != SQL_TokenType_Symbol &&
            !str8_match((*tokens)[*token_index].value, str8_lit(")"), 0))
     {
+      B32 is_null = ((*tokens)[*token_index].type == SQL_TokenType_Keyword &&
+                     str8_match((*tokens)[*token_index].value, str8_lit("null"), StringMatchFlag_CaseInsensitive));
+      
       if ((*tokens)[*token_index].type != SQL_TokenType_Number &&
-          (*tokens)[*token_index].type != SQL_TokenType_String)
+          (*tokens)[*token_index].type != SQL_TokenType_String &&
+          (*tokens)[*token_index].type != SQL_TokenType_Parameter &&
+          !is_null)
       {
         log_error("expected a literal value in 'values' clause.");
         return NULL;
@@ -1098,6 +1621,14 @@ sql_parse_values_clause(Arena* arena, SQL_Token **tokens, U64 *token_index, U64
       
       SQL_Node* value_node = push_array(arena, SQL_Node, 1);
       value_node->type = (*tokens)[*token_index].type == SQL_TokenType_Number ? SQL_NodeType_Numeric : SQL_NodeType_Literal;
+      if ((*tokens)[*token_index].type == SQL_TokenType_Parameter)
+      {
+        value_node->type = SQL_NodeType_Parameter;
+      }
+      if (is_null)
+      {
+        value_node->type = SQL_NodeType_Null;
+      }
       value_node->value = (*tokens)[*token_index].value;
       (*token_index)++;
       
@@ -1316,7 +1847,8 @@ sql_parse_expression(Arena* arena, SQL_Token **tokens, U64 *token_index, U64 tok
   
   if (token->type == SQL_TokenType_Identifier || 
       token->type == SQL_TokenType_Number ||
-      token->type == SQL_TokenType_String)
+      token->type == SQL_TokenType_String ||
+      token->type == SQL_TokenType_Parameter)
   {
     SQL_Node *node = push_array(arena, SQL_Node, 1);
     
@@ -1325,6 +1857,7 @@ sql_parse_expression(Arena* arena, SQL_Token **tokens, U64 *token_index, U64 tok
       case SQL_TokenType_Identifier: node->type = SQL_NodeType_Column; break;
       case SQL_TokenType_Number: node->type = SQL_NodeType_Numeric; break;
       case SQL_TokenType_String: node->type = SQL_NodeType_Literal; break;
+      case SQL_TokenType_Parameter: node->type = SQL_NodeType_Parameter; break;
     }
     node->value = token->value;
     (*token_index)++;
@@ -1351,13 +1884,16 @@ sql_node_type_to_string(SQL_NodeType type)
     case SQL_NodeType_ColumnList: result = str8_lit("SQL_NodeType_ColumnList"); break;
     case SQL_NodeType_Table: result = str8_lit("SQL_NodeType_Table"); break;
     case SQL_NodeType_Database: result = str8_lit("SQL_NodeType_Database"); break;
+    case SQL_NodeType_Index: result = str8_lit("SQL_NodeType_Index"); break;
     case SQL_NodeType_Where: result = str8_lit("SQL_NodeType_Where"); break;
     case SQL_NodeType_Operator: result = str8_lit("SQL_NodeType_Operator"); break;
     case SQL_NodeType_Numeric: result = str8_lit("SQL_NodeType_Numeric"); break;
     case SQL_NodeType_Identifier: result = str8_lit("SQL_NodeType_Identifier"); break;
     case SQL_NodeType_Literal: result = str8_lit("SQL_NodeType_Literal"); break;
+    case SQL_NodeType_Null: result = str8_lit("SQL_NodeType_Null"); break;
     case SQL_NodeType_Insert: result = str8_lit("SQL_NodeType_Insert"); break;
     case SQL_NodeType_Import: result = str8_lit("SQL_NodeType_Import"); break;
+    case SQL_NodeType_Export: result = str8_lit("SQL_NodeType_Export"); break;
     case SQL_NodeType_Delete: result = str8_lit("SQL_NodeType_Delete"); break;
     case SQL_NodeType_Create: result = str8_lit("SQL_NodeType_Create"); break;
     case SQL_NodeType_Drop: result = str8_lit("SQL_NodeType_Drop"); break;
@@ -1371,6 +1907,10 @@ sql_node_type_to_string(SQL_NodeType type)
     case SQL_NodeType_Alter_ColumnType: result = str8_lit("SQL_NodeType_Alter_ColumnType"); break;
     case SQL_NodeType_Alter_DropColumn: result = str8_lit("SQL_NodeType_Alter_DropColumn"); break;
     case SQL_NodeType_Alter_Rename: result = str8_lit("SQL_NodeType_Alter_Rename"); break;
+    case SQL_NodeType_Explain: result = str8_lit("SQL_NodeType_Explain"); break;
+    case SQL_NodeType_Parameter: result = str8_lit("SQL_NodeType_Parameter"); break;
+    case SQL_NodeType_Prepare: result = str8_lit("SQL_NodeType_Prepare"); break;
+    case SQL_NodeType_Execute: result = str8_lit("SQL_NodeType_Execute"); break;
   }
   
   return result;
@@ -11,6 +11,7 @@ typedef enum SQL_TokenType
   SQL_TokenType_Symbol,
   SQL_TokenType_Number,
   SQL_TokenType_String,
+  SQL_TokenType_Parameter,
   SQL_TokenType_EOF,
 } SQL_TokenType;
 
@@ -45,6 +46,7 @@ global String8 g_sql_keywords[] =
   str8_lit_comp("into"),
   str8_lit_comp("insert"),
   str8_lit_comp("import"),
+  str8_lit_comp("export"),
   str8_lit_comp("create"),
   str8_lit_comp("contains"),
   str8_lit_comp("equals"),
@@ -61,6 +63,16 @@ global String8 g_sql_keywords[] =
   str8_lit_comp("f32"),
   str8_lit_comp("f64"),
   str8_lit_comp("string8"),
+  str8_lit_comp("is"),
+  str8_lit_comp("not"),
+  str8_lit_comp("null"),
+  str8_lit_comp("index"),
+  str8_lit_comp("using"),
+  str8_lit_comp("explain"),
+  str8_lit_comp("analyze"),
+  str8_lit_comp("prepare"),
+  str8_lit_comp("execute"),
+  str8_lit_comp("as"),
 };
 
 global String8 g_sql_operators[] =
@@ -96,6 +108,7 @@ struct SQL_TokenizeResult
 
 internal SQL_TokenizeResult sql_tokenize_from_text(Arena* arena, String8 text);
 internal void sql_tokens_print(SQL_TokenizeResult tokens);
+internal String8 sql_normalize_text(Arena* arena, String8 text, SQL_Token* out_literals, U64 max_literal_count, U64* out_literal_count);
 
 //~ tec: sql ast
 typedef enum SQL_NodeType
@@ -106,13 +119,16 @@ typedef enum SQL_NodeType
   SQL_NodeType_ColumnList,
   SQL_NodeType_Table,
   SQL_NodeType_Database,
+  SQL_NodeType_Index,
   SQL_NodeType_Where,
   SQL_NodeType_Operator,
   SQL_NodeType_Numeric,
   SQL_NodeType_Identifier,
   SQL_NodeType_Literal,
+  SQL_NodeType_Null,
   SQL_NodeType_Insert,
   SQL_NodeType_Import,
+  SQL_NodeType_Export,
   SQL_NodeType_Delete,
   SQL_NodeType_Create,
   SQL_NodeType_Drop,
@@ -128,6 +144,10 @@ typedef enum SQL_NodeType
   SQL_NodeType_Alter_ColumnType,
   SQL_NodeType_Alter_DropColumn,
   SQL_NodeType_Alter_Rename,
+  SQL_NodeType_Explain,
+  SQL_NodeType_Parameter,
+  SQL_NodeType_Prepare,
+  SQL_NodeType_Execute,
 } SQL_NodeType;
 
 typedef struct SQL_Node SQL_Node;
@@ -149,6 +169,7 @@ internal SQL_Node* sql_parse_from_clause(Arena* arena, SQL_Token **tokens, U64 *
 internal SQL_Node* sql_parse_where_clause(Arena* arena, SQL_Token **tokens, U64 *token_index, U64 token_count);
 internal SQL_Node* sql_parse_insert_clause(Arena* arena, SQL_Token **tokens, U64 *token_index, U64 token_count);
 internal SQL_Node* sql_parse_import_clause(Arena* arena, SQL_Token **tokens, U64 *token_index, U64 token_count);
+internal SQL_Node* sql_parse_export_clause(Arena* arena, SQL_Token **tokens, U64 *token_index, U64 token_count);
 internal SQL_Node* sql_parse_create_clause(Arena* arena, SQL_Token **tokens, U64 *token_index, U64 token_count);
 internal SQL_Node* sql_parse_alter_clause(Arena* arena, SQL_Token **tokens, U64 *token_index, U64 token_count);
 internal SQL_Node* sql_parse_delete_clause(Arena* arena, SQL_Token **tokens, U64 *token_index, U64 token_count);
@@ -156,6 +177,9 @@ internal SQL_Node* sql_parse_values_clause(Arena* arena, SQL_Token **tokens, U64
 internal SQL_Node* sql_parse_expression(Arena* arena, SQL_Token **tokens, U64 *token_index, U64 token_count);
 internal SQL_Node* sql_parse_logical_expression(Arena* arena, SQL_Token **tokens, U64 *token_index, U64 token_count);
 internal SQL_Node* sql_parse_order_by_clause(Arena* arena, SQL_Token **tokens, U64 *token_index, U64 token_count);
+internal SQL_Node* sql_parse_explain_clause(Arena* arena, SQL_Token **tokens, U64 *token_index, U64 token_count);
+internal SQL_Node* sql_parse_prepare_clause(Arena* arena, SQL_Token **tokens, U64 *token_index, U64 token_count);
+internal SQL_Node* sql_parse_execute_clause(Arena* arena, SQL_Token **tokens, U64 *token_index, U64 token_count);
 internal SQL_Node* sql_parse(Arena* arena, SQL_Token* tokens, U64 token_count);
 
 internal String8 sql_node_type_to_string(SQL_NodeType type);
@@ -10,19 +10,19 @@
 
 #include "base/base_inc.h"
 #include "os/os_inc.h"
+#include "thread_pool/thread_pool.h"
 #include "gdb/gdb_inc.h"
 #include "ir_gen/ir_gen_inc.h"
 #include "gpu/gpu_inc.h"
 #include "application.h"
-#include "thread_pool/thread_pool.h"
 
 #include "base/base_inc.c"
 #include "os/os_inc.c"
+#include "thread_pool/thread_pool.c"
 #include "gpu/gpu_inc.c"
 #include "ir_gen/ir_gen_inc.c"
 #include "gdb/gdb_inc.c"
 #include "application.c"
-#include "thread_pool/thread_pool.c"
 
 internal void
 entry_point(CmdLine* cmdline)
@@ -46,6 +46,7 @@ entry_point(CmdLine* cmdline)
   
   gdb_init();
   gpu_init();
+  app_init();
   
   log_info("total gpu memory: %llu (MB)", gpu_device_total_memory() >> 20);
   
@@ -55,9 +56,29 @@ entry_point(CmdLine* cmdline)
     valid_query = query_str.size == 0 ? 0 : 1;
   }
   
-  if (valid_query)
+  if (cmd_line_has_flag(cmdline, str8_lit("server")))
+  {
+    String8 host = cmd_line_string(cmdline, str8_lit("host"));
+    String8 port_str = cmd_line_string(cmdline, str8_lit("port"));
+    U16 port = port_str.size ? (U16)u64_from_str8(port_str, 10) : APP_SERVER_DEFAULT_PORT;
+    app_server_run(host.size ? host : str8_lit("127.0.0.1"), port);
+  }
+  else if (valid_query)
   {
-    app_execute_query(query_str);
+    // tec: -output streams the results to a file, or to stdout with '-output -'
+    String8 output_path = cmd_line_string(cmdline, str8_lit("output"));
+    if (output_path.size)
+    {
+      APP_QueryContext context = { 0 };
+      APP_ResultSink sink = app_result_sink_open(output_path);
+      context.sink = &sink;
+      app_execute_query(query_str, &context);
+      app_result_sink_close(&sink, context.failed ? APP_ServerStatus_Error : APP_ServerStatus_Ok);
+    }
+    else
+    {
+      app_execute_query(query_str, 0);
+    }
   }
   else
   {
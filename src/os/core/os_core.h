@@ -13,6 +13,10 @@ struct OS_SystemInfo
   U64 page_size;
   U64 large_page_size;
   U64 allocation_granularity;
+  
+  // tec: large pages need the lock memory privilege, arenas asking for them fall back to regular pages without it
+  B32 large_pages_enabled;
+  U32 numa_node_count;
   String8 machine_name;
 };
 
@@ -36,12 +40,15 @@ struct OS_ProcessInfo
 typedef U32 OS_AccessFlags;
 enum
 {
-  OS_AccessFlag_Read       = (1<<0),
-  OS_AccessFlag_Write      = (1<<1),
-  OS_AccessFlag_Execute    = (1<<2),
-  OS_AccessFlag_Append     = (1<<3),
-  OS_AccessFlag_ShareRead  = (1<<4),
-  OS_AccessFlag_ShareWrite = (1<<5),
+  OS_AccessFlag_Read        = (1<<0),
+  OS_AccessFlag_Write       = (1<<1),
+  OS_AccessFlag_Execute     = (1<<2),
+  OS_AccessFlag_Append      = (1<<3),
+  OS_AccessFlag_ShareRead   = (1<<4),
+  OS_AccessFlag_ShareWrite  = (1<<5),
+  OS_AccessFlag_CopyOnWrite = (1<<6),
+  OS_AccessFlag_Async       = (1<<7),
+  OS_AccessFlag_Direct      = (1<<8),
 };
 
 ////////////////////////////////
@@ -70,6 +77,15 @@ struct OS_FileInfo
   FileProperties props;
 };
 
+// tec: one finished asynchronous read, user_data is whatever the read was submitted with
+typedef struct OS_IOCompletion OS_IOCompletion;
+struct OS_IOCompletion
+{
+  U64 user_data;
+  U64 bytes;
+  B32 failed;
+};
+
 // tec: on-disk file identifier
 typedef struct OS_FileID OS_FileID;
 struct OS_FileID
@@ -188,11 +204,17 @@ internal void  os_release(void *ptr, U64 size);
 internal void *os_reserve_large(U64 size);
 internal B32 os_commit_large(void *ptr, U64 size);
 
+//- tec: numa, memory reserved for a node is backed by that node's memory once committed
+internal void *os_reserve_numa(U64 size, U32 node);
+internal void *os_reserve_large_numa(U64 size, U32 node);
+
 ////////////////////////////////
 //~ tec: @os_hooks Thread Info (Implemented Per-OS)
 
 internal U32 os_tid(void);
 internal void os_set_thread_name(String8 string);
+internal U32 os_thread_numa_node(void);
+internal B32 os_thread_bind_numa_node(U32 node);
 
 ////////////////////////////////
 //~ tec: @os_hooks Aborting (Implemented Per-OS)
@@ -206,6 +228,7 @@ internal void os_abort(S32 exit_code);
 internal OS_Handle      os_file_open(OS_AccessFlags flags, String8 path);
 internal void           os_file_close(OS_Handle file);
 internal U64            os_file_read(OS_Handle file, Rng1U64 rng, void *out_data);
+internal U64            os_file_read_stream(OS_Handle file, void *out_data, U64 size);
 internal void           os_file_resize(OS_Handle file, U64 size);
 internal U64            os_file_write(OS_Handle file, Rng1U64 rng, void *data);
 internal B32            os_file_set_times(OS_Handle file, DateTime time);
@@ -213,10 +236,16 @@ internal FileProperties os_properties_from_file(OS_Handle file);
 internal OS_FileID      os_id_from_file(OS_Handle file);
 internal B32            os_delete_file_at_path(String8 path);
 internal B32            os_copy_file_path(String8 dst, String8 src);
+internal B32            os_move_file_path(String8 dst, String8 src);
+internal B32            os_file_flush(OS_Handle file);
 internal String8        os_full_path_from_path(Arena *arena, String8 path);
 internal B32            os_file_path_exists(String8 path);
 internal FileProperties os_properties_from_file_path(String8 path);
 
+//- tec: standard streams, the handle belongs to the process and is never closed
+internal OS_Handle os_stdin(void);
+internal OS_Handle os_stdout(void);
+
 //- tec: file maps
 internal OS_Handle os_file_map_open(OS_AccessFlags flags, OS_Handle file);
 internal void      os_file_map_close(OS_Handle map);
@@ -232,6 +261,19 @@ internal void         os_file_iter_end(OS_FileIter *iter);
 //- tec: directory creation
 internal B32 os_make_directory(String8 path);
 
+////////////////////////////////
+//~ tec: @os_hooks Asynchronous I/O (Implemented Per-OS)
+
+//- tec: io queues, reads of files opened with OS_AccessFlag_Async run in the background and
+// complete on the queue. a read is at most 4GB, a file belongs to one queue for its lifetime.
+// files opened with OS_AccessFlag_Direct bypass the page cache, their reads need sector aligned
+// offsets, sizes and buffers
+internal OS_Handle os_io_queue_alloc(void);
+internal void      os_io_queue_release(OS_Handle queue);
+internal B32       os_io_queue_add_file(OS_Handle queue, OS_Handle file);
+internal B32       os_io_queue_read(OS_Handle queue, OS_Handle file, Rng1U64 rng, void *out_data, U64 user_data);
+internal U64       os_io_queue_wait(OS_Handle queue, OS_IOCompletion *out, U64 max_count, U64 endt_us);
+
 ////////////////////////////////
 //~ tec: @os_hooks Shared Memory (Implemented Per-OS)
 
@@ -241,6 +283,17 @@ internal void      os_shared_memory_close(OS_Handle handle);
 internal void *    os_shared_memory_view_open(OS_Handle handle, Rng1U64 range);
 internal void      os_shared_memory_view_close(OS_Handle handle, void *ptr, Rng1U64 range);
 
+////////////////////////////////
+//~ tec: @os_hooks Sockets (Implemented Per-OS)
+
+//- tec: blocking tcp streams. recv returns 0 once the peer closed, send writes everything or fails
+internal OS_Handle os_socket_listen(String8 host, U16 port);
+internal OS_Handle os_socket_accept(OS_Handle listener);
+internal OS_Handle os_socket_connect(String8 host, U16 port);
+internal U64       os_socket_recv(OS_Handle socket, void *data, U64 size);
+internal U64       os_socket_send(OS_Handle socket, void *data, U64 size);
+internal void      os_socket_close(OS_Handle socket);
+
 ////////////////////////////////
 //~ tec: @os_hooks Time (Implemented Per-OS)
 
@@ -222,6 +222,23 @@ os_commit_large(void *ptr, U64 size)
   return 1;
 }
 
+//- tec: numa
+
+internal void *
+os_reserve_numa(U64 size, U32 node)
+{
+  void *result = VirtualAllocExNuma(GetCurrentProcess(), 0, size, MEM_RESERVE, PAGE_READWRITE, node);
+  return result;
+}
+
+internal void *
+os_reserve_large_numa(U64 size, U32 node)
+{
+  // we commit on reserve because windows
+  void *result = VirtualAllocExNuma(GetCurrentProcess(), 0, size, MEM_RESERVE|MEM_COMMIT|MEM_LARGE_PAGES, PAGE_READWRITE, node);
+  return result;
+}
+
 ////////////////////////////////
 //~ tec: @os_hooks Thread Info (Implemented Per-OS)
 
@@ -277,6 +294,32 @@ os_set_thread_name(String8 name)
   scratch_end(scratch);
 }
 
+internal U32
+os_thread_numa_node(void)
+{
+  PROCESSOR_NUMBER processor = {0};
+  GetCurrentProcessorNumberEx(&processor);
+  USHORT node = 0;
+  if(!GetNumaProcessorNodeEx(&processor, &node) || node == MAXUSHORT)
+  {
+    node = 0;
+  }
+  return (U32)node;
+}
+
+// tec: keeps the calling thread on the processors of one node, so the memory it allocates there stays local
+internal B32
+os_thread_bind_numa_node(U32 node)
+{
+  GROUP_AFFINITY affinity = {0};
+  B32 result = (GetNumaNodeProcessorMaskEx((USHORT)node, &affinity) && affinity.Mask != 0);
+  if(result)
+  {
+    result = (SetThreadGroupAffinity(GetCurrentThread(), &affinity, 0) != 0);
+  }
+  return result;
+}
+
 ////////////////////////////////
 //~ tec: @os_hooks Aborting (Implemented Per-OS)
 
@@ -307,7 +350,10 @@ os_file_open(OS_AccessFlags flags, String8 path)
   if(flags & OS_AccessFlag_ShareWrite) {share_mode |= FILE_SHARE_WRITE|FILE_SHARE_DELETE;}
   if(flags & OS_AccessFlag_Write)   {creation_disposition = CREATE_ALWAYS;}
   if(flags & OS_AccessFlag_Append)  {creation_disposition = OPEN_ALWAYS;}
-  HANDLE file = CreateFileW((WCHAR *)path16.str, access_flags, share_mode, 0, creation_disposition, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, 0);
+  DWORD attributes = FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN;
+  if(flags & OS_AccessFlag_Async)   {attributes |= FILE_FLAG_OVERLAPPED;}
+  if(flags & OS_AccessFlag_Direct)  {attributes = (attributes & ~FILE_FLAG_SEQUENTIAL_SCAN) | FILE_FLAG_NO_BUFFERING;}
+  HANDLE file = CreateFileW((WCHAR *)path16.str, access_flags, share_mode, 0, creation_disposition, attributes, 0);
   if(file != INVALID_HANDLE_VALUE)
   {
     result.u64[0] = (U64)file;
@@ -417,6 +463,23 @@ os_file_write(OS_Handle file, Rng1U64 rng, void *data)
   return total_bytes_written;
 }
 
+// tec: reads from the handle's current position, which is all pipes and consoles have. returns what
+// was available, at most size bytes, and 0 once the writer closed its end or the file ended
+internal U64
+os_file_read_stream(OS_Handle file, void *out_data, U64 size)
+{
+  if(os_handle_match(file, os_handle_zero()) || size == 0) { return 0; }
+  HANDLE handle = (HANDLE)file.u64[0];
+  DWORD read_size = 0;
+  BOOL success = ReadFile(handle, out_data, u32_from_u64_saturate(size), &read_size, 0);
+  if(!success)
+  {
+    // tec: ERROR_BROKEN_PIPE is how a pipe reports its end
+    read_size = 0;
+  }
+  return read_size;
+}
+
 internal B32
 os_file_set_time(OS_Handle file, DateTime time)
 {
@@ -489,6 +552,50 @@ os_copy_file_path(String8 dst, String8 src)
   return result;
 }
 
+internal B32
+os_move_file_path(String8 dst, String8 src)
+{
+  Temp scratch = scratch_begin(0, 0);
+  String16 dst16 = str16_from_8(scratch.arena, dst);
+  String16 src16 = str16_from_8(scratch.arena, src);
+  B32 result = MoveFileExW((WCHAR*)src16.str, (WCHAR*)dst16.str, MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH);
+  scratch_end(scratch);
+  return result;
+}
+
+internal B32
+os_file_flush(OS_Handle file)
+{
+  if(os_handle_match(file, os_handle_zero())) { return 0; }
+  HANDLE handle = (HANDLE)file.u64[0];
+  B32 result = FlushFileBuffers(handle);
+  return result;
+}
+
+internal OS_Handle
+os_stdin(void)
+{
+  OS_Handle result = {0};
+  HANDLE handle = GetStdHandle(STD_INPUT_HANDLE);
+  if(handle != INVALID_HANDLE_VALUE && handle != 0)
+  {
+    result.u64[0] = (U64)handle;
+  }
+  return result;
+}
+
+internal OS_Handle
+os_stdout(void)
+{
+  OS_Handle result = {0};
+  HANDLE handle = GetStdHandle(STD_OUTPUT_HANDLE);
+  if(handle != INVALID_HANDLE_VALUE && handle != 0)
+  {
+    result.u64[0] = (U64)handle;
+  }
+  return result;
+}
+
 internal String8
 os_full_path_from_path(Arena *arena, String8 path)
 {
@@ -705,6 +812,12 @@ os_file_map_view_open(OS_Handle map, OS_AccessFlags flags, Rng1U64 range)
         access_flags = FILE_MAP_ALL_ACCESS|FILE_MAP_EXECUTE;
       }break;
     }
+    
+    // tec: writes go to private pages, the file and other views never see them
+    if(flags & OS_AccessFlag_CopyOnWrite)
+    {
+      access_flags = FILE_MAP_COPY;
+    }
   }
   
   /*
@@ -880,6 +993,83 @@ os_make_directory(String8 path)
   return(result);
 }
 
+////////////////////////////////
+//~ tec: @os_hooks Asynchronous I/O (Implemented Per-OS)
+
+// tec: an io completion port, every read carries an entity holding its OVERLAPPED until it completes
+internal OS_Handle
+os_io_queue_alloc(void)
+{
+  OS_Handle result = {0};
+  HANDLE port = CreateIoCompletionPort(INVALID_HANDLE_VALUE, 0, 0, 0);
+  if(port != 0)
+  {
+    result.u64[0] = (U64)port;
+  }
+  return result;
+}
+
+internal void
+os_io_queue_release(OS_Handle queue)
+{
+  if(os_handle_match(queue, os_handle_zero())) { return; }
+  CloseHandle((HANDLE)queue.u64[0]);
+}
+
+internal B32
+os_io_queue_add_file(OS_Handle queue, OS_Handle file)
+{
+  if(os_handle_match(queue, os_handle_zero()) || os_handle_match(file, os_handle_zero())) { return 0; }
+  HANDLE port = CreateIoCompletionPort((HANDLE)file.u64[0], (HANDLE)queue.u64[0], 0, 0);
+  return (port != 0);
+}
+
+internal B32
+os_io_queue_read(OS_Handle queue, OS_Handle file, Rng1U64 rng, void *out_data, U64 user_data)
+{
+  if(os_handle_match(queue, os_handle_zero()) || os_handle_match(file, os_handle_zero())) { return 0; }
+  if(dim_1u64(rng) > max_U32) { return 0; }
+  
+  OS_W32_Entity *entity = os_w32_entity_alloc(OS_W32_EntityKind_IORead);
+  entity->io_read.overlapped.Offset     = (DWORD)(rng.min&0x00000000ffffffffull);
+  entity->io_read.overlapped.OffsetHigh = (DWORD)((rng.min&0xffffffff00000000ull) >> 32);
+  entity->io_read.user_data = user_data;
+  
+  // tec: finished right away or pending, the completion is queued on the port either way
+  BOOL ok = ReadFile((HANDLE)file.u64[0], out_data, (DWORD)dim_1u64(rng), 0, &entity->io_read.overlapped);
+  if(!ok && GetLastError() != ERROR_IO_PENDING)
+  {
+    os_w32_entity_release(entity);
+    return 0;
+  }
+  return 1;
+}
+
+internal U64
+os_io_queue_wait(OS_Handle queue, OS_IOCompletion *out, U64 max_count, U64 endt_us)
+{
+  if(os_handle_match(queue, os_handle_zero()) || max_count == 0) { return 0; }
+  
+  OVERLAPPED_ENTRY entries[64];
+  ULONG count = 0;
+  ULONG max = (ULONG)Min(max_count, ArrayCount(entries));
+  DWORD sleep_ms = os_w32_sleep_ms_from_endt_us(endt_us);
+  if(!GetQueuedCompletionStatusEx((HANDLE)queue.u64[0], entries, max, &count, sleep_ms, FALSE))
+  {
+    return 0;
+  }
+  
+  for(ULONG i = 0; i < count; i++)
+  {
+    OS_W32_Entity *entity = (OS_W32_Entity *)((U8 *)entries[i].lpOverlapped - OffsetOf(OS_W32_Entity, io_read.overlapped));
+    out[i].user_data = entity->io_read.user_data;
+    out[i].bytes     = entries[i].dwNumberOfBytesTransferred;
+    out[i].failed    = (entries[i].lpOverlapped->Internal != 0);
+    os_w32_entity_release(entity);
+  }
+  return count;
+}
+
 ////////////////////////////////
 //~ tec: @os_hooks Shared Memory (Implemented Per-OS)
 
@@ -936,6 +1126,135 @@ os_shared_memory_view_close(OS_Handle handle, void *ptr, Rng1U64 range)
   UnmapViewOfFile(ptr);
 }
 
+////////////////////////////////
+//~ tec: @os_hooks Sockets (Implemented Per-OS)
+
+global B32 os_w32_winsock_initialized = 0;
+
+internal B32
+os_w32_socket_init(void)
+{
+  if(!os_w32_winsock_initialized)
+  {
+    WSADATA wsa_data = {0};
+    os_w32_winsock_initialized = (WSAStartup(MAKEWORD(2, 2), &wsa_data) == 0);
+  }
+  return os_w32_winsock_initialized;
+}
+
+internal B32
+os_w32_sockaddr_from_host(String8 host, U16 port, struct sockaddr_in *out_addr)
+{
+  Temp scratch = scratch_begin(0, 0);
+  String8 host_copy = push_str8_copy(scratch.arena, host.size ? host : str8_lit("127.0.0.1"));
+  MemoryZeroStruct(out_addr);
+  out_addr->sin_family = AF_INET;
+  out_addr->sin_port = htons(port);
+  B32 result = (inet_pton(AF_INET, (char *)host_copy.str, &out_addr->sin_addr) == 1);
+  scratch_end(scratch);
+  return result;
+}
+
+internal OS_Handle
+os_socket_listen(String8 host, U16 port)
+{
+  OS_Handle result = {0};
+  struct sockaddr_in addr = {0};
+  if(os_w32_socket_init() && os_w32_sockaddr_from_host(host, port, &addr))
+  {
+    SOCKET s = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if(s != INVALID_SOCKET)
+    {
+      BOOL reuse = 1;
+      setsockopt(s, SOL_SOCKET, SO_REUSEADDR, (char *)&reuse, sizeof(reuse));
+      if(bind(s, (struct sockaddr *)&addr, sizeof(addr)) == 0 && listen(s, SOMAXCONN) == 0)
+      {
+        result.u64[0] = (U64)s;
+      }
+      else
+      {
+        closesocket(s);
+      }
+    }
+  }
+  return result;
+}
+
+internal OS_Handle
+os_socket_accept(OS_Handle listener)
+{
+  OS_Handle result = {0};
+  SOCKET s = accept((SOCKET)listener.u64[0], 0, 0);
+  if(s != INVALID_SOCKET)
+  {
+    // tec: replies are written in one go, don't hold them back for coalescing
+    BOOL no_delay = 1;
+    setsockopt(s, IPPROTO_TCP, TCP_NODELAY, (char *)&no_delay, sizeof(no_delay));
+    result.u64[0] = (U64)s;
+  }
+  return result;
+}
+
+internal OS_Handle
+os_socket_connect(String8 host, U16 port)
+{
+  OS_Handle result = {0};
+  struct sockaddr_in addr = {0};
+  if(os_w32_socket_init() && os_w32_sockaddr_from_host(host, port, &addr))
+  {
+    SOCKET s = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if(s != INVALID_SOCKET)
+    {
+      if(connect(s, (struct sockaddr *)&addr, sizeof(addr)) == 0)
+      {
+        BOOL no_delay = 1;
+        setsockopt(s, IPPROTO_TCP, TCP_NODELAY, (char *)&no_delay, sizeof(no_delay));
+        result.u64[0] = (U64)s;
+      }
+      else
+      {
+        closesocket(s);
+      }
+    }
+  }
+  return result;
+}
+
+internal U64
+os_socket_recv(OS_Handle socket, void *data, U64 size)
+{
+  int to_read = (int)Min(size, (U64)max_S32);
+  int read = recv((SOCKET)socket.u64[0], (char *)data, to_read, 0);
+  U64 result = (read > 0) ? (U64)read : 0;
+  return result;
+}
+
+internal U64
+os_socket_send(OS_Handle socket, void *data, U64 size)
+{
+  U64 total_sent = 0;
+  for(;total_sent < size;)
+  {
+    int to_send = (int)Min(size - total_sent, (U64)max_S32);
+    int sent = send((SOCKET)socket.u64[0], (char *)data + total_sent, to_send, 0);
+    if(sent <= 0)
+    {
+      break;
+    }
+    total_sent += (U64)sent;
+  }
+  return total_sent;
+}
+
+internal void
+os_socket_close(OS_Handle socket)
+{
+  if(socket.u64[0] != 0)
+  {
+    closesocket((SOCKET)socket.u64[0]);
+  }
+}
+
 ////////////////////////////////
 //~ tec: @os_hooks Time (Implemented Per-OS)
 
@@ -1654,6 +1973,7 @@ w32_entry_point_caller(int argc, WCHAR **wargv)
     }
     
     // tec: try to enable large pages if we can
+    B32 large_pages_enabled = 0;
     {
       HANDLE token;
       if(OpenProcessToken(GetCurrentProcess(), TOKEN_ADJUST_PRIVILEGES | TOKEN_QUERY, &token))
@@ -1665,7 +1985,11 @@ w32_entry_point_caller(int argc, WCHAR **wargv)
           priv.PrivilegeCount           = 1;
           priv.Privileges[0].Luid       = luid;
           priv.Privileges[0].Attributes = SE_PRIVILEGE_ENABLED;
-          AdjustTokenPrivileges(token, 0, &priv, sizeof(priv), 0, 0);
+          // tec: succeeds without the privilege too, only the last error tells
+          if(AdjustTokenPrivileges(token, 0, &priv, sizeof(priv), 0, 0))
+          {
+            large_pages_enabled = (GetLastError() == ERROR_SUCCESS);
+          }
         }
         CloseHandle(token);
       }
@@ -1693,6 +2017,10 @@ w32_entry_point_caller(int argc, WCHAR **wargv)
       info->page_size               = sysinfo.dwPageSize;
       info->large_page_size         = GetLargePageMinimum();
       info->allocation_granularity  = sysinfo.dwAllocationGranularity;
+      info->large_pages_enabled     = (large_pages_enabled && info->large_page_size != 0);
+      
+      ULONG highest_numa_node = 0;
+      info->numa_node_count         = GetNumaHighestNodeNumber(&highest_numa_node) ? (U32)highest_numa_node + 1 : 1;
     }
     {
       OS_ProcessInfo *info = &os_w32_state.process_info;
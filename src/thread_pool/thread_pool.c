@@ -23,6 +23,16 @@ tp_run_tasks(TP_Context *pool, TP_Worker *worker)
   }
 }
 
+// tec: worker 0 is the thread calling tp_for_parallel, it is left where it is
+internal void
+tp_worker_bind_numa_node(TP_Worker *worker)
+{
+  if (worker->id > 0 && os_get_system_info()->numa_node_count > 1)
+  {
+    os_thread_bind_numa_node(worker->numa_node);
+  }
+}
+
 internal void
 tp_worker_main(void *raw_worker)
 {
@@ -30,6 +40,7 @@ tp_worker_main(void *raw_worker)
   tctx_init_and_equip(&tctx_);
   TP_Worker *worker = raw_worker;
   TP_Context *pool = worker->pool;
+  tp_worker_bind_numa_node(worker);
   while (pool->is_live) 
   {
     if (os_semaphore_take(pool->task_semaphore, max_U64)) 
@@ -46,6 +57,7 @@ tp_worker_main_shared(void *raw_worker)
   tctx_init_and_equip(&tctx_);
   TP_Worker  *worker = raw_worker;
   TP_Context *pool = worker->pool;
+  tp_worker_bind_numa_node(worker);
   while (pool->is_live)
   {
     if (os_semaphore_take(pool->exec_semaphore, max_U64))
@@ -93,11 +105,14 @@ tp_alloc(Arena *arena, U32 worker_count, U32 max_worker_count, String8 name)
   pool->worker_count = worker_count;
   pool->worker_arr = push_array(arena, TP_Worker, worker_count);
   
+  // tec: workers are spread over the numa nodes round robin
+  U32 numa_node_count = os_get_system_info()->numa_node_count;
   for (U64 i = 0; i < worker_count; i += 1) 
   {
     TP_Worker *worker = &pool->worker_arr[i];
     worker->id = i;
     worker->pool = pool;
+    worker->numa_node = (numa_node_count > 1) ? (U32)(i % numa_node_count) : 0;
   }
   
   for (U64 i = 1; i < worker_count; i += 1) 
@@ -147,7 +162,13 @@ tp_arena_alloc(TP_Context *pool)
   Arena **arr = push_array(scratch.arena, Arena *, pool->worker_count);
   for (U64 i = 0; i < pool->worker_count; ++i) 
   {
-    arr[i] = arena_alloc(.reserve_size=MB(256), .commit_size=MB(16));
+    // tec: each worker's arena is on the node the worker keeps to, so task scratch memory is never remote
+    ArenaFlags flags = 0;
+    if (i > 0 && os_get_system_info()->numa_node_count > 1)
+    {
+      flags = ArenaFlagsFromNumaNode(pool->worker_arr[i].numa_node);
+    }
+    arr[i] = arena_alloc(.reserve_size=MB(256), .commit_size=MB(16), .flags=flags);
   }
   Arena **dst = push_array(arr[0], Arena *, pool->worker_count);
   MemoryCopy(dst, arr, sizeof(Arena*) * pool->worker_count);
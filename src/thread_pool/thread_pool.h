@@ -26,6 +26,9 @@ struct TP_Worker
   U64 id;
   OS_Handle handle;
   struct TP_Context* pool;
+  
+  // tec: the node the worker keeps to and its arena is allocated on, when there is more than one
+  U32 numa_node;
 };
 
 typedef struct TP_Context TP_Context;
@@ -55,5 +58,6 @@ internal TP_Temp      tp_temp_begin(TP_Arena *arena);
 internal void         tp_temp_end(TP_Temp temp);
 internal void         tp_for_parallel(TP_Context *pool, TP_Arena *arena, U64 task_count, TP_TaskFunc *task_func, void *task_data);
 internal Rng1U64 *    tp_divide_work(Arena *arena, U64 item_count, U32 worker_count);
+internal void         tp_worker_bind_numa_node(TP_Worker *worker);
 
 #endif //THREAD_POOL_H
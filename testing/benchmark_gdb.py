@@ -28,7 +28,7 @@ def parse_time_from_log(log_path, label, unit='ms'):
     return None
 
 
-def run_gdb_query(csv_path, query_path):
+def run_gdb_query(csv_path, query_path, use_index=False):
     if not os.path.exists("gdb_logs"):
         os.mkdir("gdb_logs")
 
@@ -62,6 +62,26 @@ def run_gdb_query(csv_path, query_path):
             print("[ERROR] Failed to run CREATE command")
             return
 
+    # Step 1b: Index the first column
+    if use_index:
+        with open(csv_path, 'r') as f:
+            index_col = f.readline().strip().split(',')[0].strip('"')
+
+        if not os.path.exists(f"gdb_data/benchmark/{table_name}/idx_{index_col}.idx"):
+            index_query = f"USE benchmark; CREATE INDEX idx_{index_col} ON {table_name} ({index_col})"
+            cmd = ["gdb.exe", f'--query="{index_query}"']
+            result = subprocess.run(cmd, capture_output=True, text=True)
+
+            try:
+                os.rename("log.txt", f"gdb_logs/{table_name}_index.txt")
+                os.rename("profile.json", f"gdb_logs/{table_name}_index.json")
+            except Exception:
+                pass
+
+            if result.returncode != 0:
+                print("[ERROR] Failed to run CREATE INDEX command")
+                return
+
     # Step 2: Run SELECT query
     cmd = ["gdb.exe", f'--query="USE benchmark; {query.replace("data", table_name)}"']
     result = subprocess.run(cmd, capture_output=True, text=True)
@@ -85,7 +105,7 @@ def run_gdb_query(csv_path, query_path):
     print(f"GDB Benchmark Results:")
     print(f"  Database location  : gdb_data/benchmark/{table_name}")
     print(f"  Table name         : {table_name}")
-    print(f"  Index on first col : N/A")
+    print(f"  Index on first col : {'Yes' if use_index else 'No'}")
     print(f"  Load time (ms)     : {load_time_ms:.3f}" if load_time_ms is not None else "  Load time (ms)     : 0")
     print(f"  Query time (ms)    : {query_time_ms:.3f}" if query_time_ms is not None else "  Query time (ms)    : N/A")
     print(f"  Kernel time (ms)   : {gpu_kernel_time_ms:.3f}" if gpu_kernel_time_ms is not None else "  Kernel Time (ms)    : N/A")
@@ -94,6 +114,7 @@ if __name__ == "__main__":
     parser = argparse.ArgumentParser(description="Benchmark query execution using gdb.exe")
     parser.add_argument("csv", help="Path to CSV file")
     parser.add_argument("query", help="Path to SQL query file")
+    parser.add_argument("--use-index", action="store_true")
 
     args = parser.parse_args()
-    run_gdb_query(args.csv, args.query)
+    run_gdb_query(args.csv, args.query, args.use_index)
@@ -0,0 +1,159 @@
+import socket
+import struct
+import argparse
+import threading
+import time
+
+REQUEST_MAGIC = 0x51424447   # 'GDBQ'
+RESPONSE_MAGIC = 0x52424447  # 'GDBR'
+FLAG_SHUTDOWN = 1 << 0
+
+STATUS_NAMES = {0: "ok", 1: "error", 2: "bad request"}
+
+# GDB_ColumnType -> (struct format, size)
+COLUMN_TYPES = {
+    1: ("I", 4),  # U32
+    2: ("Q", 8),  # U64
+    3: ("f", 4),  # F32
+    4: ("d", 8),  # F64
+    5: (None, 0), # String8
+}
+
+
+class GDBClient:
+    def __init__(self, host="127.0.0.1", port=7450):
+        self.sock = socket.create_connection((host, port))
+        self.sock.setsockopt(socket.IPPROTO_TCP, socket.TCP_NODELAY, 1)
+
+    def close(self):
+        self.sock.close()
+
+    def _recv_exact(self, size):
+        data = bytearray()
+        while len(data) < size:
+            chunk = self.sock.recv(size - len(data))
+            if not chunk:
+                raise ConnectionError("server closed the connection")
+            data.extend(chunk)
+        return bytes(data)
+
+    def query(self, sql, flags=0):
+        payload = sql.encode("utf-8")
+        self.sock.sendall(struct.pack("<IIQ", REQUEST_MAGIC, flags, len(payload)) + payload)
+
+        magic, status, size = struct.unpack("<IIQ", self._recv_exact(16))
+        if magic != RESPONSE_MAGIC:
+            raise ValueError(f"bad response magic {magic:08x}")
+        body = self._recv_exact(size) if size else b""
+        return status, decode_result_sets(body)
+
+    def shutdown(self):
+        return self.query("", FLAG_SHUTDOWN)
+
+
+def decode_result_sets(body):
+    result_sets = []
+    offset = 0
+    while offset < len(body):
+        column_count, _, row_count = struct.unpack_from("<IIQ", body, offset)
+        offset += 16
+
+        columns = []
+        for _ in range(column_count):
+            column_type, has_nulls, name_size, _ = struct.unpack_from("<IIII", body, offset)
+            offset += 16
+            name = body[offset:offset + name_size].decode("utf-8")
+            offset += name_size
+            columns.append((name, column_type, has_nulls))
+
+        values = []
+        for name, column_type, has_nulls in columns:
+            validity = None
+            if has_nulls:
+                word_count = (row_count + 63) // 64
+                validity = struct.unpack_from(f"<{word_count}Q", body, offset)
+                offset += word_count * 8
+
+            fmt, size = COLUMN_TYPES[column_type]
+            if fmt is None:
+                offsets = struct.unpack_from(f"<{row_count + 1}Q", body, offset)
+                offset += (row_count + 1) * 8
+                data = body[offset:offset + offsets[-1]]
+                offset += offsets[-1]
+                column_values = [data[offsets[i]:offsets[i + 1]].decode("utf-8", errors="replace") for i in range(row_count)]
+            else:
+                column_values = list(struct.unpack_from(f"<{row_count}{fmt}", body, offset))
+                offset += row_count * size
+
+            if validity is not None:
+                column_values = [v if (validity[i >> 6] >> (i & 63)) & 1 else None for i, v in enumerate(column_values)]
+            values.append(column_values)
+
+        rows = list(zip(*values)) if values else []
+        result_sets.append(([c[0] for c in columns], rows))
+    return result_sets
+
+
+def run_timed(host, port, sql, repeat, timings, lock):
+    client = GDBClient(host, port)
+    try:
+        local = []
+        for _ in range(repeat):
+            start = time.perf_counter()
+            client.query(sql)
+            local.append((time.perf_counter() - start) * 1000.0)
+        with lock:
+            timings.extend(local)
+    finally:
+        client.close()
+
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(description="Send queries to a gdb.exe running with -server")
+    parser.add_argument("query", nargs="?", help="SQL to execute")
+    parser.add_argument("--host", default="127.0.0.1")
+    parser.add_argument("--port", type=int, default=7450)
+    parser.add_argument("--repeat", type=int, default=1, help="Run the query this many times and report latency")
+    parser.add_argument("--clients", type=int, default=1, help="Run the query from this many connections at once")
+    parser.add_argument("--shutdown", action="store_true", help="Stop the server after the query")
+    args = parser.parse_args()
+
+    if args.query and args.clients > 1:
+        timings = []
+        lock = threading.Lock()
+        threads = [threading.Thread(target=run_timed, args=(args.host, args.port, args.query, args.repeat, timings, lock))
+                   for _ in range(args.clients)]
+        start = time.perf_counter()
+        for t in threads:
+            t.start()
+        for t in threads:
+            t.join()
+        elapsed = time.perf_counter() - start
+        timings.sort()
+        print(f"{len(timings)} queries from {args.clients} clients in {elapsed:.3f} s ({len(timings) / elapsed:.1f} queries/s)")
+        print(f"Round trip (ms) min {timings[0]:.3f} median {timings[len(timings) // 2]:.3f} max {timings[-1]:.3f}")
+        args.query = None
+
+    client = GDBClient(args.host, args.port)
+    try:
+        if args.query:
+            timings = []
+            for _ in range(args.repeat):
+                start = time.perf_counter()
+                status, result_sets = client.query(args.query)
+                timings.append((time.perf_counter() - start) * 1000.0)
+
+            print(f"Status: {STATUS_NAMES.get(status, status)}")
+            for columns, rows in result_sets:
+                print(" | ".join(columns))
+                for row in rows[:20]:
+                    print(" | ".join("NULL" if v is None else str(v) for v in row))
+                if len(rows) > 20:
+                    print(f"... {len(rows) - 20} more rows")
+            timings.sort()
+            print(f"Round trip (ms) min {timings[0]:.3f} median {timings[len(timings) // 2]:.3f} max {timings[-1]:.3f}")
+
+        if args.shutdown:
+            client.shutdown()
+    finally:
+        client.close()
@@ -24,7 +24,7 @@ def run_benchmark(engine, csv_path, query_path, args):
     cmd = [sys.executable, script, csv_path, query_path]
     if engine in ["sqlite", "duckdb"] and args.in_memory:
         cmd.append("--in-memory")
-    if args.use_index and engine != "gdb":
+    if args.use_index:
         cmd.append("--use-index")
 
     dataset_name = os.path.basename(os.path.dirname(csv_path))